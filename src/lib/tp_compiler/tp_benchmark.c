@@ -0,0 +1,681 @@
+
+// (C) Shin'ichi Ichikawa. Released under the MIT license.
+
+#include "tp_compiler.h"
+
+// Compilation throughput benchmark(-k):
+// A synthetic program is generated from the benchmark config string and compiled in-process
+// many times(see tp_measure_compile_phase). The wall time of each phase is written to stdout
+// as JSON with the percentiles and the throughput at the percentiles(units per second).
+//
+// Benchmark config string(comma separated key=value, all keys are optional):
+//  statements=64  : number of statements. The program is up to TP_MAX_LINE_BYTES.
+//  depth=4        : nesting level of parentheses of each expression(up to 62).
+//  variables=8    : number of variables. The first statements declare them.
+//  params=4       : number of undefined variables(input parameters, up to 8).
+//  operators=+-*/ : mix of the binary operators. A repeated operator is chosen more often.
+//  iterations=100 : number of measured compiles after a warm-up compile.
+//  seed=1         : seed of the program generator. The same seed makes the same program.
+//
+// Example of statements=3,depth=1,variables=2,params=2:
+// int32_t v0 = (-p0 + -71) / 68;
+// int32_t v1 = (-v0 / 58) + 69;
+// v0 = p0 - (p0 / 70);
+//
+// Note:
+//  (1) The divisor is a constant except 0, so that the program does not trap.
+
+#define TP_BENCHMARK_STATEMENT_NUM_MAX (TP_MAX_LINE_BYTES / 4)
+#define TP_BENCHMARK_EXPRESSION_DEPTH_MAX 62
+#define TP_BENCHMARK_VARIABLE_NUM_MAX 10000
+#define TP_BENCHMARK_OPERATOR_NUM_MAX 16
+#define TP_BENCHMARK_ITERATION_NUM_MAX 1000000
+#define TP_BENCHMARK_CONST_VALUE_MAX 99
+#define TP_BENCHMARK_SOURCE_SIZE_ALLOCATE_UNIT 4096
+#define TP_BENCHMARK_ELEMENT_BUFFER_SIZE 32
+
+typedef struct tp_benchmark_config_{
+    uint32_t member_statement_num;
+    uint32_t member_expression_depth;
+    uint32_t member_variable_num;
+    uint32_t member_param_num;
+    uint8_t member_operators[TP_BENCHMARK_OPERATOR_NUM_MAX + 1];
+    uint32_t member_operator_num;
+    uint32_t member_iteration_num;
+    uint64_t member_seed;
+}TP_BENCHMARK_CONFIG;
+
+typedef struct tp_benchmark_source_{
+    uint8_t* member_string;
+    rsize_t member_length;
+    rsize_t member_size;
+    uint64_t member_random; // xorshift64* state.
+    uint32_t member_defined_variable_num;
+}TP_BENCHMARK_SOURCE;
+
+static const TP_BENCHMARK_CONFIG benchmark_config_default = {
+    .member_statement_num = 64,
+    .member_expression_depth = 4,
+    .member_variable_num = 8,
+    .member_param_num = 4,
+    .member_operators = "+-*/",
+    .member_operator_num = 4,
+    .member_iteration_num = 100,
+    .member_seed = 1
+};
+
+static bool parse_benchmark_config(TP_SYMBOL_TABLE* symbol_table, uint8_t* string, TP_BENCHMARK_CONFIG* config);
+static bool parse_benchmark_config_value(
+    uint8_t* value, rsize_t value_length, uint64_t value_max, uint64_t* result
+);
+static bool make_benchmark_program(
+    TP_SYMBOL_TABLE* symbol_table, TP_BENCHMARK_CONFIG* config, TP_BENCHMARK_SOURCE* source
+);
+static bool make_benchmark_expression(
+    TP_SYMBOL_TABLE* symbol_table, TP_BENCHMARK_CONFIG* config, TP_BENCHMARK_SOURCE* source, uint32_t depth
+);
+static bool make_benchmark_factor(
+    TP_SYMBOL_TABLE* symbol_table, TP_BENCHMARK_CONFIG* config, TP_BENCHMARK_SOURCE* source, bool is_divisor
+);
+static bool append_benchmark_source(TP_SYMBOL_TABLE* symbol_table, TP_BENCHMARK_SOURCE* source, char* string);
+static uint64_t next_benchmark_random(TP_BENCHMARK_SOURCE* source);
+static int compare_wall_time(const void* param1, const void* param2);
+static void write_benchmark_phase(
+    FILE* write_file, const char* name, const char* unit, uint64_t unit_num,
+    uint64_t* wall_time, uint32_t iteration_num, bool is_last
+);
+static double calc_throughput(uint64_t unit_num, uint64_t wall_time);
+
+bool tp_benchmark(TP_SYMBOL_TABLE* symbol_table)
+{
+    bool is_success = false;
+
+    TP_BENCHMARK_SOURCE source = { 0 };
+    uint64_t* wall_time = NULL;
+    rsize_t wall_time_size = 0;
+
+    TP_BENCHMARK_CONFIG config = benchmark_config_default;
+
+    if ( ! parse_benchmark_config(symbol_table, symbol_table->member_benchmark_config, &config)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! make_benchmark_program(symbol_table, &config, &source)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    // wall_time[phase * iterations + i]: the last phase is the total of the phases.
+    uint32_t iteration_num = config.member_iteration_num;
+
+    wall_time_size = sizeof(uint64_t) * (TP_COMPILE_PHASE_NUM + 1) * iteration_num;
+
+    wall_time = (uint64_t*)TP_CALLOC(symbol_table, 1, wall_time_size);
+
+    if (NULL == wall_time){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        goto error_proc;
+    }
+
+    TP_OPTIMIZATION_LEVEL level = symbol_table->member_optimization_level;
+
+    TP_COMPILE_PHASE_RECORD phase_record[TP_COMPILE_PHASE_NUM] = { 0 };
+
+    // NOTE: The warm-up compile is not measured.
+    if ( ! tp_measure_compile_phase(source.member_string, source.member_length, level, phase_record)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    for (uint32_t i = 0; iteration_num > i; ++i){
+
+        if ( ! tp_measure_compile_phase(source.member_string, source.member_length, level, phase_record)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            goto error_proc;
+        }
+
+        uint64_t total_wall_time = 0;
+
+        for (uint32_t j = 0; TP_COMPILE_PHASE_NUM > j; ++j){
+
+            wall_time[j * iteration_num + i] = phase_record[j].member_wall_time;
+
+            total_wall_time += phase_record[j].member_wall_time;
+        }
+
+        wall_time[TP_COMPILE_PHASE_NUM * iteration_num + i] = total_wall_time;
+    }
+
+    for (uint32_t i = 0; TP_COMPILE_PHASE_NUM >= i; ++i){
+
+        qsort(wall_time + i * iteration_num, iteration_num, sizeof(uint64_t), compare_wall_time);
+    }
+
+    FILE* write_file = stdout;
+
+    fprintf_s(write_file, "{\n");
+    fprintf_s(
+        write_file,
+        "  \"config\": { \"statements\": %u, \"depth\": %u, \"variables\": %u, \"params\": %u, "
+        "\"operators\": \"%s\", \"iterations\": %u, \"seed\": %llu, \"optimization_level\": %d },\n",
+        config.member_statement_num, config.member_expression_depth, config.member_variable_num,
+        config.member_param_num, config.member_operators, config.member_iteration_num,
+        (unsigned long long)(config.member_seed), (int)level
+    );
+    fprintf_s(
+        write_file,
+        "  \"program\": { \"source_bytes\": %llu, \"tokens\": %llu, \"nodes\": %llu, "
+        "\"wasm_bytes\": %llu, \"x64_bytes\": %llu },\n",
+        (unsigned long long)(source.member_length),
+        (unsigned long long)(phase_record[TP_COMPILE_PHASE_TOKEN].member_unit_num),
+        (unsigned long long)(phase_record[TP_COMPILE_PHASE_PARSE_TREE].member_unit_num),
+        (unsigned long long)(phase_record[TP_COMPILE_PHASE_WASM].member_unit_num),
+        (unsigned long long)(phase_record[TP_COMPILE_PHASE_X64_CODE].member_unit_num)
+    );
+    fprintf_s(write_file, "  \"phases\": [\n");
+
+    for (uint32_t i = 0; TP_COMPILE_PHASE_NUM > i; ++i){
+
+        write_benchmark_phase(
+            write_file, tp_get_compile_phase_name(i), tp_get_compile_phase_unit(i), phase_record[i].member_unit_num,
+            wall_time + i * iteration_num, iteration_num, false
+        );
+    }
+
+    write_benchmark_phase(
+        write_file, "total", "source_bytes", source.member_length,
+        wall_time + TP_COMPILE_PHASE_NUM * iteration_num, iteration_num, true
+    );
+
+    fprintf_s(write_file, "  ]\n");
+    fprintf_s(write_file, "}\n");
+
+    if (0 != fflush(write_file)){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        goto error_proc;
+    }
+
+    is_success = true;
+
+error_proc:
+
+    if (wall_time){
+
+        TP_FREE(symbol_table, &wall_time, wall_time_size);
+    }
+
+    if (source.member_string){
+
+        TP_FREE(symbol_table, &(source.member_string), source.member_size);
+    }
+
+    return is_success;
+}
+
+static bool parse_benchmark_config(TP_SYMBOL_TABLE* symbol_table, uint8_t* string, TP_BENCHMARK_CONFIG* config)
+{
+    uint8_t* current_pos = string;
+
+    while ('\0' != *current_pos){
+
+        uint8_t* key = current_pos;
+
+        uint8_t* equal_pos = strchr(key, '=');
+
+        if (NULL == equal_pos){
+
+            goto fail;
+        }
+
+        rsize_t key_length = equal_pos - key;
+
+        uint8_t* value = equal_pos + 1;
+
+        uint8_t* comma_pos = strchr(value, ',');
+
+        rsize_t value_length = (comma_pos ? (rsize_t)(comma_pos - value) : strlen(value));
+
+        current_pos = (comma_pos ? comma_pos + 1 : value + value_length);
+
+        uint64_t result = 0;
+
+#define IS_BENCHMARK_CONFIG_KEY(name) \
+    ((sizeof(name) - 1 == key_length) && (0 == strncmp(key, (name), key_length)))
+
+        if (IS_BENCHMARK_CONFIG_KEY("statements")){
+
+            if ( ! parse_benchmark_config_value(value, value_length, TP_BENCHMARK_STATEMENT_NUM_MAX, &result)){
+
+                goto fail;
+            }
+
+            config->member_statement_num = (uint32_t)result;
+        }else if (IS_BENCHMARK_CONFIG_KEY("depth")){
+
+            if ( ! parse_benchmark_config_value(value, value_length, TP_BENCHMARK_EXPRESSION_DEPTH_MAX, &result)){
+
+                goto fail;
+            }
+
+            config->member_expression_depth = (uint32_t)result;
+        }else if (IS_BENCHMARK_CONFIG_KEY("variables")){
+
+            if ( ! parse_benchmark_config_value(value, value_length, TP_BENCHMARK_VARIABLE_NUM_MAX, &result)){
+
+                goto fail;
+            }
+
+            config->member_variable_num = (uint32_t)result;
+        }else if (IS_BENCHMARK_CONFIG_KEY("params")){
+
+            if ( ! parse_benchmark_config_value(value, value_length, TP_X64_CALL_ARGS_NUM_MAX, &result)){
+
+                goto fail;
+            }
+
+            config->member_param_num = (uint32_t)result;
+        }else if (IS_BENCHMARK_CONFIG_KEY("operators")){
+
+            if ((0 == value_length) || (TP_BENCHMARK_OPERATOR_NUM_MAX < value_length)){
+
+                goto fail;
+            }
+
+            for (rsize_t i = 0; value_length > i; ++i){
+
+                switch (value[i]){
+                case '+':
+//                  break;
+                case '-':
+//                  break;
+                case '*':
+//                  break;
+                case '/':
+                    config->member_operators[i] = value[i];
+                    break;
+                default:
+                    goto fail;
+                }
+            }
+
+            config->member_operators[value_length] = '\0';
+            config->member_operator_num = (uint32_t)value_length;
+        }else if (IS_BENCHMARK_CONFIG_KEY("iterations")){
+
+            if ( ! parse_benchmark_config_value(value, value_length, TP_BENCHMARK_ITERATION_NUM_MAX, &result)){
+
+                goto fail;
+            }
+
+            config->member_iteration_num = (uint32_t)result;
+        }else if (IS_BENCHMARK_CONFIG_KEY("seed")){
+
+            if ( ! parse_benchmark_config_value(value, value_length, UINT64_MAX, &result)){
+
+                goto fail;
+            }
+
+            config->member_seed = result;
+        }else{
+
+            goto fail;
+        }
+
+#undef IS_BENCHMARK_CONFIG_KEY
+    }
+
+    if ((0 == config->member_statement_num) || (0 == config->member_variable_num) ||
+        (0 == config->member_iteration_num)){
+
+        goto fail;
+    }
+
+    return true;
+
+fail:
+
+    TP_PUT_LOG_MSG(
+        symbol_table, TP_LOG_TYPE_DISP_FORCE,
+        TP_MSG_FMT("ERROR: bad benchmark config string(%1)."),
+        TP_LOG_PARAM_STRING(string)
+    );
+
+    return false;
+}
+
+static bool parse_benchmark_config_value(
+    uint8_t* value, rsize_t value_length, uint64_t value_max, uint64_t* result)
+{
+    if (0 == value_length){
+
+        return false;
+    }
+
+    uint64_t tmp_result = 0;
+
+    for (rsize_t i = 0; value_length > i; ++i){
+
+        if ( ! isdigit(value[i])){
+
+            return false;
+        }
+
+        uint64_t digit = (uint64_t)(value[i] - '0');
+
+        if ((value_max - digit) / 10 < tmp_result){
+
+            return false;
+        }
+
+        tmp_result = tmp_result * 10 + digit;
+    }
+
+    *result = tmp_result;
+
+    return true;
+}
+
+static bool make_benchmark_program(
+    TP_SYMBOL_TABLE* symbol_table, TP_BENCHMARK_CONFIG* config, TP_BENCHMARK_SOURCE* source)
+{
+    // NOTE: xorshift64* needs the state except 0.
+    source->member_random = config->member_seed ? config->member_seed : UINT64_C(0x9e3779b97f4a7c15);
+    source->member_defined_variable_num = 0;
+
+    char element[TP_BENCHMARK_ELEMENT_BUFFER_SIZE] = { 0 };
+
+    for (uint32_t i = 0; config->member_statement_num > i; ++i){
+
+        uint32_t variable_index = i % config->member_variable_num;
+
+        sprintf_s(
+            element, sizeof(element), "%sv%u = ",
+            (config->member_variable_num > i) ? "int32_t " : "", variable_index
+        );
+
+        if ( ! append_benchmark_source(symbol_table, source, element)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        if ( ! make_benchmark_expression(symbol_table, config, source, config->member_expression_depth)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        if ( ! append_benchmark_source(symbol_table, source, ";\n")){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        // NOTE: The declared variable is not used by the expression of its own declaration.
+        if (config->member_variable_num > i){
+
+            ++(source->member_defined_variable_num);
+        }
+    }
+
+    return true;
+}
+
+static bool make_benchmark_expression(
+    TP_SYMBOL_TABLE* symbol_table, TP_BENCHMARK_CONFIG* config, TP_BENCHMARK_SOURCE* source, uint32_t depth)
+{
+    // Expression -> Factor Operator Factor                      (0 == depth)
+    //             | '(' Expression ')' Operator Factor          (0 < depth)
+    //             | Factor Operator '(' Expression ')'          (0 < depth, except division)
+    char operator_string[] = " ? ";
+
+    operator_string[1] = config->member_operators[next_benchmark_random(source) % config->member_operator_num];
+
+    bool is_division = ('/' == operator_string[1]);
+
+    bool is_subexpression_first = (0 < depth) && (is_division || (next_benchmark_random(source) & 1));
+
+    if (is_subexpression_first){
+
+        if ( ! append_benchmark_source(symbol_table, source, "(")){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        if ( ! make_benchmark_expression(symbol_table, config, source, depth - 1)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        if ( ! append_benchmark_source(symbol_table, source, ")")){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+    }else if ( ! make_benchmark_factor(symbol_table, config, source, false)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! append_benchmark_source(symbol_table, source, operator_string)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ((0 < depth) && (false == is_subexpression_first)){
+
+        if ( ! append_benchmark_source(symbol_table, source, "(")){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        if ( ! make_benchmark_expression(symbol_table, config, source, depth - 1)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        if ( ! append_benchmark_source(symbol_table, source, ")")){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        return true;
+    }
+
+    if ( ! make_benchmark_factor(symbol_table, config, source, is_division)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool make_benchmark_factor(
+    TP_SYMBOL_TABLE* symbol_table, TP_BENCHMARK_CONFIG* config, TP_BENCHMARK_SOURCE* source, bool is_divisor)
+{
+    char element[TP_BENCHMARK_ELEMENT_BUFFER_SIZE] = { 0 };
+
+    uint32_t param_num = config->member_param_num;
+    uint32_t variable_num = source->member_defined_variable_num;
+
+    // Factor -> '-'? (constant | param | variable)
+    uint64_t kind = (is_divisor ? 0 : next_benchmark_random(source) % 3);
+
+    if ((1 == kind) && (0 == param_num)){
+
+        kind = 0;
+    }
+
+    if ((2 == kind) && (0 == variable_num)){
+
+        kind = 0;
+    }
+
+    const char* sign = (( ! is_divisor) && (0 == (next_benchmark_random(source) % 8))) ? "-" : "";
+
+    switch (kind){
+    case 0:
+        sprintf_s(
+            element, sizeof(element), "%s%u",
+            sign, (uint32_t)(next_benchmark_random(source) % TP_BENCHMARK_CONST_VALUE_MAX) + 1
+        );
+        break;
+    case 1:
+        sprintf_s(element, sizeof(element), "%sp%u", sign, (uint32_t)(next_benchmark_random(source) % param_num));
+        break;
+    default:
+        sprintf_s(element, sizeof(element), "%sv%u", sign, (uint32_t)(next_benchmark_random(source) % variable_num));
+        break;
+    }
+
+    if ( ! append_benchmark_source(symbol_table, source, element)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool append_benchmark_source(TP_SYMBOL_TABLE* symbol_table, TP_BENCHMARK_SOURCE* source, char* string)
+{
+    rsize_t length = strlen(string);
+
+    // NOTE: The source code of the compiler is up to TP_MAX_LINE_BYTES(see tp_make_token.c).
+    if (TP_MAX_LINE_BYTES < source->member_length + length){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE,
+            TP_MSG_FMT("ERROR: TP_MAX_LINE_BYTES(%1) < length of the benchmark program. "
+                "Decrease statements or depth."),
+            TP_LOG_PARAM_UINT64_VALUE(TP_MAX_LINE_BYTES)
+        );
+
+        return false;
+    }
+
+    // NOTE: The string is terminated by NUL.
+    if (source->member_size <= source->member_length + length){
+
+        rsize_t size = source->member_size + TP_BENCHMARK_SOURCE_SIZE_ALLOCATE_UNIT;
+
+        uint8_t* tmp_string = (uint8_t*)TP_REALLOC(symbol_table, source->member_string, size);
+
+        if (NULL == tmp_string){
+
+            TP_PRINT_CRT_ERROR(symbol_table);
+
+            return false;
+        }
+
+        memset(tmp_string + source->member_size, 0, TP_BENCHMARK_SOURCE_SIZE_ALLOCATE_UNIT);
+
+        source->member_string = tmp_string;
+        source->member_size = size;
+    }
+
+    memcpy(source->member_string + source->member_length, string, length);
+
+    source->member_length += length;
+
+    return true;
+}
+
+static uint64_t next_benchmark_random(TP_BENCHMARK_SOURCE* source)
+{
+    uint64_t x = source->member_random;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+
+    source->member_random = x;
+
+    return (x * UINT64_C(0x2545f4914f6cdd1d)) >> 32;
+}
+
+static int compare_wall_time(const void* param1, const void* param2)
+{
+    uint64_t wall_time1 = *(const uint64_t*)param1;
+    uint64_t wall_time2 = *(const uint64_t*)param2;
+
+    if (wall_time1 != wall_time2){
+
+        return (wall_time1 < wall_time2) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+static void write_benchmark_phase(
+    FILE* write_file, const char* name, const char* unit, uint64_t unit_num,
+    uint64_t* wall_time, uint32_t iteration_num, bool is_last)
+{
+    // NOTE: wall_time is sorted. The throughput at p99 is the throughput of the slowest 1%.
+    uint64_t sum = 0;
+
+    for (uint32_t i = 0; iteration_num > i; ++i){
+
+        sum += wall_time[i];
+    }
+
+    uint64_t min = wall_time[0];
+    uint64_t p50 = wall_time[(uint64_t)(iteration_num - 1) * 50 / 100];
+    uint64_t p90 = wall_time[(uint64_t)(iteration_num - 1) * 90 / 100];
+    uint64_t p99 = wall_time[(uint64_t)(iteration_num - 1) * 99 / 100];
+    uint64_t max = wall_time[iteration_num - 1];
+    uint64_t mean = sum / iteration_num;
+
+    fprintf_s(
+        write_file,
+        "    { \"name\": \"%s\", \"unit\": \"%s\", \"units\": %llu,\n"
+        "      \"wall_time_ns\": { \"min\": %llu, \"mean\": %llu, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"max\": %llu },\n"
+        "      \"units_per_sec\": { \"max\": %.1f, \"mean\": %.1f, \"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"min\": %.1f } }%s\n",
+        name, unit, (unsigned long long)unit_num,
+        (unsigned long long)min, (unsigned long long)mean, (unsigned long long)p50,
+        (unsigned long long)p90, (unsigned long long)p99, (unsigned long long)max,
+        calc_throughput(unit_num, min), calc_throughput(unit_num, mean), calc_throughput(unit_num, p50),
+        calc_throughput(unit_num, p90), calc_throughput(unit_num, p99), calc_throughput(unit_num, max),
+        is_last ? "" : ","
+    );
+}
+
+static double calc_throughput(uint64_t unit_num, uint64_t wall_time)
+{
+    // NOTE: The phase which is shorter than the resolution of the clock is counted as 1 nanosecond.
+    return (double)unit_num * 1000000000.0 / (double)(wall_time ? wall_time : 1);
+}
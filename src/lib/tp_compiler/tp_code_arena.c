@@ -0,0 +1,612 @@
+
+// (C) Shin'ichi Ichikawa. Released under the MIT license.
+
+#if ! defined(_WIN32)
+#if ! defined(_GNU_SOURCE)
+#define _GNU_SOURCE // memfd_create
+#endif
+#include <sys/mman.h>
+#include <unistd.h>
+#include <pthread.h>
+#endif
+#include "tp_compiler.h"
+
+// Persistent executable code arena:
+// x64 code is allocated out of large regions instead of
+// VirtualAlloc/VirtualProtect/VirtualFree for every compile.
+// Each region is mapped twice: a read/write view to write the code into and
+// a read/execute view to run it, so that no page is ever writable and executable,
+// and no protection is changed after the region is mapped.
+// Slots are packed in granules of TP_CODE_ARENA_ALIGNMENT_MASK + 1 bytes and
+// the granules of freed slots are reused. A region is unmapped when it is
+// no longer the current region and its last slot has been freed.
+
+#define TP_CODE_ARENA_GRANULE_SIZE (TP_CODE_ARENA_ALIGNMENT_MASK + 1)
+#define TP_CODE_ARENA_BITMAP_BITS 64
+
+typedef struct tp_code_arena_region_{
+    uint8_t* member_base; // Read/execute view.
+    uint8_t* member_writable_base; // Read/write view of the same memory.
+    size_t member_size;
+    uint64_t* member_used_bitmap; // A bit for each granule in use.
+    uint64_t* member_end_bitmap; // A bit for the last granule of each slot.
+    size_t member_bitmap_size;
+    size_t member_granule_num;
+    size_t member_free_granule_num;
+    size_t member_search_pos; // Granule to start the next search from(next fit).
+    size_t member_slot_num;
+}TP_CODE_ARENA_REGION;
+
+typedef struct tp_code_arena_{
+    TP_CODE_ARENA_REGION member_region[TP_CODE_ARENA_REGION_NUM_MAX];
+    TP_CODE_ARENA_REGION* member_current_region;
+    size_t member_page_size;
+#if defined(_WIN32)
+    SRWLOCK member_lock;
+#else
+    pthread_mutex_t member_lock;
+#endif
+}TP_CODE_ARENA;
+
+#if defined(_WIN32)
+static TP_CODE_ARENA code_arena = {
+    .member_lock = SRWLOCK_INIT
+};
+#else
+static TP_CODE_ARENA code_arena = {
+    .member_lock = PTHREAD_MUTEX_INITIALIZER
+};
+#endif
+
+static void lock_code_arena(void);
+static void unlock_code_arena(void);
+static size_t get_page_size(void);
+static TP_CODE_ARENA_REGION* find_region(size_t granule_num, size_t* granule_index);
+static bool find_free_granule(
+    TP_CODE_ARENA_REGION* region, size_t begin, size_t end, size_t granule_num, size_t* granule_index
+);
+static bool is_set_bit(uint64_t* bitmap, size_t index);
+static void set_bit(uint64_t* bitmap, size_t index, bool value);
+static TP_CODE_ARENA_REGION* allocate_region(TP_SYMBOL_TABLE* symbol_table, size_t size);
+static bool free_region(TP_SYMBOL_TABLE* symbol_table, TP_CODE_ARENA_REGION* region);
+static bool map_region(TP_SYMBOL_TABLE* symbol_table, size_t size, uint8_t** base, uint8_t** writable_base);
+static bool unmap_region(TP_SYMBOL_TABLE* symbol_table, uint8_t* base, uint8_t* writable_base, size_t size);
+
+bool tp_code_arena_allocate(TP_SYMBOL_TABLE* symbol_table, uint32_t size, uint8_t** code, uint8_t** writable_code)
+{
+    if ((0 == size) || (NULL == code) || (NULL == writable_code)){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    *code = NULL;
+    *writable_code = NULL;
+
+    size_t granule_num = ((size + TP_CODE_ARENA_ALIGNMENT_MASK) / TP_CODE_ARENA_GRANULE_SIZE);
+    size_t granule_index = 0;
+
+    lock_code_arena();
+
+    TP_CODE_ARENA_REGION* region = find_region(granule_num, &granule_index);
+
+    if (NULL == region){
+
+        TP_CODE_ARENA_REGION* prev_region = code_arena.member_current_region;
+
+        region = allocate_region(symbol_table, granule_num * TP_CODE_ARENA_GRANULE_SIZE);
+
+        if (NULL == region){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            goto error_proc;
+        }
+
+        granule_index = 0;
+
+        if (prev_region && (0 == prev_region->member_slot_num)){
+
+            if ( ! free_region(symbol_table, prev_region)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                goto error_proc;
+            }
+        }
+    }
+
+    code_arena.member_current_region = region;
+
+    for (size_t i = 0; granule_num > i; ++i){
+
+        set_bit(region->member_used_bitmap, granule_index + i, true);
+    }
+
+    set_bit(region->member_end_bitmap, granule_index + granule_num - 1, true);
+
+    region->member_free_granule_num -= granule_num;
+    region->member_search_pos = granule_index + granule_num;
+    ++(region->member_slot_num);
+
+    *code = region->member_base + granule_index * TP_CODE_ARENA_GRANULE_SIZE;
+    *writable_code = region->member_writable_base + granule_index * TP_CODE_ARENA_GRANULE_SIZE;
+
+    unlock_code_arena();
+
+    return true;
+
+error_proc:
+
+    unlock_code_arena();
+
+    return false;
+}
+
+bool tp_code_arena_publish(TP_SYMBOL_TABLE* symbol_table, uint8_t* code, uint32_t size)
+{
+    // NOTE: The code was written through the read/write view(see tp_code_arena_allocate).
+#if defined(_WIN32)
+    if ( ! FlushInstructionCache(GetCurrentProcess(), code, size)){
+
+        TP_GET_LAST_ERROR(symbol_table);
+
+        return false;
+    }
+#else
+    __builtin___clear_cache((char*)code, (char*)(code + size));
+#endif
+
+    return true;
+}
+
+bool tp_code_arena_free(TP_SYMBOL_TABLE* symbol_table, uint8_t* code)
+{
+    if (NULL == code){
+
+        return true;
+    }
+
+    lock_code_arena();
+
+    for (rsize_t i = 0; TP_CODE_ARENA_REGION_NUM_MAX > i; ++i){
+
+        TP_CODE_ARENA_REGION* region = &(code_arena.member_region[i]);
+
+        if ((NULL == region->member_base) ||
+            (code < region->member_base) || ((region->member_base + region->member_size) <= code)){
+
+            continue;
+        }
+
+        size_t offset = (size_t)(code - region->member_base);
+        size_t granule_index = offset / TP_CODE_ARENA_GRANULE_SIZE;
+
+        // NOTE: The previous granule is free or the end of the previous slot.
+        if ((0 == region->member_slot_num) || (offset % TP_CODE_ARENA_GRANULE_SIZE) ||
+            ( ! is_set_bit(region->member_used_bitmap, granule_index)) ||
+            (granule_index && is_set_bit(region->member_used_bitmap, granule_index - 1) &&
+            ( ! is_set_bit(region->member_end_bitmap, granule_index - 1)))){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            goto error_proc;
+        }
+
+        for (size_t j = granule_index; region->member_granule_num > j; ++j){
+
+            set_bit(region->member_used_bitmap, j, false);
+
+            ++(region->member_free_granule_num);
+
+            if (is_set_bit(region->member_end_bitmap, j)){
+
+                set_bit(region->member_end_bitmap, j, false);
+
+                break;
+            }
+        }
+
+        --(region->member_slot_num);
+
+        if ((0 == region->member_slot_num) && (region != code_arena.member_current_region)){
+
+            if ( ! free_region(symbol_table, region)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                goto error_proc;
+            }
+        }
+
+        unlock_code_arena();
+
+        return true;
+    }
+
+    TP_PUT_LOG_MSG(
+        symbol_table, TP_LOG_TYPE_DISP_FORCE,
+        TP_MSG_FMT("%1"), TP_LOG_PARAM_STRING("ERROR: code is not in code arena.")
+    );
+
+error_proc:
+
+    unlock_code_arena();
+
+    return false;
+}
+
+static void lock_code_arena(void)
+{
+#if defined(_WIN32)
+    AcquireSRWLockExclusive(&(code_arena.member_lock));
+#else
+    (void)pthread_mutex_lock(&(code_arena.member_lock));
+#endif
+}
+
+static void unlock_code_arena(void)
+{
+#if defined(_WIN32)
+    ReleaseSRWLockExclusive(&(code_arena.member_lock));
+#else
+    (void)pthread_mutex_unlock(&(code_arena.member_lock));
+#endif
+}
+
+static size_t get_page_size(void)
+{
+    if (0 == code_arena.member_page_size){
+
+#if defined(_WIN32)
+        SYSTEM_INFO system_info = { 0 };
+
+        GetSystemInfo(&system_info);
+
+        code_arena.member_page_size = system_info.dwPageSize;
+#else
+        long page_size = sysconf(_SC_PAGESIZE);
+
+        code_arena.member_page_size = ((0 < page_size) ? (size_t)page_size : 4096);
+#endif
+    }
+
+    return code_arena.member_page_size;
+}
+
+static TP_CODE_ARENA_REGION* find_region(size_t granule_num, size_t* granule_index)
+{
+    // The current region is searched first, so that the slots are packed.
+    TP_CODE_ARENA_REGION* current_region = code_arena.member_current_region;
+
+    for (rsize_t i = 0; TP_CODE_ARENA_REGION_NUM_MAX >= i; ++i){
+
+        TP_CODE_ARENA_REGION* region =
+            ((0 == i) ? current_region : &(code_arena.member_region[i - 1]));
+
+        if ((NULL == region) || (NULL == region->member_base) ||
+            (i && (region == current_region)) || (region->member_free_granule_num < granule_num)){
+
+            continue;
+        }
+
+        if (find_free_granule(
+            region, region->member_search_pos, region->member_granule_num, granule_num, granule_index)){
+
+            return region;
+        }
+
+        if (find_free_granule(region, 0, region->member_granule_num, granule_num, granule_index)){
+
+            return region;
+        }
+    }
+
+    return NULL;
+}
+
+static bool find_free_granule(
+    TP_CODE_ARENA_REGION* region, size_t begin, size_t end, size_t granule_num, size_t* granule_index)
+{
+    uint64_t* bitmap = region->member_used_bitmap;
+
+    size_t free_num = 0;
+
+    for (size_t i = begin; end > i; ){
+
+        // The words of the bitmap without a free granule or without a used granule are skipped.
+        if ((0 == (i % TP_CODE_ARENA_BITMAP_BITS)) && ((i + TP_CODE_ARENA_BITMAP_BITS) <= end)){
+
+            uint64_t word = bitmap[i / TP_CODE_ARENA_BITMAP_BITS];
+
+            if (UINT64_MAX == word){
+
+                free_num = 0;
+                i += TP_CODE_ARENA_BITMAP_BITS;
+
+                continue;
+            }
+
+            if (0 == word){
+
+                free_num += TP_CODE_ARENA_BITMAP_BITS;
+                i += TP_CODE_ARENA_BITMAP_BITS;
+
+                if (granule_num <= free_num){
+
+                    *granule_index = i - free_num;
+
+                    return true;
+                }
+
+                continue;
+            }
+        }
+
+        if (is_set_bit(bitmap, i)){
+
+            free_num = 0;
+        }else if (granule_num == ++free_num){
+
+            *granule_index = i + 1 - granule_num;
+
+            return true;
+        }
+
+        ++i;
+    }
+
+    return false;
+}
+
+static bool is_set_bit(uint64_t* bitmap, size_t index)
+{
+    return (bitmap[index / TP_CODE_ARENA_BITMAP_BITS] >> (index % TP_CODE_ARENA_BITMAP_BITS)) & 1;
+}
+
+static void set_bit(uint64_t* bitmap, size_t index, bool value)
+{
+    uint64_t mask = ((uint64_t)1 << (index % TP_CODE_ARENA_BITMAP_BITS));
+
+    if (value){
+
+        bitmap[index / TP_CODE_ARENA_BITMAP_BITS] |= mask;
+    }else{
+
+        bitmap[index / TP_CODE_ARENA_BITMAP_BITS] &= ~mask;
+    }
+}
+
+static TP_CODE_ARENA_REGION* allocate_region(TP_SYMBOL_TABLE* symbol_table, size_t size)
+{
+    TP_CODE_ARENA_REGION* region = NULL;
+
+    for (rsize_t i = 0; TP_CODE_ARENA_REGION_NUM_MAX > i; ++i){
+
+        if (NULL == code_arena.member_region[i].member_base){
+
+            region = &(code_arena.member_region[i]);
+
+            break;
+        }
+    }
+
+    if (NULL == region){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE,
+            TP_MSG_FMT("ERROR: TP_CODE_ARENA_REGION_NUM_MAX(%1) regions are in use."),
+            TP_LOG_PARAM_UINT64_VALUE(TP_CODE_ARENA_REGION_NUM_MAX)
+        );
+
+        return NULL;
+    }
+
+    size_t page_mask = get_page_size() - 1;
+    size_t region_size = ((TP_CODE_ARENA_REGION_SIZE < size) ? size : TP_CODE_ARENA_REGION_SIZE);
+    region_size = ((region_size + page_mask) & ~page_mask);
+
+    size_t granule_num = region_size / TP_CODE_ARENA_GRANULE_SIZE;
+    size_t bitmap_size =
+        ((granule_num + (TP_CODE_ARENA_BITMAP_BITS - 1)) / TP_CODE_ARENA_BITMAP_BITS) * sizeof(uint64_t);
+
+    uint64_t* used_bitmap = (uint64_t*)TP_CALLOC(NULL, 1, bitmap_size);
+    uint64_t* end_bitmap = (uint64_t*)TP_CALLOC(NULL, 1, bitmap_size);
+
+    if ((NULL == used_bitmap) || (NULL == end_bitmap)){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        goto error_proc;
+    }
+
+    uint8_t* base = NULL;
+    uint8_t* writable_base = NULL;
+
+    if ( ! map_region(symbol_table, region_size, &base, &writable_base)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    region->member_base = base;
+    region->member_writable_base = writable_base;
+    region->member_size = region_size;
+    region->member_used_bitmap = used_bitmap;
+    region->member_end_bitmap = end_bitmap;
+    region->member_bitmap_size = bitmap_size;
+    region->member_granule_num = granule_num;
+    region->member_free_granule_num = granule_num;
+    region->member_search_pos = 0;
+    region->member_slot_num = 0;
+
+    return region;
+
+error_proc:
+
+    TP_FREE(NULL, &used_bitmap, bitmap_size);
+    TP_FREE(NULL, &end_bitmap, bitmap_size);
+
+    return NULL;
+}
+
+static bool free_region(TP_SYMBOL_TABLE* symbol_table, TP_CODE_ARENA_REGION* region)
+{
+    bool status = unmap_region(symbol_table, region->member_base, region->member_writable_base, region->member_size);
+
+    if ( ! status){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+    }
+
+    TP_FREE(NULL, &(region->member_used_bitmap), region->member_bitmap_size);
+    TP_FREE(NULL, &(region->member_end_bitmap), region->member_bitmap_size);
+
+    if (code_arena.member_current_region == region){
+
+        code_arena.member_current_region = NULL;
+    }
+
+    memset(region, 0, sizeof(TP_CODE_ARENA_REGION));
+
+    return status;
+}
+
+static bool map_region(TP_SYMBOL_TABLE* symbol_table, size_t size, uint8_t** base, uint8_t** writable_base)
+{
+    // NOTE: The two views share the pages of an anonymous file mapping.
+#if defined(_WIN32)
+    HANDLE mapping = CreateFileMapping(
+        INVALID_HANDLE_VALUE, NULL, PAGE_EXECUTE_READWRITE | SEC_COMMIT,
+        (DWORD)((uint64_t)size >> 32), (DWORD)size, NULL
+    );
+
+    if (NULL == mapping){
+
+        TP_GET_LAST_ERROR(symbol_table);
+
+        return false;
+    }
+
+    *writable_base = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+    *base = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_EXECUTE, 0, 0, size);
+
+    if ((NULL == *writable_base) || (NULL == *base)){
+
+        TP_GET_LAST_ERROR(symbol_table);
+
+        if (*writable_base){
+
+            (void)UnmapViewOfFile(*writable_base);
+        }
+
+        if (*base){
+
+            (void)UnmapViewOfFile(*base);
+        }
+
+        (void)CloseHandle(mapping);
+
+        *writable_base = NULL;
+        *base = NULL;
+
+        return false;
+    }
+
+    // The views keep the mapping.
+    if ( ! CloseHandle(mapping)){
+
+        TP_GET_LAST_ERROR(symbol_table);
+    }
+#else
+    int fd = memfd_create("int_calc_code_arena", MFD_CLOEXEC);
+
+    if (-1 == fd){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    if (ftruncate(fd, (off_t)size)){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        (void)close(fd);
+
+        return false;
+    }
+
+    *writable_base = (uint8_t*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    *base = (uint8_t*)mmap(NULL, size, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+
+    if ((MAP_FAILED == *writable_base) || (MAP_FAILED == *base)){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        if (MAP_FAILED != *writable_base){
+
+            (void)munmap(*writable_base, size);
+        }
+
+        if (MAP_FAILED != *base){
+
+            (void)munmap(*base, size);
+        }
+
+        (void)close(fd);
+
+        *writable_base = NULL;
+        *base = NULL;
+
+        return false;
+    }
+
+    // The views keep the file.
+    if (close(fd)){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+    }
+#endif
+
+    return true;
+}
+
+static bool unmap_region(TP_SYMBOL_TABLE* symbol_table, uint8_t* base, uint8_t* writable_base, size_t size)
+{
+    bool status = true;
+
+#if defined(_WIN32)
+    if ( ! UnmapViewOfFile(writable_base)){
+
+        TP_GET_LAST_ERROR(symbol_table);
+
+        status = false;
+    }
+
+    if ( ! UnmapViewOfFile(base)){
+
+        TP_GET_LAST_ERROR(symbol_table);
+
+        status = false;
+    }
+#else
+    if (munmap(writable_base, size)){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        status = false;
+    }
+
+    if (munmap(base, size)){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        status = false;
+    }
+#endif
+
+    return status;
+}
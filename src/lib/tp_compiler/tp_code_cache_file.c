@@ -0,0 +1,374 @@
+
+// (C) Shin'ichi Ichikawa. Released under the MIT license.
+
+#if ! defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "tp_compiler.h"
+
+// On-disk code cache:
+// When a directory is set by tp_set_code_cache_directory(), tp_compile_function()
+// writes the x64 code of each compile to <directory>/<compile cache key>.tpcode
+// and a later process loads it back without running any front-end phase.
+// The file is TP_CODE_CACHE_FILE_HEADER followed by the x64 code.
+// A file is used only when the magic, version, build ID, source hash,
+// CPU features and the SHA-256 checksum of the code all match;
+// otherwise it is treated as a miss and overwritten by the next compile.
+// The file is mapped read only and the code is copied into the code arena,
+// so that the code pages stay read/execute only(see tp_code_arena.c).
+
+static char code_cache_directory[_MAX_PATH];
+static volatile int64_t code_cache_file_count = 0;
+
+static bool make_code_cache_file_path(uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], char* path, size_t path_size);
+static uint32_t get_cpu_features(TP_X64_SIMD_ISA simd_isa);
+static uint8_t* map_code_cache_file(char* path, size_t* file_size, void** map_handle);
+static void unmap_code_cache_file(uint8_t* file_content, size_t file_size, void* map_handle);
+static bool is_valid_code_cache_file(
+    uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], TP_X64_ENTRY_MODE entry_mode, uint8_t* file_content, size_t file_size
+);
+static bool rename_code_cache_file(char* from_path, char* to_path);
+
+bool tp_set_code_cache_directory(char* path)
+{
+    if ((NULL == path) || ('\0' == path[0])){
+
+        code_cache_directory[0] = '\0';
+
+        return true;
+    }
+
+    // NOTE: Room for "/" and the file name of TP_COMPILE_CACHE_KEY_SIZE * 2 hex digits.
+    size_t length = strlen(path);
+
+    if ((sizeof(code_cache_directory) - TP_COMPILE_CACHE_KEY_SIZE * 2 - 32) < length){
+
+        fprintf_s(stderr, "ERROR: too long path at %s function.\n", __func__);
+
+        return false;
+    }
+
+    memcpy(code_cache_directory, path, length + 1);
+
+    return true;
+}
+
+bool tp_load_code_cache_file(
+    uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], TP_X64_ENTRY_MODE entry_mode, TP_COMPILED_FUNCTION* compiled_function)
+{
+    char path[_MAX_PATH];
+
+    if ( ! make_code_cache_file_path(key, path, sizeof(path))){
+
+        return false;
+    }
+
+    size_t file_size = 0;
+    void* map_handle = NULL;
+
+    uint8_t* file_content = map_code_cache_file(path, &file_size, &map_handle);
+
+    if (NULL == file_content){
+
+        return false;
+    }
+
+    bool is_hit = false;
+
+    if ( ! is_valid_code_cache_file(key, entry_mode, file_content, file_size)){
+
+        goto cleanup;
+    }
+
+    TP_CODE_CACHE_FILE_HEADER* header = (TP_CODE_CACHE_FILE_HEADER*)file_content;
+
+    uint8_t* x64_code = NULL;
+    uint8_t* writable_x64_code = NULL;
+
+    if ( ! tp_code_arena_allocate(NULL, header->member_x64_code_size, &x64_code, &writable_x64_code)){
+
+        goto cleanup;
+    }
+
+    memcpy(writable_x64_code, file_content + header->member_header_size, header->member_x64_code_size);
+
+    if ( ! tp_code_arena_publish(NULL, x64_code, header->member_x64_code_size)){
+
+        (void)tp_code_arena_free(NULL, x64_code);
+
+        goto cleanup;
+    }
+
+    compiled_function->member_x64_code = x64_code;
+    compiled_function->member_x64_code_size = header->member_x64_code_size;
+    compiled_function->member_param_count = header->member_param_count;
+    compiled_function->member_entry_mode = (TP_X64_ENTRY_MODE)(header->member_entry_mode);
+    compiled_function->member_x64_simd_isa = (TP_X64_SIMD_ISA)(header->member_x64_simd_isa);
+    compiled_function->member_x64_jit_func = (TP_X64_JIT_FUNC)x64_code;
+
+    is_hit = true;
+
+cleanup:
+
+    unmap_code_cache_file(file_content, file_size, map_handle);
+
+    return is_hit;
+}
+
+bool tp_save_code_cache_file(uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], TP_COMPILED_FUNCTION* compiled_function)
+{
+    char path[_MAX_PATH];
+
+    if ( ! make_code_cache_file_path(key, path, sizeof(path))){
+
+        return true;
+    }
+
+    uint32_t content_size = sizeof(TP_CODE_CACHE_FILE_HEADER) + compiled_function->member_x64_code_size;
+
+    uint8_t* content = (uint8_t*)TP_CALLOC(NULL, content_size, sizeof(uint8_t));
+
+    if (NULL == content){
+
+        TP_PRINT_CRT_ERROR(NULL);
+
+        return false;
+    }
+
+    TP_CODE_CACHE_FILE_HEADER* header = (TP_CODE_CACHE_FILE_HEADER*)content;
+
+    memcpy(header->member_magic, TP_CODE_CACHE_FILE_MAGIC, sizeof(header->member_magic));
+    header->member_version = TP_CODE_CACHE_FILE_VERSION;
+    header->member_header_size = sizeof(TP_CODE_CACHE_FILE_HEADER);
+    memcpy(header->member_source_hash, key, TP_COMPILE_CACHE_KEY_SIZE);
+    header->member_codegen_version = TP_X64_CODEGEN_VERSION;
+    header->member_cpu_features = get_cpu_features(tp_get_x64_simd_isa());
+    header->member_required_cpu_features = get_cpu_features(compiled_function->member_x64_simd_isa);
+    header->member_entry_mode = compiled_function->member_entry_mode;
+    header->member_x64_simd_isa = compiled_function->member_x64_simd_isa;
+    header->member_param_count = compiled_function->member_param_count;
+    header->member_x64_code_size = compiled_function->member_x64_code_size;
+    tp_calc_sha256(compiled_function->member_x64_code, compiled_function->member_x64_code_size, header->member_checksum);
+
+    memcpy(content + sizeof(TP_CODE_CACHE_FILE_HEADER), compiled_function->member_x64_code, compiled_function->member_x64_code_size);
+
+    // NOTE: Write to a temporary file and rename it, so that other processes never map a partial file.
+    char tmp_path[_MAX_PATH];
+
+#if defined(_WIN32)
+    uint32_t process_id = GetCurrentProcessId();
+    int64_t count = InterlockedIncrement64((volatile LONG64*)&code_cache_file_count);
+#else
+    uint32_t process_id = (uint32_t)getpid();
+    int64_t count = __atomic_add_fetch(&code_cache_file_count, 1, __ATOMIC_SEQ_CST);
+#endif
+
+    sprintf_s(tmp_path, sizeof(tmp_path), "%s.%u.%lld.tmp", path, process_id, (long long)count);
+
+    bool status = tp_write_file(NULL, tmp_path, content, content_size);
+
+    TP_FREE(NULL, &content, content_size);
+
+    if ( ! status){
+
+        (void)remove(tmp_path);
+
+        return false;
+    }
+
+    if ( ! rename_code_cache_file(tmp_path, path)){
+
+        (void)remove(tmp_path);
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool make_code_cache_file_path(uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], char* path, size_t path_size)
+{
+    if ('\0' == code_cache_directory[0]){
+
+        return false;
+    }
+
+    char file_name[TP_COMPILE_CACHE_KEY_SIZE * 2 + 1];
+
+    for (uint32_t i = 0; TP_COMPILE_CACHE_KEY_SIZE > i; ++i){
+
+        sprintf_s(&(file_name[i * 2]), 3, "%02x", key[i]);
+    }
+
+    sprintf_s(path, path_size, "%s/%s.%s", code_cache_directory, file_name, TP_CODE_CACHE_FILE_EXT_NAME);
+
+    return true;
+}
+
+static uint32_t get_cpu_features(TP_X64_SIMD_ISA simd_isa)
+{
+    switch (simd_isa){
+    case TP_X64_SIMD_ISA_AVX512:
+        return TP_CODE_CACHE_CPU_FEATURE_AVX2 | TP_CODE_CACHE_CPU_FEATURE_AVX512F;
+    case TP_X64_SIMD_ISA_AVX2:
+        return TP_CODE_CACHE_CPU_FEATURE_AVX2;
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+static uint8_t* map_code_cache_file(char* path, size_t* file_size, void** map_handle)
+{
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(
+        path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL
+    );
+
+    if (INVALID_HANDLE_VALUE == file){
+
+        return NULL;
+    }
+
+    LARGE_INTEGER size = { 0 };
+
+    if (( ! GetFileSizeEx(file, &size)) || (sizeof(TP_CODE_CACHE_FILE_HEADER) > size.QuadPart) ||
+        (TP_MAX_FILE_BYTES < size.QuadPart)){
+
+        (void)CloseHandle(file);
+
+        return NULL;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    (void)CloseHandle(file);
+
+    if (NULL == mapping){
+
+        return NULL;
+    }
+
+    uint8_t* file_content = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (NULL == file_content){
+
+        (void)CloseHandle(mapping);
+
+        return NULL;
+    }
+
+    *file_size = (size_t)(size.QuadPart);
+    *map_handle = mapping;
+
+    return file_content;
+#else
+    int fd = open(path, O_RDONLY);
+
+    if (-1 == fd){
+
+        // NOTE: A code cache file that does not exist is a miss.
+        errno_t err = _set_errno(0);
+
+        return NULL;
+    }
+
+    struct stat stbuf;
+
+    if ((-1 == fstat(fd, &stbuf)) || (sizeof(TP_CODE_CACHE_FILE_HEADER) > stbuf.st_size) ||
+        (TP_MAX_FILE_BYTES < stbuf.st_size)){
+
+        (void)close(fd);
+
+        return NULL;
+    }
+
+    void* file_content = mmap(NULL, stbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    (void)close(fd);
+
+    if (MAP_FAILED == file_content){
+
+        return NULL;
+    }
+
+    *file_size = (size_t)(stbuf.st_size);
+    *map_handle = NULL;
+
+    return (uint8_t*)file_content;
+#endif
+}
+
+static void unmap_code_cache_file(uint8_t* file_content, size_t file_size, void* map_handle)
+{
+#if defined(_WIN32)
+    (void)UnmapViewOfFile(file_content);
+
+    (void)CloseHandle((HANDLE)map_handle);
+#else
+    (void)munmap(file_content, file_size);
+#endif
+}
+
+static bool is_valid_code_cache_file(
+    uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], TP_X64_ENTRY_MODE entry_mode, uint8_t* file_content, size_t file_size)
+{
+    TP_CODE_CACHE_FILE_HEADER* header = (TP_CODE_CACHE_FILE_HEADER*)file_content;
+
+    if (memcmp(header->member_magic, TP_CODE_CACHE_FILE_MAGIC, sizeof(header->member_magic)) ||
+        (TP_CODE_CACHE_FILE_VERSION != header->member_version) ||
+        (sizeof(TP_CODE_CACHE_FILE_HEADER) != header->member_header_size) ||
+        (TP_X64_CODEGEN_VERSION != header->member_codegen_version) ||
+        memcmp(header->member_source_hash, key, TP_COMPILE_CACHE_KEY_SIZE) ||
+        (entry_mode != header->member_entry_mode) ||
+        (0 == header->member_x64_code_size) ||
+        ((file_size - sizeof(TP_CODE_CACHE_FILE_HEADER)) != header->member_x64_code_size)){
+
+        return false;
+    }
+
+    uint32_t cpu_features = get_cpu_features(tp_get_x64_simd_isa());
+
+    if ((header->member_required_cpu_features & cpu_features) != header->member_required_cpu_features){
+
+        return false;
+    }
+
+    uint8_t checksum[TP_SHA256_DIGEST_SIZE];
+
+    tp_calc_sha256(file_content + sizeof(TP_CODE_CACHE_FILE_HEADER), header->member_x64_code_size, checksum);
+
+    if (memcmp(header->member_checksum, checksum, sizeof(checksum))){
+
+        fprintf_s(stderr, "WARNING: bad checksum of code cache file at %s function.\n", __func__);
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool rename_code_cache_file(char* from_path, char* to_path)
+{
+#if defined(_WIN32)
+    if ( ! MoveFileExA(from_path, to_path, MOVEFILE_REPLACE_EXISTING)){
+
+        TP_GET_LAST_ERROR(NULL);
+
+        return false;
+    }
+#else
+    if (rename(from_path, to_path)){
+
+        TP_PRINT_CRT_ERROR(NULL);
+
+        return false;
+    }
+#endif
+
+    return true;
+}
@@ -0,0 +1,886 @@
+
+// (C) Shin'ichi Ichikawa. Released under the MIT license.
+
+#if ! defined(_WIN32)
+#include <pthread.h>
+#endif
+#include "tp_compiler.h"
+
+// Compile cache:
+// tp_compile_function() looks up the SHA-256 of the normalized source code
+// (with the entry mode and SIMD ISA) before tp_make_token(), and on a hit
+// shares the x64 code of an earlier compile instead of compiling again.
+// Readers do not take any lock: bucket chains are published atomically and
+// each reader is counted in the epoch at which it started. An unlinked entry is
+// retired with the current epoch, and it is freed two epochs later: the epoch
+// advances only after the readers of the epoch before the previous one are done.
+// Writers(insert, eviction, retire) hold the cache lock. Entries are evicted
+// by the clock algorithm(second chance) while the total size exceeds the budget:
+// readers set the referenced flag, and the clock hand skips a referenced entry once.
+// An entry holds the x64 code or the wasm interpreter code of a key(before tier up);
+// both kinds of entries of a key can be in the cache at the same time.
+
+struct tp_compile_cache_entry_{
+    TP_COMPILE_CACHE_ENTRY* volatile member_next;
+    TP_COMPILE_CACHE_ENTRY* member_clock_prev; // Circular list of the linked entries.
+    TP_COMPILE_CACHE_ENTRY* member_clock_next;
+    TP_COMPILE_CACHE_ENTRY* member_retired_next;
+    int64_t member_retired_epoch;
+    uint8_t member_key[TP_COMPILE_CACHE_KEY_SIZE];
+    volatile int64_t member_ref_count; // The cache itself holds one reference while linked.
+    volatile bool member_is_referenced; // NOTE: A lost update changes the eviction order only.
+    size_t member_size;
+    TP_WASM_INTERPRETER_CODE* member_interpreter_code; // NULL: x64 code.
+    uint8_t* member_x64_code;
+    uint32_t member_x64_code_size;
+    uint32_t member_param_count;
+    TP_X64_ENTRY_MODE member_entry_mode;
+    TP_X64_SIMD_ISA member_x64_simd_isa;
+};
+
+typedef struct tp_compile_cache_{
+    TP_COMPILE_CACHE_ENTRY* volatile member_bucket[TP_COMPILE_CACHE_BUCKET_NUM];
+    TP_COMPILE_CACHE_ENTRY* member_clock_hand; // NULL: no linked entries.
+    TP_COMPILE_CACHE_ENTRY* member_retired;
+    volatile int64_t member_epoch;
+    volatile int64_t member_reader_num[2]; // Readers of the even and odd epochs.
+    volatile size_t member_budget;
+    size_t member_total_size;
+    size_t member_entry_num;
+#if defined(_WIN32)
+    SRWLOCK member_lock;
+#else
+    pthread_mutex_t member_lock;
+#endif
+}TP_COMPILE_CACHE;
+
+#if defined(_WIN32)
+static TP_COMPILE_CACHE compile_cache = {
+    .member_budget = TP_COMPILE_CACHE_BUDGET_DEFAULT,
+    .member_lock = SRWLOCK_INIT
+};
+#else
+static TP_COMPILE_CACHE compile_cache = {
+    .member_budget = TP_COMPILE_CACHE_BUDGET_DEFAULT,
+    .member_lock = PTHREAD_MUTEX_INITIALIZER
+};
+#endif
+
+typedef struct tp_sha256_{
+    uint32_t member_state[8];
+    uint64_t member_length;
+    uint8_t member_block[64];
+    uint32_t member_block_pos;
+}TP_SHA256;
+
+static void lock_compile_cache(void);
+static void unlock_compile_cache(void);
+static int64_t atomic_increment(volatile int64_t* value);
+static int64_t atomic_decrement(volatile int64_t* value);
+static bool atomic_increment_if_not_zero(volatile int64_t* value);
+static int64_t atomic_load(volatile int64_t* value);
+static TP_COMPILE_CACHE_ENTRY* atomic_load_entry(TP_COMPILE_CACHE_ENTRY* volatile* entry);
+static void atomic_store_entry(TP_COMPILE_CACHE_ENTRY* volatile* entry, TP_COMPILE_CACHE_ENTRY* value);
+static TP_COMPILE_CACHE_ENTRY* volatile* get_bucket(uint8_t* key);
+static TP_COMPILE_CACHE_ENTRY* find_entry(
+    TP_COMPILE_CACHE_ENTRY* entry, uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], bool is_interpreter
+);
+static bool insert_entry(
+    TP_SYMBOL_TABLE* symbol_table, TP_COMPILE_CACHE_ENTRY** entry, TP_COMPILE_CACHE_ENTRY** same_key_entry
+);
+static int64_t begin_reader(void);
+static void end_reader(int64_t epoch);
+static void advance_epoch(void);
+static void link_clock_entry(TP_COMPILE_CACHE_ENTRY* entry);
+static void unlink_clock_entry(TP_COMPILE_CACHE_ENTRY* entry);
+static bool evict_entries(size_t budget);
+static bool unlink_entry(TP_COMPILE_CACHE_ENTRY* entry);
+static void retire_entry(TP_COMPILE_CACHE_ENTRY* entry);
+static void free_retired_entries(void);
+static void sha256_init(TP_SHA256* sha256);
+static void sha256_update(TP_SHA256* sha256, const uint8_t* data, size_t size);
+static void sha256_final(TP_SHA256* sha256, uint8_t digest[TP_COMPILE_CACHE_KEY_SIZE]);
+static void sha256_block(TP_SHA256* sha256, const uint8_t* block);
+
+void tp_set_compile_cache_budget(size_t budget)
+{
+    lock_compile_cache();
+
+    compile_cache.member_budget = budget;
+
+    (void)evict_entries(budget);
+
+    free_retired_entries();
+
+    unlock_compile_cache();
+}
+
+void tp_clear_compile_cache(void)
+{
+    lock_compile_cache();
+
+    (void)evict_entries(0);
+
+    free_retired_entries();
+
+    unlock_compile_cache();
+}
+
+void tp_make_compile_cache_key(
+    uint8_t* source_code, rsize_t source_code_length, TP_X64_ENTRY_MODE entry_mode,
+    TP_OPTIMIZATION_LEVEL optimization_level, uint8_t key[TP_COMPILE_CACHE_KEY_SIZE])
+{
+    // Same normalization as tp_make_token(): Byte Order Mark, CR LF, CR and NUL.
+    static const uint8_t byte_order_mark[] = { 0xEF, 0xBB, 0xBF };
+
+    TP_SHA256 sha256 = { 0 };
+
+    sha256_init(&sha256);
+
+    rsize_t i = 0;
+
+    if ((sizeof(byte_order_mark) <= source_code_length) &&
+        (0 == memcmp(source_code, byte_order_mark, sizeof(byte_order_mark)))){
+
+        i = sizeof(byte_order_mark);
+    }
+
+    uint8_t buffer[256];
+    size_t buffer_pos = 0;
+
+    for (; source_code_length > i; ++i){
+
+        uint8_t c = source_code[i];
+
+        if ('\r' == c){
+
+            if (((i + 1) < source_code_length) && ('\n' == source_code[i + 1])){
+
+                ++i;
+            }
+
+            c = '\n';
+        }else if ('\0' == c){
+
+            c = ' ';
+        }
+
+        buffer[buffer_pos++] = c;
+
+        if (sizeof(buffer) == buffer_pos){
+
+            sha256_update(&sha256, buffer, buffer_pos);
+
+            buffer_pos = 0;
+        }
+    }
+
+    TP_X64_SIMD_ISA simd_isa =
+        ((TP_X64_ENTRY_MODE_BATCH == entry_mode) ? tp_get_x64_simd_isa() : TP_X64_SIMD_ISA_NONE);
+
+    sha256_update(&sha256, buffer, buffer_pos);
+
+    buffer_pos = 0;
+
+    // NOTE: NUL never remains in the normalized source code, so it separates the options.
+    buffer[buffer_pos++] = '\0';
+    buffer[buffer_pos++] = (uint8_t)entry_mode;
+    buffer[buffer_pos++] = '\0';
+    buffer[buffer_pos++] = (uint8_t)simd_isa;
+    buffer[buffer_pos++] = '\0';
+    buffer[buffer_pos++] = (uint8_t)optimization_level;
+
+    sha256_update(&sha256, buffer, buffer_pos);
+
+    sha256_final(&sha256, key);
+}
+
+bool tp_compile_cache_lookup(uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], TP_COMPILED_FUNCTION* compiled_function)
+{
+    if (0 == compile_cache.member_budget){
+
+        return false;
+    }
+
+    bool is_hit = false;
+
+    int64_t epoch = begin_reader();
+
+    TP_COMPILE_CACHE_ENTRY* entry = find_entry(atomic_load_entry(get_bucket(key)), key, false);
+
+    // NOTE: Zero reference count means that the entry is being retired.
+    if (entry && atomic_increment_if_not_zero(&(entry->member_ref_count))){
+
+        if ( ! entry->member_is_referenced){
+
+            entry->member_is_referenced = true;
+        }
+
+        compiled_function->member_x64_code = entry->member_x64_code;
+        compiled_function->member_x64_code_size = entry->member_x64_code_size;
+        compiled_function->member_param_count = entry->member_param_count;
+        compiled_function->member_entry_mode = entry->member_entry_mode;
+        compiled_function->member_x64_simd_isa = entry->member_x64_simd_isa;
+        compiled_function->member_x64_jit_func = (TP_X64_JIT_FUNC)(entry->member_x64_code);
+        compiled_function->member_cache_entry = entry;
+
+        is_hit = true;
+    }
+
+    end_reader(epoch);
+
+    return is_hit;
+}
+
+bool tp_compile_cache_insert(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], TP_COMPILED_FUNCTION* compiled_function)
+{
+    size_t size = sizeof(TP_COMPILE_CACHE_ENTRY) +
+        ((compiled_function->member_x64_code_size + TP_CODE_ARENA_ALIGNMENT_MASK) &
+        ~((size_t)TP_CODE_ARENA_ALIGNMENT_MASK));
+
+    if (compile_cache.member_budget < size){
+
+        return true;
+    }
+
+    TP_COMPILE_CACHE_ENTRY* entry = (TP_COMPILE_CACHE_ENTRY*)TP_CALLOC(symbol_table, 1, sizeof(TP_COMPILE_CACHE_ENTRY));
+
+    if (NULL == entry){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    memcpy(entry->member_key, key, TP_COMPILE_CACHE_KEY_SIZE);
+    entry->member_ref_count = 2; // The cache and compiled_function.
+    entry->member_size = size;
+    entry->member_x64_code = compiled_function->member_x64_code;
+    entry->member_x64_code_size = compiled_function->member_x64_code_size;
+    entry->member_param_count = compiled_function->member_param_count;
+    entry->member_entry_mode = compiled_function->member_entry_mode;
+    entry->member_x64_simd_isa = compiled_function->member_x64_simd_isa;
+
+    lock_compile_cache();
+
+    bool status = insert_entry(symbol_table, &entry, NULL);
+
+    if (entry){
+
+        compiled_function->member_cache_entry = entry;
+    }
+
+    unlock_compile_cache();
+
+    return status;
+}
+
+void tp_compile_cache_release(TP_COMPILE_CACHE_ENTRY* entry)
+{
+    if (atomic_decrement(&(entry->member_ref_count))){
+
+        return;
+    }
+
+    lock_compile_cache();
+
+    retire_entry(entry);
+
+    free_retired_entries();
+
+    unlock_compile_cache();
+}
+
+bool tp_compile_cache_lookup_interpreter(
+    uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], TP_WASM_INTERPRETER_CODE** interpreter_code)
+{
+    if (0 == compile_cache.member_budget){
+
+        return false;
+    }
+
+    int64_t epoch = begin_reader();
+
+    // NOTE: The entry holds a reference of the interpreter code until the entry is freed.
+    TP_COMPILE_CACHE_ENTRY* entry = find_entry(atomic_load_entry(get_bucket(key)), key, true);
+
+    if (entry){
+
+        if ( ! entry->member_is_referenced){
+
+            entry->member_is_referenced = true;
+        }
+
+        tp_add_ref_wasm_interpreter_code(entry->member_interpreter_code);
+
+        *interpreter_code = entry->member_interpreter_code;
+    }
+
+    end_reader(epoch);
+
+    return NULL != entry;
+}
+
+bool tp_compile_cache_insert_interpreter(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], TP_WASM_INTERPRETER_CODE** interpreter_code)
+{
+    TP_WASM_INTERPRETER_CODE* code = *interpreter_code;
+
+    size_t size = sizeof(TP_COMPILE_CACHE_ENTRY) + sizeof(TP_WASM_INTERPRETER_CODE) +
+        code->member_instruction_num * sizeof(TP_WASM_INTERPRETER_INSTRUCTION) +
+        code->member_wasm_instruction_num * sizeof(TP_WASM_INSTRUCTION);
+
+    if (compile_cache.member_budget < size){
+
+        return true;
+    }
+
+    TP_COMPILE_CACHE_ENTRY* entry = (TP_COMPILE_CACHE_ENTRY*)TP_CALLOC(symbol_table, 1, sizeof(TP_COMPILE_CACHE_ENTRY));
+
+    if (NULL == entry){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    memcpy(entry->member_key, key, TP_COMPILE_CACHE_KEY_SIZE);
+    entry->member_ref_count = 1; // The cache only: compiled functions refer to the interpreter code.
+    entry->member_size = size;
+    entry->member_interpreter_code = code;
+    entry->member_param_count = code->member_param_count;
+
+    lock_compile_cache();
+
+    TP_COMPILE_CACHE_ENTRY* same_key_entry = NULL;
+
+    bool status = insert_entry(symbol_table, &entry, &same_key_entry);
+
+    if (entry){
+
+        tp_add_ref_wasm_interpreter_code(code);
+    }else if (same_key_entry){
+
+        // Made by another thread at the same time: shares the calls of the other interpreter code.
+        tp_add_ref_wasm_interpreter_code(same_key_entry->member_interpreter_code);
+
+        *interpreter_code = same_key_entry->member_interpreter_code;
+    }
+
+    unlock_compile_cache();
+
+    if (*interpreter_code != code){
+
+        tp_release_wasm_interpreter_code(&code);
+    }
+
+    return status;
+}
+
+static void lock_compile_cache(void)
+{
+#if defined(_WIN32)
+    AcquireSRWLockExclusive(&(compile_cache.member_lock));
+#else
+    (void)pthread_mutex_lock(&(compile_cache.member_lock));
+#endif
+}
+
+static void unlock_compile_cache(void)
+{
+#if defined(_WIN32)
+    ReleaseSRWLockExclusive(&(compile_cache.member_lock));
+#else
+    (void)pthread_mutex_unlock(&(compile_cache.member_lock));
+#endif
+}
+
+static int64_t atomic_increment(volatile int64_t* value)
+{
+#if defined(_WIN32)
+    return InterlockedIncrement64((volatile LONG64*)value);
+#else
+    return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static int64_t atomic_decrement(volatile int64_t* value)
+{
+#if defined(_WIN32)
+    return InterlockedDecrement64((volatile LONG64*)value);
+#else
+    return __atomic_sub_fetch(value, 1, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static bool atomic_increment_if_not_zero(volatile int64_t* value)
+{
+    int64_t current = atomic_load(value);
+
+    while (current){
+
+#if defined(_WIN32)
+        int64_t prev = InterlockedCompareExchange64((volatile LONG64*)value, current + 1, current);
+
+        if (prev == current){
+
+            return true;
+        }
+
+        current = prev;
+#else
+        if (__atomic_compare_exchange_n(
+            value, &current, current + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)){
+
+            return true;
+        }
+#endif
+    }
+
+    return false;
+}
+
+static int64_t atomic_load(volatile int64_t* value)
+{
+#if defined(_WIN32)
+    return InterlockedCompareExchange64((volatile LONG64*)value, 0, 0);
+#else
+    return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static TP_COMPILE_CACHE_ENTRY* atomic_load_entry(TP_COMPILE_CACHE_ENTRY* volatile* entry)
+{
+#if defined(_WIN32)
+    // NOTE: Volatile loads have acquire semantics on x64.
+    return *entry;
+#else
+    return __atomic_load_n(entry, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static void atomic_store_entry(TP_COMPILE_CACHE_ENTRY* volatile* entry, TP_COMPILE_CACHE_ENTRY* value)
+{
+#if defined(_WIN32)
+    (void)InterlockedExchangePointer((PVOID volatile*)entry, value);
+#else
+    __atomic_store_n(entry, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static TP_COMPILE_CACHE_ENTRY* find_entry(
+    TP_COMPILE_CACHE_ENTRY* entry, uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], bool is_interpreter)
+{
+    for (; entry; entry = atomic_load_entry(&(entry->member_next))){
+
+        if ((is_interpreter == (NULL != entry->member_interpreter_code)) &&
+            (0 == memcmp(entry->member_key, key, TP_COMPILE_CACHE_KEY_SIZE))){
+
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static bool insert_entry(
+    TP_SYMBOL_TABLE* symbol_table, TP_COMPILE_CACHE_ENTRY** entry, TP_COMPILE_CACHE_ENTRY** same_key_entry)
+{
+    // NOTE: Called with the cache lock held. *entry is freed and set to NULL unless it is linked.
+    TP_COMPILE_CACHE_ENTRY* new_entry = *entry;
+
+    TP_COMPILE_CACHE_ENTRY* volatile* bucket = get_bucket(new_entry->member_key);
+
+    TP_COMPILE_CACHE_ENTRY* p = find_entry(
+        *bucket, new_entry->member_key, NULL != new_entry->member_interpreter_code
+    );
+
+    if (p || (compile_cache.member_budget < new_entry->member_size)){
+
+        // Budget changed or compiled by another thread at the same time:
+        // the caller keeps its own code.
+        if (same_key_entry){
+
+            *same_key_entry = p;
+        }
+
+        TP_FREE(symbol_table, entry, sizeof(TP_COMPILE_CACHE_ENTRY));
+
+        return true;
+    }
+
+    if ( ! evict_entries(compile_cache.member_budget - new_entry->member_size)){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        TP_FREE(symbol_table, entry, sizeof(TP_COMPILE_CACHE_ENTRY));
+
+        return false;
+    }
+
+    new_entry->member_next = *bucket;
+
+    atomic_store_entry(bucket, new_entry);
+
+    link_clock_entry(new_entry);
+
+    compile_cache.member_total_size += new_entry->member_size;
+
+    free_retired_entries();
+
+    return true;
+}
+
+static TP_COMPILE_CACHE_ENTRY* volatile* get_bucket(uint8_t* key)
+{
+    uint32_t index = (key[0] | (key[1] << 8) | (key[2] << 16)) % TP_COMPILE_CACHE_BUCKET_NUM;
+
+    return &(compile_cache.member_bucket[index]);
+}
+
+static int64_t begin_reader(void)
+{
+    for (;;){
+
+        int64_t epoch = atomic_load(&(compile_cache.member_epoch));
+
+        (void)atomic_increment(&(compile_cache.member_reader_num[epoch & 1]));
+
+        // NOTE: The epoch may have advanced before the reader was counted.
+        if (epoch == atomic_load(&(compile_cache.member_epoch))){
+
+            return epoch;
+        }
+
+        (void)atomic_decrement(&(compile_cache.member_reader_num[epoch & 1]));
+    }
+}
+
+static void end_reader(int64_t epoch)
+{
+    (void)atomic_decrement(&(compile_cache.member_reader_num[epoch & 1]));
+}
+
+static void advance_epoch(void)
+{
+    // NOTE: Called with the cache lock held.
+    // The readers of epoch - 1 share the counter with the readers of epoch + 1.
+    int64_t epoch = compile_cache.member_epoch;
+
+    if (0 == atomic_load(&(compile_cache.member_reader_num[(epoch + 1) & 1]))){
+
+        (void)atomic_increment(&(compile_cache.member_epoch));
+    }
+}
+
+static void link_clock_entry(TP_COMPILE_CACHE_ENTRY* entry)
+{
+    // NOTE: Called with the cache lock held. The entry is inserted behind the clock hand.
+    TP_COMPILE_CACHE_ENTRY* hand = compile_cache.member_clock_hand;
+
+    if (NULL == hand){
+
+        entry->member_clock_prev = entry;
+        entry->member_clock_next = entry;
+
+        compile_cache.member_clock_hand = entry;
+    }else{
+
+        entry->member_clock_prev = hand->member_clock_prev;
+        entry->member_clock_next = hand;
+
+        hand->member_clock_prev->member_clock_next = entry;
+        hand->member_clock_prev = entry;
+    }
+
+    ++(compile_cache.member_entry_num);
+}
+
+static void unlink_clock_entry(TP_COMPILE_CACHE_ENTRY* entry)
+{
+    // NOTE: Called with the cache lock held.
+    if (entry == entry->member_clock_next){
+
+        compile_cache.member_clock_hand = NULL;
+    }else{
+
+        entry->member_clock_prev->member_clock_next = entry->member_clock_next;
+        entry->member_clock_next->member_clock_prev = entry->member_clock_prev;
+
+        if (entry == compile_cache.member_clock_hand){
+
+            compile_cache.member_clock_hand = entry->member_clock_next;
+        }
+    }
+
+    entry->member_clock_prev = NULL;
+    entry->member_clock_next = NULL;
+
+    --(compile_cache.member_entry_num);
+}
+
+static bool evict_entries(size_t budget)
+{
+    // NOTE: Called with the cache lock held.
+    // A referenced entry gets a second chance, but the hand does not skip more than one lap.
+    size_t skip_num = 0;
+
+    while (budget < compile_cache.member_total_size){
+
+        TP_COMPILE_CACHE_ENTRY* entry = compile_cache.member_clock_hand;
+
+        if (NULL == entry){
+
+            return false;
+        }
+
+        if (entry->member_is_referenced && (compile_cache.member_entry_num > skip_num)){
+
+            entry->member_is_referenced = false;
+
+            compile_cache.member_clock_hand = entry->member_clock_next;
+
+            ++skip_num;
+
+            continue;
+        }
+
+        if ( ! unlink_entry(entry)){
+
+            return false;
+        }
+
+        skip_num = 0;
+    }
+
+    return true;
+}
+
+static bool unlink_entry(TP_COMPILE_CACHE_ENTRY* entry)
+{
+    TP_COMPILE_CACHE_ENTRY* volatile* prev = get_bucket(entry->member_key);
+
+    for (; *prev; prev = &((*prev)->member_next)){
+
+        if (entry != *prev){
+
+            continue;
+        }
+
+        // NOTE: entry->member_next stays valid for readers on entry until it is freed.
+        atomic_store_entry(prev, entry->member_next);
+
+        unlink_clock_entry(entry);
+
+        compile_cache.member_total_size -= entry->member_size;
+
+        if (0 == atomic_decrement(&(entry->member_ref_count))){
+
+            retire_entry(entry);
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+static void retire_entry(TP_COMPILE_CACHE_ENTRY* entry)
+{
+    // NOTE: The readers which start after this epoch can't reach the unlinked entry.
+    entry->member_retired_epoch = compile_cache.member_epoch;
+    entry->member_retired_next = compile_cache.member_retired;
+
+    compile_cache.member_retired = entry;
+}
+
+static void free_retired_entries(void)
+{
+    if (NULL == compile_cache.member_retired){
+
+        return;
+    }
+
+    // NOTE: Both epochs advance at once if no reader is active.
+    advance_epoch();
+    advance_epoch();
+
+    int64_t epoch = compile_cache.member_epoch;
+
+    TP_COMPILE_CACHE_ENTRY** prev = &(compile_cache.member_retired);
+
+    while (*prev){
+
+        TP_COMPILE_CACHE_ENTRY* entry = *prev;
+
+        if (epoch < entry->member_retired_epoch + 2){
+
+            prev = &(entry->member_retired_next);
+
+            continue;
+        }
+
+        *prev = entry->member_retired_next;
+
+        if (entry->member_interpreter_code){
+
+            tp_release_wasm_interpreter_code(&(entry->member_interpreter_code));
+
+        }else if ( ! tp_code_arena_free(NULL, entry->member_x64_code)){
+
+            fprintf_s(stderr, "ERROR: tp_code_arena_free failed at %s function.\n", __func__);
+        }
+
+        TP_FREE(NULL, &entry, sizeof(TP_COMPILE_CACHE_ENTRY));
+    }
+}
+
+// SHA-256(FIPS 180-4)
+
+void tp_calc_sha256(const uint8_t* data, size_t size, uint8_t digest[TP_SHA256_DIGEST_SIZE])
+{
+    TP_SHA256 sha256 = { 0 };
+
+    sha256_init(&sha256);
+
+    sha256_update(&sha256, data, size);
+
+    sha256_final(&sha256, digest);
+}
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define TP_SHA256_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_init(TP_SHA256* sha256)
+{
+    static const uint32_t sha256_h[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    memcpy(sha256->member_state, sha256_h, sizeof(sha256_h));
+    sha256->member_length = 0;
+    sha256->member_block_pos = 0;
+}
+
+static void sha256_update(TP_SHA256* sha256, const uint8_t* data, size_t size)
+{
+    sha256->member_length += size;
+
+    for (size_t i = 0; size > i; ++i){
+
+        sha256->member_block[sha256->member_block_pos++] = data[i];
+
+        if (sizeof(sha256->member_block) == sha256->member_block_pos){
+
+            sha256_block(sha256, sha256->member_block);
+
+            sha256->member_block_pos = 0;
+        }
+    }
+}
+
+static void sha256_final(TP_SHA256* sha256, uint8_t digest[TP_COMPILE_CACHE_KEY_SIZE])
+{
+    uint64_t bit_length = sha256->member_length * 8;
+
+    sha256->member_block[sha256->member_block_pos++] = 0x80;
+
+    if ((sizeof(sha256->member_block) - sizeof(uint64_t)) < sha256->member_block_pos){
+
+        memset(
+            &(sha256->member_block[sha256->member_block_pos]), 0,
+            sizeof(sha256->member_block) - sha256->member_block_pos
+        );
+
+        sha256_block(sha256, sha256->member_block);
+
+        sha256->member_block_pos = 0;
+    }
+
+    memset(
+        &(sha256->member_block[sha256->member_block_pos]), 0,
+        sizeof(sha256->member_block) - sha256->member_block_pos
+    );
+
+    for (uint32_t i = 0; sizeof(uint64_t) > i; ++i){
+
+        sha256->member_block[sizeof(sha256->member_block) - 1 - i] = (uint8_t)(bit_length >> (i * 8));
+    }
+
+    sha256_block(sha256, sha256->member_block);
+
+    for (uint32_t i = 0; 8 > i; ++i){
+
+        digest[i * 4 + 0] = (uint8_t)(sha256->member_state[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(sha256->member_state[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(sha256->member_state[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)(sha256->member_state[i]);
+    }
+}
+
+static void sha256_block(TP_SHA256* sha256, const uint8_t* block)
+{
+    uint32_t w[64];
+
+    for (uint32_t i = 0; 16 > i; ++i){
+
+        w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+            ((uint32_t)block[i * 4 + 2] << 8) | (uint32_t)block[i * 4 + 3];
+    }
+
+    for (uint32_t i = 16; 64 > i; ++i){
+
+        uint32_t s0 = TP_SHA256_ROTR(w[i - 15], 7) ^ TP_SHA256_ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = TP_SHA256_ROTR(w[i - 2], 17) ^ TP_SHA256_ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = sha256->member_state[0];
+    uint32_t b = sha256->member_state[1];
+    uint32_t c = sha256->member_state[2];
+    uint32_t d = sha256->member_state[3];
+    uint32_t e = sha256->member_state[4];
+    uint32_t f = sha256->member_state[5];
+    uint32_t g = sha256->member_state[6];
+    uint32_t h = sha256->member_state[7];
+
+    for (uint32_t i = 0; 64 > i; ++i){
+
+        uint32_t s1 = TP_SHA256_ROTR(e, 6) ^ TP_SHA256_ROTR(e, 11) ^ TP_SHA256_ROTR(e, 25);
+        uint32_t ch = (e & f) ^ ((~e) & g);
+        uint32_t t1 = h + s1 + ch + sha256_k[i] + w[i];
+        uint32_t s0 = TP_SHA256_ROTR(a, 2) ^ TP_SHA256_ROTR(a, 13) ^ TP_SHA256_ROTR(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    sha256->member_state[0] += a;
+    sha256->member_state[1] += b;
+    sha256->member_state[2] += c;
+    sha256->member_state[3] += d;
+    sha256->member_state[4] += e;
+    sha256->member_state[5] += f;
+    sha256->member_state[6] += g;
+    sha256->member_state[7] += h;
+}
@@ -0,0 +1,276 @@
+
+// (C) Shin'ichi Ichikawa. Released under the MIT license.
+
+#include "tp_compiler.h"
+
+// Compile phase instrumentation(-i):
+// Each phase of compiler_main is bracketed by tp_begin_compile_phase and tp_end_compile_phase.
+// The wall time, the CPU time of the thread, the allocations of TP_CALLOC and TP_REALLOC and
+// the peak of the live bytes are recorded into member_compile_phase_record.
+// tp_write_compile_phase_file writes them as a JSON summary(int_calc_phase.json) and as
+// Chrome trace events(int_calc_phase_trace.json, open it with chrome://tracing or Perfetto).
+//
+// Note:
+//  (1) The bytes are the usable size of the blocks of the C runtime.
+//  (2) The blocks allocated before the first phase are not counted in the live bytes.
+
+static const char* compile_phase_name[TP_COMPILE_PHASE_NUM] = {
+    "token", "parse_tree", "semantic_analysis", "optimize", "wasm", "x64_code"
+};
+
+static const char* compile_phase_unit[TP_COMPILE_PHASE_NUM] = {
+    "tokens", "nodes", "nodes", "nodes", "wasm_bytes", "x64_bytes"
+};
+
+static bool write_compile_phase_summary(TP_SYMBOL_TABLE* symbol_table, FILE* write_file);
+static bool write_compile_phase_trace(TP_SYMBOL_TABLE* symbol_table, FILE* write_file);
+
+void tp_begin_compile_phase(TP_SYMBOL_TABLE* symbol_table)
+{
+    if ( ! symbol_table->member_is_record_compile_phase){
+
+        return;
+    }
+
+    TP_MEMORY_STATISTICS* memory_statistics = &(symbol_table->member_memory_statistics);
+
+    // The peak of each phase starts from the live bytes at the beginning of the phase.
+    memory_statistics->member_peak_bytes = memory_statistics->member_live_bytes;
+
+    symbol_table->member_phase_begin_memory_statistics = *memory_statistics;
+
+    symbol_table->member_phase_begin_cpu_time = tp_get_cpu_time();
+    symbol_table->member_phase_begin_time = tp_get_wall_time();
+
+    if (0 == symbol_table->member_compile_begin_time){
+
+        symbol_table->member_compile_begin_time = symbol_table->member_phase_begin_time;
+    }
+}
+
+void tp_end_compile_phase(TP_SYMBOL_TABLE* symbol_table, TP_COMPILE_PHASE phase, uint64_t unit_num)
+{
+    if (( ! symbol_table->member_is_record_compile_phase) || (TP_COMPILE_PHASE_NUM <= phase)){
+
+        return;
+    }
+
+    uint64_t end_time = tp_get_wall_time();
+    uint64_t end_cpu_time = tp_get_cpu_time();
+
+    TP_MEMORY_STATISTICS* memory_statistics = &(symbol_table->member_memory_statistics);
+    TP_MEMORY_STATISTICS* begin_memory_statistics = &(symbol_table->member_phase_begin_memory_statistics);
+
+    TP_COMPILE_PHASE_RECORD* phase_record = &(symbol_table->member_compile_phase_record[phase]);
+
+    phase_record->member_is_recorded = true;
+    phase_record->member_begin_time =
+        symbol_table->member_phase_begin_time - symbol_table->member_compile_begin_time;
+    phase_record->member_wall_time = end_time - symbol_table->member_phase_begin_time;
+    phase_record->member_cpu_time = end_cpu_time - symbol_table->member_phase_begin_cpu_time;
+    phase_record->member_unit_num = unit_num;
+    phase_record->member_allocation_num =
+        memory_statistics->member_allocation_num - begin_memory_statistics->member_allocation_num;
+    phase_record->member_allocation_bytes =
+        memory_statistics->member_allocation_bytes - begin_memory_statistics->member_allocation_bytes;
+    phase_record->member_peak_bytes = memory_statistics->member_peak_bytes;
+}
+
+const char* tp_get_compile_phase_name(TP_COMPILE_PHASE phase)
+{
+    return (TP_COMPILE_PHASE_NUM > phase) ? compile_phase_name[phase] : "unknown";
+}
+
+const char* tp_get_compile_phase_unit(TP_COMPILE_PHASE phase)
+{
+    return (TP_COMPILE_PHASE_NUM > phase) ? compile_phase_unit[phase] : "unknown";
+}
+
+bool tp_write_compile_phase_file(TP_SYMBOL_TABLE* symbol_table)
+{
+    FILE* write_file = NULL;
+
+    if ( ! tp_open_write_file_text(symbol_table, symbol_table->member_phase_file_path, &write_file)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! write_compile_phase_summary(symbol_table, write_file)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        (void)tp_close_file(symbol_table, &write_file);
+
+        return false;
+    }
+
+    if ( ! tp_close_file(symbol_table, &write_file)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! tp_open_write_file_text(symbol_table, symbol_table->member_phase_trace_file_path, &write_file)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! write_compile_phase_trace(symbol_table, write_file)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        (void)tp_close_file(symbol_table, &write_file);
+
+        return false;
+    }
+
+    if ( ! tp_close_file(symbol_table, &write_file)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool write_compile_phase_summary(TP_SYMBOL_TABLE* symbol_table, FILE* write_file)
+{
+    TP_COMPILE_PHASE_RECORD total = { 0 };
+
+    for (uint32_t i = 0; TP_COMPILE_PHASE_NUM > i; ++i){
+
+        TP_COMPILE_PHASE_RECORD* phase_record = &(symbol_table->member_compile_phase_record[i]);
+
+        if ( ! phase_record->member_is_recorded){
+
+            continue;
+        }
+
+        total.member_wall_time += phase_record->member_wall_time;
+        total.member_cpu_time += phase_record->member_cpu_time;
+        total.member_allocation_num += phase_record->member_allocation_num;
+        total.member_allocation_bytes += phase_record->member_allocation_bytes;
+
+        if (total.member_peak_bytes < phase_record->member_peak_bytes){
+
+            total.member_peak_bytes = phase_record->member_peak_bytes;
+        }
+    }
+
+    fprintf_s(write_file, "{\n");
+    fprintf_s(
+        write_file, "  \"config\": { \"optimization_level\": %d },\n",
+        (int)(symbol_table->member_optimization_level)
+    );
+    fprintf_s(
+        write_file,
+        "  \"total\": { \"wall_time_ns\": %llu, \"cpu_time_ns\": %llu, \"allocations\": %llu, "
+        "\"allocation_bytes\": %llu, \"peak_bytes\": %lld },\n",
+        (unsigned long long)(total.member_wall_time), (unsigned long long)(total.member_cpu_time),
+        (unsigned long long)(total.member_allocation_num), (unsigned long long)(total.member_allocation_bytes),
+        (long long)(total.member_peak_bytes)
+    );
+    fprintf_s(write_file, "  \"phases\": [");
+
+    bool is_first = true;
+
+    for (uint32_t i = 0; TP_COMPILE_PHASE_NUM > i; ++i){
+
+        TP_COMPILE_PHASE_RECORD* phase_record = &(symbol_table->member_compile_phase_record[i]);
+
+        if ( ! phase_record->member_is_recorded){
+
+            continue;
+        }
+
+        fprintf_s(
+            write_file,
+            "%s\n    { \"name\": \"%s\", \"unit\": \"%s\", \"units\": %llu, \"begin_ns\": %llu, "
+            "\"wall_time_ns\": %llu, \"cpu_time_ns\": %llu, \"allocations\": %llu, "
+            "\"allocation_bytes\": %llu, \"peak_bytes\": %lld }",
+            (is_first ? "" : ","), compile_phase_name[i], compile_phase_unit[i],
+            (unsigned long long)(phase_record->member_unit_num),
+            (unsigned long long)(phase_record->member_begin_time),
+            (unsigned long long)(phase_record->member_wall_time),
+            (unsigned long long)(phase_record->member_cpu_time),
+            (unsigned long long)(phase_record->member_allocation_num),
+            (unsigned long long)(phase_record->member_allocation_bytes),
+            (long long)(phase_record->member_peak_bytes)
+        );
+
+        is_first = false;
+    }
+
+    fprintf_s(write_file, "\n  ]\n");
+    fprintf_s(write_file, "}\n");
+
+    if (0 != fflush(write_file)){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool write_compile_phase_trace(TP_SYMBOL_TABLE* symbol_table, FILE* write_file)
+{
+    // Trace Event Format: "X" is a complete event and "C" is a counter event.
+    // The timestamps and the durations are in microseconds.
+    fprintf_s(write_file, "{\n");
+    fprintf_s(write_file, "  \"traceEvents\": [");
+
+    bool is_first = true;
+
+    for (uint32_t i = 0; TP_COMPILE_PHASE_NUM > i; ++i){
+
+        TP_COMPILE_PHASE_RECORD* phase_record = &(symbol_table->member_compile_phase_record[i]);
+
+        if ( ! phase_record->member_is_recorded){
+
+            continue;
+        }
+
+        double begin_us = phase_record->member_begin_time / 1000.0;
+
+        fprintf_s(
+            write_file,
+            "%s\n    { \"name\": \"%s\", \"cat\": \"compile\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+            "\"pid\": 1, \"tid\": 1, \"args\": { \"%s\": %llu, \"cpu_time_ns\": %llu, "
+            "\"allocations\": %llu, \"allocation_bytes\": %llu } },",
+            (is_first ? "" : ","), compile_phase_name[i], begin_us,
+            phase_record->member_wall_time / 1000.0, compile_phase_unit[i],
+            (unsigned long long)(phase_record->member_unit_num),
+            (unsigned long long)(phase_record->member_cpu_time),
+            (unsigned long long)(phase_record->member_allocation_num),
+            (unsigned long long)(phase_record->member_allocation_bytes)
+        );
+        fprintf_s(
+            write_file,
+            "\n    { \"name\": \"heap\", \"ph\": \"C\", \"ts\": %.3f, \"pid\": 1, \"args\": { \"peak_bytes\": %lld } }",
+            begin_us, (long long)(phase_record->member_peak_bytes)
+        );
+
+        is_first = false;
+    }
+
+    fprintf_s(write_file, "\n  ],\n");
+    fprintf_s(write_file, "  \"displayTimeUnit\": \"ns\"\n");
+    fprintf_s(write_file, "}\n");
+
+    if (0 != fflush(write_file)){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
@@ -1,18 +1,36 @@
 
 // (C) Shin'ichi Ichikawa. Released under the MIT license.
 
+#if ! defined(_WIN32)
+#include <sched.h>
+#include <setjmp.h>
+#include <signal.h>
+#endif
 #include "tp_compiler.h"
 
 static TP_SYMBOL_TABLE init_symbol_table_value = {
 // config section:
+    // TP_CONFIG_OPTION_IS_BATCH 'b'
+    .member_is_batch = false,
     // TP_CONFIG_OPTION_IS_OUTPUT_CURRENT_DIR 'c'
     .member_is_output_current_dir = false,
+    // TP_CONFIG_OPTION_IS_OUTPUT_ELF_SHARED_OBJECT_FILE 'd'
+    .member_is_output_elf_shared_object_file = false,
+    // TP_CONFIG_OPTION_IS_OUTPUT_ELF_OBJECT_FILE 'e'
+    .member_is_output_elf_object_file = false,
+    // TP_CONFIG_OPTION_IS_OUTPUT_PHASE_FILE 'i'
+    .member_is_output_phase_file = false,
+    // TP_CONFIG_OPTION_IS_BENCHMARK_MODE 'k'
+    .member_is_benchmark_mode = false,
+    .member_benchmark_config = { 0 },
     // TP_CONFIG_OPTION_IS_OUTPUT_LOG_FILE 'l'
     .member_is_output_log_file = false,
     // TP_CONFIG_OPTION_IS_NO_OUTPUT_MESSAGES 'm'
     .member_is_no_output_messages = false,
     // TP_CONFIG_OPTION_IS_NO_OUTPUT_FILES 'n'
     .member_is_no_output_files = false,
+    // TP_CONFIG_OPTION_IS_INPUTS_POINTER 'p'
+    .member_is_inputs_pointer = false,
     // TP_CONFIG_OPTION_IS_ORIGIN_WASM 'r'
     .member_is_origin_wasm = false,
     // TP_CONFIG_OPTION_IS_SOURCE_CMD_PARAM 's'
@@ -24,6 +42,8 @@ static TP_SYMBOL_TABLE init_symbol_table_value = {
     .member_is_output_wasm_file = false,
     // TP_CONFIG_OPTION_IS_OUTPUT_X64_FILE 'x'
     .member_is_output_x64_file = false,
+    // TP_CONFIG_OPTION_OPTIMIZATION_LEVEL 'O'
+    .member_optimization_level = TP_OPTIMIZATION_LEVEL_DEFAULT,
 
 // message section:
     .member_log_hide_after_disp = false,
@@ -40,6 +60,10 @@ static TP_SYMBOL_TABLE init_symbol_table_value = {
     .member_object_hash_file_path = { 0 },
     .member_wasm_file_path = { 0 },
     .member_x64_file_path = { 0 },
+    .member_elf_object_file_path = { 0 },
+    .member_elf_shared_object_file_path = { 0 },
+    .member_phase_file_path = { 0 },
+    .member_phase_trace_file_path = { 0 },
 
 // input file section:
     .member_input_file_path = { 0 },
@@ -62,11 +86,13 @@ static TP_SYMBOL_TABLE init_symbol_table_value = {
 // parse tree section:
     .member_nesting_level_of_expression = 0,
     .member_tp_parse_tree = NULL,
+    .member_tp_parse_tree_node_num = 0,
 
 // semantic analysis section:
     .member_object_hash.member_mask = UINT8_MAX,
     .member_object_hash.member_hash_table = { 0 },
     .member_var_count = 0,
+    .member_param_count = 0,
     .member_last_statement = NULL,
     .member_parse_tree_type = {
         // TP_GRAMMER_TYPE_INDEX_STATEMENT_1, Grammer: Statement -> variable '=' Expression ';'
@@ -100,17 +126,27 @@ static TP_SYMBOL_TABLE init_symbol_table_value = {
     .member_grammer_factor_2_num = 0,
     .member_grammer_factor_3_num = 0,
 
+// SSA IR section:
+    .member_ir_instruction = NULL,
+    .member_ir_instruction_num = 0,
+    .member_ir_instruction_size = 0,
+    .member_ir_return_value = TP_IR_VALUE_NULL,
+
 // wasm section:
     .member_wasm_module = { 0 },
     .member_code_index = 0,
     .member_code_body_size = 0,
     .member_code_section_buffer = NULL,
+    .member_wasm_instruction = NULL,
+    .member_wasm_instruction_num = 0,
+    .member_wasm_instruction_size = 0,
+    .member_wasm_instruction_param_count = 0,
+    .member_wasm_instruction_var_count = 0,
+    .member_wasm_instruction_stack_depth_max = 0,
 
 // x64 section:
     .member_stack = NULL,
-    .member_wasm_code_body_buffer = NULL,
-    .member_wasm_code_body_pos = 0,
-    .member_wasm_code_body_size = 0,
+    .member_wasm_instruction_pos = 0,
     .member_stack_pos = TP_WASM_STACK_EMPTY,
     .member_stack_size = 0,
     .member_stack_size_allocate_unit = TP_WASM_STACK_SIZE_ALLOCATE_UNIT,
@@ -125,6 +161,13 @@ static TP_SYMBOL_TABLE init_symbol_table_value = {
     .member_temporary_variable_size_max = TP_WASM_TEMPORARY_VARIABLE_MAX_DEFAULT,
     .member_padding_temporary_variable_bytes = 0,
 
+    .member_x64_live_range = NULL,
+    .member_x64_live_range_num = 0,
+    .member_x64_live_range_size = 0,
+    .member_x64_live_range_pos = 0,
+    .member_x64_local_live_range = NULL,
+    .member_x64_local_live_range_size = 0,
+
     .member_use_X86_32_register = { 0 },
     .member_use_X64_32_register = { 0 },
     .member_use_nv_register = { TP_X64_NV64_REGISTER_NULL },
@@ -132,7 +175,39 @@ static TP_SYMBOL_TABLE init_symbol_table_value = {
     .member_register_bytes = 0,
     .member_padding_register_bytes = 0,
 
-    .member_stack_imm32 = 0
+    .member_stack_imm32 = 0,
+    .member_is_x64_frame_elision = false,
+
+    .member_x64_entry_mode = TP_X64_ENTRY_MODE_ARGS,
+    .member_batch_slot_offset = 0,
+    .member_batch_loop_offset = 0,
+    .member_batch_exit_jump_offset = 0,
+    .member_x64_simd_isa = TP_X64_SIMD_ISA_NONE,
+    .member_simd_lane_num = 0,
+    .member_simd_register_num = 0,
+    .member_simd_local_variable_size = 0,
+    .member_simd_nv_register_size = 0,
+    .member_simd_local_variable_offset = 0,
+    .member_simd_nv_register_offset = 0,
+    .member_simd_loop_offset = 0,
+    .member_simd_exit_jump_offset = 0,
+    .member_simd_bail_jump_offset = 0,
+
+    .member_x64_instruction = NULL,
+    .member_x64_instruction_num = 0,
+    .member_x64_instruction_size = 0,
+    .member_is_record_x64_instruction = false,
+
+    .member_optimization_statistics = { 0 },
+
+// compile phase section:
+    .member_is_record_compile_phase = false,
+    .member_compile_begin_time = 0,
+    .member_phase_begin_time = 0,
+    .member_phase_begin_cpu_time = 0,
+    .member_phase_begin_memory_statistics = { 0 },
+    .member_memory_statistics = { 0 },
+    .member_compile_phase_record = { 0 }
 };
 
 typedef struct test_case_table_{
@@ -191,9 +266,137 @@ static TEST_CASE_TABLE test_case_table[] = {
     "int32_t value2 = 2 + (3 * value1);\n"
     "value1 = value2 + 100;\n", 129 },
 
+    { "int32_t value1 = 2147483647;\n"
+    "int32_t value2 = value1 + 1;\n"
+    "int32_t value3 = value2 - 1 + value2 * 2;\n", 2147483647 },
+
+    // 64 expressions: more than NESTING_LEVEL_OF_EXPRESSION_MAXIMUM without nesting.
+    { "int32_t value1 =\n"
+    "(1) + (1) + (1) + (1) + (1) + (1) + (1) + (1) +\n"
+    "(1) + (1) + (1) + (1) + (1) + (1) + (1) + (1) +\n"
+    "(1) + (1) + (1) + (1) + (1) + (1) + (1) + (1) +\n"
+    "(1) + (1) + (1) + (1) + (1) + (1) + (1) + (1) +\n"
+    "(1) + (1) + (1) + (1) + (1) + (1) + (1) + (1) +\n"
+    "(1) + (1) + (1) + (1) + (1) + (1) + (1) + (1) +\n"
+    "(1) + (1) + (1) + (1) + (1) + (1) + (1) + (1) +\n"
+    "(1) + (1) + (1) + (1) + (1) + (1) + (1) + (1);\n", 64 },
+
     { NULL, 0 }
 };
 
+#define TP_TEST_BATCH_ROW_NUM 100
+
+typedef struct test_inputs_case_table_{
+    uint8_t* member_source_code;
+    uint32_t member_input_count;
+    int32_t member_inputs[TP_X64_CALL_ARGS_NUM_MAX];
+    int32_t member_return_value;
+}TEST_INPUTS_CASE_TABLE;
+
+static TEST_INPUTS_CASE_TABLE test_inputs_case_table[] = {
+
+    { "int32_t value1 = a + b;\n", 2, { 1, 2 }, 3 },
+
+    { "int32_t value1 = a * 2;\n"
+    "int32_t value2 = value1 - b;\n", 2, { 5, 3 }, 7 },
+
+    { "int32_t value1 = -a + b;\n", 2, { 3, 10 }, 7 },
+
+    { "a = a + 1;\n", 1, { 41 }, 42 },
+
+    { "int32_t value1 = a + b * c - d + e * f;\n"
+    "int32_t value2 = value1 * g;\n", 7, { 1, 2, 3, 8, 4, 5, -2 }, -38 },
+
+    { "int32_t value1 = (a * 7 - b) / (b + 3);\n"
+    "int32_t value2 = 1000 / b - value1;\n", 2, { 20, 5 }, 184 },
+
+    // The dividend is sign extended(EDX:EAX).
+    { "int32_t value1 = a / b;\n", 2, { -7, 2 }, -3 },
+
+    { "int32_t value1 = (a - 30) / -3 + b / 4;\n", 2, { 10, -9 }, 4 },
+
+    { "int32_t value1 = (a + b) * (c - d) * (a - c);\n"
+    "int32_t value2 = value1 * (b + d) - (a * c + b * d) * (a * b - (c * d + (a - b) * (c - a)));\n",
+    4, { 5, -3, 7, 2 }, 1325 },
+
+    { "int32_t value1 = a * (b + (c * (d - (a + (b * (c - (d + (a * (b - (c + (d * (a + (b - (c * (d + 7)))))))))))))));\n"
+    "int32_t value2 = (a * 100) / b + (c * 50) / d * (a - c) + value1 / 7;\n", 4, { 9, 4, 6, 3 }, 38993 },
+
+    { "int32_t value1 = a + b;\n"
+    "int32_t value2 = value1 * c - a;\n"
+    "int32_t value3 = value2 / (value1 - d) + value1 * b;\n"
+    "a = value3 - value2 / c + a;\n"
+    "int32_t value4 = a * value1 + value3 / b - c;\n", 4, { 7, 3, 5, 2 }, 346 },
+
+    { "int32_t value1 = (1 + 2) * 3;\n"
+    "int32_t value2 = -value1 + 100 / (value1 - 4) + 2147483647;\n"
+    "a = a + value2 * 2;\n", 1, { 5 }, 25 },
+
+    { "int32_t value1 = a + (b * (c - (d + (a * (b - (c + (d * (a + (b - (c * (d + (a - (b + (c * (d - (a + b))))))))))))))));\n"
+    "int32_t value2 = value1 * a - value1 * b;\n", 4, { 3, -2, 5, 7 }, -19285 },
+
+    { "int32_t value1 = a / 100 + b / 1000 - c / 60;\n"
+    "int32_t value2 = value1 * 9 + a * 16 - b * 3 + c * 5;\n", 3, { -12345, 987654, -3599 }, -3170170 },
+
+    { "int32_t value1 = a / b + a / (-7) + a / 8;\n", 2, { -100, 3 }, -31 },
+
+    { "int32_t value1 = a * 3;\n"
+    "value1 = b + 1;\n"
+    "int32_t value2 = a / 7;\n"
+    "int32_t value3 = value2 + value1;\n"
+    "int32_t value4 = value1 * 2;\n", 2, { 4, 10 }, 22 },
+
+    { "int32_t value1 = a;\n"
+    "value1 = value1 + 1;\n"
+    "value1 = value1 * 2;\n"
+    "int32_t value2 = a / b;\n"
+    "int32_t value3 = a - 1;\n", 2, { 5, 2 }, 4 },
+
+    { "int32_t value1 = (a + b) * c;\n"
+    "int32_t value2 = (b + a) * c + (a + b);\n"
+    "int32_t value3 = value1 * value2 - (a + b) * c;\n", 3, { 2, 3, 4 }, 480 },
+
+    { "int32_t value1 = a - b;\n"
+    "int32_t value2 = value1 / c;\n"
+    "int32_t value3 = -a + (a - b) / c * -a + value2;\n", 3, { -50, 7, 3 }, -919 },
+
+    { "int32_t value1 = a * 2;\n"
+    "value1 = value1 + 1;\n"
+    "int32_t value2 = a * 2 + value1 * (a * 2 + 1);\n", 1, { 5 }, 131 },
+
+    { "int32_t value1 = a * 1 + 0 - (b - b);\n"
+    "int32_t value2 = 0 - value1 * -1;\n"
+    "int32_t value3 = value2 / 1 + b * 0 - -a;\n", 2, { 6, 9 }, 12 },
+
+    { "int32_t value1 = a - (b * (c - (a + (b * (c - (a - (b + (c * (a - (b + c))))))))));\n"
+    "int32_t value2 = value1 * (a - (b + c)) + (b + c) / a;\n", 3, { 3, -4, 11 }, 2422 },
+
+    { "int32_t value1 = a * 1000 - 300;\n"
+    "int32_t value2 = 0;\n"
+    "value2 = value1 + b * 7 - -200 + 100000 * b;\n", 2, { 3, 5 }, 502935 },
+
+    { "int32_t value1 = (a * b + c * d) * (e * f + g * h) + (a - h) * (b - g) * (c - f) * (d - e);\n",
+    8, { 3, -2, 5, 7, -4, 6, 1, 9 }, -633 },
+
+    { "int32_t value1 = (a + b) * (c - d) / e + a * b * c * d * e - f;\n", 6, { 1, 2, 3, 4, 5, 6 }, 114 },
+
+    { "int32_t value1 = (8 - d) / a + (a + b / 16);\n"
+    "int32_t value2 = -a - 15 / 16;\n"
+    "int32_t value3 = value2 - (a - c) + (19 - -value2) - value2;\n"
+    "int32_t value4 = value2 / a - (d - value3) + value3 / a;\n"
+    "int32_t value5 = ((19 - -value2) / 7 - value3 / b) / b;\n"
+    "value1 = 49 * (b + d) * (value3 / b * value1 + (d + value3));\n",
+    4, { 93, 1937425168, -9100, 1535089532 }, 1206321204 },
+
+    // Without input parameters: only TP_X64_ENTRY_MODE_ARGS is called by tp_call_compiled_function.
+    { "int32_t value1 = (2 + 3) * 7;\n", 0, { 0 }, 35 },
+
+    { NULL, 0, { 0 }, 0 }
+};
+
+static volatile uint32_t tier_up_threshold = TP_TIER_UP_THRESHOLD_DEFAULT;
+static volatile TP_OPTIMIZATION_LEVEL optimization_level = TP_OPTIMIZATION_LEVEL_DEFAULT;
+
 static bool test_compiler(
     int argc, char** argv, uint8_t* msg_buffer, size_t msg_buffer_size,
     char* drive, char* dir, time_t now
@@ -224,23 +427,69 @@ static bool make_path(
     TP_SYMBOL_TABLE* symbol_table, char* drive, char* dir, char* prefix, char* fname, char* ext,
     char* path, size_t path_size
 );
+static bool is_exists_path(char* path);
+static bool make_directory(char* path);
+static bool move_path(char* from_path, char* to_path);
+static void init_grammer_type_num(TP_SYMBOL_TABLE* symbol_table);
 static uint32_t calc_grammer_type_num(TP_SYMBOL_TABLE* symbol_table, size_t grammer_type_index);
+static bool optimize_program(TP_SYMBOL_TABLE* symbol_table);
 static bool parse_cmd_line_param(
     int argc, char** argv, TP_SYMBOL_TABLE* symbol_table, bool* is_disp_usage, bool* is_test
 );
 static void free_memory_and_file(TP_SYMBOL_TABLE** symbol_table);
+static bool make_interpreter_function(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t cache_key[TP_COMPILE_CACHE_KEY_SIZE],
+    TP_X64_ENTRY_MODE entry_mode, uint32_t threshold, TP_COMPILED_FUNCTION* compiled_function
+);
+static void set_interpreter_function(
+    TP_WASM_INTERPRETER_CODE* interpreter_code,
+    TP_X64_ENTRY_MODE entry_mode, uint32_t threshold, TP_COMPILED_FUNCTION* compiled_function
+);
+static uint8_t* get_tiered_x64_code(TP_COMPILED_FUNCTION* compiled_function, uint64_t call_count);
+static bool tier_up_compiled_function(TP_COMPILED_FUNCTION* compiled_function);
+static int64_t atomic_add(volatile int64_t* value, int64_t addend);
+static bool atomic_compare_exchange(volatile int64_t* value, int64_t expected, int64_t desired);
+static int64_t atomic_load(volatile int64_t* value);
+static void atomic_store(volatile int64_t* value, int64_t desired);
+static uint8_t* atomic_load_x64_code(uint8_t** x64_code);
+static void atomic_store_x64_code(uint8_t** x64_code, uint8_t* value);
+static bool test_compiled_function(uint8_t* source_code, int32_t correct_value);
+static bool test_compile_cache(void);
+static bool test_code_cache_file(void);
+static bool test_code_arena(void);
+static bool test_elf_file(void);
+static bool test_tiered_function(void);
+static bool test_optimized_x64_code(void);
+static bool is_x64_frame_code(uint8_t* x64_code, uint32_t x64_code_size);
+static bool test_measure_compile_phase(void);
+static bool test_compiled_function_with_inputs(TEST_INPUTS_CASE_TABLE* test_case, TP_X64_ENTRY_MODE entry_mode);
+static bool test_compiled_function_batch(TEST_INPUTS_CASE_TABLE* test_case);
+static bool test_args_param_count_max(void);
+static bool test_batch_division_trap(void);
+static bool call_batch_division_trap(
+    TP_COMPILED_FUNCTION* batch_function, const int32_t* const* columns, int32_t* outputs, bool* is_raised
+);
+#if defined(_WIN32)
+static LONG CALLBACK division_trap_handler(PEXCEPTION_POINTERS exception_pointers);
+#else
+static void division_trap_handler(int signal_number);
+#endif
 
 bool tp_compiler(int argc, char** argv, uint8_t* msg_buffer, size_t msg_buffer_size)
 {
+#if defined(_WIN32)
     SetLastError(NO_ERROR);
+#endif
 
     errno_t err = _set_errno(0);
 
+#if defined(_WIN32)
     _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
     _CrtSetReportMode(_CRT_ERROR, _CRTDBG_MODE_FILE | _CRTDBG_MODE_DEBUG);
     _CrtSetReportFile(_CRT_ERROR, _CRTDBG_FILE_STDERR);
     _CrtSetReportMode(_CRT_WARN, _CRTDBG_MODE_FILE | _CRTDBG_MODE_DEBUG);
     _CrtSetReportFile(_CRT_WARN, _CRTDBG_FILE_STDERR);
+#endif
 
     bool is_test_mode = false;
 
@@ -263,8 +512,11 @@ bool tp_compiler(int argc, char** argv, uint8_t* msg_buffer, size_t msg_buffer_s
 
     if (is_test_mode){
 
-        if ( ! test_compiler(
-            argc, argv, msg_buffer, msg_buffer_size, drive, dir, now)){
+        bool status = test_compiler(argc, argv, msg_buffer, msg_buffer_size, drive, dir, now);
+
+        tp_clear_compile_cache();
+
+        if ( ! status){
 
             _CrtDumpMemoryLeaks();
 
@@ -277,54 +529,2094 @@ bool tp_compiler(int argc, char** argv, uint8_t* msg_buffer, size_t msg_buffer_s
     return true;
 }
 
-static bool test_compiler(
-    int argc, char** argv, uint8_t* msg_buffer, size_t msg_buffer_size,
-    char* drive, char* dir, time_t now)
+bool tp_compile_function(
+    uint8_t* source_code, rsize_t source_code_length, TP_X64_ENTRY_MODE entry_mode,
+    TP_COMPILED_FUNCTION** compiled_function)
 {
-    bool status = true;
+    if ((NULL == source_code) || (0 == source_code_length) || (NULL == compiled_function)){
 
-    bool is_test_mode = true;
+        fprintf_s(stderr, "ERROR: bad parameter at %s function.\n", __func__);
+
+        return false;
+    }
+
+    *compiled_function = NULL;
+
+    uint8_t cache_key[TP_COMPILE_CACHE_KEY_SIZE] = { 0 };
+
+    TP_OPTIMIZATION_LEVEL level = optimization_level;
+
+    tp_make_compile_cache_key(source_code, source_code_length, entry_mode, level, cache_key);
+
+    TP_COMPILED_FUNCTION* function = (TP_COMPILED_FUNCTION*)TP_CALLOC(NULL, 1, sizeof(TP_COMPILED_FUNCTION));
+
+    if (NULL == function){
+
+        TP_PRINT_CRT_ERROR(NULL);
+
+        return false;
+    }
+
+    if (tp_compile_cache_lookup(cache_key, function)){
+
+        *compiled_function = function;
+
+        return true;
+    }
+
+    if (tp_load_code_cache_file(cache_key, entry_mode, function)){
+
+        // NOTE: function is valid without the compile cache.
+        (void)tp_compile_cache_insert(NULL, cache_key, function);
+
+        *compiled_function = function;
+
+        return true;
+    }
+
+    uint32_t threshold = tier_up_threshold;
+
+    TP_WASM_INTERPRETER_CODE* interpreter_code = NULL;
+
+    // NOTE: The interpreter code and the calls are shared without running the front end again.
+    if (threshold && tp_compile_cache_lookup_interpreter(cache_key, &interpreter_code)){
+
+        set_interpreter_function(interpreter_code, entry_mode, threshold, function);
+
+        *compiled_function = function;
+
+        return true;
+    }
+
+    TP_SYMBOL_TABLE* symbol_table = (TP_SYMBOL_TABLE*)TP_CALLOC(NULL, 1, sizeof(TP_SYMBOL_TABLE));
+
+    if (NULL == symbol_table){
+
+        TP_PRINT_CRT_ERROR(NULL);
+
+        TP_FREE(NULL, &function, sizeof(TP_COMPILED_FUNCTION));
+
+        return false;
+    }
+
+    *symbol_table = init_symbol_table_value;
+
+    symbol_table->member_disp_log_file = stderr;
+    symbol_table->member_is_no_output_files = true;
+    symbol_table->member_x64_entry_mode = entry_mode;
+    symbol_table->member_optimization_level = level;
+
+    init_grammer_type_num(symbol_table);
+
+    if ( ! tp_make_token(symbol_table, source_code, source_code_length)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    if ( ! tp_make_parse_tree(symbol_table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    if ( ! tp_semantic_analysis(symbol_table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    // NOTE: The interpreter has no limit, but the x64 code after tier-up has.
+    if ((TP_X64_ENTRY_MODE_ARGS == entry_mode) &&
+        (TP_X64_CALL_ARGS_NUM_MAX < symbol_table->member_param_count)){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE,
+            TP_MSG_FMT("ERROR: TP_X64_CALL_ARGS_NUM_MAX(%1) < param_count(%2). Use TP_X64_ENTRY_MODE_INPUTS_POINTER."),
+            TP_LOG_PARAM_INT32_VALUE(TP_X64_CALL_ARGS_NUM_MAX),
+            TP_LOG_PARAM_UINT64_VALUE(symbol_table->member_param_count)
+        );
+
+        goto error_proc;
+    }
+
+    if ( ! optimize_program(symbol_table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    // NOTE: The wasm module is not needed by x64 code and the interpreter.
+    if ( ! tp_make_wasm_instruction(symbol_table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    if (threshold){
+
+        if (make_interpreter_function(symbol_table, cache_key, entry_mode, threshold, function)){
+
+            free_memory_and_file(&symbol_table);
+
+            *compiled_function = function;
+
+            return true;
+        }
+
+        // NOTE: Compiles x64 code at once without the interpreter.
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+    }
+
+    if ( ! tp_make_x64_function(symbol_table, &(function->member_x64_code), &(function->member_x64_code_size))){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    function->member_param_count = symbol_table->member_param_count;
+    function->member_entry_mode = entry_mode;
+    function->member_x64_simd_isa = symbol_table->member_x64_simd_isa;
+    function->member_x64_jit_func = (TP_X64_JIT_FUNC)(function->member_x64_code);
+
+    if ( ! tp_compile_cache_insert(symbol_table, cache_key, function)){
+
+        // NOTE: function is valid without the compile cache.
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+    }
+
+    if ( ! tp_save_code_cache_file(cache_key, function)){
+
+        // NOTE: function is valid without the on-disk code cache.
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+    }
+
+    free_memory_and_file(&symbol_table);
+
+    *compiled_function = function;
+
+    return true;
+
+error_proc:
+
+    TP_PUT_LOG_MSG(
+        symbol_table, TP_LOG_TYPE_DISP_FORCE,
+        TP_MSG_FMT("%1"), TP_LOG_PARAM_STRING("ERROR: Compile failed.")
+    );
+
+    if (function){
+
+        TP_FREE(symbol_table, &function, sizeof(TP_COMPILED_FUNCTION));
+    }
+
+    free_memory_and_file(&symbol_table);
+
+    return false;
+}
+
+bool tp_measure_compile_phase(
+    uint8_t* source_code, rsize_t source_code_length, TP_OPTIMIZATION_LEVEL optimization_level,
+    TP_COMPILE_PHASE_RECORD phase_record[TP_COMPILE_PHASE_NUM])
+{
+    if ((NULL == source_code) || (0 == source_code_length) || (NULL == phase_record)){
+
+        fprintf_s(stderr, "ERROR: bad parameter at %s function.\n", __func__);
+
+        return false;
+    }
+
+    memset(phase_record, 0, sizeof(TP_COMPILE_PHASE_RECORD) * TP_COMPILE_PHASE_NUM);
+
+    uint8_t* x64_code = NULL;
+    uint32_t x64_code_size = 0;
+
+    TP_SYMBOL_TABLE* symbol_table = (TP_SYMBOL_TABLE*)TP_CALLOC(NULL, 1, sizeof(TP_SYMBOL_TABLE));
+
+    if (NULL == symbol_table){
+
+        TP_PRINT_CRT_ERROR(NULL);
+
+        return false;
+    }
+
+    *symbol_table = init_symbol_table_value;
+
+    symbol_table->member_disp_log_file = stderr;
+    symbol_table->member_is_no_output_files = true;
+    symbol_table->member_optimization_level = optimization_level;
+    symbol_table->member_is_record_compile_phase = true;
+
+    init_grammer_type_num(symbol_table);
+
+    // NOTE: The phases are the same as compiler_main with the wasm module(-n -w without writing the file).
+    tp_begin_compile_phase(symbol_table);
+
+    if ( ! tp_make_token(symbol_table, source_code, source_code_length)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    tp_end_compile_phase(symbol_table, TP_COMPILE_PHASE_TOKEN, symbol_table->member_tp_token_pos);
+    tp_begin_compile_phase(symbol_table);
+
+    if ( ! tp_make_parse_tree(symbol_table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    tp_end_compile_phase(symbol_table, TP_COMPILE_PHASE_PARSE_TREE, symbol_table->member_tp_parse_tree_node_num);
+    tp_begin_compile_phase(symbol_table);
+
+    if ( ! tp_semantic_analysis(symbol_table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    tp_end_compile_phase(symbol_table, TP_COMPILE_PHASE_SEMANTIC_ANALYSIS, symbol_table->member_tp_parse_tree_node_num);
+    tp_begin_compile_phase(symbol_table);
+
+    if ( ! optimize_program(symbol_table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    tp_end_compile_phase(symbol_table, TP_COMPILE_PHASE_OPTIMIZE, symbol_table->member_tp_parse_tree_node_num);
+    tp_begin_compile_phase(symbol_table);
+
+    if ( ! tp_make_wasm(symbol_table, false)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    tp_end_compile_phase(symbol_table, TP_COMPILE_PHASE_WASM, symbol_table->member_wasm_module.member_content_size);
+    tp_begin_compile_phase(symbol_table);
+
+    if ( ! tp_make_x64_function(symbol_table, &x64_code, &x64_code_size)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    tp_end_compile_phase(symbol_table, TP_COMPILE_PHASE_X64_CODE, x64_code_size);
+
+    memcpy(phase_record, symbol_table->member_compile_phase_record, sizeof(TP_COMPILE_PHASE_RECORD) * TP_COMPILE_PHASE_NUM);
+
+    if ( ! tp_code_arena_free(symbol_table, x64_code)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    free_memory_and_file(&symbol_table);
+
+    return true;
+
+error_proc:
+
+    TP_PUT_LOG_MSG(
+        symbol_table, TP_LOG_TYPE_DISP_FORCE,
+        TP_MSG_FMT("%1"), TP_LOG_PARAM_STRING("ERROR: Compile failed.")
+    );
+
+    free_memory_and_file(&symbol_table);
+
+    return false;
+}
+
+bool tp_call_compiled_function(TP_COMPILED_FUNCTION* compiled_function, int32_t* return_value)
+{
+    if ((NULL == compiled_function) || (NULL == return_value)){
+
+        fprintf_s(stderr, "ERROR: bad parameter at %s function.\n", __func__);
+
+        return false;
+    }
+
+    // NOTE: The x64 code of the other entry modes reads the inputs or the columns.
+    if ((TP_X64_ENTRY_MODE_ARGS != compiled_function->member_entry_mode) ||
+        compiled_function->member_param_count){
+
+        fprintf_s(
+            stderr, "ERROR: entry_mode=(%d), param_count=(%d) needs tp_call_compiled_function_with_inputs "
+            "or tp_call_compiled_function_batch at %s function.\n",
+            compiled_function->member_entry_mode, compiled_function->member_param_count, __func__
+        );
+
+        return false;
+    }
+
+    uint8_t* x64_code = get_tiered_x64_code(compiled_function, 1);
+
+    if (x64_code){
+
+        *return_value = ((TP_X64_JIT_FUNC)x64_code)();
+
+        return true;
+    }
+
+    if ( ! tp_run_wasm_interpreter(compiled_function->member_interpreter_code, NULL, return_value)){
+
+        fprintf_s(stderr, "ERROR: tp_run_wasm_interpreter failed at %s function.\n", __func__);
+
+        return false;
+    }
+
+    return true;
+}
+
+bool tp_call_compiled_function_with_inputs(
+    TP_COMPILED_FUNCTION* compiled_function, const int32_t* inputs, uint32_t input_count, int32_t* return_value)
+{
+    if ((NULL == compiled_function) || (NULL == return_value) ||
+        (compiled_function->member_param_count != input_count) || (input_count && (NULL == inputs))){
+
+        fprintf_s(stderr, "ERROR: bad parameter at %s function.\n", __func__);
+
+        return false;
+    }
+
+    uint8_t* x64_code = NULL;
+
+    if (TP_X64_ENTRY_MODE_BATCH != compiled_function->member_entry_mode){
+
+        x64_code = get_tiered_x64_code(compiled_function, 1);
+
+        if (NULL == x64_code){
+
+            return tp_run_wasm_interpreter(compiled_function->member_interpreter_code, inputs, return_value);
+        }
+    }
+
+    switch (compiled_function->member_entry_mode){
+    case TP_X64_ENTRY_MODE_ARGS:
+        break;
+    case TP_X64_ENTRY_MODE_INPUTS_POINTER:{
+
+        TP_X64_JIT_FUNC_INPUTS func = (TP_X64_JIT_FUNC_INPUTS)x64_code;
+
+        *return_value = func(inputs);
+
+        return true;
+    }
+    case TP_X64_ENTRY_MODE_BATCH:{
+
+        // One row.
+        const int32_t** columns = NULL;
+
+        if (input_count){
+
+            columns = (const int32_t**)TP_CALLOC(NULL, input_count, sizeof(int32_t*));
+
+            if (NULL == columns){
+
+                TP_PRINT_CRT_ERROR(NULL);
+
+                return false;
+            }
+
+            for (uint32_t i = 0; input_count > i; ++i){
+
+                columns[i] = &(inputs[i]);
+            }
+        }
+
+        bool status = tp_call_compiled_function_batch(
+            compiled_function, columns, input_count, return_value, 1
+        );
+
+        TP_FREE(NULL, &columns, input_count * sizeof(int32_t*));
+
+        return status;
+    }
+    default:
+        fprintf_s(stderr, "ERROR: bad entry mode at %s function.\n", __func__);
+        return false;
+    }
+
+    if (TP_X64_CALL_ARGS_NUM_MAX < input_count){
+
+        fprintf_s(
+            stderr, "ERROR: TP_X64_CALL_ARGS_NUM_MAX(%d) < input_count(%d) at %s function.\n",
+            TP_X64_CALL_ARGS_NUM_MAX, input_count, __func__
+        );
+
+        return false;
+    }
+
+    // NOTE: The caller cleans up the stack, so passing unused arguments is harmless.
+    int32_t args[TP_X64_CALL_ARGS_NUM_MAX] = { 0 };
+
+    for (uint32_t i = 0; input_count > i; ++i){
+
+        args[i] = inputs[i];
+    }
+
+    TP_X64_JIT_FUNC_ARGS func = (TP_X64_JIT_FUNC_ARGS)x64_code;
+
+    *return_value = func(args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7]);
+
+    return true;
+}
+
+bool tp_call_compiled_function_batch(
+    TP_COMPILED_FUNCTION* compiled_function,
+    const int32_t* const* columns, uint32_t column_count, int32_t* outputs, uint64_t row_count)
+{
+    if ((NULL == compiled_function) ||
+        (TP_X64_ENTRY_MODE_BATCH != compiled_function->member_entry_mode) ||
+        (compiled_function->member_param_count != column_count) ||
+        (column_count && (NULL == columns)) || (row_count && (NULL == outputs))){
+
+        fprintf_s(stderr, "ERROR: bad parameter at %s function.\n", __func__);
+
+        return false;
+    }
+
+    for (uint32_t i = 0; column_count > i; ++i){
+
+        if (row_count && (NULL == columns[i])){
+
+            fprintf_s(stderr, "ERROR: NULL == columns[%d] at %s function.\n", i, __func__);
+
+            return false;
+        }
+    }
+
+    uint8_t* x64_code = get_tiered_x64_code(compiled_function, row_count);
+
+    if (NULL == x64_code){
+
+        return tp_run_wasm_interpreter_batch(compiled_function->member_interpreter_code, columns, outputs, row_count);
+    }
+
+    TP_X64_JIT_FUNC_BATCH func = (TP_X64_JIT_FUNC_BATCH)x64_code;
+
+    func(columns, outputs, row_count);
+
+    return true;
+}
+
+void tp_release_compiled_function(TP_COMPILED_FUNCTION** compiled_function)
+{
+    if ((NULL == compiled_function) || (NULL == *compiled_function)){
+
+        return;
+    }
+
+    if ((*compiled_function)->member_cache_entry){
+
+        tp_compile_cache_release((*compiled_function)->member_cache_entry);
+
+    }else if ( ! tp_code_arena_free(NULL, (*compiled_function)->member_x64_code)){
+
+        fprintf_s(stderr, "ERROR: tp_code_arena_free failed at %s function.\n", __func__);
+    }
+
+    tp_release_wasm_interpreter_code(&((*compiled_function)->member_interpreter_code));
+
+    TP_FREE(NULL, compiled_function, sizeof(TP_COMPILED_FUNCTION));
+}
+
+void tp_set_tier_up_threshold(uint32_t threshold)
+{
+    tier_up_threshold = threshold;
+}
+
+void tp_set_optimization_level(TP_OPTIMIZATION_LEVEL level)
+{
+    optimization_level = level;
+}
+
+bool tp_tier_up_compiled_function(TP_COMPILED_FUNCTION* compiled_function)
+{
+    if (NULL == compiled_function){
+
+        fprintf_s(stderr, "ERROR: bad parameter at %s function.\n", __func__);
+
+        return false;
+    }
+
+    for (;;){
+
+        if (atomic_load_x64_code(&(compiled_function->member_x64_code))){
+
+            return true;
+        }
+
+        if (NULL == compiled_function->member_interpreter_code){
+
+            fprintf_s(stderr, "ERROR: NULL == member_interpreter_code at %s function.\n", __func__);
+
+            return false;
+        }
+
+        if (atomic_compare_exchange(
+            &(compiled_function->member_tier_up_state), TP_TIER_UP_STATE_INTERPRETER, TP_TIER_UP_STATE_COMPILING)){
+
+            return tier_up_compiled_function(compiled_function);
+        }
+
+        if (TP_TIER_UP_STATE_FAILED == atomic_load(&(compiled_function->member_tier_up_state))){
+
+            return false;
+        }
+
+        // Compiling by another thread.
+#if defined(_WIN32)
+        (void)SwitchToThread();
+#else
+        (void)sched_yield();
+#endif
+    }
+}
+
+static bool make_interpreter_function(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t cache_key[TP_COMPILE_CACHE_KEY_SIZE],
+    TP_X64_ENTRY_MODE entry_mode, uint32_t threshold, TP_COMPILED_FUNCTION* compiled_function)
+{
+    if ( ! tp_get_wasm_instruction(symbol_table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    TP_WASM_INTERPRETER_CODE* interpreter_code = tp_make_wasm_interpreter_code(symbol_table);
+
+    if (NULL == interpreter_code){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    memcpy(interpreter_code->member_cache_key, cache_key, TP_COMPILE_CACHE_KEY_SIZE);
+
+    interpreter_code->member_optimization_level = symbol_table->member_optimization_level;
+
+    if ( ! tp_compile_cache_insert_interpreter(symbol_table, cache_key, &interpreter_code)){
+
+        // NOTE: interpreter_code is valid without the compile cache.
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+    }
+
+    set_interpreter_function(interpreter_code, entry_mode, threshold, compiled_function);
+
+    return true;
+}
+
+static void set_interpreter_function(
+    TP_WASM_INTERPRETER_CODE* interpreter_code,
+    TP_X64_ENTRY_MODE entry_mode, uint32_t threshold, TP_COMPILED_FUNCTION* compiled_function)
+{
+    // NOTE: compiled_function holds a reference of interpreter_code.
+    compiled_function->member_interpreter_code = interpreter_code;
+    compiled_function->member_tier_up_threshold = threshold;
+    compiled_function->member_tier_up_state = TP_TIER_UP_STATE_INTERPRETER;
+    compiled_function->member_param_count = interpreter_code->member_param_count;
+    compiled_function->member_entry_mode = entry_mode;
+}
+
+static uint8_t* get_tiered_x64_code(TP_COMPILED_FUNCTION* compiled_function, uint64_t call_count)
+{
+    uint8_t* x64_code = atomic_load_x64_code(&(compiled_function->member_x64_code));
+
+    if (x64_code || (NULL == compiled_function->member_interpreter_code)){
+
+        return x64_code;
+    }
+
+    if (TP_TIER_UP_STATE_INTERPRETER != atomic_load(&(compiled_function->member_tier_up_state))){
+
+        return NULL;
+    }
+
+    // NOTE: The calls of all the compiled functions of the cache key are counted.
+    if (compiled_function->member_tier_up_threshold >
+        atomic_add(&(compiled_function->member_interpreter_code->member_call_count), (int64_t)call_count)){
+
+        return NULL;
+    }
+
+    // NOTE: Does not wait for another thread: the interpreter runs until x64 code is ready.
+    if ( ! atomic_compare_exchange(
+        &(compiled_function->member_tier_up_state), TP_TIER_UP_STATE_INTERPRETER, TP_TIER_UP_STATE_COMPILING)){
+
+        return NULL;
+    }
+
+    if ( ! tier_up_compiled_function(compiled_function)){
+
+        return NULL;
+    }
+
+    return compiled_function->member_x64_code;
+}
+
+static bool tier_up_compiled_function(TP_COMPILED_FUNCTION* compiled_function)
+{
+    TP_WASM_INTERPRETER_CODE* interpreter_code = compiled_function->member_interpreter_code;
+
+    TP_COMPILED_FUNCTION function = { 0 };
+
+    TP_SYMBOL_TABLE* symbol_table = NULL;
+
+    if (tp_compile_cache_lookup(interpreter_code->member_cache_key, &function)){
+
+        goto publish;
+    }
+
+    if (tp_load_code_cache_file(interpreter_code->member_cache_key, compiled_function->member_entry_mode, &function)){
+
+        // NOTE: function is valid without the compile cache.
+        (void)tp_compile_cache_insert(NULL, interpreter_code->member_cache_key, &function);
+
+        goto publish;
+    }
+
+    symbol_table = (TP_SYMBOL_TABLE*)TP_CALLOC(NULL, 1, sizeof(TP_SYMBOL_TABLE));
+
+    if (NULL == symbol_table){
+
+        TP_PRINT_CRT_ERROR(NULL);
+
+        atomic_store(&(compiled_function->member_tier_up_state), TP_TIER_UP_STATE_FAILED);
+
+        return false;
+    }
+
+    *symbol_table = init_symbol_table_value;
+
+    symbol_table->member_disp_log_file = stderr;
+    symbol_table->member_is_no_output_files = true;
+    symbol_table->member_x64_entry_mode = compiled_function->member_entry_mode;
+    symbol_table->member_optimization_level = interpreter_code->member_optimization_level;
+    symbol_table->member_param_count = interpreter_code->member_param_count;
+
+    // NOTE: x64 code is made from the wasm instructions without parsing the source code
+    // and decoding the wasm module again.
+    uint32_t wasm_instruction_size = interpreter_code->member_wasm_instruction_num * sizeof(TP_WASM_INSTRUCTION);
+
+    symbol_table->member_wasm_instruction = (TP_WASM_INSTRUCTION*)TP_CALLOC(symbol_table,
+        interpreter_code->member_wasm_instruction_num, sizeof(TP_WASM_INSTRUCTION)
+    );
+
+    if (NULL == symbol_table->member_wasm_instruction){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        goto error_proc;
+    }
+
+    memcpy(symbol_table->member_wasm_instruction, interpreter_code->member_wasm_instruction, wasm_instruction_size);
+
+    symbol_table->member_wasm_instruction_num = interpreter_code->member_wasm_instruction_num;
+    symbol_table->member_wasm_instruction_size = wasm_instruction_size;
+
+    if ( ! tp_validate_wasm_instruction(
+        symbol_table, interpreter_code->member_param_count,
+        interpreter_code->member_local_num - interpreter_code->member_param_count)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    if ( ! tp_make_x64_function(symbol_table, &(function.member_x64_code), &(function.member_x64_code_size))){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    function.member_param_count = interpreter_code->member_param_count;
+    function.member_entry_mode = compiled_function->member_entry_mode;
+    function.member_x64_simd_isa = symbol_table->member_x64_simd_isa;
+
+    if ( ! tp_compile_cache_insert(symbol_table, interpreter_code->member_cache_key, &function)){
+
+        // NOTE: function is valid without the compile cache.
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+    }
+
+    if ( ! tp_save_code_cache_file(interpreter_code->member_cache_key, &function)){
+
+        // NOTE: function is valid without the on-disk code cache.
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+    }
+
+    free_memory_and_file(&symbol_table);
+
+publish:
+
+    compiled_function->member_cache_entry = function.member_cache_entry;
+    compiled_function->member_x64_code_size = function.member_x64_code_size;
+    compiled_function->member_x64_simd_isa = function.member_x64_simd_isa;
+    compiled_function->member_x64_jit_func = (TP_X64_JIT_FUNC)(function.member_x64_code);
+
+    // NOTE: The other members are visible before member_x64_code.
+    atomic_store_x64_code(&(compiled_function->member_x64_code), function.member_x64_code);
+
+    atomic_store(&(compiled_function->member_tier_up_state), TP_TIER_UP_STATE_X64);
+
+    return true;
+
+error_proc:
+
+    TP_PUT_LOG_MSG(
+        symbol_table, TP_LOG_TYPE_DISP_FORCE,
+        TP_MSG_FMT("%1"), TP_LOG_PARAM_STRING("ERROR: Tier up failed(the interpreter keeps running).")
+    );
+
+    free_memory_and_file(&symbol_table);
+
+    atomic_store(&(compiled_function->member_tier_up_state), TP_TIER_UP_STATE_FAILED);
+
+    return false;
+}
+
+static int64_t atomic_add(volatile int64_t* value, int64_t addend)
+{
+#if defined(_WIN32)
+    return InterlockedAdd64((volatile LONG64*)value, addend);
+#else
+    return __atomic_add_fetch(value, addend, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static bool atomic_compare_exchange(volatile int64_t* value, int64_t expected, int64_t desired)
+{
+#if defined(_WIN32)
+    return expected == InterlockedCompareExchange64((volatile LONG64*)value, desired, expected);
+#else
+    return __atomic_compare_exchange_n(value, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static int64_t atomic_load(volatile int64_t* value)
+{
+#if defined(_WIN32)
+    return InterlockedCompareExchange64((volatile LONG64*)value, 0, 0);
+#else
+    return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static void atomic_store(volatile int64_t* value, int64_t desired)
+{
+#if defined(_WIN32)
+    (void)InterlockedExchange64((volatile LONG64*)value, desired);
+#else
+    __atomic_store_n(value, desired, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static uint8_t* atomic_load_x64_code(uint8_t** x64_code)
+{
+#if defined(_WIN32)
+    // NOTE: Volatile loads have acquire semantics on x64.
+    return *(uint8_t* volatile*)x64_code;
+#else
+    return __atomic_load_n(x64_code, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static void atomic_store_x64_code(uint8_t** x64_code, uint8_t* value)
+{
+#if defined(_WIN32)
+    (void)InterlockedExchangePointer((PVOID volatile*)x64_code, value);
+#else
+    __atomic_store_n(x64_code, value, __ATOMIC_RELEASE);
+#endif
+}
+
+static bool test_compiler(
+    int argc, char** argv, uint8_t* msg_buffer, size_t msg_buffer_size,
+    char* drive, char* dir, time_t now)
+{
+    bool status = true;
+
+    bool is_test_mode = true;
+
+    size_t size = (sizeof(test_case_table) / sizeof(TEST_CASE_TABLE));
+
+    for (size_t i = 0; size > i; ++i){
+
+        uint8_t* source_code = test_case_table[i].member_source_code;
+
+        if (NULL == source_code){
+
+            break;
+        }
+
+        int32_t return_value = 0;
+
+        if ( ! compiler_main(
+            argc, argv, msg_buffer, msg_buffer_size,
+            &is_test_mode, i, &return_value, drive, dir, now)){
+
+            status = false;
+
+            fprintf_s(stderr, "ERROR: compile failed. test case No.%03zd.\n", i + 1);
+        }else{
+
+            int32_t correct_value = test_case_table[i].member_return_value;
+
+            if (return_value == correct_value){
+
+                fprintf_s(stderr, "SUCCESS: test case No.%03zd.\n", i + 1);
+
+                if ( ! test_compiled_function(source_code, correct_value)){
+
+                    status = false;
+
+                    fprintf_s(stderr, "ERROR: compiled function failed. test case No.%03zd.\n", i + 1);
+                }
+            }else{
+
+                fprintf_s(
+                    stderr, "ERROR: test case No.%03zd: "
+                    "return value=(%d), correct value=(%d),\n"
+                    "source code=(%s).\n",
+                    i + 1, return_value, correct_value, source_code
+                );
+            }
+        }
+    }
+
+    size = (sizeof(test_inputs_case_table) / sizeof(TEST_INPUTS_CASE_TABLE));
+
+    // NOTE: The inputs test cases are same values at all optimization levels.
+    for (int level = TP_OPTIMIZATION_LEVEL_0; TP_OPTIMIZATION_LEVEL_2 >= level; ++level){
+
+        tp_set_optimization_level((TP_OPTIMIZATION_LEVEL)level);
+
+        for (size_t i = 0; size > i; ++i){
+
+            if (NULL == test_inputs_case_table[i].member_source_code){
+
+                break;
+            }
+
+            if (test_compiled_function_with_inputs(&(test_inputs_case_table[i]), TP_X64_ENTRY_MODE_ARGS) &&
+                test_compiled_function_with_inputs(&(test_inputs_case_table[i]), TP_X64_ENTRY_MODE_INPUTS_POINTER) &&
+                test_compiled_function_with_inputs(&(test_inputs_case_table[i]), TP_X64_ENTRY_MODE_BATCH) &&
+                test_compiled_function_batch(&(test_inputs_case_table[i]))){
+
+                fprintf_s(stderr, "SUCCESS: inputs test case No.%03zd(-O%d).\n", i + 1, level);
+            }else{
+
+                status = false;
+
+                fprintf_s(
+                    stderr, "ERROR: inputs test case No.%03zd(-O%d): source code=(%s).\n",
+                    i + 1, level, test_inputs_case_table[i].member_source_code
+                );
+            }
+        }
+    }
+
+    tp_set_optimization_level(TP_OPTIMIZATION_LEVEL_DEFAULT);
+
+    if (test_compile_cache()){
+
+        fprintf_s(stderr, "SUCCESS: compile cache test.\n");
+    }else{
+
+        status = false;
+
+        fprintf_s(stderr, "ERROR: compile cache test.\n");
+    }
+
+    if (test_code_cache_file()){
+
+        fprintf_s(stderr, "SUCCESS: code cache file test.\n");
+    }else{
+
+        status = false;
+
+        fprintf_s(stderr, "ERROR: code cache file test.\n");
+    }
+
+    if (test_code_arena()){
+
+        fprintf_s(stderr, "SUCCESS: code arena test.\n");
+    }else{
+
+        status = false;
+
+        fprintf_s(stderr, "ERROR: code arena test.\n");
+    }
+
+    if (test_elf_file()){
+
+        fprintf_s(stderr, "SUCCESS: ELF file test.\n");
+    }else{
+
+        status = false;
+
+        fprintf_s(stderr, "ERROR: ELF file test.\n");
+    }
+
+    if (test_tiered_function()){
+
+        fprintf_s(stderr, "SUCCESS: tiered function test.\n");
+    }else{
+
+        status = false;
+
+        fprintf_s(stderr, "ERROR: tiered function test.\n");
+    }
+
+    if (test_optimized_x64_code()){
+
+        fprintf_s(stderr, "SUCCESS: optimized x64 code test.\n");
+    }else{
+
+        status = false;
+
+        fprintf_s(stderr, "ERROR: optimized x64 code test.\n");
+    }
+
+    if (test_args_param_count_max()){
+
+        fprintf_s(stderr, "SUCCESS: args param count max test.\n");
+    }else{
+
+        status = false;
+
+        fprintf_s(stderr, "ERROR: args param count max test.\n");
+    }
+
+    if (test_batch_division_trap()){
+
+        fprintf_s(stderr, "SUCCESS: batch division trap test.\n");
+    }else{
+
+        status = false;
+
+        fprintf_s(stderr, "ERROR: batch division trap test.\n");
+    }
+
+    if (test_measure_compile_phase()){
+
+        fprintf_s(stderr, "SUCCESS: measure compile phase test.\n");
+    }else{
+
+        status = false;
+
+        fprintf_s(stderr, "ERROR: measure compile phase test.\n");
+    }
+
+    (void)move_test_log_files(drive, dir, is_test_mode, now);
+
+    return status;
+}
+
+static bool test_compiled_function(uint8_t* source_code, int32_t correct_value)
+{
+    TP_COMPILED_FUNCTION* compiled_function = NULL;
+
+    if ( ! tp_compile_function(source_code, strlen(source_code), TP_X64_ENTRY_MODE_ARGS, &compiled_function)){
+
+        return false;
+    }
+
+    bool status = true;
+
+    // Compile once, call many times.
+    for (size_t i = 0; 2 > i; ++i){
+
+        int32_t return_value = 0;
+
+        if (( ! tp_call_compiled_function(compiled_function, &return_value)) || (correct_value != return_value)){
+
+            status = false;
+        }
+    }
+
+    // Same source code: the interpreter code and x64 code are shared by the compile cache.
+    TP_COMPILED_FUNCTION* cached_function = NULL;
+
+    if ( ! tp_compile_function(source_code, strlen(source_code), TP_X64_ENTRY_MODE_ARGS, &cached_function)){
+
+        status = false;
+    }else{
+
+        int32_t return_value = 0;
+
+        if ((cached_function->member_interpreter_code != compiled_function->member_interpreter_code) ||
+            ( ! tp_tier_up_compiled_function(compiled_function)) ||
+            ( ! tp_tier_up_compiled_function(cached_function)) ||
+            (cached_function->member_x64_code != compiled_function->member_x64_code) ||
+            ( ! tp_call_compiled_function(cached_function, &return_value)) || (correct_value != return_value)){
+
+            status = false;
+        }
+
+        tp_release_compiled_function(&cached_function);
+    }
+
+    tp_release_compiled_function(&compiled_function);
+
+    return status;
+}
+
+static bool test_compile_cache(void)
+{
+    uint8_t source_code[] = "int32_t value1 = 3;\r\nint32_t value2 = value1 * 5;\r\n";
+    uint8_t normalized_source_code[] = "\xEF\xBB\xBFint32_t value1 = 3;\nint32_t value2 = value1 * 5;\n";
+
+    TP_COMPILED_FUNCTION* compiled_function[3] = { NULL };
+
+    bool status = false;
+
+    if ( ! tp_compile_function(source_code, strlen(source_code), TP_X64_ENTRY_MODE_ARGS, &(compiled_function[0]))){
+
+        goto error_proc;
+    }
+
+    // Byte Order Mark and CR LF: hit.
+    if ( ! tp_compile_function(
+        normalized_source_code, strlen(normalized_source_code), TP_X64_ENTRY_MODE_ARGS, &(compiled_function[1]))){
+
+        goto error_proc;
+    }
+
+    if ((compiled_function[0]->member_interpreter_code != compiled_function[1]->member_interpreter_code) ||
+        ( ! tp_tier_up_compiled_function(compiled_function[0])) ||
+        ( ! tp_tier_up_compiled_function(compiled_function[1])) ||
+        (compiled_function[0]->member_x64_code != compiled_function[1]->member_x64_code)){
+
+        goto error_proc;
+    }
+
+    // Other entry mode: miss.
+    if ( ! tp_compile_function(
+        source_code, strlen(source_code), TP_X64_ENTRY_MODE_INPUTS_POINTER, &(compiled_function[2]))){
+
+        goto error_proc;
+    }
+
+    if ((compiled_function[0]->member_interpreter_code == compiled_function[2]->member_interpreter_code) ||
+        ( ! tp_tier_up_compiled_function(compiled_function[2])) ||
+        (compiled_function[0]->member_x64_code == compiled_function[2]->member_x64_code)){
+
+        goto error_proc;
+    }
+
+    tp_release_compiled_function(&(compiled_function[2]));
+
+    // Evicted entries stay valid until released.
+    tp_set_compile_cache_budget(0);
+
+    int32_t return_value = 0;
+
+    if (( ! tp_call_compiled_function(compiled_function[1], &return_value)) || (15 != return_value)){
+
+        goto error_proc;
+    }
+
+    if ( ! tp_compile_function(source_code, strlen(source_code), TP_X64_ENTRY_MODE_ARGS, &(compiled_function[2]))){
+
+        goto error_proc;
+    }
+
+    if ((compiled_function[0]->member_interpreter_code == compiled_function[2]->member_interpreter_code) ||
+        ( ! tp_tier_up_compiled_function(compiled_function[2])) ||
+        (compiled_function[0]->member_x64_code == compiled_function[2]->member_x64_code) ||
+        compiled_function[2]->member_cache_entry ||
+        ( ! tp_call_compiled_function(compiled_function[2], &return_value)) || (15 != return_value)){
+
+        goto error_proc;
+    }
+
+    status = true;
+
+error_proc:
+
+    tp_set_compile_cache_budget(TP_COMPILE_CACHE_BUDGET_DEFAULT);
+
+    for (size_t i = 0; 3 > i; ++i){
+
+        tp_release_compiled_function(&(compiled_function[i]));
+    }
+
+    return status;
+}
+
+static bool test_code_cache_file(void)
+{
+    uint8_t source_code[] = "int32_t value1 = 7;\nint32_t value2 = value1 * value1 - 6;\n";
+
+    uint8_t key[TP_COMPILE_CACHE_KEY_SIZE] = { 0 };
+
+    tp_make_compile_cache_key(source_code, strlen(source_code), TP_X64_ENTRY_MODE_ARGS, optimization_level, key);
+
+    char path[_MAX_PATH] = ".";
+    size_t path_length = strlen(path);
+
+    path[path_length++] = '/';
+
+    for (uint32_t i = 0; TP_COMPILE_CACHE_KEY_SIZE > i; ++i){
+
+        path_length += sprintf_s(&(path[path_length]), sizeof(path) - path_length, "%02x", key[i]);
+    }
+
+    sprintf_s(&(path[path_length]), sizeof(path) - path_length, ".%s", TP_CODE_CACHE_FILE_EXT_NAME);
+
+    TP_COMPILED_FUNCTION* compiled_function[2] = { NULL };
+
+    FILE* file = NULL;
+
+    bool status = false;
+
+    // Without the compile cache, every compile reads or writes the file.
+    tp_set_compile_cache_budget(0);
+
+    if ( ! tp_set_code_cache_directory(".")){
+
+        goto error_proc;
+    }
+
+    // The file is written at tier up.
+    if (( ! tp_compile_function(source_code, strlen(source_code), TP_X64_ENTRY_MODE_ARGS, &(compiled_function[0]))) ||
+        ( ! tp_tier_up_compiled_function(compiled_function[0]))){
+
+        goto error_proc;
+    }
+
+    compiled_function[1] = (TP_COMPILED_FUNCTION*)TP_CALLOC(NULL, 1, sizeof(TP_COMPILED_FUNCTION));
+
+    if (NULL == compiled_function[1]){
+
+        goto error_proc;
+    }
+
+    int32_t return_value = 0;
+
+    if (( ! tp_load_code_cache_file(key, TP_X64_ENTRY_MODE_ARGS, compiled_function[1])) ||
+        (compiled_function[0]->member_x64_code_size != compiled_function[1]->member_x64_code_size) ||
+        memcmp(compiled_function[0]->member_x64_code, compiled_function[1]->member_x64_code,
+            compiled_function[0]->member_x64_code_size) ||
+        ( ! tp_call_compiled_function(compiled_function[1], &return_value)) || (43 != return_value)){
+
+        goto error_proc;
+    }
+
+    tp_release_compiled_function(&(compiled_function[1]));
+
+    compiled_function[1] = (TP_COMPILED_FUNCTION*)TP_CALLOC(NULL, 1, sizeof(TP_COMPILED_FUNCTION));
+
+    if (NULL == compiled_function[1]){
+
+        goto error_proc;
+    }
+
+    // Other entry mode: miss.
+    if (tp_load_code_cache_file(key, TP_X64_ENTRY_MODE_INPUTS_POINTER, compiled_function[1])){
+
+        goto error_proc;
+    }
+
+    // Other codegen version: miss.
+    uint32_t codegen_version = TP_X64_CODEGEN_VERSION + 1;
+
+    errno_t err = fopen_s(&file, path, "r+b");
+
+    if ((NULL == file) || fseek(file, offsetof(TP_CODE_CACHE_FILE_HEADER, member_codegen_version), SEEK_SET) ||
+        (1 != fwrite(&codegen_version, sizeof(codegen_version), 1, file)) || ( ! tp_close_file(NULL, &file))){
+
+        goto error_proc;
+    }
+
+    if (tp_load_code_cache_file(key, TP_X64_ENTRY_MODE_ARGS, compiled_function[1])){
+
+        goto error_proc;
+    }
+
+    // NOTE: Restores the codegen version, so that only the x64 code is broken below.
+    codegen_version = TP_X64_CODEGEN_VERSION;
+
+    err = fopen_s(&file, path, "r+b");
+
+    if ((NULL == file) || fseek(file, offsetof(TP_CODE_CACHE_FILE_HEADER, member_codegen_version), SEEK_SET) ||
+        (1 != fwrite(&codegen_version, sizeof(codegen_version), 1, file)) || ( ! tp_close_file(NULL, &file))){
+
+        goto error_proc;
+    }
+
+    // Broken x64 code: miss.
+    err = fopen_s(&file, path, "r+b");
+
+    if ((NULL == file) || fseek(file, -1, SEEK_END) || (EOF == fputc(0xCC, file)) ||
+        ( ! tp_close_file(NULL, &file))){
+
+        goto error_proc;
+    }
+
+    if (tp_load_code_cache_file(key, TP_X64_ENTRY_MODE_ARGS, compiled_function[1])){
+
+        goto error_proc;
+    }
+
+    status = true;
+
+error_proc:
+
+    (void)tp_close_file(NULL, &file);
+
+    (void)remove(path);
+
+    (void)tp_set_code_cache_directory(NULL);
+
+    tp_set_compile_cache_budget(TP_COMPILE_CACHE_BUDGET_DEFAULT);
+
+    for (size_t i = 0; 2 > i; ++i){
+
+        if (compiled_function[i] && (NULL == compiled_function[i]->member_x64_code)){
+
+            TP_FREE(NULL, &(compiled_function[i]), sizeof(TP_COMPILED_FUNCTION));
+        }
+
+        tp_release_compiled_function(&(compiled_function[i]));
+    }
+
+    return status;
+}
+
+static bool test_code_arena(void)
+{
+    // NOTE: More functions than the pages of TP_CODE_ARENA_REGION_NUM_MAX regions, so that
+    // the functions must be packed. The second round reuses the slots of the first round.
+    uint32_t function_num = (TP_CODE_ARENA_REGION_SIZE / 4096) * TP_CODE_ARENA_REGION_NUM_MAX + 4464;
+
+    rsize_t x64_code_size = sizeof(uint8_t*) * function_num;
+
+    uint8_t** x64_code = (uint8_t**)TP_CALLOC(NULL, function_num, sizeof(uint8_t*));
+
+    if (NULL == x64_code){
+
+        TP_PRINT_CRT_ERROR(NULL);
+
+        return false;
+    }
+
+    bool status = false;
+
+    for (uint32_t round = 0; 2 > round; ++round){
+
+        for (uint32_t i = 0; function_num > i; ++i){
+
+            uint8_t* writable_x64_code = NULL;
+
+            // mov eax, i
+            // ret
+            uint8_t code[] = {
+                0xB8, (uint8_t)i, (uint8_t)(i >> 8), (uint8_t)(i >> 16), (uint8_t)(i >> 24), 0xC3
+            };
+
+            if ( ! tp_code_arena_allocate(NULL, sizeof(code), &(x64_code[i]), &writable_x64_code)){
+
+                goto cleanup;
+            }
+
+            memcpy(writable_x64_code, code, sizeof(code));
+
+            if ( ! tp_code_arena_publish(NULL, x64_code[i], sizeof(code))){
+
+                goto cleanup;
+            }
+        }
+
+        for (uint32_t i = 0; function_num > i; i += 997){
+
+            TP_X64_JIT_FUNC func = (TP_X64_JIT_FUNC)(x64_code[i]);
+
+            if ((int32_t)i != func()){
+
+                goto cleanup;
+            }
+        }
+
+        for (uint32_t i = 0; function_num > i; ++i){
+
+            if ( ! tp_code_arena_free(NULL, x64_code[i])){
+
+                goto cleanup;
+            }
+
+            x64_code[i] = NULL;
+        }
+    }
+
+    status = true;
+
+cleanup:
+
+    for (uint32_t i = 0; function_num > i; ++i){
+
+        (void)tp_code_arena_free(NULL, x64_code[i]);
+    }
+
+    TP_FREE(NULL, &x64_code, x64_code_size);
+
+    return status;
+}
+
+static bool test_elf_file(void)
+{
+    uint8_t source_code[] = "int32_t value1 = a * 7;\nint32_t value2 = value1 - b;\n";
+
+    char* path[] = { "./" TP_ELF_DEFAULT_FILE_NAME "_test." TP_ELF_OBJECT_DEFAULT_EXT_NAME,
+        "./" TP_ELF_DEFAULT_FILE_NAME "_test." TP_ELF_SHARED_OBJECT_DEFAULT_EXT_NAME };
+
+    // e_ident[EI_MAG0..EI_VERSION], e_type(ET_REL, ET_DYN), e_machine(EM_X86_64)
+    uint8_t elf_header[][20] = {
+        { 0x7f, 'E', 'L', 'F', 2, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 62, 0 },
+        { 0x7f, 'E', 'L', 'F', 2, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 0, 62, 0 }
+    };
+
+    TP_COMPILED_FUNCTION* compiled_function = NULL;
+
+    FILE* file = NULL;
+
+    bool status = false;
+
+    if ( ! tp_compile_function(source_code, strlen(source_code), TP_X64_ENTRY_MODE_ARGS, &compiled_function)){
+
+        goto error_proc;
+    }
+
+    for (size_t i = 0; 2 > i; ++i){
+
+        if ( ! tp_write_elf_file(compiled_function, path[i], NULL, (1 == i))){
+
+            goto error_proc;
+        }
+
+        uint8_t content[sizeof(elf_header[0])] = { 0 };
+
+        errno_t err = fopen_s(&file, path[i], "rb");
+
+        if ((NULL == file) || (sizeof(content) != fread(content, sizeof(uint8_t), sizeof(content), file)) ||
+            ( ! tp_close_file(NULL, &file)) || memcmp(content, elf_header[i], sizeof(content))){
+
+            goto error_proc;
+        }
+    }
+
+    // Bad symbol name.
+    if (tp_write_elf_file(compiled_function, path[0], "0calc", false)){
+
+        goto error_proc;
+    }
+
+    status = true;
+
+error_proc:
+
+    (void)tp_close_file(NULL, &file);
+
+    for (size_t i = 0; 2 > i; ++i){
+
+        (void)remove(path[i]);
+    }
+
+    tp_release_compiled_function(&compiled_function);
+
+    return status;
+}
+
+static bool test_measure_compile_phase(void)
+{
+    uint8_t source_code[] = "int32_t value1 = (a + 2) * b;\nvalue1 = value1 - 3;\n";
+
+    // int32_t value1 = ( a + 2 ) * b ; value1 = value1 - 3 ; and the end of the tokens.
+    uint64_t token_num = 18;
+
+    TP_OPTIMIZATION_LEVEL level[] = { TP_OPTIMIZATION_LEVEL_0, TP_OPTIMIZATION_LEVEL_1, TP_OPTIMIZATION_LEVEL_2 };
+
+    for (size_t i = 0; (sizeof(level) / sizeof(level[0])) > i; ++i){
+
+        TP_COMPILE_PHASE_RECORD phase_record[TP_COMPILE_PHASE_NUM] = { 0 };
+
+        if ( ! tp_measure_compile_phase(source_code, strlen(source_code), level[i], phase_record)){
+
+            return false;
+        }
+
+        if (token_num != phase_record[TP_COMPILE_PHASE_TOKEN].member_unit_num){
+
+            return false;
+        }
+
+        for (size_t j = 0; TP_COMPILE_PHASE_NUM > j; ++j){
+
+            if (( ! phase_record[j].member_is_recorded) || (0 == phase_record[j].member_unit_num)){
+
+                return false;
+            }
+
+            if (phase_record[j].member_allocation_num && (0 >= phase_record[j].member_peak_bytes)){
+
+                return false;
+            }
+        }
+
+        // The token buffer is allocated at the token phase.
+        if (0 == phase_record[TP_COMPILE_PHASE_TOKEN].member_allocation_num){
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool test_tiered_function(void)
+{
+    uint8_t source_code[] = "int32_t value1 = (a - b) * 3;\nint32_t value2 = value1 / c + 11;\n";
+
+    int32_t inputs[] = { 10, 4, 5 };
+    int32_t correct_value = 14;
+
+    int32_t column_a[] = { 10, 10 };
+    int32_t column_b[] = { 4, 4 };
+    int32_t column_c[] = { 5, 0 };
+    const int32_t* columns[] = { column_a, column_b, column_c };
+    int32_t outputs[2] = { 0 };
+
+    uint32_t threshold = 3;
+
+    TP_COMPILED_FUNCTION* compiled_function = NULL;
+    TP_COMPILED_FUNCTION* cached_function = NULL;
+
+    bool status = false;
+
+    tp_set_tier_up_threshold(threshold);
+
+    // The x64 code of tier up is made at the optimization level of the interpreter code.
+    tp_set_optimization_level(TP_OPTIMIZATION_LEVEL_1);
+
+    if ( ! tp_compile_function(source_code, strlen(source_code), TP_X64_ENTRY_MODE_INPUTS_POINTER, &compiled_function)){
+
+        goto error_proc;
+    }
+
+    tp_set_optimization_level(TP_OPTIMIZATION_LEVEL_DEFAULT);
+
+    if ((NULL == compiled_function->member_interpreter_code) ||
+        (TP_OPTIMIZATION_LEVEL_1 != compiled_function->member_interpreter_code->member_optimization_level)){
+
+        goto error_proc;
+    }
+
+    // Same source code: the interpreter code is shared by the compile cache.
+    tp_set_optimization_level(TP_OPTIMIZATION_LEVEL_1);
+
+    if ( ! tp_compile_function(source_code, strlen(source_code), TP_X64_ENTRY_MODE_INPUTS_POINTER, &cached_function)){
+
+        goto error_proc;
+    }
+
+    tp_set_optimization_level(TP_OPTIMIZATION_LEVEL_DEFAULT);
+
+    if ((cached_function->member_interpreter_code != compiled_function->member_interpreter_code) ||
+        cached_function->member_x64_code){
+
+        goto error_proc;
+    }
+
+    // The interpreter until the threshold, x64 code after that.
+    for (uint32_t i = 0; threshold + 1 > i; ++i){
+
+        int32_t return_value = 0;
+
+        if (( ! tp_call_compiled_function_with_inputs(compiled_function, inputs, 3, &return_value)) ||
+            (correct_value != return_value)){
+
+            goto error_proc;
+        }
+
+        if ((threshold <= i + 1) != (NULL != compiled_function->member_x64_code)){
+
+            goto error_proc;
+        }
+    }
+
+    // The calls of compiled_function are counted for cached_function too.
+    int32_t cached_return_value = 0;
+
+    if (( ! tp_call_compiled_function_with_inputs(cached_function, inputs, 3, &cached_return_value)) ||
+        (correct_value != cached_return_value) || (NULL == cached_function->member_x64_code)){
+
+        goto error_proc;
+    }
+
+    tp_release_compiled_function(&cached_function);
+    tp_release_compiled_function(&compiled_function);
+
+    if ( ! tp_compile_function(source_code, strlen(source_code), TP_X64_ENTRY_MODE_BATCH, &compiled_function)){
+
+        goto error_proc;
+    }
+
+    // Integer divide error of the interpreter(2 rows of 3 calls).
+    if (tp_call_compiled_function_batch(compiled_function, columns, 3, outputs, 2) ||
+        compiled_function->member_x64_code){
+
+        goto error_proc;
+    }
+
+    column_c[1] = 2;
+
+    if (( ! tp_call_compiled_function_batch(compiled_function, columns, 3, outputs, 2)) ||
+        (NULL == compiled_function->member_x64_code) || (correct_value != outputs[0]) || (20 != outputs[1])){
+
+        goto error_proc;
+    }
+
+    status = true;
+
+error_proc:
+
+    tp_release_compiled_function(&cached_function);
+    tp_release_compiled_function(&compiled_function);
+
+    tp_set_tier_up_threshold(TP_TIER_UP_THRESHOLD_DEFAULT);
+
+    tp_set_optimization_level(TP_OPTIMIZATION_LEVEL_DEFAULT);
+
+    return status;
+}
+
+static bool test_optimized_x64_code(void)
+{
+    // NOTE: A fully constant program is mov eax, imm32; ret.
+    uint8_t constant_source_code[] = "int32_t value1 = (1 + 2) * 3;\nint32_t value2 = value1 * 5 - 4;\n";
+    uint8_t constant_x64_code[] = { 0xB8, 0x29, 0x00, 0x00, 0x00, 0xC3 }; // 41
+
+    // NOTE: A leaf kernel in registers has no stack frame.
+    uint8_t leaf_source_code[] = "int32_t value1 = a * b + c;\n";
+    int32_t inputs[] = { 3, 4, 5 };
+
+    TP_OPTIMIZATION_LEVEL level_table[] = { TP_OPTIMIZATION_LEVEL_1, TP_OPTIMIZATION_LEVEL_2 };
+
+    TP_COMPILED_FUNCTION* compiled_function = NULL;
+
+    bool status = false;
+
+    tp_set_tier_up_threshold(0);
+
+    for (size_t i = 0; (sizeof(level_table) / sizeof(level_table[0])) > i; ++i){
+
+        tp_set_optimization_level(level_table[i]);
+
+        if ( ! tp_compile_function(
+            constant_source_code, strlen(constant_source_code), TP_X64_ENTRY_MODE_ARGS, &compiled_function)){
+
+            goto error_proc;
+        }
+
+        if ((sizeof(constant_x64_code) != compiled_function->member_x64_code_size) ||
+            memcmp(compiled_function->member_x64_code, constant_x64_code, sizeof(constant_x64_code))){
+
+            fprintf_s(stderr, "ERROR: constant x64 code, optimization level=(%d).\n", level_table[i]);
+
+            goto error_proc;
+        }
+
+        tp_release_compiled_function(&compiled_function);
+
+        if ( ! tp_compile_function(
+            leaf_source_code, strlen(leaf_source_code), TP_X64_ENTRY_MODE_INPUTS_POINTER, &compiled_function)){
+
+            goto error_proc;
+        }
+
+        int32_t return_value = 0;
+
+        if (is_x64_frame_code(compiled_function->member_x64_code, compiled_function->member_x64_code_size) ||
+            ( ! tp_call_compiled_function_with_inputs(compiled_function, inputs, 3, &return_value)) ||
+            (17 != return_value)){
+
+            fprintf_s(stderr, "ERROR: leaf x64 code, optimization level=(%d).\n", level_table[i]);
+
+            goto error_proc;
+        }
+
+        tp_release_compiled_function(&compiled_function);
+    }
+
+    status = true;
+
+error_proc:
+
+    tp_release_compiled_function(&compiled_function);
+
+    tp_set_tier_up_threshold(TP_TIER_UP_THRESHOLD_DEFAULT);
+
+    tp_set_optimization_level(TP_OPTIMIZATION_LEVEL_DEFAULT);
+
+    return status;
+}
+
+static bool is_x64_frame_code(uint8_t* x64_code, uint32_t x64_code_size)
+{
+    // push rbp
+    if (x64_code_size && (0x55 == x64_code[0])){
+
+        return true;
+    }
+
+    // sub rsp, imm8 / sub rsp, imm32
+    for (uint32_t i = 0; x64_code_size > i + 2; ++i){
+
+        if ((0x48 == x64_code[i]) && ((0x83 == x64_code[i + 1]) || (0x81 == x64_code[i + 1])) &&
+            (0xEC == x64_code[i + 2])){
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool test_compiled_function_with_inputs(TEST_INPUTS_CASE_TABLE* test_case, TP_X64_ENTRY_MODE entry_mode)
+{
+    TP_COMPILED_FUNCTION* compiled_function = NULL;
+
+    uint8_t* source_code = test_case->member_source_code;
+
+    if ( ! tp_compile_function(source_code, strlen(source_code), entry_mode, &compiled_function)){
+
+        return false;
+    }
+
+    int32_t return_value = 0;
+
+    bool status = tp_call_compiled_function_with_inputs(
+        compiled_function, test_case->member_inputs, test_case->member_input_count, &return_value
+    );
+
+    // Only the functions of TP_X64_ENTRY_MODE_ARGS without input parameters are called without inputs.
+    bool is_call_without_inputs = ((TP_X64_ENTRY_MODE_ARGS == entry_mode) && (0 == test_case->member_input_count));
+
+    int32_t return_value_without_inputs = 0;
+
+    // NOTE: The rejected calls are checked with the first test case only.
+    bool is_check = ((0 == test_case->member_input_count) || (test_inputs_case_table == test_case));
+
+    if (status && is_check && (is_call_without_inputs !=
+        tp_call_compiled_function(compiled_function, &return_value_without_inputs))){
+
+        fprintf_s(stderr, "ERROR: tp_call_compiled_function with entry_mode=(%d).\n", entry_mode);
+
+        status = false;
+    }
+
+    if (status && is_call_without_inputs && (test_case->member_return_value != return_value_without_inputs)){
+
+        status = false;
+    }
+
+    if (status && (test_case->member_return_value != return_value)){
+
+        fprintf_s(
+            stderr, "ERROR: return value=(%d), correct value=(%d), entry_mode=(%d).\n",
+            return_value, test_case->member_return_value, entry_mode
+        );
+
+        status = false;
+    }
+
+    // The interpreter above and x64 code after tier up.
+    int32_t x64_return_value = 0;
+
+    if (status && (( ! tp_tier_up_compiled_function(compiled_function)) ||
+        ( ! tp_call_compiled_function_with_inputs(
+            compiled_function, test_case->member_inputs, test_case->member_input_count, &x64_return_value)) ||
+        (return_value != x64_return_value))){
+
+        fprintf_s(
+            stderr, "ERROR: x64 return value=(%d), correct value=(%d), entry_mode=(%d).\n",
+            x64_return_value, return_value, entry_mode
+        );
+
+        status = false;
+    }
+
+    tp_release_compiled_function(&compiled_function);
+
+    return status;
+}
+
+static bool test_compiled_function_batch(TEST_INPUTS_CASE_TABLE* test_case)
+{
+    bool status = false;
+
+    TP_COMPILED_FUNCTION* batch_function = NULL;
+    TP_COMPILED_FUNCTION* row_function = NULL;
+
+    uint8_t* source_code = test_case->member_source_code;
+    uint32_t column_count = test_case->member_input_count;
+
+    int32_t columns_buffer[TP_X64_CALL_ARGS_NUM_MAX][TP_TEST_BATCH_ROW_NUM] = { 0 };
+    const int32_t* columns[TP_X64_CALL_ARGS_NUM_MAX] = { 0 };
+    int32_t outputs[TP_TEST_BATCH_ROW_NUM + 1] = { 0 };
+
+    // Row r: inputs + r.
+    for (uint32_t i = 0; column_count > i; ++i){
+
+        for (int32_t j = 0; TP_TEST_BATCH_ROW_NUM > j; ++j){
+
+            columns_buffer[i][j] = test_case->member_inputs[i] + j;
+        }
+
+        columns[i] = columns_buffer[i];
+    }
+
+    if ( ! tp_compile_function(source_code, strlen(source_code), TP_X64_ENTRY_MODE_ARGS, &row_function)){
+
+        goto error_proc;
+    }
+
+    // Vector loop of each ISA(if the CPU supports it) and the scalar loop only.
+    TP_X64_SIMD_ISA simd_isa_table[] = {
+        TP_X64_SIMD_ISA_AVX512, TP_X64_SIMD_ISA_AVX2, TP_X64_SIMD_ISA_NONE
+    };
+
+    for (rsize_t k = 0; (sizeof(simd_isa_table) / sizeof(simd_isa_table[0])) > k; ++k){
+
+        tp_set_x64_simd_isa_max(simd_isa_table[k]);
+
+        memset(outputs, 0, sizeof(outputs));
+
+        outputs[TP_TEST_BATCH_ROW_NUM] = INT32_MIN;
+
+        if (( ! tp_compile_function(source_code, strlen(source_code), TP_X64_ENTRY_MODE_BATCH, &batch_function)) ||
+            ( ! tp_tier_up_compiled_function(batch_function))){
+
+            goto error_proc;
+        }
+
+        if ( ! tp_call_compiled_function_batch(batch_function, columns, column_count, outputs, 0)){
+
+            goto error_proc;
+        }
+
+        if (0 != outputs[0]){
+
+            fprintf_s(stderr, "ERROR: row_count(0) wrote outputs[0]=(%d).\n", outputs[0]);
+
+            goto error_proc;
+        }
+
+        if ( ! tp_call_compiled_function_batch(batch_function, columns, column_count, outputs, TP_TEST_BATCH_ROW_NUM)){
+
+            goto error_proc;
+        }
+
+        if (INT32_MIN != outputs[TP_TEST_BATCH_ROW_NUM]){
+
+            fprintf_s(stderr, "ERROR: outputs[row_count] was overwritten.\n");
+
+            goto error_proc;
+        }
+
+        for (int32_t j = 0; TP_TEST_BATCH_ROW_NUM > j; ++j){
+
+            int32_t inputs[TP_X64_CALL_ARGS_NUM_MAX] = { 0 };
+
+            for (uint32_t i = 0; column_count > i; ++i){
+
+                inputs[i] = columns_buffer[i][j];
+            }
+
+            int32_t return_value = 0;
+
+            if ( ! tp_call_compiled_function_with_inputs(row_function, inputs, column_count, &return_value)){
+
+                goto error_proc;
+            }
+
+            if (return_value != outputs[j]){
+
+                fprintf_s(
+                    stderr, "ERROR: row(%d): batch output=(%d), correct value=(%d), SIMD ISA=(%d).\n",
+                    j, outputs[j], return_value, batch_function->member_x64_simd_isa
+                );
+
+                goto error_proc;
+            }
+        }
+
+        tp_release_compiled_function(&batch_function);
+    }
+
+    status = true;
+
+error_proc:
+
+    tp_set_x64_simd_isa_max(TP_X64_SIMD_ISA_AVX512);
+
+    tp_release_compiled_function(&batch_function);
+    tp_release_compiled_function(&row_function);
+
+    return status;
+}
+
+static bool test_args_param_count_max(void)
+{
+    TP_COMPILED_FUNCTION* compiled_function = NULL;
+
+    // TP_X64_CALL_ARGS_NUM_MAX + 1 input parameters.
+    uint8_t* source_code = "int32_t value1 = a + b + c + d + e + f + g + h + i;\n";
+
+    int32_t inputs[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    uint32_t input_count = (sizeof(inputs) / sizeof(inputs[0]));
+
+    if (TP_X64_CALL_ARGS_NUM_MAX >= input_count){
+
+        fprintf_s(stderr, "ERROR: input_count(%d) of the test at %s function.\n", input_count, __func__);
+
+        return false;
+    }
+
+    // Rejected at compile time, not after tier-up.
+    if (tp_compile_function(source_code, strlen(source_code), TP_X64_ENTRY_MODE_ARGS, &compiled_function)){
+
+        fprintf_s(stderr, "ERROR: TP_X64_ENTRY_MODE_ARGS with %d input parameters was compiled.\n", input_count);
+
+        tp_release_compiled_function(&compiled_function);
+
+        return false;
+    }
+
+    if ( ! tp_compile_function(
+        source_code, strlen(source_code), TP_X64_ENTRY_MODE_INPUTS_POINTER, &compiled_function)){
+
+        return false;
+    }
+
+    int32_t return_value = 0;
+
+    bool status = tp_call_compiled_function_with_inputs(compiled_function, inputs, input_count, &return_value);
+
+    if (status && (45 != return_value)){
+
+        fprintf_s(stderr, "ERROR: return value=(%d), correct value=(45).\n", return_value);
+
+        status = false;
+    }
+
+    tp_release_compiled_function(&compiled_function);
+
+    return status;
+}
+
+#if defined(_WIN32)
+static CONTEXT division_trap_context;
+static volatile bool is_division_trap_raised = false;
+
+static LONG CALLBACK division_trap_handler(PEXCEPTION_POINTERS exception_pointers)
+{
+    DWORD exception_code = exception_pointers->ExceptionRecord->ExceptionCode;
+
+    if ((EXCEPTION_INT_DIVIDE_BY_ZERO != exception_code) && (EXCEPTION_INT_OVERFLOW != exception_code)){
+
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+
+    // NOTE: The x64 code has no unwind information, so that __try/__except can not catch the exception.
+    // Resume at the context captured before the call(see call_batch_division_trap).
+    is_division_trap_raised = true;
+
+    *(exception_pointers->ContextRecord) = division_trap_context;
+
+    return EXCEPTION_CONTINUE_EXECUTION;
+}
+#else
+static sigjmp_buf division_trap_jmp_buf;
+
+static void division_trap_handler(int signal_number)
+{
+    siglongjmp(division_trap_jmp_buf, 1);
+}
+#endif
+
+static bool test_batch_division_trap(void)
+{
+    bool status = false;
+
+    TP_COMPILED_FUNCTION* batch_function = NULL;
+
+    uint8_t* source_code = "int32_t value1 = a / b;\n";
+
+#if defined(_WIN32)
+    PVOID trap_handler = AddVectoredExceptionHandler(1, division_trap_handler);
+
+    if (NULL == trap_handler){
+
+        TP_GET_LAST_ERROR(NULL);
+
+        return false;
+    }
+#else
+    struct sigaction trap_action = { .sa_handler = division_trap_handler };
+    struct sigaction old_action = { 0 };
+
+    if (0 != sigaction(SIGFPE, &trap_action, &old_action)){
+
+        TP_PRINT_CRT_ERROR(NULL);
+
+        return false;
+    }
+#endif
+
+    // The bad row is in the vector loop of both ISAs: zero divisor and INT32_MIN / -1.
+    struct{
+        int32_t member_dividend;
+        int32_t member_divisor;
+    }bad_row_table[] = {
+        { 5, 0 }, { INT32_MIN, -1 }
+    };
+
+    int32_t bad_row = 37;
+
+    int32_t column_a[TP_TEST_BATCH_ROW_NUM] = { 0 };
+    int32_t column_b[TP_TEST_BATCH_ROW_NUM] = { 0 };
+    const int32_t* columns[] = { column_a, column_b };
+    int32_t outputs[TP_TEST_BATCH_ROW_NUM] = { 0 };
+
+    // The scalar loop only, and the vector loop of each ISA(if the CPU supports it).
+    TP_X64_SIMD_ISA simd_isa_table[] = {
+        TP_X64_SIMD_ISA_NONE, TP_X64_SIMD_ISA_AVX2, TP_X64_SIMD_ISA_AVX512
+    };
+
+    for (rsize_t k = 0; (sizeof(simd_isa_table) / sizeof(simd_isa_table[0])) > k; ++k){
+
+        tp_set_x64_simd_isa_max(simd_isa_table[k]);
+
+        // NOTE: The interpreter checks the divisors before the division.
+        if (( ! tp_compile_function(source_code, strlen(source_code), TP_X64_ENTRY_MODE_BATCH, &batch_function)) ||
+            ( ! tp_tier_up_compiled_function(batch_function))){
+
+            goto error_proc;
+        }
+
+        for (rsize_t i = 0; (sizeof(bad_row_table) / sizeof(bad_row_table[0])) > i; ++i){
+
+            // -1 divisors of the other rows are not the exception.
+            for (int32_t j = 0; TP_TEST_BATCH_ROW_NUM > j; ++j){
+
+                column_a[j] = 1000 + j;
+                column_b[j] = ((0 == (j % 5)) ? -1 : (j % 7) + 1);
+                outputs[j] = INT32_MAX;
+            }
+
+            column_a[bad_row] = bad_row_table[i].member_dividend;
+            column_b[bad_row] = bad_row_table[i].member_divisor;
+
+            bool is_raised = false;
+
+            if ( ! call_batch_division_trap(batch_function, columns, outputs, &is_raised)){
+
+                goto error_proc;
+            }
+
+            if ( ! is_raised){
+
+                fprintf_s(
+                    stderr, "ERROR: %d / %d did not raise the exception, SIMD ISA=(%d).\n",
+                    bad_row_table[i].member_dividend, bad_row_table[i].member_divisor,
+                    batch_function->member_x64_simd_isa
+                );
+
+                goto error_proc;
+            }
 
-    size_t size = (sizeof(test_case_table) / sizeof(TEST_CASE_TABLE));
+            // The rows before the bad row are written, and the rows after that are not written.
+            for (int32_t j = 0; TP_TEST_BATCH_ROW_NUM > j; ++j){
 
-    for (size_t i = 0; size > i; ++i){
+                int32_t correct_value = ((bad_row > j) ? (column_a[j] / column_b[j]) : INT32_MAX);
 
-        uint8_t* source_code = test_case_table[i].member_source_code;
+                if (correct_value != outputs[j]){
 
-        if (NULL == source_code){
+                    fprintf_s(
+                        stderr, "ERROR: row(%d): batch output=(%d), correct value=(%d), SIMD ISA=(%d).\n",
+                        j, outputs[j], correct_value, batch_function->member_x64_simd_isa
+                    );
 
-            break;
+                    goto error_proc;
+                }
+            }
         }
 
-        int32_t return_value = 0;
+        tp_release_compiled_function(&batch_function);
+    }
 
-        if ( ! compiler_main(
-            argc, argv, msg_buffer, msg_buffer_size,
-            &is_test_mode, i, &return_value, drive, dir, now)){
+    status = true;
 
-            status = false;
+error_proc:
 
-            fprintf_s(stderr, "ERROR: compile failed. test case No.%03zd.\n", i + 1);
-        }else{
+#if defined(_WIN32)
+    (void)RemoveVectoredExceptionHandler(trap_handler);
+#else
+    (void)sigaction(SIGFPE, &old_action, NULL);
+#endif
 
-            int32_t correct_value = test_case_table[i].member_return_value;
+    tp_set_x64_simd_isa_max(TP_X64_SIMD_ISA_AVX512);
 
-            if (return_value == correct_value){
+    tp_release_compiled_function(&batch_function);
 
-                fprintf_s(stderr, "SUCCESS: test case No.%03zd.\n", i + 1);
-            }else{
+    return status;
+}
 
-                fprintf_s(
-                    stderr, "ERROR: test case No.%03zd: "
-                    "return value=(%d), correct value=(%d),\n"
-                    "source code=(%s).\n",
-                    i + 1, return_value, correct_value, source_code
-                );
-            }
-        }
+static bool call_batch_division_trap(
+    TP_COMPILED_FUNCTION* batch_function, const int32_t* const* columns, int32_t* outputs, bool* is_raised)
+{
+    bool status = true;
+
+#if defined(_WIN32)
+    is_division_trap_raised = false;
+
+    RtlCaptureContext(&division_trap_context);
+
+    if ( ! is_division_trap_raised){
+
+        status = tp_call_compiled_function_batch(batch_function, columns, 2, outputs, TP_TEST_BATCH_ROW_NUM);
     }
 
-    (void)move_test_log_files(drive, dir, is_test_mode, now);
+    *is_raised = is_division_trap_raised;
+#else
+    if (0 == sigsetjmp(division_trap_jmp_buf, 1)){
+
+        status = tp_call_compiled_function_batch(batch_function, columns, 2, outputs, TP_TEST_BATCH_ROW_NUM);
+    }else{
+
+        *is_raised = true;
+    }
+#endif
 
     return status;
 }
@@ -334,7 +2626,7 @@ static bool compiler_main(
     bool* is_test_mode, size_t test_index, int32_t* return_value,
     char* drive, char* dir, time_t now)
 {
-    TP_SYMBOL_TABLE* symbol_table = (TP_SYMBOL_TABLE*)calloc(1, sizeof(TP_SYMBOL_TABLE));
+    TP_SYMBOL_TABLE* symbol_table = (TP_SYMBOL_TABLE*)TP_CALLOC(NULL, 1, sizeof(TP_SYMBOL_TABLE));
 
     if (NULL == symbol_table){
 
@@ -372,10 +2664,26 @@ static bool compiler_main(
         }
     }
 
+    if (symbol_table->member_is_benchmark_mode){
+
+        if ( ! tp_benchmark(symbol_table)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            goto error_proc;
+        }
+
+        free_memory_and_file(&symbol_table);
+
+        return true;
+    }
+
     bool is_origin_wasm = symbol_table->member_is_origin_wasm;
 
     if (is_origin_wasm){
 
+        tp_begin_compile_phase(symbol_table);
+
         if ( ! tp_make_wasm(symbol_table, is_origin_wasm)){
 
             TP_PUT_LOG_MSG_TRACE(symbol_table);
@@ -383,6 +2691,10 @@ static bool compiler_main(
             goto error_proc;
         }
 
+        tp_end_compile_phase(
+            symbol_table, TP_COMPILE_PHASE_WASM, symbol_table->member_wasm_module.member_content_size
+        );
+
         if ( ! tp_make_x64_code(symbol_table, return_value)){
 
             TP_PUT_LOG_MSG_TRACE(symbol_table);
@@ -391,6 +2703,8 @@ static bool compiler_main(
         }
     }else{
 
+        tp_begin_compile_phase(symbol_table);
+
         if (is_test_mode && *is_test_mode){
 
             if ( ! tp_make_token(
@@ -425,6 +2739,9 @@ static bool compiler_main(
             }
         }
 
+        tp_end_compile_phase(symbol_table, TP_COMPILE_PHASE_TOKEN, symbol_table->member_tp_token_pos);
+        tp_begin_compile_phase(symbol_table);
+
         if ( ! tp_make_parse_tree(symbol_table)){
 
             TP_PUT_LOG_MSG_TRACE(symbol_table);
@@ -432,6 +2749,11 @@ static bool compiler_main(
             goto error_proc;
         }
 
+        tp_end_compile_phase(
+            symbol_table, TP_COMPILE_PHASE_PARSE_TREE, symbol_table->member_tp_parse_tree_node_num
+        );
+        tp_begin_compile_phase(symbol_table);
+
         if ( ! tp_semantic_analysis(symbol_table)){
 
             TP_PUT_LOG_MSG_TRACE(symbol_table);
@@ -439,13 +2761,43 @@ static bool compiler_main(
             goto error_proc;
         }
 
-        if ( ! tp_make_wasm(symbol_table, is_origin_wasm)){
+        tp_end_compile_phase(
+            symbol_table, TP_COMPILE_PHASE_SEMANTIC_ANALYSIS, symbol_table->member_tp_parse_tree_node_num
+        );
+        tp_begin_compile_phase(symbol_table);
+
+        if ( ! optimize_program(symbol_table)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            goto error_proc;
+        }
+
+        tp_end_compile_phase(
+            symbol_table, TP_COMPILE_PHASE_OPTIMIZE, symbol_table->member_tp_parse_tree_node_num
+        );
+        tp_begin_compile_phase(symbol_table);
+
+        if (symbol_table->member_is_no_output_files && (false == symbol_table->member_is_output_wasm_file)){
+
+            if ( ! tp_make_wasm_instruction(symbol_table)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                goto error_proc;
+            }
+        }else if ( ! tp_make_wasm(symbol_table, is_origin_wasm)){
 
             TP_PUT_LOG_MSG_TRACE(symbol_table);
 
             goto error_proc;
         }
 
+        // NOTE: The units are zero without the wasm module(-n without -w).
+        tp_end_compile_phase(
+            symbol_table, TP_COMPILE_PHASE_WASM, symbol_table->member_wasm_module.member_content_size
+        );
+
         if ( ! tp_make_x64_code(symbol_table, return_value)){
 
             TP_PUT_LOG_MSG_TRACE(symbol_table);
@@ -454,6 +2806,16 @@ static bool compiler_main(
         }
     }
 
+    if (symbol_table->member_is_output_phase_file){
+
+        if ( ! tp_write_compile_phase_file(symbol_table)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            goto error_proc;
+        }
+    }
+
     free_memory_and_file(&symbol_table);
 
     return true;
@@ -491,15 +2853,7 @@ static bool init_symbol_table(
         return false;
     }
 
-    symbol_table->member_grammer_statement_1_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_STATEMENT_1);
-    symbol_table->member_grammer_statement_2_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_STATEMENT_2);
-    symbol_table->member_grammer_expression_1_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_EXPRESSION_1);
-    symbol_table->member_grammer_expression_2_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_EXPRESSION_2);
-    symbol_table->member_grammer_term_1_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_TERM_1);
-    symbol_table->member_grammer_term_2_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_TERM_2);
-    symbol_table->member_grammer_factor_1_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_FACTOR_1);
-    symbol_table->member_grammer_factor_2_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_FACTOR_2);
-    symbol_table->member_grammer_factor_3_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_FACTOR_3);
+    init_grammer_type_num(symbol_table);
 
     if (NULL == is_test){
 
@@ -531,14 +2885,22 @@ static bool init_symbol_table(
 
     if (symbol_table->member_is_output_current_dir){
 
+#if defined(_WIN32)
         DWORD status = GetCurrentDirectoryA(sizeof(base_dir), base_dir);
 
         if (0 == status){
 
             goto error_out;
         }
+#else
+        if (NULL == getcwd(base_dir, sizeof(base_dir))){
+
+            goto error_out;
+        }
+#endif
     }else{
 
+#if defined(_WIN32)
         HMODULE handle = GetModuleHandleA(NULL);
 
         if (0 == handle){
@@ -552,6 +2914,12 @@ static bool init_symbol_table(
 
             goto error_out;
         }
+#else
+        if (-1 == readlink("/proc/self/exe", base_dir, sizeof(base_dir) - 1)){
+
+            goto error_out;
+        }
+#endif
     }
 
     err = _splitpath_s(base_dir, drive, _MAX_DRIVE, dir, _MAX_DIR, NULL, 0, NULL, 0);
@@ -621,7 +2989,7 @@ static bool make_path_test_log_files(
     memset(dir, 0, sizeof(dir));
 
     sprintf_s(
-        dir, sizeof(dir), "%s\\test_%04d-%02d-%02d",
+        dir, sizeof(dir), "%s" TP_PATH_SEPARATOR "test_%04d-%02d-%02d",
         dir_param, local_time.tm_year + 1900, local_time.tm_mon + 1, local_time.tm_mday
     );
 
@@ -637,13 +3005,9 @@ static bool make_path_test_log_files(
         return false;
     }
 
-    DWORD attributes = GetFileAttributesA(path);
+    if ( ! is_exists_path(path)){
 
-    if (-1 == attributes){
-
-        SetLastError(NO_ERROR);
-
-        if ( ! CreateDirectoryA(path, NULL)){
+        if ( ! make_directory(path)){
 
             TP_GET_LAST_ERROR(NULL);
 
@@ -661,7 +3025,7 @@ static bool make_path_test_log_files(
     memset(dir, 0, sizeof(dir));
 
     sprintf_s(
-        dir, sizeof(dir), "%s\\test_%04d-%02d-%02d\\test_case_%03zd",
+        dir, sizeof(dir), "%s" TP_PATH_SEPARATOR "test_%04d-%02d-%02d" TP_PATH_SEPARATOR "test_case_%03zd",
         dir_param, local_time.tm_year + 1900, local_time.tm_mon + 1, local_time.tm_mday, test_index + 1
     );
 
@@ -676,13 +3040,9 @@ static bool make_path_test_log_files(
         return false;
     }
 
-    attributes = GetFileAttributesA(path);
-
-    if (-1 == attributes){
-
-        SetLastError(NO_ERROR);
+    if ( ! is_exists_path(path)){
 
-        if ( ! CreateDirectoryA(path, NULL)){
+        if ( ! make_directory(path)){
 
             TP_GET_LAST_ERROR(NULL);
 
@@ -722,7 +3082,7 @@ static bool move_test_log_files(char* drive, char* dir_param, bool is_test, time
     memset(dir, 0, sizeof(dir));
 
     sprintf_s(
-        dir, sizeof(dir), "%s\\test_%04d-%02d-%02d",
+        dir, sizeof(dir), "%s" TP_PATH_SEPARATOR "test_%04d-%02d-%02d",
         dir_param, local_time.tm_year + 1900, local_time.tm_mon + 1, local_time.tm_mday
     );
 
@@ -738,9 +3098,7 @@ static bool move_test_log_files(char* drive, char* dir_param, bool is_test, time
         return false;
     }
 
-    DWORD attributes = GetFileAttributesA(path);
-
-    if (-1 == attributes){
+    if ( ! is_exists_path(path)){
 
         TP_GET_LAST_ERROR(NULL);
 
@@ -755,7 +3113,7 @@ static bool move_test_log_files(char* drive, char* dir_param, bool is_test, time
         memset(dir, 0, sizeof(dir));
 
         sprintf_s(
-            dir, sizeof(dir), "%s\\test_%04d-%02d-%02d_%03zd",
+            dir, sizeof(dir), "%s" TP_PATH_SEPARATOR "test_%04d-%02d-%02d_%03zd",
             dir_param, local_time.tm_year + 1900, local_time.tm_mon + 1, local_time.tm_mday, i
         );
 
@@ -768,16 +3126,12 @@ static bool move_test_log_files(char* drive, char* dir_param, bool is_test, time
             return false;
         }
 
-        DWORD attributes = GetFileAttributesA(new_path);
-
-        if (-1 != attributes){
+        if (is_exists_path(new_path)){
 
             continue;
         }
 
-        SetLastError(NO_ERROR);
-
-        if ( ! MoveFileA(path, new_path)){
+        if ( ! move_path(path, new_path)){
 
             TP_GET_LAST_ERROR(NULL);
 
@@ -883,6 +3237,50 @@ static bool make_path_log_files_main(TP_SYMBOL_TABLE* symbol_table, char* drive,
         return false;
     }
 
+    if ( ! make_path(
+        symbol_table, drive, dir, NULL,
+        TP_ELF_DEFAULT_FILE_NAME, TP_ELF_OBJECT_DEFAULT_EXT_NAME,
+        symbol_table->member_elf_object_file_path,
+        sizeof(symbol_table->member_elf_object_file_path))){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! make_path(
+        symbol_table, drive, dir, NULL,
+        TP_ELF_DEFAULT_FILE_NAME, TP_ELF_SHARED_OBJECT_DEFAULT_EXT_NAME,
+        symbol_table->member_elf_shared_object_file_path,
+        sizeof(symbol_table->member_elf_shared_object_file_path))){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! make_path(
+        symbol_table, drive, dir, TP_LOG_FILE_PREFIX,
+        TP_PHASE_DEFAULT_FILE_NAME, TP_PHASE_DEFAULT_EXT_NAME,
+        symbol_table->member_phase_file_path,
+        sizeof(symbol_table->member_phase_file_path))){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! make_path(
+        symbol_table, drive, dir, TP_LOG_FILE_PREFIX,
+        TP_PHASE_TRACE_DEFAULT_FILE_NAME, TP_PHASE_DEFAULT_EXT_NAME,
+        symbol_table->member_phase_trace_file_path,
+        sizeof(symbol_table->member_phase_trace_file_path))){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
     return true;
 }
 
@@ -913,6 +3311,100 @@ static bool make_path(
     return true;
 }
 
+static bool is_exists_path(char* path)
+{
+#if defined(_WIN32)
+    return INVALID_FILE_ATTRIBUTES != GetFileAttributesA(path);
+#else
+    struct stat stbuf;
+
+    if (stat(path, &stbuf)){
+
+        // NOTE: A path that does not exist is not an error.
+        errno_t err = _set_errno(0);
+
+        return false;
+    }
+
+    return true;
+#endif
+}
+
+static bool make_directory(char* path)
+{
+#if defined(_WIN32)
+    SetLastError(NO_ERROR);
+
+    return CreateDirectoryA(path, NULL);
+#else
+    return 0 == mkdir(path, 0755);
+#endif
+}
+
+static bool move_path(char* from_path, char* to_path)
+{
+#if defined(_WIN32)
+    SetLastError(NO_ERROR);
+
+    return MoveFileA(from_path, to_path);
+#else
+    return 0 == rename(from_path, to_path);
+#endif
+}
+
+static bool optimize_program(TP_SYMBOL_TABLE* symbol_table)
+{
+    switch (symbol_table->member_optimization_level){
+    case TP_OPTIMIZATION_LEVEL_0:
+        return true;
+    case TP_OPTIMIZATION_LEVEL_1:
+
+        if ( ! tp_optimize_parse_tree(symbol_table)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+        return true;
+    case TP_OPTIMIZATION_LEVEL_2:
+
+        // NOTE: The wasm code is made of the SSA IR instead of the parse tree(see tp_make_wasm.c).
+        if ( ! tp_make_ir(symbol_table)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        if ( ! tp_optimize_ir(symbol_table)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+        return true;
+    default:
+        break;
+    }
+
+    TP_PUT_LOG_MSG_ICE(symbol_table);
+
+    return false;
+}
+
+static void init_grammer_type_num(TP_SYMBOL_TABLE* symbol_table)
+{
+    symbol_table->member_grammer_statement_1_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_STATEMENT_1);
+    symbol_table->member_grammer_statement_2_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_STATEMENT_2);
+    symbol_table->member_grammer_expression_1_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_EXPRESSION_1);
+    symbol_table->member_grammer_expression_2_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_EXPRESSION_2);
+    symbol_table->member_grammer_term_1_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_TERM_1);
+    symbol_table->member_grammer_term_2_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_TERM_2);
+    symbol_table->member_grammer_factor_1_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_FACTOR_1);
+    symbol_table->member_grammer_factor_2_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_FACTOR_2);
+    symbol_table->member_grammer_factor_3_num = calc_grammer_type_num(symbol_table, TP_GRAMMER_TYPE_INDEX_FACTOR_3);
+}
+
 static uint32_t calc_grammer_type_num(TP_SYMBOL_TABLE* symbol_table, size_t grammer_type_index)
 {
     uint32_t grammer_type_num = 0;
@@ -960,9 +3452,25 @@ static bool parse_cmd_line_param(
             for (int j = 1; length > j; ++j){
 
                 switch (param[j]){
+                case TP_CONFIG_OPTION_IS_BATCH: // -b
+                    symbol_table->member_is_batch = true;
+                    break;
                 case TP_CONFIG_OPTION_IS_OUTPUT_CURRENT_DIR: // -c
                     symbol_table->member_is_output_current_dir = true;
                     break;
+                case TP_CONFIG_OPTION_IS_OUTPUT_ELF_SHARED_OBJECT_FILE: // -d
+                    symbol_table->member_is_output_elf_shared_object_file = true;
+                    break;
+                case TP_CONFIG_OPTION_IS_OUTPUT_ELF_OBJECT_FILE: // -e
+                    symbol_table->member_is_output_elf_object_file = true;
+                    break;
+                case TP_CONFIG_OPTION_IS_OUTPUT_PHASE_FILE: // -i
+                    symbol_table->member_is_output_phase_file = true;
+                    symbol_table->member_is_record_compile_phase = true;
+                    break;
+                case TP_CONFIG_OPTION_IS_BENCHMARK_MODE: // -k
+                    symbol_table->member_is_benchmark_mode = true;
+                    break;
                 case TP_CONFIG_OPTION_IS_OUTPUT_LOG_FILE: // -l
                     symbol_table->member_is_output_log_file = true;
                     break;
@@ -972,6 +3480,9 @@ static bool parse_cmd_line_param(
                 case TP_CONFIG_OPTION_IS_NO_OUTPUT_FILES: // -n
                     symbol_table->member_is_no_output_files = true;
                     break;
+                case TP_CONFIG_OPTION_IS_INPUTS_POINTER: // -p
+                    symbol_table->member_is_inputs_pointer = true;
+                    break;
                 case TP_CONFIG_OPTION_IS_ORIGIN_WASM: // -r
                     symbol_table->member_is_origin_wasm = true;
                     break;
@@ -989,6 +3500,22 @@ static bool parse_cmd_line_param(
                 case TP_CONFIG_OPTION_IS_OUTPUT_X64_FILE: // -x
                     symbol_table->member_is_output_x64_file = true;
                     break;
+                case TP_CONFIG_OPTION_OPTIMIZATION_LEVEL: // -O0, -O1 or -O2
+                    switch (param[j + 1]){
+                    case '0':
+                        symbol_table->member_optimization_level = TP_OPTIMIZATION_LEVEL_0;
+                        break;
+                    case '1':
+                        symbol_table->member_optimization_level = TP_OPTIMIZATION_LEVEL_1;
+                        break;
+                    case '2':
+                        symbol_table->member_optimization_level = TP_OPTIMIZATION_LEVEL_2;
+                        break;
+                    default:
+                        goto fail;
+                    }
+                    ++j;
+                    break;
                 default:
                     goto fail;
                 }
@@ -1007,6 +3534,41 @@ static bool parse_cmd_line_param(
         goto fail;
     }
 
+    if (symbol_table->member_is_batch && symbol_table->member_is_inputs_pointer){
+
+        goto fail;
+    }
+
+    if (symbol_table->member_is_benchmark_mode){
+
+        if (symbol_table->member_is_origin_wasm || symbol_table->member_is_source_cmd_param ||
+            symbol_table->member_is_test_mode || symbol_table->member_is_output_phase_file){
+
+            goto fail;
+        }
+
+        size_t length = (command_line_param ? strlen(command_line_param) : 0);
+
+        if (TP_BENCHMARK_CONFIG_STRING_LENGTH_MAX < length){
+
+            goto fail;
+        }
+
+        sprintf_s(
+            symbol_table->member_benchmark_config,
+            sizeof(symbol_table->member_benchmark_config),
+            "%s", (command_line_param ? command_line_param : "")
+        );
+    }
+
+    if (symbol_table->member_is_batch){
+
+        symbol_table->member_x64_entry_mode = TP_X64_ENTRY_MODE_BATCH;
+    }else if (symbol_table->member_is_inputs_pointer){
+
+        symbol_table->member_x64_entry_mode = TP_X64_ENTRY_MODE_INPUTS_POINTER;
+    }
+
     if (symbol_table->member_is_source_cmd_param){
 
         size_t length = (command_line_param ? strlen(command_line_param) : 0);
@@ -1025,7 +3587,8 @@ static bool parse_cmd_line_param(
 
     if (command_line_param &&
         ((false == symbol_table->member_is_origin_wasm) &&
-        (false == symbol_table->member_is_source_cmd_param))){
+        (false == symbol_table->member_is_source_cmd_param) &&
+        (false == symbol_table->member_is_benchmark_mode))){
 
         sprintf_s(
             symbol_table->member_input_file_path,
@@ -1042,11 +3605,24 @@ fail:
 
     *is_disp_usage = true;
 
-    fprintf_s(stderr, "usage: int_calc_compiler [-/][rcmlnwx] [input file] [source code string]\n");
+    fprintf_s(stderr, "usage: int_calc_compiler [-/][rbcdeikmlnpwx] [-/]O[012] [input file] [source code string] [benchmark config string]\n");
+    fprintf_s(stderr, "  -b : set batch mode. x64 code loops over columns of undefined variables.\n");
     fprintf_s(stderr, "  -c : set output current directory.\n");
+    fprintf_s(stderr, "  -d : set output ELF shared object file(x86-64 System V ABI).\n");
+    fprintf_s(stderr, "  -e : set output ELF relocatable object file(x86-64 System V ABI).\n");
+    fprintf_s(stderr, "  -i : set output phase files(time and memory of each phase as JSON and Chrome trace).\n");
+    fprintf_s(stderr, "  -k : set benchmark mode. [input file] is not necessary.\n");
+    fprintf_s(stderr, "       compiles a generated program many times and writes the throughput as JSON.\n");
+    fprintf_s(
+        stderr,
+        "       [benchmark config string] up to %d characters(see tp_benchmark.c):\n",
+        TP_BENCHMARK_CONFIG_STRING_LENGTH_MAX
+    );
+    fprintf_s(stderr, "       statements=64,depth=4,variables=8,params=4,operators=+-*/,iterations=100,seed=1\n");
     fprintf_s(stderr, "  -l : set output log file.\n");
     fprintf_s(stderr, "  -m : set no output messages.\n");
     fprintf_s(stderr, "  -n : set no output files.\n");
+    fprintf_s(stderr, "  -p : set inputs pointer mode. x64 code takes undefined variables as int32_t array.\n");
     fprintf_s(stderr, "  -r : set origin wasm. [input file] is not necessary.\n");
     fprintf_s(stderr, "  -s : set source code command line parameter mode.\n");
     fprintf_s(
@@ -1057,6 +3633,9 @@ fail:
     fprintf_s(stderr, "  -t : set test mode. [input file] is not necessary.\n");
     fprintf_s(stderr, "  -w : set output wasm file.\n");
     fprintf_s(stderr, "  -x : set output x64 file.\n");
+    fprintf_s(stderr, "  -O0 : set no optimization. the parse tree is translated to wasm directly.\n");
+    fprintf_s(stderr, "  -O1 : set optimization of the parse tree.\n");
+    fprintf_s(stderr, "  -O2 : set optimization of the SSA IR(default).\n");
 
     err = _set_errno(0);
 
@@ -1107,11 +3686,51 @@ static void free_memory_and_file(TP_SYMBOL_TABLE** symbol_table)
             sizeof(TP_WASM_MODULE_CONTENT) + wasm_module->member_content_size);
     }
 
+    if ((*symbol_table)->member_ir_instruction){
+
+        TP_FREE(
+            *symbol_table, &((*symbol_table)->member_ir_instruction),
+            (*symbol_table)->member_ir_instruction_size
+        );
+    }
+
+    if ((*symbol_table)->member_wasm_instruction){
+
+        TP_FREE(
+            *symbol_table, &((*symbol_table)->member_wasm_instruction),
+            (*symbol_table)->member_wasm_instruction_size
+        );
+    }
+
     if ((*symbol_table)->member_stack){
 
         TP_FREE(*symbol_table, &((*symbol_table)->member_stack), (*symbol_table)->member_stack_size);
     }
 
+    if ((*symbol_table)->member_x64_live_range){
+
+        TP_FREE(
+            *symbol_table, &((*symbol_table)->member_x64_live_range),
+            (*symbol_table)->member_x64_live_range_size
+        );
+    }
+
+    if ((*symbol_table)->member_x64_local_live_range){
+
+        TP_FREE(
+            *symbol_table, &((*symbol_table)->member_x64_local_live_range),
+            (*symbol_table)->member_x64_local_live_range_size
+        );
+    }
+
+    if ((*symbol_table)->member_x64_instruction){
+
+        TP_FREE(
+            *symbol_table, &((*symbol_table)->member_x64_instruction),
+            (*symbol_table)->member_x64_instruction_size
+        );
+    }
+
     if ( ! tp_close_file(*symbol_table, &((*symbol_table)->member_read_file))){
 
         TP_PUT_LOG_MSG_TRACE(*symbol_table);
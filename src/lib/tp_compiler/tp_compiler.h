@@ -4,12 +4,21 @@
 #if ! defined(INT_CALC_COMPILER_H_)
 #define INT_CALC_COMPILER_H_
 
+#if defined(_WIN32)
 #define MICROSOFT_WINDOWS_WINBASE_H_DEFINE_INTERLOCKED_CPLUSPLUS_OVERLOADS 0
 #include <windows.h>
+#else
+#if ! defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+#endif
 #include <stdio.h>
 #define _CRTDBG_MAP_ALLOC
 #include <stdlib.h>
+#if defined(_WIN32)
 #include <crtdbg.h>
+#endif
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <limits.h>
@@ -18,22 +27,95 @@
 #include <ctype.h>
 #include <time.h>
 #include <errno.h>
+#if ! defined(_WIN32)
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#if ! defined(_WIN32)
+// POSIX: the Microsoft CRT functions used by this compiler(see tp_utils.c).
+
+typedef int errno_t;
+typedef size_t rsize_t;
+
+#define _MAX_PATH PATH_MAX
+#define _MAX_DRIVE 3
+#define _MAX_DIR PATH_MAX
+#define _MAX_FNAME 256
+#define _MAX_EXT 256
+
+#define printf_s printf
+#define fprintf_s fprintf
+#define sprintf_s snprintf
+#define _set_errno(value) ((errno = (value)), 0)
+#define _CrtDumpMemoryLeaks() 0 // No debug heap.
+#endif
 
 // config section:
 
+#define TP_CONFIG_OPTION_IS_BATCH 'b'
 #define TP_CONFIG_OPTION_IS_OUTPUT_CURRENT_DIR 'c'
+#define TP_CONFIG_OPTION_IS_OUTPUT_ELF_SHARED_OBJECT_FILE 'd'
+#define TP_CONFIG_OPTION_IS_OUTPUT_ELF_OBJECT_FILE 'e'
+#define TP_CONFIG_OPTION_IS_OUTPUT_PHASE_FILE 'i'
+#define TP_CONFIG_OPTION_IS_BENCHMARK_MODE 'k'
 #define TP_CONFIG_OPTION_IS_OUTPUT_LOG_FILE 'l'
 #define TP_CONFIG_OPTION_IS_NO_OUTPUT_MESSAGES 'm'
 #define TP_CONFIG_OPTION_IS_NO_OUTPUT_FILES 'n'
+#define TP_CONFIG_OPTION_IS_INPUTS_POINTER 'p'
 #define TP_CONFIG_OPTION_IS_ORIGIN_WASM 'r'
 #define TP_CONFIG_OPTION_IS_SOURCE_CMD_PARAM 's'
 #define TP_CONFIG_OPTION_IS_TEST_MODE 't'
 #define TP_CONFIG_OPTION_IS_OUTPUT_WASM_FILE 'w'
 #define TP_CONFIG_OPTION_IS_OUTPUT_X64_FILE 'x'
+#define TP_CONFIG_OPTION_OPTIMIZATION_LEVEL 'O' // -O0, -O1 or -O2
+
+typedef enum TP_OPTIMIZATION_LEVEL_
+{
+    TP_OPTIMIZATION_LEVEL_0 = 0, // The parse tree is translated to wasm directly.
+    TP_OPTIMIZATION_LEVEL_1,     // The parse tree is optimized(see tp_optimize_parse_tree.c).
+    TP_OPTIMIZATION_LEVEL_2      // The SSA IR is optimized(see tp_optimize_ir.c).
+}TP_OPTIMIZATION_LEVEL;
+
+#define TP_OPTIMIZATION_LEVEL_DEFAULT TP_OPTIMIZATION_LEVEL_2
 
 #define TP_SOURCE_CODE_STRING_BUFFER_SIZE 256
 #define TP_SOURCE_CODE_STRING_LENGTH_MAX (TP_SOURCE_CODE_STRING_BUFFER_SIZE - 1)
 
+// benchmark section:
+
+#define TP_BENCHMARK_CONFIG_STRING_BUFFER_SIZE 256
+#define TP_BENCHMARK_CONFIG_STRING_LENGTH_MAX (TP_BENCHMARK_CONFIG_STRING_BUFFER_SIZE - 1)
+
+typedef enum TP_COMPILE_PHASE_
+{
+    TP_COMPILE_PHASE_TOKEN = 0,         // Unit: tokens.
+    TP_COMPILE_PHASE_PARSE_TREE,        // Unit: parse tree nodes.
+    TP_COMPILE_PHASE_SEMANTIC_ANALYSIS, // Unit: parse tree nodes.
+    TP_COMPILE_PHASE_OPTIMIZE,          // Unit: parse tree nodes.
+    TP_COMPILE_PHASE_WASM,              // Unit: bytes of the wasm module.
+    TP_COMPILE_PHASE_X64_CODE,          // Unit: bytes of the x64 code.
+    TP_COMPILE_PHASE_NUM
+}TP_COMPILE_PHASE;
+
+typedef struct tp_compile_phase_record_{
+    bool member_is_recorded;
+    uint64_t member_begin_time; // Nanoseconds from the beginning of the first phase.
+    uint64_t member_wall_time; // Nanoseconds.
+    uint64_t member_cpu_time; // Nanoseconds of the user and kernel time of the thread.
+    uint64_t member_unit_num;
+    uint64_t member_allocation_num; // TP_CALLOC and TP_REALLOC.
+    uint64_t member_allocation_bytes;
+    int64_t member_peak_bytes; // Maximum of the live bytes of the compile.
+}TP_COMPILE_PHASE_RECORD;
+
+typedef struct tp_memory_statistics_{
+    uint64_t member_allocation_num;
+    uint64_t member_allocation_bytes;
+    int64_t member_live_bytes; // Allocated and not freed yet(see tp_calloc and tp_free).
+    int64_t member_peak_bytes;
+}TP_MEMORY_STATISTICS;
+
 // message section:
 
 #define TP_MESSAGE_BUFFER_SIZE 1024
@@ -97,11 +179,19 @@ typedef struct tp_put_log_element_{
     );
 #define TP_GET_LAST_ERROR(symbol_table) tp_get_last_error((symbol_table), __FILE__, __func__, __LINE__);
 #define TP_PRINT_CRT_ERROR(symbol_table) tp_print_crt_error((symbol_table), __FILE__, __func__, __LINE__);
+#define TP_CALLOC(symbol_table, num, size) tp_calloc((symbol_table), (num), (size), __FILE__, __LINE__)
+#define TP_REALLOC(symbol_table, ptr, size) tp_realloc((symbol_table), (ptr), (size), __FILE__, __LINE__)
 #define TP_FREE(symbol_table, ptr, size) tp_free((symbol_table), (ptr), (size), __FILE__, __func__, __LINE__);
 #define TP_FREE2(symbol_table, ptr, size) tp_free2((symbol_table), (ptr), (size), __FILE__, __func__, __LINE__);
 
 // output file section:
 
+#if defined(_WIN32)
+#define TP_PATH_SEPARATOR "\\"
+#else
+#define TP_PATH_SEPARATOR "/"
+#endif
+
 #define TP_LOG_FILE_PREFIX "int_calc"
 
 #define TP_WRITE_LOG_DEFAULT_FILE_NAME "log"
@@ -122,6 +212,15 @@ typedef struct tp_put_log_element_{
 #define TP_X64_DEFAULT_FILE_NAME "int_calc"
 #define TP_X64_DEFAULT_EXT_NAME "bin"
 
+#define TP_ELF_DEFAULT_FILE_NAME "int_calc"
+#define TP_ELF_OBJECT_DEFAULT_EXT_NAME "o"
+#define TP_ELF_SHARED_OBJECT_DEFAULT_EXT_NAME "so"
+#define TP_ELF_DEFAULT_SYMBOL_NAME "calc"
+
+#define TP_PHASE_DEFAULT_FILE_NAME "phase"
+#define TP_PHASE_TRACE_DEFAULT_FILE_NAME "phase_trace"
+#define TP_PHASE_DEFAULT_EXT_NAME "json"
+
 #define TP_INDENT_UNIT 4
 #define TP_INDENT_FORMAT_BUFFER_SIZE 32
 #define TP_INDENT_STRING_BUFFER_SIZE 4096
@@ -252,12 +351,56 @@ typedef enum TP_PARSE_TREE_GRAMMER_
     TP_PARSE_TREE_GRAMMER_FACTOR_3
 }TP_PARSE_TREE_GRAMMER;
 
+// Common subexpression(see tp_optimize_parse_tree.c).
+typedef enum TP_PARSE_TREE_CSE_KIND_
+{
+    TP_PARSE_TREE_CSE_NONE = 0,
+    TP_PARSE_TREE_CSE_TEE_LOCAL, // The first computation is saved to the temporary variable.
+    TP_PARSE_TREE_CSE_GET_LOCAL  // The subtree is not evaluated: the saved value is reused.
+}TP_PARSE_TREE_CSE_KIND;
+
 typedef struct tp_parse_tree_{
     TP_PARSE_TREE_GRAMMER member_grammer;
     size_t member_element_num;
     TP_PARSE_TREE_ELEMENT* member_element;
+    uint32_t member_value_number;
+    TP_PARSE_TREE_CSE_KIND member_cse_kind;
+    uint32_t member_cse_local_index;
 }TP_PARSE_TREE;
 
+// SSA IR section:
+
+#define TP_IR_INSTRUCTION_SIZE_ALLOCATE_UNIT 256
+#define TP_IR_VALUE_NULL UINT32_MAX
+
+// The values of the single use are evaluated at the use, while the wasm value stack
+// is not deeper than this(see allocate_ir_local_variable function of tp_optimize_ir.c).
+#define TP_IR_WASM_STACK_DEPTH_MAX 8
+
+typedef enum TP_IR_OPCODE_
+{
+    TP_IR_OPCODE_NOP = 0, // Removed.
+    TP_IR_OPCODE_PARAM,   // member_i32: the local index of the parameter.
+    TP_IR_OPCODE_CONST,   // member_i32
+    TP_IR_OPCODE_COPY,    // op1(removed by copy propagation).
+    TP_IR_OPCODE_NEG,     // 0 - op1
+    TP_IR_OPCODE_ADD,     // op1 + op2
+    TP_IR_OPCODE_SUB,     // op1 - op2
+    TP_IR_OPCODE_MUL,     // op1 * op2
+    TP_IR_OPCODE_DIV      // op1 / op2(the trap of wasm: the division by zero and INT32_MIN / -1).
+}TP_IR_OPCODE;
+
+// NOTE: The value of the instruction is the index of it. The program is straight-line code,
+// so each value is defined once without phi functions.
+typedef struct tp_ir_instruction_{
+    TP_IR_OPCODE member_opcode;
+    uint32_t member_op1;
+    uint32_t member_op2;
+    int32_t member_i32;
+    uint32_t member_use_count;
+    uint32_t member_local_index; // TP_IR_VALUE_NULL: The value is evaluated at the use.
+}TP_IR_INSTRUCTION;
+
 // semantic analysis section:
 
 #define TP_GRAMMER_TYPE_INDEX_STATEMENT_1 0
@@ -319,7 +462,7 @@ typedef struct register_object_hash_{
 
 #define TP_WASM_MODULE_SECTION_TYPE_COUNT 1
 #define TP_WASM_MODULE_SECTION_TYPE_FORM_FUNC 0x60
-#define TP_WASM_MODULE_SECTION_TYPE_PARAM_COUNT 0
+#define TP_WASM_MODULE_SECTION_TYPE_PARAM_TYPE_I32 0x7f
 #define TP_WASM_MODULE_SECTION_TYPE_RETURN_COUNT 1
 #define TP_WASM_MODULE_SECTION_TYPE_RETURN_TYPE_I32 0x7f
 
@@ -393,6 +536,19 @@ typedef struct tp_wasm_module_{
     TP_WASM_MODULE_CONTENT* member_module_content;
 }TP_WASM_MODULE;
 
+// Fixed-width wasm instruction of the code body(without the wasm module).
+#define TP_WASM_INSTRUCTION_SIZE_ALLOCATE_UNIT 256
+
+typedef union tp_wasm_instruction_immediate_{
+    uint32_t member_local_index; // get_local, set_local and tee_local.
+    int32_t member_i32; // i32.const
+}TP_WASM_INSTRUCTION_IMMEDIATE;
+
+typedef struct tp_wasm_instruction_{
+    uint32_t member_wasm_opcode;
+    TP_WASM_INSTRUCTION_IMMEDIATE member_immediate;
+}TP_WASM_INSTRUCTION;
+
 // x64 section:
 
 #define TP_WASM_STACK_EMPTY -1
@@ -402,6 +558,37 @@ typedef struct tp_wasm_module_{
 
 #define TP_PADDING_MASK (16 - 1)
 
+#define TP_CODE_ARENA_REGION_SIZE (1024 * 1024)
+#define TP_CODE_ARENA_REGION_NUM_MAX 256
+#define TP_CODE_ARENA_ALIGNMENT_MASK (16 - 1)
+
+#define TP_SHA256_DIGEST_SIZE 32
+#define TP_COMPILE_CACHE_KEY_SIZE TP_SHA256_DIGEST_SIZE
+#define TP_COMPILE_CACHE_BUCKET_NUM 1024
+#define TP_COMPILE_CACHE_BUDGET_DEFAULT (16 * 1024 * 1024)
+
+#define TP_CODE_CACHE_FILE_MAGIC "TPX64BIN"
+#define TP_CODE_CACHE_FILE_VERSION 2 // Increment when TP_CODE_CACHE_FILE_HEADER changes.
+#define TP_CODE_CACHE_FILE_EXT_NAME "tpcode"
+#define TP_X64_CODEGEN_VERSION 1 // Increment when the x64 code of the same source code changes.
+#define TP_CODE_CACHE_CPU_FEATURE_AVX2 0x00000001
+#define TP_CODE_CACHE_CPU_FEATURE_AVX512F 0x00000002
+
+typedef struct tp_code_cache_file_header_{
+    uint8_t member_magic[8];
+    uint32_t member_version;
+    uint32_t member_header_size;
+    uint8_t member_source_hash[TP_COMPILE_CACHE_KEY_SIZE];
+    uint32_t member_codegen_version;
+    uint32_t member_cpu_features; // CPU of the compiler process.
+    uint32_t member_required_cpu_features; // Used by the x64 code.
+    uint32_t member_entry_mode;
+    uint32_t member_x64_simd_isa;
+    uint32_t member_param_count;
+    uint32_t member_x64_code_size;
+    uint8_t member_checksum[TP_SHA256_DIGEST_SIZE]; // SHA-256 of the x64 code.
+}TP_CODE_CACHE_FILE_HEADER;
+
 #define TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size) \
 \
     do{ \
@@ -470,7 +657,8 @@ typedef enum tp_x64_item_kind_{
     TP_X64_ITEM_KIND_NONE = 0,
     TP_X64_ITEM_KIND_X86_32_REGISTER,
     TP_X64_ITEM_KIND_X64_32_REGISTER,
-    TP_X64_ITEM_KIND_MEMORY
+    TP_X64_ITEM_KIND_MEMORY,
+    TP_X64_ITEM_KIND_IMMEDIATE // member_i32: The constant operand of the next instruction(not materialized).
 }TP_X64_ITEM_KIND;
 
 typedef enum tp_x64_item_memory_kind_{
@@ -494,10 +682,21 @@ typedef struct tp_wasm_stack_element_{
     int32_t member_offset;
 }TP_WASM_STACK_ELEMENT;
 
-typedef enum tp_x64_allocate_mode_{
-    TP_X64_ALLOCATE_DEFAULT,
-    TP_X64_ALLOCATE_MEMORY
-}TP_X64_ALLOCATE_MODE;
+// Live range of a value of the wasm value stack or a local variable(see allocate_x64_register function).
+// NOTE: The result of a binary operator continues the live range of op1.
+typedef struct tp_x64_live_range_{
+    uint32_t member_begin; // Index of the wasm instruction which pushes the value(or accesses the local variable first).
+    uint32_t member_end; // Index of the wasm instruction which pops the value(or accesses the local variable last).
+    uint32_t member_use_count; // Spill cost.
+    uint32_t member_forbidden_register_mask; // (1 << TP_X64_64_REGISTER)
+    TP_X64_64_REGISTER member_hint_register;
+    struct tp_x64_live_range_* member_hint_live_range; // Prefers the register of it(coalescing of moves).
+    TP_X64_64_REGISTER member_register; // TP_X64_64_REGISTER_NULL: Spilled to the temporary(or local) variable.
+    int32_t member_offset; // Offset of the temporary variable from the end of local variables.
+    bool member_is_local_variable;
+    bool member_is_load; // The local variable is loaded from the stack frame at the beginning.
+    bool member_is_immediate; // The constant operand of the next instruction(not allocated).
+}TP_X64_LIVE_RANGE;
 
 typedef enum tp_x64_nv64_register_{
     TP_X64_NV64_REGISTER_NULL = 0,
@@ -525,6 +724,9 @@ typedef enum tp_x64_{
     TP_X64_IMUL,
     TP_X64_IDIV,
     TP_X64_XOR,
+    TP_X64_SHL,
+    TP_X64_SAR,
+    TP_X64_SHR,
     TP_X64_NULL
 }TP_X64;
 
@@ -533,16 +735,220 @@ typedef enum tp_x64_direction_{
     TP_X64_DIRECTION_SOURCE_MEMORY
 }TP_X64_DIRECTION;
 
+typedef enum tp_x64_disp_mode_{
+    TP_X64_DISP_MODE_DEFAULT,
+    TP_X64_DISP_MODE_FORCE_DISP32
+}TP_X64_DISP_MODE;
+
+typedef enum tp_x64_operand_size_{
+    TP_X64_OPERAND_SIZE_32,
+    TP_X64_OPERAND_SIZE_64
+}TP_X64_OPERAND_SIZE;
+
+// NOTE: TP_X64_MOV_IMM_MODE_DEFAULT zeroes the register by xor(changes the flags).
+typedef enum tp_x64_mov_imm_mode_{
+    TP_X64_MOV_IMM_MODE_DEFAULT,
+    TP_X64_MOV_IMM_MODE_FORCE_IMM32
+}TP_X64_MOV_IMM_MODE;
+
+// Instruction of the function body for the peephole optimization(see tp_optimize_x64_code.c).
+#define TP_X64_INSTRUCTION_SIZE_ALLOCATE_UNIT 256
+
+typedef enum tp_x64_instruction_kind_{
+    TP_X64_INSTRUCTION_KIND_2_OPERAND, // op dst, src
+    TP_X64_INSTRUCTION_KIND_MOV_IMM,   // mov dst, imm(or xor dst, dst)
+    TP_X64_INSTRUCTION_KIND_ALU_IMM,   // add/sub/xor dst, imm
+    TP_X64_INSTRUCTION_KIND_IMUL_IMM,  // imul dst, src, imm(dst: register)
+    TP_X64_INSTRUCTION_KIND_PUSH,      // push reg64
+    TP_X64_INSTRUCTION_KIND_POP,       // pop reg64
+    TP_X64_INSTRUCTION_KIND_SHIFT_IMM, // shl/sar/shr dst, imm
+    TP_X64_INSTRUCTION_KIND_NEG,       // neg dst
+    TP_X64_INSTRUCTION_KIND_LEA_SCALE, // lea dst, [src+src*imm](imm: 2, 4 or 8)
+    TP_X64_INSTRUCTION_KIND_MUL_HIGH,  // dst = (src * imm) >> 32(movsxd, imul and sar of 64 bits)
+    TP_X64_INSTRUCTION_KIND_CDQ        // cdq(EDX:EAX = sign extended EAX)
+}TP_X64_INSTRUCTION_KIND;
+
+typedef struct tp_x64_instruction_{
+    uint32_t member_offset;
+    uint32_t member_size;
+    TP_X64_INSTRUCTION_KIND member_kind;
+    TP_X64 member_x64_op;
+    TP_WASM_STACK_ELEMENT member_dst;
+    TP_WASM_STACK_ELEMENT member_src;
+    int32_t member_imm;
+    TP_X64_MOV_IMM_MODE member_x64_mov_imm_mode;
+    TP_X64_64_REGISTER member_register; // push and pop.
+    bool member_is_remove;
+    bool member_is_rewrite; // Encoded again from the operands.
+}TP_X64_INSTRUCTION;
+
+// Optimization statistics(written to the log file).
+typedef struct tp_optimization_statistics_{
+    uint32_t member_peephole_forwarded_load_num; // Reloads of the stored values.
+    uint32_t member_peephole_folded_move_num; // Moves folded into the next use.
+    uint32_t member_peephole_removed_self_move_num;
+    uint32_t member_peephole_removed_push_pop_num;
+    uint32_t member_peephole_removed_instruction_num;
+    uint32_t member_peephole_saved_x64_code_size;
+    uint32_t member_strength_reduced_mul_num; // Multiplications by shl or lea.
+    uint32_t member_strength_reduced_div_num; // Divisions by the constant.
+    uint32_t member_immediate_operand_num; // Constants which are not materialized to registers.
+    uint32_t member_frame_elision_num; // Functions without the stack frame.
+    uint32_t member_removed_dead_statement_num; // Statements which do not reach the returned value.
+    uint32_t member_eliminated_common_subexpression_num; // Reuses of the computed values.
+    uint32_t member_common_subexpression_variable_num; // Temporary variables of the computed values.
+    uint32_t member_ir_folded_num; // Constants and algebraic identities.
+    uint32_t member_ir_numbered_num; // Values replaced by the same value number.
+    uint32_t member_ir_removed_num; // Instructions which do not reach the returned value.
+    uint32_t member_ir_local_variable_num;
+}TP_OPTIMIZATION_STATISTICS;
+
+#define TP_X64_PARAM_REGISTER_NUM 4
+#define TP_X64_CALL_ARGS_NUM_MAX 8
+
+// Upper bound of x64 code of one wasm opcode(vector loop: one byte of the wasm code body).
+#define TP_X64_CODE_SIZE_WASM_OPCODE_MAX 256
+// Upper bound of x64 code of END: mov eax, the rest of the batch loop end(5 instructions) and
+// the epilogue(add rsp, pop of the non-volatile registers, pop rbp and ret).
+#define TP_X64_INSTRUCTION_SIZE_MAX 15
+#define TP_X64_CODE_SIZE_END_MAX ((1 + 5 + 1 + TP_X64_NV64_REGISTER_NUM + 2) * TP_X64_INSTRUCTION_SIZE_MAX)
+#define TP_X64_CODE_BUFFER_SIZE_MIN 4096
+
+// NOTE: The x64 code uses the calling convention of Windows x64.
+#if defined(_MSC_VER)
+#define TP_X64_JIT_CALL
+#else
+#define TP_X64_JIT_CALL __attribute__((ms_abi))
+#endif
+
+typedef int32_t (TP_X64_JIT_CALL *TP_X64_JIT_FUNC)(void);
+typedef int32_t (TP_X64_JIT_CALL *TP_X64_JIT_FUNC_ARGS)(
+    int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, int32_t
+);
+typedef int32_t (TP_X64_JIT_CALL *TP_X64_JIT_FUNC_INPUTS)(const int32_t* inputs);
+typedef void (TP_X64_JIT_CALL *TP_X64_JIT_FUNC_BATCH)(const int32_t* const* columns, int32_t* outputs, uint64_t row_count);
+
+typedef enum tp_x64_entry_mode_{
+    TP_X64_ENTRY_MODE_ARGS = 0,         // int32_t f(int32_t, ...)
+    TP_X64_ENTRY_MODE_INPUTS_POINTER,   // int32_t f(const int32_t* inputs)
+    TP_X64_ENTRY_MODE_BATCH             // void f(const int32_t* const* columns, int32_t* outputs, uint64_t row_count)
+}TP_X64_ENTRY_MODE;
+
+// Batch mode: loop state in the frame, after the local variables.
+#define TP_X64_BATCH_SLOT_COLUMNS 0
+#define TP_X64_BATCH_SLOT_OUTPUTS 1
+#define TP_X64_BATCH_SLOT_ROW_COUNT 2
+#define TP_X64_BATCH_SLOT_ROW_INDEX 3
+#define TP_X64_BATCH_SLOT_NUM 4
+
+// Batch mode: vector loop before the scalar loop(see tp_make_x64_simd_code.c).
+typedef enum tp_x64_simd_isa_{
+    TP_X64_SIMD_ISA_NONE = 0,
+    TP_X64_SIMD_ISA_AVX2,   // 8 lanes of ymm.
+    TP_X64_SIMD_ISA_AVX512  // 16 lanes of zmm(AVX-512F).
+}TP_X64_SIMD_ISA;
+
+#define TP_X64_SIMD_REGISTER_NUM 16
+#define TP_X64_SIMD_NV_REGISTER_BEGIN 6 // xmm6-xmm15 are non-volatile.
+#define TP_X64_SIMD_NV_REGISTER_BYTES 16
+#define TP_X64_SIMD_FRAME_SIZE_MAX 2048 // Less than a page: no stack probe.
+
+typedef struct tp_compile_cache_entry_ TP_COMPILE_CACHE_ENTRY;
+
+// Tiered execution: a compiled function starts in the wasm interpreter and
+// tiers up to x64 code after TP_TIER_UP_THRESHOLD calls(batch mode: rows).
+// The interpreter code and the calls are shared by the compiled functions of a cache key.
+#define TP_TIER_UP_THRESHOLD_DEFAULT 1000 // 0: x64 code at once.
+#define TP_WASM_INTERPRETER_FRAME_SIZE 256 // Local variables and wasm stack(int32_t) on the C stack.
+
+typedef enum tp_wasm_interpreter_opcode_{
+    TP_WASM_INTERPRETER_OPCODE_GET_LOCAL = 0,
+    TP_WASM_INTERPRETER_OPCODE_SET_LOCAL,
+    TP_WASM_INTERPRETER_OPCODE_TEE_LOCAL,
+    TP_WASM_INTERPRETER_OPCODE_I32_CONST,
+    TP_WASM_INTERPRETER_OPCODE_I32_ADD,
+    TP_WASM_INTERPRETER_OPCODE_I32_SUB,
+    TP_WASM_INTERPRETER_OPCODE_I32_MUL,
+    TP_WASM_INTERPRETER_OPCODE_I32_DIV,
+    TP_WASM_INTERPRETER_OPCODE_I32_XOR,
+    // get_local or i32.const followed by a binary operator.
+    TP_WASM_INTERPRETER_OPCODE_I32_ADD_LOCAL,
+    TP_WASM_INTERPRETER_OPCODE_I32_SUB_LOCAL,
+    TP_WASM_INTERPRETER_OPCODE_I32_MUL_LOCAL,
+    TP_WASM_INTERPRETER_OPCODE_I32_DIV_LOCAL,
+    TP_WASM_INTERPRETER_OPCODE_I32_XOR_LOCAL,
+    TP_WASM_INTERPRETER_OPCODE_I32_ADD_CONST,
+    TP_WASM_INTERPRETER_OPCODE_I32_SUB_CONST,
+    TP_WASM_INTERPRETER_OPCODE_I32_MUL_CONST,
+    TP_WASM_INTERPRETER_OPCODE_I32_DIV_CONST,
+    TP_WASM_INTERPRETER_OPCODE_I32_XOR_CONST,
+    TP_WASM_INTERPRETER_OPCODE_END,
+    TP_WASM_INTERPRETER_OPCODE_NUM
+}TP_WASM_INTERPRETER_OPCODE;
+
+typedef struct tp_wasm_interpreter_instruction_{
+    TP_WASM_INTERPRETER_OPCODE member_opcode;
+    int32_t member_operand; // Local index or i32 constant(decoded LEB128).
+}TP_WASM_INTERPRETER_INSTRUCTION;
+
+typedef struct tp_wasm_interpreter_code_{
+    TP_WASM_INTERPRETER_INSTRUCTION* member_instruction;
+    uint32_t member_instruction_num;
+    uint32_t member_param_count;
+    uint32_t member_local_num; // Parameters and variables.
+    uint32_t member_stack_depth_max;
+    volatile int64_t member_ref_count; // Compiled functions and the compile cache.
+    volatile int64_t member_call_count; // Calls of all the compiled functions.
+    // Tier up: x64 code of the wasm instructions.
+    uint8_t member_cache_key[TP_COMPILE_CACHE_KEY_SIZE];
+    TP_OPTIMIZATION_LEVEL member_optimization_level; // Same as the cache key.
+    TP_WASM_INSTRUCTION* member_wasm_instruction;
+    uint32_t member_wasm_instruction_num;
+}TP_WASM_INTERPRETER_CODE;
+
+typedef enum tp_tier_up_state_{
+    TP_TIER_UP_STATE_INTERPRETER = 0,
+    TP_TIER_UP_STATE_COMPILING,
+    TP_TIER_UP_STATE_X64,
+    TP_TIER_UP_STATE_FAILED // Keeps the interpreter.
+}TP_TIER_UP_STATE;
+
+typedef struct tp_compiled_function_{
+    TP_COMPILE_CACHE_ENTRY* member_cache_entry; // NULL: member_x64_code is not shared.
+    TP_WASM_INTERPRETER_CODE* member_interpreter_code; // NULL: x64 code only.
+    uint32_t member_tier_up_threshold;
+    volatile int64_t member_tier_up_state; // TP_TIER_UP_STATE
+    uint8_t* member_x64_code; // NULL: before tier up(see tp_tier_up_compiled_function).
+    uint32_t member_x64_code_size;
+    uint32_t member_param_count;
+    TP_X64_ENTRY_MODE member_entry_mode;
+    TP_X64_SIMD_ISA member_x64_simd_isa;
+    TP_X64_JIT_FUNC member_x64_jit_func;
+}TP_COMPILED_FUNCTION;
+
 typedef struct symbol_table_{
 // config section:
+    // TP_CONFIG_OPTION_IS_BATCH 'b'
+    bool member_is_batch;
     // TP_CONFIG_OPTION_IS_OUTPUT_CURRENT_DIR 'c'
     bool member_is_output_current_dir;
+    // TP_CONFIG_OPTION_IS_OUTPUT_ELF_SHARED_OBJECT_FILE 'd'
+    bool member_is_output_elf_shared_object_file;
+    // TP_CONFIG_OPTION_IS_OUTPUT_ELF_OBJECT_FILE 'e'
+    bool member_is_output_elf_object_file;
+    // TP_CONFIG_OPTION_IS_OUTPUT_PHASE_FILE 'i'
+    bool member_is_output_phase_file;
+    // TP_CONFIG_OPTION_IS_BENCHMARK_MODE 'k'
+    bool member_is_benchmark_mode;
+    uint8_t member_benchmark_config[TP_BENCHMARK_CONFIG_STRING_BUFFER_SIZE];
     // TP_CONFIG_OPTION_IS_OUTPUT_LOG_FILE 'l'
     bool member_is_output_log_file;
     // TP_CONFIG_OPTION_IS_NO_OUTPUT_MESSAGES 'm'
     bool member_is_no_output_messages;
     // TP_CONFIG_OPTION_IS_NO_OUTPUT_FILES 'n'
     bool member_is_no_output_files;
+    // TP_CONFIG_OPTION_IS_INPUTS_POINTER 'p'
+    bool member_is_inputs_pointer;
     // TP_CONFIG_OPTION_IS_ORIGIN_WASM 'r'
     bool member_is_origin_wasm;
     // TP_CONFIG_OPTION_IS_SOURCE_CMD_PARAM 's'
@@ -554,6 +960,8 @@ typedef struct symbol_table_{
     bool member_is_output_wasm_file;
     // TP_CONFIG_OPTION_IS_OUTPUT_X64_FILE 'x'
     bool member_is_output_x64_file;
+    // TP_CONFIG_OPTION_OPTIMIZATION_LEVEL 'O'
+    TP_OPTIMIZATION_LEVEL member_optimization_level;
 
 // message section:
     bool member_log_hide_after_disp;
@@ -570,6 +978,10 @@ typedef struct symbol_table_{
     char member_object_hash_file_path[_MAX_PATH];
     char member_wasm_file_path[_MAX_PATH];
     char member_x64_file_path[_MAX_PATH];
+    char member_elf_object_file_path[_MAX_PATH];
+    char member_elf_shared_object_file_path[_MAX_PATH];
+    char member_phase_file_path[_MAX_PATH];
+    char member_phase_trace_file_path[_MAX_PATH];
 
 // input file section:
     uint8_t member_input_file_path[_MAX_PATH];
@@ -592,10 +1004,12 @@ typedef struct symbol_table_{
 // parse tree section:
     uint8_t member_nesting_level_of_expression;
     TP_PARSE_TREE* member_tp_parse_tree;
+    uint64_t member_tp_parse_tree_node_num;
 
 // semantic analysis section:
     REGISTER_OBJECT_HASH member_object_hash;
     uint32_t member_var_count;
+    uint32_t member_param_count; // Undefined variables are input parameters.
     TP_PARSE_TREE* member_last_statement;
     TP_PARSE_TREE_TYPE member_parse_tree_type[TP_PARSE_TREE_TYPE_MAX_NUM2][TP_PARSE_TREE_TYPE_MAX_NUM1];
     uint32_t member_grammer_statement_1_num;
@@ -608,17 +1022,27 @@ typedef struct symbol_table_{
     uint32_t member_grammer_factor_2_num;
     uint32_t member_grammer_factor_3_num;
 
+// SSA IR section:
+    TP_IR_INSTRUCTION* member_ir_instruction; // NULL: The wasm code is made of the parse tree.
+    uint32_t member_ir_instruction_num;
+    uint32_t member_ir_instruction_size;
+    uint32_t member_ir_return_value;
+
 // wasm section:
     TP_WASM_MODULE member_wasm_module;
     size_t member_code_index;
     uint32_t member_code_body_size;
     uint8_t* member_code_section_buffer;
+    TP_WASM_INSTRUCTION* member_wasm_instruction; // NULL: Not decoded yet(see tp_get_wasm_instruction).
+    uint32_t member_wasm_instruction_num;
+    uint32_t member_wasm_instruction_size;
+    uint32_t member_wasm_instruction_param_count;
+    uint32_t member_wasm_instruction_var_count;
+    uint32_t member_wasm_instruction_stack_depth_max;
 
 // x64 section:
     TP_WASM_STACK_ELEMENT* member_stack;
-    uint8_t* member_wasm_code_body_buffer;
-    uint32_t member_wasm_code_body_pos;
-    uint32_t member_wasm_code_body_size;
+    uint32_t member_wasm_instruction_pos;
     int32_t member_stack_pos;
     int32_t member_stack_size;
     int32_t member_stack_size_allocate_unit;
@@ -633,6 +1057,13 @@ typedef struct symbol_table_{
     int32_t member_temporary_variable_size_max;
     int32_t member_padding_temporary_variable_bytes;
 
+    TP_X64_LIVE_RANGE* member_x64_live_range;
+    uint32_t member_x64_live_range_num;
+    uint32_t member_x64_live_range_size;
+    uint32_t member_x64_live_range_pos;
+    TP_X64_LIVE_RANGE* member_x64_local_live_range; // Indexed by the local index.
+    uint32_t member_x64_local_live_range_size;
+
     TP_WASM_STACK_ELEMENT member_use_X86_32_register[TP_X86_32_REGISTER_NUM];
     TP_WASM_STACK_ELEMENT member_use_X64_32_register[TP_X64_32_REGISTER_NUM];
     TP_X64_NV64_REGISTER member_use_nv_register[TP_X64_NV64_REGISTER_NUM];
@@ -641,12 +1072,103 @@ typedef struct symbol_table_{
     int32_t member_padding_register_bytes;
 
     int32_t member_stack_imm32;
+    bool member_is_x64_frame_elision; // No RBP and no stack allocation(see tp_encode_end_code function).
+
+    TP_X64_ENTRY_MODE member_x64_entry_mode;
+    int32_t member_batch_slot_offset;
+    uint32_t member_batch_loop_offset;
+    uint32_t member_batch_exit_jump_offset; // End of JAE rel32(patched at the loop exit).
+
+    TP_X64_SIMD_ISA member_x64_simd_isa;
+    uint32_t member_simd_lane_num;
+    uint32_t member_simd_register_num;
+    uint32_t member_simd_local_variable_size;
+    uint32_t member_simd_nv_register_size;
+    int32_t member_simd_local_variable_offset;
+    int32_t member_simd_nv_register_offset;
+    uint32_t member_simd_loop_offset;
+    uint32_t member_simd_exit_jump_offset; // End of JA rel32(patched at the loop exit).
+    uint32_t member_simd_bail_jump_offset; // End of JMP rel32 to the loop exit(patched at the loop exit).
+
+    TP_X64_INSTRUCTION* member_x64_instruction; // Recorded from the first wasm opcode to END.
+    uint32_t member_x64_instruction_num;
+    uint32_t member_x64_instruction_size;
+    bool member_is_record_x64_instruction;
+
+    TP_OPTIMIZATION_STATISTICS member_optimization_statistics;
+
+// compile phase section:
+    bool member_is_record_compile_phase; // -i or tp_measure_compile_phase.
+    uint64_t member_compile_begin_time;
+    uint64_t member_phase_begin_time;
+    uint64_t member_phase_begin_cpu_time;
+    TP_MEMORY_STATISTICS member_phase_begin_memory_statistics;
+    TP_MEMORY_STATISTICS member_memory_statistics;
+    TP_COMPILE_PHASE_RECORD member_compile_phase_record[TP_COMPILE_PHASE_NUM];
 }TP_SYMBOL_TABLE;
 
 // ----------------------------------------------------------------------------------------
 // Main section:
 bool tp_compiler(int argc, char** argv, uint8_t* msg_buffer, size_t msg_buffer_size);
 
+// Compiled function: compile once, call many times from any thread.
+// Undefined variables are input parameters in order of first use(see TP_X64_ENTRY_MODE).
+bool tp_compile_function(
+    uint8_t* source_code, rsize_t source_code_length, TP_X64_ENTRY_MODE entry_mode,
+    TP_COMPILED_FUNCTION** compiled_function
+);
+// NOTE: Only for TP_X64_ENTRY_MODE_ARGS without input parameters. The other functions are called by
+// tp_call_compiled_function_with_inputs or tp_call_compiled_function_batch.
+bool tp_call_compiled_function(TP_COMPILED_FUNCTION* compiled_function, int32_t* return_value);
+bool tp_call_compiled_function_with_inputs(
+    TP_COMPILED_FUNCTION* compiled_function, const int32_t* inputs, uint32_t input_count, int32_t* return_value
+);
+bool tp_call_compiled_function_batch(
+    TP_COMPILED_FUNCTION* compiled_function,
+    const int32_t* const* columns, uint32_t column_count, int32_t* outputs, uint64_t row_count
+);
+void tp_release_compiled_function(TP_COMPILED_FUNCTION** compiled_function);
+
+// Compile cache: compiled functions of the same source code share x64 code.
+// 0 == budget disables the compile cache.
+void tp_set_compile_cache_budget(size_t budget);
+void tp_clear_compile_cache(void);
+
+// On-disk code cache: NULL == path disables the on-disk code cache(default).
+// NOTE: Set it before compiling in other threads.
+bool tp_set_code_cache_directory(char* path);
+
+// Tiered execution: 0 == threshold compiles x64 code at once(default).
+// NOTE: Set it before compiling in other threads.
+void tp_set_tier_up_threshold(uint32_t threshold);
+
+// Optimization level: TP_OPTIMIZATION_LEVEL_DEFAULT(-O2) runs the full pipeline of the SSA IR.
+// NOTE: Set it before compiling in other threads.
+void tp_set_optimization_level(TP_OPTIMIZATION_LEVEL optimization_level);
+bool tp_tier_up_compiled_function(TP_COMPILED_FUNCTION* compiled_function);
+
+// ELF64 output: the exported symbol is a System V ABI function(NULL == symbol_name: "calc").
+bool tp_write_elf_file(
+    TP_COMPILED_FUNCTION* compiled_function, char* path, char* symbol_name, bool is_shared_object
+);
+
+// Compiles source code once without the compile caches and records each phase.
+bool tp_measure_compile_phase(
+    uint8_t* source_code, rsize_t source_code_length, TP_OPTIMIZATION_LEVEL optimization_level,
+    TP_COMPILE_PHASE_RECORD phase_record[TP_COMPILE_PHASE_NUM]
+);
+
+// ----------------------------------------------------------------------------------------
+// benchmark section:
+bool tp_benchmark(TP_SYMBOL_TABLE* symbol_table);
+
+// Compile phase
+void tp_begin_compile_phase(TP_SYMBOL_TABLE* symbol_table);
+void tp_end_compile_phase(TP_SYMBOL_TABLE* symbol_table, TP_COMPILE_PHASE phase, uint64_t unit_num);
+const char* tp_get_compile_phase_name(TP_COMPILE_PHASE phase);
+const char* tp_get_compile_phase_unit(TP_COMPILE_PHASE phase);
+bool tp_write_compile_phase_file(TP_SYMBOL_TABLE* symbol_table);
+
 // ----------------------------------------------------------------------------------------
 // token section:
 bool tp_make_token(TP_SYMBOL_TABLE* symbol_table, uint8_t* string, rsize_t string_length);
@@ -663,57 +1185,93 @@ void tp_free_parse_subtree(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE** parse_
 // semantic analysis section:
 bool tp_semantic_analysis(TP_SYMBOL_TABLE* symbol_table);
 bool tp_search_object(TP_SYMBOL_TABLE* symbol_table, TP_TOKEN* token, REGISTER_OBJECT* register_object);
+bool tp_get_local_index(TP_SYMBOL_TABLE* symbol_table, TP_TOKEN* token, uint32_t* local_index);
 void tp_free_object_hash(
     TP_SYMBOL_TABLE* symbol_table,
     REGISTER_OBJECT_HASH* object_hash, REGISTER_OBJECT_HASH_ELEMENT* hash_element
 );
 
+// ----------------------------------------------------------------------------------------
+// optimize parse tree section:
+bool tp_optimize_parse_tree(TP_SYMBOL_TABLE* symbol_table);
+
+// ----------------------------------------------------------------------------------------
+// SSA IR section:
+bool tp_make_ir(TP_SYMBOL_TABLE* symbol_table);
+
+// Pass manager: the passes run in order of the pass table until nothing is changed.
+bool tp_optimize_ir(TP_SYMBOL_TABLE* symbol_table);
 
 // ----------------------------------------------------------------------------------------
 // wasm section:
 bool tp_make_wasm(TP_SYMBOL_TABLE* symbol_table, bool is_origin_wasm);
 
+// Makes only the wasm instructions of the code body(x64 code and the wasm interpreter).
+bool tp_make_wasm_instruction(TP_SYMBOL_TABLE* symbol_table);
+
 
 // ----------------------------------------------------------------------------------------
 // x64 section:
 bool tp_make_x64_code(TP_SYMBOL_TABLE* symbol_table, int32_t* return_value);
+bool tp_make_x64_function(TP_SYMBOL_TABLE* symbol_table, uint8_t** x64_code, uint32_t* x64_code_size);
+bool tp_get_wasm_instruction(TP_SYMBOL_TABLE* symbol_table);
+bool tp_validate_wasm_instruction(TP_SYMBOL_TABLE* symbol_table, uint32_t param_count, uint32_t var_count);
 bool tp_wasm_stack_push(TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_ELEMENT* value);
 bool tp_get_local_variable_offset(
     TP_SYMBOL_TABLE* symbol_table, uint32_t local_index, int32_t* local_variable_offset
 );
-bool tp_allocate_temporary_variable(
-    TP_SYMBOL_TABLE* symbol_table, TP_X64_ALLOCATE_MODE allocate_mode,
-    uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t* x64_code_size,
-    TP_WASM_STACK_ELEMENT* wasm_stack_element
+bool tp_allocate_temporary_variable(TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_ELEMENT* wasm_stack_element);
+bool tp_get_scratch_register(
+    TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_ELEMENT* scratch_register, bool* is_zero_free_register
 );
 bool tp_free_register(TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_ELEMENT* stack_element);
-uint32_t tp_encode_allocate_stack(
-    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
-    uint32_t var_count, uint32_t var_type
+void tp_use_x64_register(
+    TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_ELEMENT* wasm_stack_element, TP_X64_64_REGISTER x64_register
+);
+TP_X64_64_REGISTER tp_get_x64_64_register(TP_WASM_STACK_ELEMENT* wasm_stack_element);
+bool tp_prepare_x64_stack_frame(
+    TP_SYMBOL_TABLE* symbol_table, uint32_t param_count, uint32_t var_count, uint32_t var_type
+);
+// NOTE: The prologue of the function without the stack frame may be empty(0 == *x64_code_size).
+bool tp_encode_allocate_stack(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t param_count,
+    uint32_t* x64_code_size
 );
 
 // Variable access
 
-uint32_t tp_encode_get_local_code(
-    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t local_index
+// NOTE: The x64 code size of variable access is 0 when the move is coalesced(see allocate_x64_register function).
+bool tp_encode_get_local_code(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t local_index,
+    uint32_t* x64_code_size
 );
-uint32_t tp_encode_set_local_code(
+bool tp_encode_set_local_code(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t local_index,
-    TP_WASM_STACK_ELEMENT* op1
+    TP_WASM_STACK_ELEMENT* op1, uint32_t* x64_code_size
 );
-uint32_t tp_encode_tee_local_code(
+bool tp_encode_tee_local_code(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t local_index,
-    TP_WASM_STACK_ELEMENT* op1
+    TP_WASM_STACK_ELEMENT* op1, uint32_t* x64_code_size
 );
 
 // Constants
 
-uint32_t tp_encode_i32_const_code(
-    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, int32_t value
+// Lazy materialization: The constant is the immediate operand of the next wasm instruction
+// (add/sub/xor r/m32, imm, imul r32, r/m32, imm, mov r/m32, imm or the strength reduced operator),
+// and the x64 code size of it is 0. Otherwise, it is loaded to the register(xor r32, r32 if it is 0).
+bool tp_is_x64_immediate_operand(uint32_t wasm_opcode, int32_t value);
+
+bool tp_encode_i32_const_code(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, int32_t value,
+    uint32_t* x64_code_size
 );
 
 // Numeric operators(i32)
 
+// Strength reduction: The multiplication by 2^k, 3, 5 or 9 is lowered to shl or lea, and
+// the division by the constant is lowered to the multiplication by the magic number.
+bool tp_is_x64_strength_reduction(uint32_t wasm_opcode, int32_t value);
+
 uint32_t tp_encode_i32_add_code(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
     TP_WASM_STACK_ELEMENT* op1, TP_WASM_STACK_ELEMENT* op2
@@ -734,7 +1292,25 @@ uint32_t tp_encode_i32_xor_code(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
     TP_WASM_STACK_ELEMENT* op1, TP_WASM_STACK_ELEMENT* op2
 );
+// NOTE: The function which has no memory operands and no push/pop in the function body is
+// encoded without the stack frame(the prologue is the pushes of the non-volatile registers and
+// the loads of the parameters only).
 uint32_t tp_encode_end_code(TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset);
+uint32_t tp_encode_batch_loop_begin(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t param_count
+);
+uint32_t tp_encode_batch_loop_end(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, TP_WASM_STACK_ELEMENT* op1
+);
+
+// SIMD(batch mode)
+
+TP_X64_SIMD_ISA tp_get_x64_simd_isa(void);
+void tp_set_x64_simd_isa_max(TP_X64_SIMD_ISA simd_isa_max);
+void tp_prepare_x64_simd_code(TP_SYMBOL_TABLE* symbol_table);
+uint32_t tp_encode_x64_simd_batch_loop(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t param_count
+);
 
 // x64 Assembly
 
@@ -742,6 +1318,91 @@ uint32_t tp_encode_x64_2_operand(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
     TP_X64 x64_op, TP_WASM_STACK_ELEMENT* op1, TP_WASM_STACK_ELEMENT* op2
 );
+uint32_t tp_encode_x64_memory_operand(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_OPERAND_SIZE x64_operand_size, uint8_t opcode, TP_X64_64_REGISTER reg64,
+    TP_X64_64_REGISTER reg64_base, TP_X64_64_REGISTER reg64_index, uint8_t scale, int32_t offset,
+    TP_X64_DISP_MODE x64_disp_mode
+);
+uint32_t tp_encode_x64_mov_memory(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_DIRECTION x64_direction, TP_X64_OPERAND_SIZE x64_operand_size,
+    TP_X64_64_REGISTER reg64, TP_X64_64_REGISTER reg64_base, int32_t offset, TP_X64_DISP_MODE x64_disp_mode
+);
+uint32_t tp_encode_x64_jcc_rel32(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint8_t opcode, int32_t rel32
+);
+uint32_t tp_encode_x64_jmp_rel32(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, int32_t rel32
+);
+void tp_patch_x64_imm32(uint8_t* x64_code_buffer, uint32_t x64_code_offset, int32_t imm32);
+uint32_t tp_encode_x64_instruction(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_INSTRUCTION* x64_instruction
+);
+
+// Peephole optimization
+
+bool tp_append_x64_instruction(TP_SYMBOL_TABLE* symbol_table, TP_X64_INSTRUCTION* x64_instruction);
+bool tp_optimize_x64_code(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_begin, uint32_t* x64_code_size,
+    TP_WASM_STACK_ELEMENT* result
+);
+
+// Code arena
+
+// NOTE: The code is written through writable_code and executed at code. The slot is published to
+// the other threads after tp_code_arena_publish.
+bool tp_code_arena_allocate(TP_SYMBOL_TABLE* symbol_table, uint32_t size, uint8_t** code, uint8_t** writable_code);
+bool tp_code_arena_publish(TP_SYMBOL_TABLE* symbol_table, uint8_t* code, uint32_t size);
+bool tp_code_arena_free(TP_SYMBOL_TABLE* symbol_table, uint8_t* code);
+
+// Compile cache
+
+void tp_make_compile_cache_key(
+    uint8_t* source_code, rsize_t source_code_length, TP_X64_ENTRY_MODE entry_mode,
+    TP_OPTIMIZATION_LEVEL optimization_level, uint8_t key[TP_COMPILE_CACHE_KEY_SIZE]
+);
+bool tp_compile_cache_lookup(uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], TP_COMPILED_FUNCTION* compiled_function);
+bool tp_compile_cache_insert(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], TP_COMPILED_FUNCTION* compiled_function
+);
+void tp_compile_cache_release(TP_COMPILE_CACHE_ENTRY* entry);
+bool tp_compile_cache_lookup_interpreter(
+    uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], TP_WASM_INTERPRETER_CODE** interpreter_code
+);
+bool tp_compile_cache_insert_interpreter(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], TP_WASM_INTERPRETER_CODE** interpreter_code
+);
+void tp_calc_sha256(const uint8_t* data, size_t size, uint8_t digest[TP_SHA256_DIGEST_SIZE]);
+
+// On-disk code cache
+
+bool tp_load_code_cache_file(
+    uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], TP_X64_ENTRY_MODE entry_mode, TP_COMPILED_FUNCTION* compiled_function
+);
+bool tp_save_code_cache_file(uint8_t key[TP_COMPILE_CACHE_KEY_SIZE], TP_COMPILED_FUNCTION* compiled_function);
+
+// wasm interpreter
+
+TP_WASM_INTERPRETER_CODE* tp_make_wasm_interpreter_code(TP_SYMBOL_TABLE* symbol_table);
+void tp_add_ref_wasm_interpreter_code(TP_WASM_INTERPRETER_CODE* interpreter_code);
+void tp_release_wasm_interpreter_code(TP_WASM_INTERPRETER_CODE** interpreter_code);
+bool tp_run_wasm_interpreter(
+    TP_WASM_INTERPRETER_CODE* interpreter_code, const int32_t* inputs, int32_t* return_value
+);
+bool tp_run_wasm_interpreter_batch(
+    TP_WASM_INTERPRETER_CODE* interpreter_code,
+    const int32_t* const* columns, int32_t* outputs, uint64_t row_count
+);
+
+// ELF64 output
+
+bool tp_make_elf_file(
+    TP_SYMBOL_TABLE* symbol_table, char* path, char* symbol_name,
+    uint8_t* x64_code, uint32_t x64_code_size, uint32_t param_count, TP_X64_ENTRY_MODE entry_mode,
+    bool is_shared_object
+);
 
 
 // ----------------------------------------------------------------------------------------
@@ -765,6 +1426,10 @@ int32_t tp_decode_si32leb128(uint8_t* buffer, uint32_t* size);
 uint32_t tp_decode_ui32leb128(uint8_t* buffer, uint32_t* size);
 
 // Utilities
+uint64_t tp_get_wall_time(void);
+uint64_t tp_get_cpu_time(void);
+void* tp_calloc(TP_SYMBOL_TABLE* symbol_table, size_t num, size_t size, uint8_t* file, size_t line_num);
+void* tp_realloc(TP_SYMBOL_TABLE* symbol_table, void* ptr, size_t size, uint8_t* file, size_t line_num);
 void tp_free(TP_SYMBOL_TABLE* symbol_table, void** ptr, size_t size, uint8_t* file, uint8_t* func, size_t line_num);
 void tp_free2(TP_SYMBOL_TABLE* symbol_table, void*** ptr, size_t size, uint8_t* file, uint8_t* func, size_t line_num);
 void tp_get_last_error(TP_SYMBOL_TABLE* symbol_table, uint8_t* file, uint8_t* func, size_t line_num);
@@ -775,5 +1440,20 @@ bool tp_put_log_msg(
     TP_LOG_PARAM_ELEMENT* log_param_element, size_t log_param_element_num
 );
 
+#if ! defined(_WIN32)
+// Microsoft CRT
+errno_t fopen_s(FILE** file_stream, const char* path, const char* mode);
+errno_t localtime_s(struct tm* local_time, const time_t* now);
+errno_t strerror_s(char* buffer, size_t buffer_size, int error_number);
+errno_t strncpy_s(char* dest, size_t dest_size, const char* src, size_t count);
+errno_t _splitpath_s(
+    const char* path, char* drive, size_t drive_size, char* dir, size_t dir_size,
+    char* fname, size_t fname_size, char* ext, size_t ext_size
+);
+errno_t _makepath_s(
+    char* path, size_t path_size, const char* drive, const char* dir, const char* fname, const char* ext
+);
+#endif
+
 #endif
 
@@ -1,18 +1,23 @@
 
 // (C) Shin'ichi Ichikawa. Released under the MIT license.
 
+#if defined(_WIN32)
 #include <io.h>
+#endif
 #include <fcntl.h>
 #include <time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#if defined(_WIN32)
 #include <share.h>
+#endif
 #include "tp_compiler.h"
 
 bool tp_open_read_file(TP_SYMBOL_TABLE* symbol_table, char* path, FILE** file_stream)
 {
     int fd = 0;
 
+#if defined(_WIN32)
     errno_t _sopen_s_error = _sopen_s(&fd, path, _O_RDONLY | _O_BINARY, _SH_DENYWR, 0);
 
     if (_sopen_s_error){
@@ -23,6 +28,18 @@ bool tp_open_read_file(TP_SYMBOL_TABLE* symbol_table, char* path, FILE** file_st
     }
   
     FILE* stream = _fdopen(fd, "rb");
+#else
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (-1 == fd){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    FILE* stream = fdopen(fd, "rb");
+#endif
 
     if (NULL == stream){
 
@@ -0,0 +1,1221 @@
+
+// (C) Shin'ichi Ichikawa. Released under the MIT license.
+
+#include "tp_compiler.h"
+
+// ELF64 output(x86-64 System V):
+// The x64 code uses the Windows x64 calling convention, so .text starts with
+// a System V entry point(the exported symbol) which moves the arguments to
+// RCX, RDX, R8, R9 and the stack, and calls the x64 code(a local symbol).
+// .eh_frame describes both functions. A relocatable object(ET_REL) refers to
+// .text by R_X86_64_PC32 relocations, a shared object(ET_DYN) is loaded
+// without any dynamic relocation.
+//
+// C prototypes of the exported symbol:
+//   TP_X64_ENTRY_MODE_ARGS:           int32_t name(int32_t, ...); // Up to 8 parameters.
+//   TP_X64_ENTRY_MODE_INPUTS_POINTER: int32_t name(const int32_t* inputs);
+//   TP_X64_ENTRY_MODE_BATCH:          void name(const int32_t* const* columns, int32_t* outputs, uint64_t row_count);
+
+#define TP_ELF_CLASS_64 2
+#define TP_ELF_DATA_2LSB 1
+#define TP_ELF_VERSION_CURRENT 1
+#define TP_ELF_OSABI_SYSV 0
+#define TP_ELF_TYPE_REL 1
+#define TP_ELF_TYPE_DYN 3
+#define TP_ELF_MACHINE_X86_64 62
+
+#define TP_ELF_SHT_NULL 0
+#define TP_ELF_SHT_PROGBITS 1
+#define TP_ELF_SHT_SYMTAB 2
+#define TP_ELF_SHT_STRTAB 3
+#define TP_ELF_SHT_RELA 4
+#define TP_ELF_SHT_HASH 5
+#define TP_ELF_SHT_DYNAMIC 6
+#define TP_ELF_SHT_DYNSYM 11
+#define TP_ELF_SHT_X86_64_UNWIND 0x70000001
+
+#define TP_ELF_SHF_WRITE 0x1
+#define TP_ELF_SHF_ALLOC 0x2
+#define TP_ELF_SHF_EXECINSTR 0x4
+#define TP_ELF_SHF_INFO_LINK 0x40
+
+#define TP_ELF_PT_LOAD 1
+#define TP_ELF_PT_DYNAMIC 2
+#define TP_ELF_PT_GNU_EH_FRAME 0x6474e550
+#define TP_ELF_PT_GNU_STACK 0x6474e551
+#define TP_ELF_PF_X 0x1
+#define TP_ELF_PF_W 0x2
+#define TP_ELF_PF_R 0x4
+#define TP_ELF_PAGE_SIZE 0x1000
+
+#define TP_ELF_STB_LOCAL 0
+#define TP_ELF_STB_GLOBAL 1
+#define TP_ELF_STT_FUNC 2
+#define TP_ELF_STT_SECTION 3
+#define TP_ELF_ST_INFO(bind, type) ((uint8_t)(((bind) << 4) | (type)))
+
+#define TP_ELF_R_X86_64_PC32 2
+#define TP_ELF_R_INFO(sym, type) ((((uint64_t)(sym)) << 32) | (type))
+
+#define TP_ELF_DT_NULL 0
+#define TP_ELF_DT_HASH 4
+#define TP_ELF_DT_STRTAB 5
+#define TP_ELF_DT_SYMTAB 6
+#define TP_ELF_DT_STRSZ 10
+#define TP_ELF_DT_SYMENT 11
+
+// DWARF call frame information.
+#define TP_DW_CFA_NOP 0x00
+#define TP_DW_CFA_ADVANCE_LOC1 0x02
+#define TP_DW_CFA_ADVANCE_LOC2 0x03
+#define TP_DW_CFA_ADVANCE_LOC4 0x04
+#define TP_DW_CFA_DEF_CFA 0x0c
+#define TP_DW_CFA_DEF_CFA_REGISTER 0x0d
+#define TP_DW_CFA_DEF_CFA_OFFSET 0x0e
+#define TP_DW_CFA_ADVANCE_LOC 0x40
+#define TP_DW_CFA_OFFSET 0x80
+#define TP_DW_EH_PE_UDATA4 0x03
+#define TP_DW_EH_PE_PCREL_SDATA4 0x1b
+#define TP_DW_EH_PE_DATAREL_SDATA4 0x3b
+#define TP_DW_REGISTER_RSP 7
+#define TP_DW_REGISTER_RBP 6
+#define TP_DW_REGISTER_RA 16
+
+#define TP_ELF_EH_FRAME_SIZE_MAX 256
+#define TP_ELF_FDE_NUM 2 // System V entry point and x64 code.
+#define TP_ELF_THUNK_STACK_SIZE 64 // Home space and 4 stack parameters.
+#define TP_ELF_SYMBOL_NAME_LENGTH_MAX 128
+#define TP_ELF_BODY_SYMBOL_SUFFIX "_ms_abi"
+
+typedef struct tp_elf64_ehdr_{
+    uint8_t member_ident[16];
+    uint16_t member_type;
+    uint16_t member_machine;
+    uint32_t member_version;
+    uint64_t member_entry;
+    uint64_t member_phoff;
+    uint64_t member_shoff;
+    uint32_t member_flags;
+    uint16_t member_ehsize;
+    uint16_t member_phentsize;
+    uint16_t member_phnum;
+    uint16_t member_shentsize;
+    uint16_t member_shnum;
+    uint16_t member_shstrndx;
+}TP_ELF64_EHDR;
+
+typedef struct tp_elf64_phdr_{
+    uint32_t member_type;
+    uint32_t member_flags;
+    uint64_t member_offset;
+    uint64_t member_vaddr;
+    uint64_t member_paddr;
+    uint64_t member_filesz;
+    uint64_t member_memsz;
+    uint64_t member_align;
+}TP_ELF64_PHDR;
+
+typedef struct tp_elf64_shdr_{
+    uint32_t member_name;
+    uint32_t member_type;
+    uint64_t member_flags;
+    uint64_t member_addr;
+    uint64_t member_offset;
+    uint64_t member_size;
+    uint32_t member_link;
+    uint32_t member_info;
+    uint64_t member_addralign;
+    uint64_t member_entsize;
+}TP_ELF64_SHDR;
+
+typedef struct tp_elf64_sym_{
+    uint32_t member_name;
+    uint8_t member_info;
+    uint8_t member_other;
+    uint16_t member_shndx;
+    uint64_t member_value;
+    uint64_t member_size;
+}TP_ELF64_SYM;
+
+typedef struct tp_elf64_rela_{
+    uint64_t member_offset;
+    uint64_t member_info;
+    int64_t member_addend;
+}TP_ELF64_RELA;
+
+typedef struct tp_elf64_dyn_{
+    int64_t member_tag;
+    uint64_t member_val;
+}TP_ELF64_DYN;
+
+// .text and .eh_frame(independent of the file type).
+typedef struct tp_elf_text_{
+    uint8_t* member_text;
+    uint32_t member_text_size;
+    uint32_t member_thunk_size;
+    uint32_t member_body_offset;
+    uint32_t member_body_size;
+    uint8_t member_eh_frame[TP_ELF_EH_FRAME_SIZE_MAX];
+    uint32_t member_eh_frame_size;
+    uint32_t member_fde_num;
+    uint32_t member_fde_offset[TP_ELF_FDE_NUM];
+    uint32_t member_pc_begin_offset[TP_ELF_FDE_NUM]; // Offset of the pc_begin field in .eh_frame.
+    uint32_t member_pc_begin[TP_ELF_FDE_NUM]; // Offset in .text.
+}TP_ELF_TEXT;
+
+static bool is_valid_symbol_name(TP_SYMBOL_TABLE* symbol_table, char* symbol_name);
+static bool make_elf_text(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code, uint32_t x64_code_size,
+    uint32_t param_count, TP_X64_ENTRY_MODE entry_mode, TP_ELF_TEXT* text
+);
+static uint32_t encode_sysv_thunk(uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t arg_count, int32_t body_rel32);
+static uint32_t encode_thunk_bytes(uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint8_t* bytes, uint32_t bytes_size);
+static bool make_eh_frame(TP_SYMBOL_TABLE* symbol_table, TP_ELF_TEXT* text);
+static bool make_body_cfa_instructions(
+    TP_ELF_TEXT* text, uint8_t* body, uint32_t body_size, uint8_t* cfa, uint32_t* cfa_size, uint32_t cfa_size_max
+);
+static void put_eh_frame_advance_loc(uint8_t* cfa, uint32_t* cfa_size, uint32_t delta);
+static void put_eh_frame_uleb128(uint8_t* buffer, uint32_t* offset, uint32_t value);
+static void put_eh_frame_sleb128(uint8_t* buffer, uint32_t* offset, int32_t value);
+static void put_eh_frame_uint32(uint8_t* buffer, uint32_t offset, uint32_t value);
+static void patch_eh_frame_pc_begin(TP_ELF_TEXT* text, uint64_t eh_frame_addr, uint64_t text_addr);
+static bool make_elf_relocatable_object(
+    TP_SYMBOL_TABLE* symbol_table, char* path, char* symbol_name, TP_ELF_TEXT* text
+);
+static bool make_elf_shared_object(
+    TP_SYMBOL_TABLE* symbol_table, char* path, char* symbol_name, TP_ELF_TEXT* text
+);
+static void set_elf_header(TP_ELF64_EHDR* ehdr, uint16_t type);
+static uint64_t align_up(uint64_t value, uint64_t alignment);
+
+bool tp_write_elf_file(
+    TP_COMPILED_FUNCTION* compiled_function, char* path, char* symbol_name, bool is_shared_object)
+{
+    if ((NULL == compiled_function) || (NULL == path)){
+
+        fprintf_s(stderr, "ERROR: bad parameter at %s function.\n", __func__);
+
+        return false;
+    }
+
+    // NOTE: The interpreter of tiered execution has no x64 code yet.
+    if ( ! tp_tier_up_compiled_function(compiled_function)){
+
+        fprintf_s(stderr, "ERROR: tp_tier_up_compiled_function failed at %s function.\n", __func__);
+
+        return false;
+    }
+
+    if ( ! tp_make_elf_file(
+        NULL, path, (symbol_name ? symbol_name : TP_ELF_DEFAULT_SYMBOL_NAME),
+        compiled_function->member_x64_code, compiled_function->member_x64_code_size,
+        compiled_function->member_param_count, compiled_function->member_entry_mode, is_shared_object)){
+
+        fprintf_s(stderr, "ERROR: tp_make_elf_file failed at %s function.\n", __func__);
+
+        return false;
+    }
+
+    return true;
+}
+
+bool tp_make_elf_file(
+    TP_SYMBOL_TABLE* symbol_table, char* path, char* symbol_name,
+    uint8_t* x64_code, uint32_t x64_code_size, uint32_t param_count, TP_X64_ENTRY_MODE entry_mode,
+    bool is_shared_object)
+{
+    if ((NULL == path) || (NULL == x64_code) || (0 == x64_code_size)){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! is_valid_symbol_name(symbol_table, symbol_name)){
+
+        return false;
+    }
+
+    TP_ELF_TEXT text = { 0 };
+
+    if ( ! make_elf_text(symbol_table, x64_code, x64_code_size, param_count, entry_mode, &text)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    bool status = (is_shared_object ?
+        make_elf_shared_object(symbol_table, path, symbol_name, &text) :
+        make_elf_relocatable_object(symbol_table, path, symbol_name, &text));
+
+    if ( ! status){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+    }
+
+    TP_FREE(symbol_table, &(text.member_text), text.member_text_size);
+
+    return status;
+}
+
+static bool is_valid_symbol_name(TP_SYMBOL_TABLE* symbol_table, char* symbol_name)
+{
+    size_t length = (symbol_name ? strlen(symbol_name) : 0);
+
+    bool is_valid = ((0 < length) && (TP_ELF_SYMBOL_NAME_LENGTH_MAX >= length) && ( ! isdigit((uint8_t)symbol_name[0])));
+
+    for (size_t i = 0; is_valid && (length > i); ++i){
+
+        if ( ! (isalnum((uint8_t)symbol_name[i]) || ('_' == symbol_name[i]))){
+
+            is_valid = false;
+        }
+    }
+
+    if ( ! is_valid){
+
+        if (NULL == symbol_table){
+
+            fprintf_s(stderr, "ERROR: bad ELF symbol name(%s) at %s function.\n", (symbol_name ? symbol_name : "NULL"), __func__);
+        }else{
+
+            TP_PUT_LOG_MSG(
+                symbol_table, TP_LOG_TYPE_DISP_FORCE,
+                TP_MSG_FMT("ERROR: bad ELF symbol name(%1)."),
+                TP_LOG_PARAM_STRING(symbol_name ? symbol_name : "NULL")
+            );
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool make_elf_text(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code, uint32_t x64_code_size,
+    uint32_t param_count, TP_X64_ENTRY_MODE entry_mode, TP_ELF_TEXT* text)
+{
+    // Arguments of the System V entry point.
+    uint32_t arg_count = 0;
+
+    switch (entry_mode){
+    case TP_X64_ENTRY_MODE_ARGS:
+        if (TP_X64_CALL_ARGS_NUM_MAX < param_count){
+
+            TP_PUT_LOG_MSG(
+                symbol_table, TP_LOG_TYPE_DISP_FORCE,
+                TP_MSG_FMT("ERROR: TP_X64_CALL_ARGS_NUM_MAX(%1) < param_count(%2)"),
+                TP_LOG_PARAM_INT32_VALUE(TP_X64_CALL_ARGS_NUM_MAX),
+                TP_LOG_PARAM_UINT64_VALUE(param_count)
+            );
+
+            return false;
+        }
+        arg_count = param_count;
+        break;
+    case TP_X64_ENTRY_MODE_INPUTS_POINTER:
+        arg_count = 1;
+        break;
+    case TP_X64_ENTRY_MODE_BATCH:
+        arg_count = 3;
+        break;
+    default:
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+        return false;
+    }
+
+    uint32_t thunk_size = encode_sysv_thunk(NULL, 0, arg_count, 0);
+    uint32_t body_offset = (uint32_t)align_up(thunk_size, 16);
+
+    text->member_text_size = body_offset + x64_code_size;
+    text->member_text = (uint8_t*)TP_CALLOC(symbol_table, text->member_text_size, sizeof(uint8_t));
+
+    if (NULL == text->member_text){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    // NOTE: rel32 of call is relative to the next instruction(leave; ret).
+    (void)encode_sysv_thunk(text->member_text, 0, arg_count, (int32_t)(body_offset - (thunk_size - 2)));
+
+    // int 3
+    memset(text->member_text + thunk_size, 0xcc, body_offset - thunk_size);
+
+    memcpy(text->member_text + body_offset, x64_code, x64_code_size);
+
+    text->member_thunk_size = thunk_size;
+    text->member_body_offset = body_offset;
+    text->member_body_size = x64_code_size;
+
+    if ( ! make_eh_frame(symbol_table, text)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        TP_FREE(symbol_table, &(text->member_text), text->member_text_size);
+
+        return false;
+    }
+
+    return true;
+}
+
+static uint32_t encode_sysv_thunk(uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t arg_count, int32_t body_rel32)
+{
+    uint32_t x64_code_size = 0;
+
+    // push rbp; mov rbp, rsp; sub rsp, 64
+    static uint8_t prologue[] = { 0x55, 0x48, 0x89, 0xe5, 0x48, 0x83, 0xec, TP_ELF_THUNK_STACK_SIZE };
+
+    x64_code_size += encode_thunk_bytes(x64_code_buffer, x64_code_offset + x64_code_size, prologue, sizeof(prologue));
+
+    // Parameters 5 to 8 are on the stack(Windows x64 calling convention).
+    static uint8_t store_r8[] = { 0x4c, 0x89, 0x44, 0x24, 0x20 }; // mov QWORD PTR [rsp+32], r8
+    static uint8_t store_r9[] = { 0x4c, 0x89, 0x4c, 0x24, 0x28 }; // mov QWORD PTR [rsp+40], r9
+    static uint8_t store_arg7[] = {
+        0x48, 0x8b, 0x45, 0x10, // mov rax, QWORD PTR [rbp+16]
+        0x48, 0x89, 0x44, 0x24, 0x30 // mov QWORD PTR [rsp+48], rax
+    };
+    static uint8_t store_arg8[] = {
+        0x48, 0x8b, 0x45, 0x18, // mov rax, QWORD PTR [rbp+24]
+        0x48, 0x89, 0x44, 0x24, 0x38 // mov QWORD PTR [rsp+56], rax
+    };
+
+    if (4 < arg_count){ x64_code_size += encode_thunk_bytes(x64_code_buffer, x64_code_offset + x64_code_size, store_r8, sizeof(store_r8)); }
+    if (5 < arg_count){ x64_code_size += encode_thunk_bytes(x64_code_buffer, x64_code_offset + x64_code_size, store_r9, sizeof(store_r9)); }
+    if (6 < arg_count){ x64_code_size += encode_thunk_bytes(x64_code_buffer, x64_code_offset + x64_code_size, store_arg7, sizeof(store_arg7)); }
+    if (7 < arg_count){ x64_code_size += encode_thunk_bytes(x64_code_buffer, x64_code_offset + x64_code_size, store_arg8, sizeof(store_arg8)); }
+
+    // NOTE: R9 and R8 are stored before they are overwritten.
+    static uint8_t mov_r9_rcx[] = { 0x49, 0x89, 0xc9 };
+    static uint8_t mov_r8_rdx[] = { 0x49, 0x89, 0xd0 };
+    static uint8_t mov_rdx_rsi[] = { 0x48, 0x89, 0xf2 };
+    static uint8_t mov_rcx_rdi[] = { 0x48, 0x89, 0xf9 };
+
+    if (3 < arg_count){ x64_code_size += encode_thunk_bytes(x64_code_buffer, x64_code_offset + x64_code_size, mov_r9_rcx, sizeof(mov_r9_rcx)); }
+    if (2 < arg_count){ x64_code_size += encode_thunk_bytes(x64_code_buffer, x64_code_offset + x64_code_size, mov_r8_rdx, sizeof(mov_r8_rdx)); }
+    if (1 < arg_count){ x64_code_size += encode_thunk_bytes(x64_code_buffer, x64_code_offset + x64_code_size, mov_rdx_rsi, sizeof(mov_rdx_rsi)); }
+    if (0 < arg_count){ x64_code_size += encode_thunk_bytes(x64_code_buffer, x64_code_offset + x64_code_size, mov_rcx_rdi, sizeof(mov_rcx_rdi)); }
+
+    // call rel32; leave; ret
+    uint8_t call_leave_ret[] = {
+        0xe8,
+        (uint8_t)body_rel32, (uint8_t)(body_rel32 >> 8), (uint8_t)(body_rel32 >> 16), (uint8_t)(body_rel32 >> 24),
+        0xc9, 0xc3
+    };
+
+    x64_code_size += encode_thunk_bytes(x64_code_buffer, x64_code_offset + x64_code_size, call_leave_ret, sizeof(call_leave_ret));
+
+    return x64_code_size;
+}
+
+static uint32_t encode_thunk_bytes(uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint8_t* bytes, uint32_t bytes_size)
+{
+    if (x64_code_buffer){
+
+        memcpy(x64_code_buffer + x64_code_offset, bytes, bytes_size);
+    }
+
+    return bytes_size;
+}
+
+static bool make_eh_frame(TP_SYMBOL_TABLE* symbol_table, TP_ELF_TEXT* text)
+{
+    uint8_t* eh_frame = text->member_eh_frame;
+    uint32_t offset = 0;
+
+    // CIE
+    {
+        uint32_t cie_offset = offset;
+
+        offset += sizeof(uint32_t); // length
+        put_eh_frame_uint32(eh_frame, offset, 0); // CIE_id
+        offset += sizeof(uint32_t);
+        eh_frame[offset++] = 1; // version
+        eh_frame[offset++] = 'z';
+        eh_frame[offset++] = 'R';
+        eh_frame[offset++] = '\0';
+        put_eh_frame_uleb128(eh_frame, &offset, 1); // code_alignment_factor
+        put_eh_frame_sleb128(eh_frame, &offset, -8); // data_alignment_factor
+        put_eh_frame_uleb128(eh_frame, &offset, TP_DW_REGISTER_RA);
+        put_eh_frame_uleb128(eh_frame, &offset, 1); // augmentation_length
+        eh_frame[offset++] = TP_DW_EH_PE_PCREL_SDATA4; // FDE encoding
+
+        // CFA = rsp + 8, return address = [CFA - 8]
+        eh_frame[offset++] = TP_DW_CFA_DEF_CFA;
+        put_eh_frame_uleb128(eh_frame, &offset, TP_DW_REGISTER_RSP);
+        put_eh_frame_uleb128(eh_frame, &offset, sizeof(uint64_t));
+        eh_frame[offset++] = TP_DW_CFA_OFFSET | TP_DW_REGISTER_RA;
+        put_eh_frame_uleb128(eh_frame, &offset, 1);
+
+        offset = (uint32_t)align_up(offset, sizeof(uint64_t)); // DW_CFA_nop
+
+        put_eh_frame_uint32(eh_frame, cie_offset, offset - cie_offset - sizeof(uint32_t));
+    }
+
+    // FDE of the System V entry point and the x64 code.
+    for (uint32_t i = 0; TP_ELF_FDE_NUM > i; ++i){
+
+        uint8_t cfa[TP_ELF_EH_FRAME_SIZE_MAX / 2] = { 0 };
+        uint32_t cfa_size = 0;
+
+        uint32_t pc_begin = 0;
+        uint32_t pc_range = 0;
+
+        if (0 == i){
+
+            pc_begin = 0;
+            pc_range = text->member_thunk_size;
+
+            // push rbp: CFA = rsp + 16, rbp = [CFA - 16]
+            put_eh_frame_advance_loc(cfa, &cfa_size, 1);
+            cfa[cfa_size++] = TP_DW_CFA_DEF_CFA_OFFSET;
+            put_eh_frame_uleb128(cfa, &cfa_size, 16);
+            cfa[cfa_size++] = TP_DW_CFA_OFFSET | TP_DW_REGISTER_RBP;
+            put_eh_frame_uleb128(cfa, &cfa_size, 2);
+
+            // mov rbp, rsp: CFA = rbp + 16
+            put_eh_frame_advance_loc(cfa, &cfa_size, 3);
+            cfa[cfa_size++] = TP_DW_CFA_DEF_CFA_REGISTER;
+            put_eh_frame_uleb128(cfa, &cfa_size, TP_DW_REGISTER_RBP);
+
+            // leave: CFA = rsp + 8
+            put_eh_frame_advance_loc(cfa, &cfa_size, text->member_thunk_size - 1 - 4);
+            cfa[cfa_size++] = TP_DW_CFA_DEF_CFA;
+            put_eh_frame_uleb128(cfa, &cfa_size, TP_DW_REGISTER_RSP);
+            put_eh_frame_uleb128(cfa, &cfa_size, sizeof(uint64_t));
+        }else{
+
+            pc_begin = text->member_body_offset;
+            pc_range = text->member_body_size;
+
+            if ( ! make_body_cfa_instructions(
+                text, text->member_text + text->member_body_offset, text->member_body_size,
+                cfa, &cfa_size, sizeof(cfa))){
+
+                // NOTE: Unknown prologue: no unwind information of the x64 code.
+                break;
+            }
+        }
+
+        uint32_t fde_offset = offset;
+
+        if (TP_ELF_EH_FRAME_SIZE_MAX < (fde_offset + 4 * sizeof(uint32_t) + 1 + cfa_size + sizeof(uint64_t) * 2)){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return false;
+        }
+
+        offset += sizeof(uint32_t); // length
+        put_eh_frame_uint32(eh_frame, offset, offset); // CIE_pointer
+        offset += sizeof(uint32_t);
+
+        text->member_fde_offset[i] = fde_offset;
+        text->member_pc_begin_offset[i] = offset;
+        text->member_pc_begin[i] = pc_begin;
+        offset += sizeof(uint32_t); // pc_begin(see patch_eh_frame_pc_begin function)
+        put_eh_frame_uint32(eh_frame, offset, pc_range);
+        offset += sizeof(uint32_t);
+        put_eh_frame_uleb128(eh_frame, &offset, 0); // augmentation_length
+
+        memcpy(eh_frame + offset, cfa, cfa_size);
+        offset += cfa_size;
+
+        offset = (uint32_t)align_up(offset, sizeof(uint64_t)); // DW_CFA_nop
+
+        put_eh_frame_uint32(eh_frame, fde_offset, offset - fde_offset - sizeof(uint32_t));
+
+        ++(text->member_fde_num);
+    }
+
+    // Terminator.
+    put_eh_frame_uint32(eh_frame, offset, 0);
+    offset += sizeof(uint32_t);
+
+    text->member_eh_frame_size = offset;
+
+    return true;
+}
+
+static bool make_body_cfa_instructions(
+    TP_ELF_TEXT* text, uint8_t* body, uint32_t body_size, uint8_t* cfa, uint32_t* cfa_size, uint32_t cfa_size_max)
+{
+    // Prologue(see tp_encode_allocate_stack function):
+    //   push rbp; push non-volatile registers; sub rsp, imm8 or imm32; lea rbp, [rsp+32]
+    // Epilogue(see tp_encode_end_code function):
+    //   ...; pop rbp; ret
+    // Prologue and epilogue of the function without the stack frame:
+    //   push non-volatile registers; ...; pop non-volatile registers; ret
+    static const uint8_t dwarf_register[] = {
+        0, 2, 1, 3, 7, 6, 4, 5, 8, 9, 10, 11, 12, 13, 14, 15 // RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8-R15
+    };
+
+    uint32_t pos = 0;
+    uint32_t prev_pos = 0;
+    uint32_t cfa_offset = sizeof(uint64_t);
+
+    if ((pos < body_size) && (0xcc == body[pos])){ // TP_DEBUG_BREAK
+
+        ++pos;
+    }
+
+    bool is_frame = ((pos < body_size) && (0x55 == body[pos]));
+    uint32_t push_bytes = 0;
+
+    while (true){
+
+        uint8_t reg64 = 0;
+        uint32_t push_size = 0;
+
+        if ((0 == push_bytes) && is_frame){ // push rbp
+
+            reg64 = 5;
+            push_size = 1;
+        }else if ((pos < body_size) && ((0x53 == body[pos]) || (0x56 == body[pos]) || (0x57 == body[pos]))){
+
+            // push rbx, rsi, rdi
+            reg64 = (uint8_t)(body[pos] - 0x50);
+            push_size = 1;
+        }else if (((pos + 1) < body_size) && ((0x41 == body[pos]) || (0x49 == body[pos])) &&
+            (0x54 <= body[pos + 1]) && (0x57 >= body[pos + 1])){
+
+            // push r12-r15(REX.B or REX.WB, see encode_x64_push_reg64 function)
+            reg64 = (uint8_t)(body[pos + 1] - 0x50 + 8);
+            push_size = 2;
+        }else{
+
+            break;
+        }
+
+        pos += push_size;
+        push_bytes += push_size;
+
+        // CFA = rsp + cfa_offset, pushed register = [CFA - cfa_offset]
+        cfa_offset += sizeof(uint64_t);
+
+        if (cfa_size_max < (*cfa_size + 16)){
+
+            return false;
+        }
+
+        put_eh_frame_advance_loc(cfa, cfa_size, pos - prev_pos);
+        prev_pos = pos;
+        cfa[(*cfa_size)++] = TP_DW_CFA_DEF_CFA_OFFSET;
+        put_eh_frame_uleb128(cfa, cfa_size, cfa_offset);
+        cfa[(*cfa_size)++] = TP_DW_CFA_OFFSET | dwarf_register[reg64];
+        put_eh_frame_uleb128(cfa, cfa_size, cfa_offset / sizeof(uint64_t));
+    }
+
+    if ( ! is_frame){
+
+        // NOTE: The function body without the stack frame does not push the registers,
+        // so CFA = rsp + cfa_offset until the pops of the epilogue(the same size as the pushes).
+        if ( ! (((pos + push_bytes + 1) <= body_size) && (0xc3 == body[body_size - 1]))){
+
+            return false;
+        }
+
+        pos = body_size - 1 - push_bytes;
+
+        while ((body_size - 1) > pos){
+
+            // pop rbx, rsi, rdi(or pop r12-r15)
+            uint32_t pop_size = (((0x41 == body[pos]) || (0x49 == body[pos])) ? 2 : 1);
+
+            if ((0x58 != (body[pos + pop_size - 1] & 0xf8)) || ((body_size - 1) < (pos + pop_size))){
+
+                return false;
+            }
+
+            pos += pop_size;
+
+            cfa_offset -= sizeof(uint64_t);
+
+            if (cfa_size_max < (*cfa_size + 16)){
+
+                return false;
+            }
+
+            put_eh_frame_advance_loc(cfa, cfa_size, pos - prev_pos);
+            prev_pos = pos;
+            cfa[(*cfa_size)++] = TP_DW_CFA_DEF_CFA_OFFSET;
+            put_eh_frame_uleb128(cfa, cfa_size, cfa_offset);
+        }
+
+        return true;
+    }
+
+    // sub rsp, imm8(48 83 ec ib) or sub rsp, imm32(48 81 ec id)
+    if ( ! (((pos + 4) <= body_size) && (0x48 == body[pos]) &&
+        ((0x83 == body[pos + 1]) || (0x81 == body[pos + 1])) && (0xec == body[pos + 2]))){
+
+        return false;
+    }
+
+    uint32_t stack_imm32 = 0;
+
+    if (0x83 == body[pos + 1]){
+
+        stack_imm32 = body[pos + 3];
+
+        pos += 4;
+    }else{
+
+        if ((pos + 7) > body_size){
+
+            return false;
+        }
+
+        stack_imm32 = body[pos + 3] | (body[pos + 4] << 8) | (body[pos + 5] << 16) | ((uint32_t)body[pos + 6] << 24);
+
+        pos += 7;
+    }
+
+    cfa_offset += stack_imm32;
+
+    put_eh_frame_advance_loc(cfa, cfa_size, pos - prev_pos);
+    prev_pos = pos;
+    cfa[(*cfa_size)++] = TP_DW_CFA_DEF_CFA_OFFSET;
+    put_eh_frame_uleb128(cfa, cfa_size, cfa_offset);
+
+    // lea rbp, [rsp+32]: CFA = rbp + cfa_offset - 32(RSP changes in the x64 code, but RBP does not).
+    static const uint8_t lea_rbp[] = { 0x48, 0x8d, 0x6c, 0x24, 0x20 };
+
+    if ( ! (((pos + sizeof(lea_rbp)) <= body_size) && (0 == memcmp(body + pos, lea_rbp, sizeof(lea_rbp))))){
+
+        return false;
+    }
+
+    pos += sizeof(lea_rbp);
+
+    put_eh_frame_advance_loc(cfa, cfa_size, pos - prev_pos);
+    prev_pos = pos;
+    cfa[(*cfa_size)++] = TP_DW_CFA_DEF_CFA;
+    put_eh_frame_uleb128(cfa, cfa_size, TP_DW_REGISTER_RBP);
+    put_eh_frame_uleb128(cfa, cfa_size, cfa_offset - lea_rbp[4]);
+
+    // pop rbp; ret: CFA = rsp + 8
+    if ( ! ((2 <= body_size) && (0x5d == body[body_size - 2]) && (0xc3 == body[body_size - 1]))){
+
+        return false;
+    }
+
+    put_eh_frame_advance_loc(cfa, cfa_size, (body_size - 1) - prev_pos);
+    cfa[(*cfa_size)++] = TP_DW_CFA_DEF_CFA;
+    put_eh_frame_uleb128(cfa, cfa_size, TP_DW_REGISTER_RSP);
+    put_eh_frame_uleb128(cfa, cfa_size, sizeof(uint64_t));
+
+    return true;
+}
+
+static void put_eh_frame_advance_loc(uint8_t* cfa, uint32_t* cfa_size, uint32_t delta)
+{
+    if (0x3f >= delta){
+
+        cfa[(*cfa_size)++] = (uint8_t)(TP_DW_CFA_ADVANCE_LOC | delta);
+    }else if (UINT8_MAX >= delta){
+
+        cfa[(*cfa_size)++] = TP_DW_CFA_ADVANCE_LOC1;
+        cfa[(*cfa_size)++] = (uint8_t)delta;
+    }else if (UINT16_MAX >= delta){
+
+        cfa[(*cfa_size)++] = TP_DW_CFA_ADVANCE_LOC2;
+        cfa[(*cfa_size)++] = (uint8_t)delta;
+        cfa[(*cfa_size)++] = (uint8_t)(delta >> 8);
+    }else{
+
+        cfa[(*cfa_size)++] = TP_DW_CFA_ADVANCE_LOC4;
+        put_eh_frame_uint32(cfa, *cfa_size, delta);
+        *cfa_size += sizeof(uint32_t);
+    }
+}
+
+static void put_eh_frame_uleb128(uint8_t* buffer, uint32_t* offset, uint32_t value)
+{
+    do{
+        uint8_t byte = (uint8_t)(value & 0x7f);
+
+        value >>= 7;
+
+        buffer[(*offset)++] = (value ? (byte | 0x80) : byte);
+    }while (value);
+}
+
+static void put_eh_frame_sleb128(uint8_t* buffer, uint32_t* offset, int32_t value)
+{
+    while (true){
+
+        uint8_t byte = (uint8_t)(value & 0x7f);
+
+        value >>= 7;
+
+        if (((0 == value) && (0 == (byte & 0x40))) || ((-1 == value) && (byte & 0x40))){
+
+            buffer[(*offset)++] = byte;
+
+            break;
+        }
+
+        buffer[(*offset)++] = (byte | 0x80);
+    }
+}
+
+static void put_eh_frame_uint32(uint8_t* buffer, uint32_t offset, uint32_t value)
+{
+    buffer[offset] = (uint8_t)value;
+    buffer[offset + 1] = (uint8_t)(value >> 8);
+    buffer[offset + 2] = (uint8_t)(value >> 16);
+    buffer[offset + 3] = (uint8_t)(value >> 24);
+}
+
+static void patch_eh_frame_pc_begin(TP_ELF_TEXT* text, uint64_t eh_frame_addr, uint64_t text_addr)
+{
+    for (uint32_t i = 0; text->member_fde_num > i; ++i){
+
+        uint64_t field_addr = eh_frame_addr + text->member_pc_begin_offset[i];
+
+        put_eh_frame_uint32(
+            text->member_eh_frame, text->member_pc_begin_offset[i],
+            (uint32_t)((text_addr + text->member_pc_begin[i]) - field_addr)
+        );
+    }
+}
+
+static bool make_elf_relocatable_object(
+    TP_SYMBOL_TABLE* symbol_table, char* path, char* symbol_name, TP_ELF_TEXT* text)
+{
+    enum{
+        SECTION_NULL, SECTION_TEXT, SECTION_EH_FRAME, SECTION_RELA_EH_FRAME,
+        SECTION_SYMTAB, SECTION_STRTAB, SECTION_SHSTRTAB, SECTION_NOTE_GNU_STACK, SECTION_NUM
+    };
+
+    static const char shstrtab[] =
+        "\0.text\0.eh_frame\0.rela.eh_frame\0.symtab\0.strtab\0.shstrtab\0.note.GNU-stack";
+    static const uint32_t shstrtab_name[SECTION_NUM] = { 0, 1, 7, 17, 32, 40, 48, 58 };
+
+    // .strtab: "\0name\0name_ms_abi\0"
+    size_t symbol_name_length = strlen(symbol_name);
+    uint32_t strtab_size = (uint32_t)(1 + (symbol_name_length + 1) + (symbol_name_length + sizeof(TP_ELF_BODY_SYMBOL_SUFFIX)));
+
+    enum{ SYMBOL_NULL, SYMBOL_TEXT, SYMBOL_BODY, SYMBOL_THUNK, SYMBOL_NUM };
+
+    uint64_t text_offset = sizeof(TP_ELF64_EHDR);
+    uint64_t eh_frame_offset = align_up(text_offset + text->member_text_size, sizeof(uint64_t));
+    uint64_t rela_offset = align_up(eh_frame_offset + text->member_eh_frame_size, sizeof(uint64_t));
+    uint64_t rela_size = text->member_fde_num * sizeof(TP_ELF64_RELA);
+    uint64_t symtab_offset = align_up(rela_offset + rela_size, sizeof(uint64_t));
+    uint64_t symtab_size = SYMBOL_NUM * sizeof(TP_ELF64_SYM);
+    uint64_t strtab_offset = symtab_offset + symtab_size;
+    uint64_t shstrtab_offset = strtab_offset + strtab_size;
+    uint64_t shdr_offset = align_up(shstrtab_offset + sizeof(shstrtab), sizeof(uint64_t));
+    uint64_t file_size = shdr_offset + SECTION_NUM * sizeof(TP_ELF64_SHDR);
+
+    if (UINT32_MAX < file_size){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    uint8_t* content = (uint8_t*)TP_CALLOC(symbol_table, (size_t)file_size, sizeof(uint8_t));
+
+    if (NULL == content){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    TP_ELF64_EHDR* ehdr = (TP_ELF64_EHDR*)content;
+
+    set_elf_header(ehdr, TP_ELF_TYPE_REL);
+    ehdr->member_shoff = shdr_offset;
+    ehdr->member_shnum = SECTION_NUM;
+    ehdr->member_shstrndx = SECTION_SHSTRTAB;
+
+    memcpy(content + text_offset, text->member_text, text->member_text_size);
+
+    // pc_begin is resolved by R_X86_64_PC32 relocations.
+    patch_eh_frame_pc_begin(text, 0, 0);
+
+    memcpy(content + eh_frame_offset, text->member_eh_frame, text->member_eh_frame_size);
+
+    TP_ELF64_RELA* rela = (TP_ELF64_RELA*)(content + rela_offset);
+
+    for (uint32_t i = 0; text->member_fde_num > i; ++i){
+
+        memset(content + eh_frame_offset + text->member_pc_begin_offset[i], 0, sizeof(uint32_t));
+
+        rela[i].member_offset = text->member_pc_begin_offset[i];
+        rela[i].member_info = TP_ELF_R_INFO(SYMBOL_TEXT, TP_ELF_R_X86_64_PC32);
+        rela[i].member_addend = text->member_pc_begin[i];
+    }
+
+    char* strtab = (char*)(content + strtab_offset);
+    uint32_t thunk_name = 1;
+    uint32_t body_name = (uint32_t)(thunk_name + symbol_name_length + 1);
+
+    memcpy(strtab + thunk_name, symbol_name, symbol_name_length);
+    memcpy(strtab + body_name, symbol_name, symbol_name_length);
+    memcpy(strtab + body_name + symbol_name_length, TP_ELF_BODY_SYMBOL_SUFFIX, sizeof(TP_ELF_BODY_SYMBOL_SUFFIX));
+
+    TP_ELF64_SYM* symtab = (TP_ELF64_SYM*)(content + symtab_offset);
+
+    symtab[SYMBOL_TEXT].member_info = TP_ELF_ST_INFO(TP_ELF_STB_LOCAL, TP_ELF_STT_SECTION);
+    symtab[SYMBOL_TEXT].member_shndx = SECTION_TEXT;
+
+    symtab[SYMBOL_BODY].member_name = body_name;
+    symtab[SYMBOL_BODY].member_info = TP_ELF_ST_INFO(TP_ELF_STB_LOCAL, TP_ELF_STT_FUNC);
+    symtab[SYMBOL_BODY].member_shndx = SECTION_TEXT;
+    symtab[SYMBOL_BODY].member_value = text->member_body_offset;
+    symtab[SYMBOL_BODY].member_size = text->member_body_size;
+
+    symtab[SYMBOL_THUNK].member_name = thunk_name;
+    symtab[SYMBOL_THUNK].member_info = TP_ELF_ST_INFO(TP_ELF_STB_GLOBAL, TP_ELF_STT_FUNC);
+    symtab[SYMBOL_THUNK].member_shndx = SECTION_TEXT;
+    symtab[SYMBOL_THUNK].member_value = 0;
+    symtab[SYMBOL_THUNK].member_size = text->member_thunk_size;
+
+    memcpy(content + shstrtab_offset, shstrtab, sizeof(shstrtab));
+
+    TP_ELF64_SHDR* shdr = (TP_ELF64_SHDR*)(content + shdr_offset);
+
+    for (uint32_t i = 0; SECTION_NUM > i; ++i){
+
+        shdr[i].member_name = shstrtab_name[i];
+    }
+
+    shdr[SECTION_TEXT].member_type = TP_ELF_SHT_PROGBITS;
+    shdr[SECTION_TEXT].member_flags = TP_ELF_SHF_ALLOC | TP_ELF_SHF_EXECINSTR;
+    shdr[SECTION_TEXT].member_offset = text_offset;
+    shdr[SECTION_TEXT].member_size = text->member_text_size;
+    shdr[SECTION_TEXT].member_addralign = 16;
+
+    shdr[SECTION_EH_FRAME].member_type = TP_ELF_SHT_X86_64_UNWIND;
+    shdr[SECTION_EH_FRAME].member_flags = TP_ELF_SHF_ALLOC;
+    shdr[SECTION_EH_FRAME].member_offset = eh_frame_offset;
+    shdr[SECTION_EH_FRAME].member_size = text->member_eh_frame_size;
+    shdr[SECTION_EH_FRAME].member_addralign = sizeof(uint64_t);
+
+    shdr[SECTION_RELA_EH_FRAME].member_type = TP_ELF_SHT_RELA;
+    shdr[SECTION_RELA_EH_FRAME].member_flags = TP_ELF_SHF_INFO_LINK;
+    shdr[SECTION_RELA_EH_FRAME].member_offset = rela_offset;
+    shdr[SECTION_RELA_EH_FRAME].member_size = rela_size;
+    shdr[SECTION_RELA_EH_FRAME].member_link = SECTION_SYMTAB;
+    shdr[SECTION_RELA_EH_FRAME].member_info = SECTION_EH_FRAME;
+    shdr[SECTION_RELA_EH_FRAME].member_addralign = sizeof(uint64_t);
+    shdr[SECTION_RELA_EH_FRAME].member_entsize = sizeof(TP_ELF64_RELA);
+
+    shdr[SECTION_SYMTAB].member_type = TP_ELF_SHT_SYMTAB;
+    shdr[SECTION_SYMTAB].member_offset = symtab_offset;
+    shdr[SECTION_SYMTAB].member_size = symtab_size;
+    shdr[SECTION_SYMTAB].member_link = SECTION_STRTAB;
+    shdr[SECTION_SYMTAB].member_info = SYMBOL_THUNK; // First global symbol.
+    shdr[SECTION_SYMTAB].member_addralign = sizeof(uint64_t);
+    shdr[SECTION_SYMTAB].member_entsize = sizeof(TP_ELF64_SYM);
+
+    shdr[SECTION_STRTAB].member_type = TP_ELF_SHT_STRTAB;
+    shdr[SECTION_STRTAB].member_offset = strtab_offset;
+    shdr[SECTION_STRTAB].member_size = strtab_size;
+    shdr[SECTION_STRTAB].member_addralign = 1;
+
+    shdr[SECTION_SHSTRTAB].member_type = TP_ELF_SHT_STRTAB;
+    shdr[SECTION_SHSTRTAB].member_offset = shstrtab_offset;
+    shdr[SECTION_SHSTRTAB].member_size = sizeof(shstrtab);
+    shdr[SECTION_SHSTRTAB].member_addralign = 1;
+
+    // Non-executable stack.
+    shdr[SECTION_NOTE_GNU_STACK].member_type = TP_ELF_SHT_PROGBITS;
+    shdr[SECTION_NOTE_GNU_STACK].member_offset = shdr_offset;
+    shdr[SECTION_NOTE_GNU_STACK].member_addralign = 1;
+
+    bool status = tp_write_file(symbol_table, path, content, (uint32_t)file_size);
+
+    if ( ! status){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+    }
+
+    TP_FREE(symbol_table, &content, (size_t)file_size);
+
+    return status;
+}
+
+static bool make_elf_shared_object(
+    TP_SYMBOL_TABLE* symbol_table, char* path, char* symbol_name, TP_ELF_TEXT* text)
+{
+    enum{
+        SECTION_NULL, SECTION_HASH, SECTION_DYNSYM, SECTION_DYNSTR, SECTION_TEXT,
+        SECTION_EH_FRAME_HDR, SECTION_EH_FRAME, SECTION_DYNAMIC, SECTION_SHSTRTAB, SECTION_NUM
+    };
+
+    static const char shstrtab[] =
+        "\0.hash\0.dynsym\0.dynstr\0.text\0.eh_frame_hdr\0.eh_frame\0.dynamic\0.shstrtab";
+    static const uint32_t shstrtab_name[SECTION_NUM] = { 0, 1, 7, 15, 23, 29, 43, 53, 62 };
+
+    enum{
+        SEGMENT_LOAD_TEXT, SEGMENT_LOAD_DYNAMIC, SEGMENT_DYNAMIC, SEGMENT_GNU_EH_FRAME, SEGMENT_GNU_STACK, SEGMENT_NUM
+    };
+
+    enum{ SYMBOL_NULL, SYMBOL_THUNK, SYMBOL_NUM };
+
+    enum{ DYNAMIC_HASH, DYNAMIC_STRTAB, DYNAMIC_SYMTAB, DYNAMIC_STRSZ, DYNAMIC_SYMENT, DYNAMIC_NULL, DYNAMIC_NUM };
+
+    // .hash: nbucket = 1, nchain = SYMBOL_NUM, bucket[0] = SYMBOL_THUNK, chain[]
+    uint32_t hash_size = (2 + 1 + SYMBOL_NUM) * sizeof(uint32_t);
+
+    // .dynstr: "\0name\0"
+    size_t symbol_name_length = strlen(symbol_name);
+    uint32_t dynstr_size = (uint32_t)(1 + symbol_name_length + 1);
+
+    // .eh_frame_hdr: version, 3 encodings, eh_frame_ptr, fde_count, table
+    uint32_t eh_frame_hdr_size = 4 + sizeof(uint32_t) * 2 + text->member_fde_num * sizeof(uint32_t) * 2;
+
+    // Read/execute segment. NOTE: The virtual address is the file offset.
+    uint64_t phdr_offset = sizeof(TP_ELF64_EHDR);
+    uint64_t hash_offset = align_up(phdr_offset + SEGMENT_NUM * sizeof(TP_ELF64_PHDR), sizeof(uint64_t));
+    uint64_t dynsym_offset = align_up(hash_offset + hash_size, sizeof(uint64_t));
+    uint64_t dynsym_size = SYMBOL_NUM * sizeof(TP_ELF64_SYM);
+    uint64_t dynstr_offset = dynsym_offset + dynsym_size;
+    uint64_t text_offset = align_up(dynstr_offset + dynstr_size, 16);
+    uint64_t eh_frame_hdr_offset = align_up(text_offset + text->member_text_size, sizeof(uint32_t));
+    uint64_t eh_frame_offset = align_up(eh_frame_hdr_offset + eh_frame_hdr_size, sizeof(uint64_t));
+    uint64_t load_text_size = eh_frame_offset + text->member_eh_frame_size;
+
+    // Read/write segment: the next page of the virtual address.
+    uint64_t dynamic_offset = align_up(load_text_size, sizeof(uint64_t));
+    uint64_t dynamic_addr = dynamic_offset + TP_ELF_PAGE_SIZE;
+    uint64_t dynamic_size = DYNAMIC_NUM * sizeof(TP_ELF64_DYN);
+
+    uint64_t shstrtab_offset = dynamic_offset + dynamic_size;
+    uint64_t shdr_offset = align_up(shstrtab_offset + sizeof(shstrtab), sizeof(uint64_t));
+    uint64_t file_size = shdr_offset + SECTION_NUM * sizeof(TP_ELF64_SHDR);
+
+    if (UINT32_MAX < file_size){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    uint8_t* content = (uint8_t*)TP_CALLOC(symbol_table, (size_t)file_size, sizeof(uint8_t));
+
+    if (NULL == content){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    TP_ELF64_EHDR* ehdr = (TP_ELF64_EHDR*)content;
+
+    set_elf_header(ehdr, TP_ELF_TYPE_DYN);
+    ehdr->member_phoff = phdr_offset;
+    ehdr->member_phnum = SEGMENT_NUM;
+    ehdr->member_shoff = shdr_offset;
+    ehdr->member_shnum = SECTION_NUM;
+    ehdr->member_shstrndx = SECTION_SHSTRTAB;
+
+    TP_ELF64_PHDR* phdr = (TP_ELF64_PHDR*)(content + phdr_offset);
+
+    phdr[SEGMENT_LOAD_TEXT].member_type = TP_ELF_PT_LOAD;
+    phdr[SEGMENT_LOAD_TEXT].member_flags = TP_ELF_PF_R | TP_ELF_PF_X;
+    phdr[SEGMENT_LOAD_TEXT].member_filesz = load_text_size;
+    phdr[SEGMENT_LOAD_TEXT].member_memsz = load_text_size;
+    phdr[SEGMENT_LOAD_TEXT].member_align = TP_ELF_PAGE_SIZE;
+
+    phdr[SEGMENT_LOAD_DYNAMIC].member_type = TP_ELF_PT_LOAD;
+    phdr[SEGMENT_LOAD_DYNAMIC].member_flags = TP_ELF_PF_R | TP_ELF_PF_W;
+    phdr[SEGMENT_LOAD_DYNAMIC].member_offset = dynamic_offset;
+    phdr[SEGMENT_LOAD_DYNAMIC].member_vaddr = dynamic_addr;
+    phdr[SEGMENT_LOAD_DYNAMIC].member_paddr = dynamic_addr;
+    phdr[SEGMENT_LOAD_DYNAMIC].member_filesz = dynamic_size;
+    phdr[SEGMENT_LOAD_DYNAMIC].member_memsz = dynamic_size;
+    phdr[SEGMENT_LOAD_DYNAMIC].member_align = TP_ELF_PAGE_SIZE;
+
+    phdr[SEGMENT_DYNAMIC].member_type = TP_ELF_PT_DYNAMIC;
+    phdr[SEGMENT_DYNAMIC].member_flags = TP_ELF_PF_R | TP_ELF_PF_W;
+    phdr[SEGMENT_DYNAMIC].member_offset = dynamic_offset;
+    phdr[SEGMENT_DYNAMIC].member_vaddr = dynamic_addr;
+    phdr[SEGMENT_DYNAMIC].member_paddr = dynamic_addr;
+    phdr[SEGMENT_DYNAMIC].member_filesz = dynamic_size;
+    phdr[SEGMENT_DYNAMIC].member_memsz = dynamic_size;
+    phdr[SEGMENT_DYNAMIC].member_align = sizeof(uint64_t);
+
+    phdr[SEGMENT_GNU_EH_FRAME].member_type = TP_ELF_PT_GNU_EH_FRAME;
+    phdr[SEGMENT_GNU_EH_FRAME].member_flags = TP_ELF_PF_R;
+    phdr[SEGMENT_GNU_EH_FRAME].member_offset = eh_frame_hdr_offset;
+    phdr[SEGMENT_GNU_EH_FRAME].member_vaddr = eh_frame_hdr_offset;
+    phdr[SEGMENT_GNU_EH_FRAME].member_paddr = eh_frame_hdr_offset;
+    phdr[SEGMENT_GNU_EH_FRAME].member_filesz = eh_frame_hdr_size;
+    phdr[SEGMENT_GNU_EH_FRAME].member_memsz = eh_frame_hdr_size;
+    phdr[SEGMENT_GNU_EH_FRAME].member_align = sizeof(uint32_t);
+
+    phdr[SEGMENT_GNU_STACK].member_type = TP_ELF_PT_GNU_STACK;
+    phdr[SEGMENT_GNU_STACK].member_flags = TP_ELF_PF_R | TP_ELF_PF_W;
+    phdr[SEGMENT_GNU_STACK].member_align = 16;
+
+    // NOTE: The hash function is not needed with only one bucket.
+    uint32_t* hash = (uint32_t*)(content + hash_offset);
+
+    hash[0] = 1; // nbucket
+    hash[1] = SYMBOL_NUM; // nchain
+    hash[2] = SYMBOL_THUNK; // bucket[0]
+
+    TP_ELF64_SYM* dynsym = (TP_ELF64_SYM*)(content + dynsym_offset);
+
+    dynsym[SYMBOL_THUNK].member_name = 1;
+    dynsym[SYMBOL_THUNK].member_info = TP_ELF_ST_INFO(TP_ELF_STB_GLOBAL, TP_ELF_STT_FUNC);
+    dynsym[SYMBOL_THUNK].member_shndx = SECTION_TEXT;
+    dynsym[SYMBOL_THUNK].member_value = text_offset;
+    dynsym[SYMBOL_THUNK].member_size = text->member_thunk_size;
+
+    memcpy(content + dynstr_offset + 1, symbol_name, symbol_name_length);
+
+    memcpy(content + text_offset, text->member_text, text->member_text_size);
+
+    patch_eh_frame_pc_begin(text, eh_frame_offset, text_offset);
+
+    memcpy(content + eh_frame_offset, text->member_eh_frame, text->member_eh_frame_size);
+
+    uint8_t* eh_frame_hdr = content + eh_frame_hdr_offset;
+
+    eh_frame_hdr[0] = 1; // version
+    eh_frame_hdr[1] = TP_DW_EH_PE_PCREL_SDATA4; // eh_frame_ptr_enc
+    eh_frame_hdr[2] = TP_DW_EH_PE_UDATA4; // fde_count_enc
+    eh_frame_hdr[3] = TP_DW_EH_PE_DATAREL_SDATA4; // table_enc
+    put_eh_frame_uint32(eh_frame_hdr, 4, (uint32_t)(eh_frame_offset - (eh_frame_hdr_offset + 4)));
+    put_eh_frame_uint32(eh_frame_hdr, 8, text->member_fde_num);
+
+    // Sorted by initial location: the System V entry point is the first.
+    for (uint32_t i = 0; text->member_fde_num > i; ++i){
+
+        put_eh_frame_uint32(
+            eh_frame_hdr, 12 + i * 8,
+            (uint32_t)((text_offset + text->member_pc_begin[i]) - eh_frame_hdr_offset)
+        );
+        put_eh_frame_uint32(
+            eh_frame_hdr, 12 + i * 8 + 4,
+            (uint32_t)((eh_frame_offset + text->member_fde_offset[i]) - eh_frame_hdr_offset)
+        );
+    }
+
+    TP_ELF64_DYN* dynamic = (TP_ELF64_DYN*)(content + dynamic_offset);
+
+    dynamic[DYNAMIC_HASH].member_tag = TP_ELF_DT_HASH;
+    dynamic[DYNAMIC_HASH].member_val = hash_offset;
+    dynamic[DYNAMIC_STRTAB].member_tag = TP_ELF_DT_STRTAB;
+    dynamic[DYNAMIC_STRTAB].member_val = dynstr_offset;
+    dynamic[DYNAMIC_SYMTAB].member_tag = TP_ELF_DT_SYMTAB;
+    dynamic[DYNAMIC_SYMTAB].member_val = dynsym_offset;
+    dynamic[DYNAMIC_STRSZ].member_tag = TP_ELF_DT_STRSZ;
+    dynamic[DYNAMIC_STRSZ].member_val = dynstr_size;
+    dynamic[DYNAMIC_SYMENT].member_tag = TP_ELF_DT_SYMENT;
+    dynamic[DYNAMIC_SYMENT].member_val = sizeof(TP_ELF64_SYM);
+    dynamic[DYNAMIC_NULL].member_tag = TP_ELF_DT_NULL;
+
+    memcpy(content + shstrtab_offset, shstrtab, sizeof(shstrtab));
+
+    TP_ELF64_SHDR* shdr = (TP_ELF64_SHDR*)(content + shdr_offset);
+
+    for (uint32_t i = 0; SECTION_NUM > i; ++i){
+
+        shdr[i].member_name = shstrtab_name[i];
+    }
+
+    shdr[SECTION_HASH].member_type = TP_ELF_SHT_HASH;
+    shdr[SECTION_HASH].member_flags = TP_ELF_SHF_ALLOC;
+    shdr[SECTION_HASH].member_addr = hash_offset;
+    shdr[SECTION_HASH].member_offset = hash_offset;
+    shdr[SECTION_HASH].member_size = hash_size;
+    shdr[SECTION_HASH].member_link = SECTION_DYNSYM;
+    shdr[SECTION_HASH].member_addralign = sizeof(uint64_t);
+    shdr[SECTION_HASH].member_entsize = sizeof(uint32_t);
+
+    shdr[SECTION_DYNSYM].member_type = TP_ELF_SHT_DYNSYM;
+    shdr[SECTION_DYNSYM].member_flags = TP_ELF_SHF_ALLOC;
+    shdr[SECTION_DYNSYM].member_addr = dynsym_offset;
+    shdr[SECTION_DYNSYM].member_offset = dynsym_offset;
+    shdr[SECTION_DYNSYM].member_size = dynsym_size;
+    shdr[SECTION_DYNSYM].member_link = SECTION_DYNSTR;
+    shdr[SECTION_DYNSYM].member_info = SYMBOL_THUNK; // First global symbol.
+    shdr[SECTION_DYNSYM].member_addralign = sizeof(uint64_t);
+    shdr[SECTION_DYNSYM].member_entsize = sizeof(TP_ELF64_SYM);
+
+    shdr[SECTION_DYNSTR].member_type = TP_ELF_SHT_STRTAB;
+    shdr[SECTION_DYNSTR].member_flags = TP_ELF_SHF_ALLOC;
+    shdr[SECTION_DYNSTR].member_addr = dynstr_offset;
+    shdr[SECTION_DYNSTR].member_offset = dynstr_offset;
+    shdr[SECTION_DYNSTR].member_size = dynstr_size;
+    shdr[SECTION_DYNSTR].member_addralign = 1;
+
+    shdr[SECTION_TEXT].member_type = TP_ELF_SHT_PROGBITS;
+    shdr[SECTION_TEXT].member_flags = TP_ELF_SHF_ALLOC | TP_ELF_SHF_EXECINSTR;
+    shdr[SECTION_TEXT].member_addr = text_offset;
+    shdr[SECTION_TEXT].member_offset = text_offset;
+    shdr[SECTION_TEXT].member_size = text->member_text_size;
+    shdr[SECTION_TEXT].member_addralign = 16;
+
+    shdr[SECTION_EH_FRAME_HDR].member_type = TP_ELF_SHT_PROGBITS;
+    shdr[SECTION_EH_FRAME_HDR].member_flags = TP_ELF_SHF_ALLOC;
+    shdr[SECTION_EH_FRAME_HDR].member_addr = eh_frame_hdr_offset;
+    shdr[SECTION_EH_FRAME_HDR].member_offset = eh_frame_hdr_offset;
+    shdr[SECTION_EH_FRAME_HDR].member_size = eh_frame_hdr_size;
+    shdr[SECTION_EH_FRAME_HDR].member_addralign = sizeof(uint32_t);
+
+    shdr[SECTION_EH_FRAME].member_type = TP_ELF_SHT_X86_64_UNWIND;
+    shdr[SECTION_EH_FRAME].member_flags = TP_ELF_SHF_ALLOC;
+    shdr[SECTION_EH_FRAME].member_addr = eh_frame_offset;
+    shdr[SECTION_EH_FRAME].member_offset = eh_frame_offset;
+    shdr[SECTION_EH_FRAME].member_size = text->member_eh_frame_size;
+    shdr[SECTION_EH_FRAME].member_addralign = sizeof(uint64_t);
+
+    shdr[SECTION_DYNAMIC].member_type = TP_ELF_SHT_DYNAMIC;
+    shdr[SECTION_DYNAMIC].member_flags = TP_ELF_SHF_ALLOC | TP_ELF_SHF_WRITE;
+    shdr[SECTION_DYNAMIC].member_addr = dynamic_addr;
+    shdr[SECTION_DYNAMIC].member_offset = dynamic_offset;
+    shdr[SECTION_DYNAMIC].member_size = dynamic_size;
+    shdr[SECTION_DYNAMIC].member_link = SECTION_DYNSTR;
+    shdr[SECTION_DYNAMIC].member_addralign = sizeof(uint64_t);
+    shdr[SECTION_DYNAMIC].member_entsize = sizeof(TP_ELF64_DYN);
+
+    shdr[SECTION_SHSTRTAB].member_type = TP_ELF_SHT_STRTAB;
+    shdr[SECTION_SHSTRTAB].member_offset = shstrtab_offset;
+    shdr[SECTION_SHSTRTAB].member_size = sizeof(shstrtab);
+    shdr[SECTION_SHSTRTAB].member_addralign = 1;
+
+    bool status = tp_write_file(symbol_table, path, content, (uint32_t)file_size);
+
+    if ( ! status){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+    }
+
+    TP_FREE(symbol_table, &content, (size_t)file_size);
+
+    return status;
+}
+
+static void set_elf_header(TP_ELF64_EHDR* ehdr, uint16_t type)
+{
+    static const uint8_t ident[] = {
+        0x7f, 'E', 'L', 'F', TP_ELF_CLASS_64, TP_ELF_DATA_2LSB, TP_ELF_VERSION_CURRENT, TP_ELF_OSABI_SYSV
+    };
+
+    memcpy(ehdr->member_ident, ident, sizeof(ident));
+    ehdr->member_type = type;
+    ehdr->member_machine = TP_ELF_MACHINE_X86_64;
+    ehdr->member_version = TP_ELF_VERSION_CURRENT;
+    ehdr->member_ehsize = sizeof(TP_ELF64_EHDR);
+    ehdr->member_phentsize = ((TP_ELF_TYPE_DYN == type) ? sizeof(TP_ELF64_PHDR) : 0);
+    ehdr->member_shentsize = sizeof(TP_ELF64_SHDR);
+}
+
+static uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+    return ((value + (alignment - 1)) & ~(alignment - 1));
+}
@@ -0,0 +1,408 @@
+
+// (C) Shin'ichi Ichikawa. Released under the MIT license.
+
+#include "tp_compiler.h"
+
+// Convert parse tree to SSA IR.
+//
+// Example:
+// int32_t value1 = (1 + 2) * 3;
+// int32_t value2 = 2 + (3 * value1);
+// value1 = value2 + x;
+//
+// SSA IR(the value of the instruction is the index of it):
+//  0: CONST 1
+//  1: CONST 2
+//  2: ADD 0, 1
+//  3: CONST 3
+//  4: MUL 2, 3       ; value1
+//  5: CONST 2
+//  6: CONST 3
+//  7: MUL 6, 4
+//  8: ADD 5, 7       ; value2
+//  9: PARAM 0       ; x
+// 10: ADD 8, 9       ; value1(the returned value)
+//
+// Note:
+//  (1) The local variables are replaced by the values of the expressions, so the assignment
+//      does not make any instruction.
+//  (2) The variable which is not assigned yet has the initial value of wasm(CONST 0).
+
+static bool make_ir_statement(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, uint32_t* local_value);
+static bool make_ir_expression(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, uint32_t* local_value, uint32_t* value
+);
+static bool make_ir_factor(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, uint32_t* local_value, uint32_t* value
+);
+static bool append_ir_instruction(
+    TP_SYMBOL_TABLE* symbol_table, TP_IR_OPCODE opcode, uint32_t op1, uint32_t op2, int32_t i32, uint32_t* value
+);
+
+bool tp_make_ir(TP_SYMBOL_TABLE* symbol_table)
+{
+    if (symbol_table->member_ir_instruction){
+
+        TP_FREE(symbol_table, &(symbol_table->member_ir_instruction), symbol_table->member_ir_instruction_size);
+    }
+
+    symbol_table->member_ir_instruction_num = 0;
+    symbol_table->member_ir_instruction_size = 0;
+    symbol_table->member_ir_return_value = TP_IR_VALUE_NULL;
+
+    // Calculated by semantic analysis.
+    uint32_t local_num = symbol_table->member_param_count + symbol_table->member_var_count;
+
+    // NOTE: TP_IR_VALUE_NULL: The instruction of the local variable is not made yet.
+    uint32_t* local_value = (uint32_t*)TP_CALLOC(symbol_table, local_num + 1, sizeof(uint32_t));
+
+    if (NULL == local_value){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    for (uint32_t i = 0; local_num > i; ++i){
+
+        local_value[i] = TP_IR_VALUE_NULL;
+    }
+
+    bool is_make_success = make_ir_statement(symbol_table, symbol_table->member_tp_parse_tree, local_value);
+
+    TP_FREE(symbol_table, &local_value, (local_num + 1) * sizeof(uint32_t));
+
+    if ( ! is_make_success){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if (TP_IR_VALUE_NULL == symbol_table->member_ir_return_value){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool make_ir_statement(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, uint32_t* local_value)
+{
+    switch (parse_tree->member_grammer){
+    // Grammer: Program -> Statement+
+    case TP_PARSE_TREE_GRAMMER_PROGRAM:
+
+        // NOTE: The statements are visited in order of the source code.
+        for (size_t i = 0; parse_tree->member_element_num > i; ++i){
+
+            if (TP_PARSE_TREE_TYPE_NODE != parse_tree->member_element[i].member_type){
+
+                TP_PUT_LOG_MSG_ICE(symbol_table);
+
+                return false;
+            }
+
+            if ( ! make_ir_statement(symbol_table, parse_tree->member_element[i].member_body.member_child, local_value)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                return false;
+            }
+        }
+        return true;
+    // Grammer: Statement -> variable '=' Expression ';'
+    case TP_PARSE_TREE_GRAMMER_STATEMENT_1:
+//      break;
+    // Grammer: Statement -> Type variable '=' Expression ';'
+    case TP_PARSE_TREE_GRAMMER_STATEMENT_2:
+        break;
+    default:
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    size_t element_num = parse_tree->member_element_num;
+
+    if (((TP_PARSE_TREE_GRAMMER_STATEMENT_1 == parse_tree->member_grammer) &&
+        (symbol_table->member_grammer_statement_1_num != element_num)) ||
+        ((TP_PARSE_TREE_GRAMMER_STATEMENT_2 == parse_tree->member_grammer) &&
+        (symbol_table->member_grammer_statement_2_num != element_num))){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    TP_PARSE_TREE_ELEMENT* variable = &(parse_tree->member_element[element_num - 4]);
+    TP_PARSE_TREE_ELEMENT* expression = &(parse_tree->member_element[element_num - 2]);
+
+    if ((TP_PARSE_TREE_TYPE_TOKEN != variable->member_type) || (TP_PARSE_TREE_TYPE_NODE != expression->member_type)){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    uint32_t local_index = 0;
+
+    if ( ! tp_get_local_index(symbol_table, variable->member_body.member_tp_token, &local_index)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    uint32_t value = TP_IR_VALUE_NULL;
+
+    if ( ! make_ir_expression(symbol_table, expression->member_body.member_child, local_value, &value)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    local_value[local_index] = value;
+
+    if (symbol_table->member_last_statement == parse_tree){ // Setup by semantic analysis.
+
+        symbol_table->member_ir_return_value = value;
+    }
+
+    return true;
+}
+
+static bool make_ir_expression(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, uint32_t* local_value, uint32_t* value)
+{
+    switch (parse_tree->member_grammer){
+    // Grammer: Expression -> Term (('+' | '-') Term)*
+    case TP_PARSE_TREE_GRAMMER_EXPRESSION_1:
+//      break;
+    case TP_PARSE_TREE_GRAMMER_EXPRESSION_2:
+//      break;
+    // Grammer: Term -> Factor (('*' | '/') Factor)*
+    case TP_PARSE_TREE_GRAMMER_TERM_1:
+//      break;
+    case TP_PARSE_TREE_GRAMMER_TERM_2:
+        break;
+    // Grammer: Factor -> '(' Expression ')'
+    case TP_PARSE_TREE_GRAMMER_FACTOR_1:
+
+        if ((symbol_table->member_grammer_factor_1_num != parse_tree->member_element_num) ||
+            (TP_PARSE_TREE_TYPE_NODE != parse_tree->member_element[1].member_type)){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return false;
+        }
+
+        return make_ir_expression(symbol_table, parse_tree->member_element[1].member_body.member_child, local_value, value);
+    // Grammer: Factor -> ('+' | '-')? (variable | constant)
+    case TP_PARSE_TREE_GRAMMER_FACTOR_2:
+//      break;
+    case TP_PARSE_TREE_GRAMMER_FACTOR_3:
+        return make_ir_factor(symbol_table, parse_tree, local_value, value);
+    default:
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    // Grammer: (Expression | Term) ('+' | '-' | '*' | '/') (Term | Factor)
+
+    if ((3 != parse_tree->member_element_num) ||
+        (TP_PARSE_TREE_TYPE_NODE != parse_tree->member_element[0].member_type) ||
+        (TP_PARSE_TREE_TYPE_TOKEN != parse_tree->member_element[1].member_type) ||
+        (TP_PARSE_TREE_TYPE_NODE != parse_tree->member_element[2].member_type)){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    TP_IR_OPCODE opcode = TP_IR_OPCODE_NOP;
+
+    switch (parse_tree->member_element[1].member_body.member_tp_token->member_symbol){
+    case TP_SYMBOL_PLUS:
+        opcode = TP_IR_OPCODE_ADD;
+        break;
+    case TP_SYMBOL_MINUS:
+        opcode = TP_IR_OPCODE_SUB;
+        break;
+    case TP_SYMBOL_MUL:
+        opcode = TP_IR_OPCODE_MUL;
+        break;
+    case TP_SYMBOL_DIV:
+        opcode = TP_IR_OPCODE_DIV;
+        break;
+    default:
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    uint32_t op1 = TP_IR_VALUE_NULL;
+    uint32_t op2 = TP_IR_VALUE_NULL;
+
+    if ( ! make_ir_expression(symbol_table, parse_tree->member_element[0].member_body.member_child, local_value, &op1)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! make_ir_expression(symbol_table, parse_tree->member_element[2].member_body.member_child, local_value, &op2)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! append_ir_instruction(symbol_table, opcode, op1, op2, 0, value)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool make_ir_factor(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, uint32_t* local_value, uint32_t* value)
+{
+    // Factor -> ('+' | '-')? (variable | constant)
+
+    bool is_minus = false;
+    TP_TOKEN* token = NULL;
+
+    if (TP_PARSE_TREE_GRAMMER_FACTOR_2 == parse_tree->member_grammer){
+
+        if ((symbol_table->member_grammer_factor_2_num != parse_tree->member_element_num) ||
+            (TP_PARSE_TREE_TYPE_TOKEN != parse_tree->member_element[0].member_type) ||
+            (TP_PARSE_TREE_TYPE_TOKEN != parse_tree->member_element[1].member_type)){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return false;
+        }
+
+        is_minus = IS_TOKEN_MINUS(parse_tree->member_element[0].member_body.member_tp_token);
+        token = parse_tree->member_element[1].member_body.member_tp_token;
+    }else{
+
+        if ((symbol_table->member_grammer_factor_3_num != parse_tree->member_element_num) ||
+            (TP_PARSE_TREE_TYPE_TOKEN != parse_tree->member_element[0].member_type)){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return false;
+        }
+
+        token = parse_tree->member_element[0].member_body.member_tp_token;
+    }
+
+    if (IS_TOKEN_CONST_VALUE(token)){
+
+        int32_t const_value = (is_minus ? (int32_t)(0 - (uint32_t)(token->member_i32_value)) : token->member_i32_value);
+
+        return append_ir_instruction(symbol_table, TP_IR_OPCODE_CONST, TP_IR_VALUE_NULL, TP_IR_VALUE_NULL, const_value, value);
+    }
+
+    uint32_t local_index = 0;
+
+    if ( ! tp_get_local_index(symbol_table, token, &local_index)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if (TP_IR_VALUE_NULL == local_value[local_index]){
+
+        // NOTE: The parameters precede the local variables(see get_var_value function of tp_make_wasm.c).
+        bool is_param = (symbol_table->member_param_count > local_index);
+
+        if ( ! append_ir_instruction(
+            symbol_table, (is_param ? TP_IR_OPCODE_PARAM : TP_IR_OPCODE_CONST),
+            TP_IR_VALUE_NULL, TP_IR_VALUE_NULL, (is_param ? (int32_t)local_index : 0), &(local_value[local_index]))){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+    }
+
+    if (is_minus){
+
+        return append_ir_instruction(
+            symbol_table, TP_IR_OPCODE_NEG, local_value[local_index], TP_IR_VALUE_NULL, 0, value
+        );
+    }
+
+    *value = local_value[local_index];
+
+    return true;
+}
+
+static bool append_ir_instruction(
+    TP_SYMBOL_TABLE* symbol_table, TP_IR_OPCODE opcode, uint32_t op1, uint32_t op2, int32_t i32, uint32_t* value)
+{
+    uint32_t instruction_num_max =
+        (uint32_t)(symbol_table->member_ir_instruction_size / sizeof(TP_IR_INSTRUCTION));
+
+    if (instruction_num_max == symbol_table->member_ir_instruction_num){
+
+        uint32_t size_allocate_unit = TP_IR_INSTRUCTION_SIZE_ALLOCATE_UNIT * sizeof(TP_IR_INSTRUCTION);
+
+        uint32_t size = symbol_table->member_ir_instruction_size + size_allocate_unit;
+
+        if (symbol_table->member_ir_instruction_size > size){
+
+            TP_PUT_LOG_MSG(
+                symbol_table, TP_LOG_TYPE_DISP_FORCE,
+                TP_MSG_FMT("ERROR: symbol_table->member_ir_instruction_size(%1) > size(%2)"),
+                TP_LOG_PARAM_UINT64_VALUE(symbol_table->member_ir_instruction_size),
+                TP_LOG_PARAM_UINT64_VALUE(size)
+            );
+
+            return false;
+        }
+
+        TP_IR_INSTRUCTION* ir_instruction = (TP_IR_INSTRUCTION*)TP_REALLOC(symbol_table,
+            symbol_table->member_ir_instruction, size
+        );
+
+        if (NULL == ir_instruction){
+
+            TP_PRINT_CRT_ERROR(symbol_table);
+
+            return false;
+        }
+
+        symbol_table->member_ir_instruction = ir_instruction;
+        symbol_table->member_ir_instruction_size = size;
+    }
+
+    *value = symbol_table->member_ir_instruction_num;
+
+    TP_IR_INSTRUCTION* instruction = &(symbol_table->member_ir_instruction[*value]);
+
+    instruction->member_opcode = opcode;
+    instruction->member_op1 = op1;
+    instruction->member_op2 = op2;
+    instruction->member_i32 = i32;
+    instruction->member_use_count = 0;
+    instruction->member_local_index = TP_IR_VALUE_NULL;
+
+    ++(symbol_table->member_ir_instruction_num);
+
+    return true;
+}
@@ -128,7 +128,7 @@ static TP_PARSE_TREE* make_parse_subtree(
     TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE_GRAMMER grammer,
     TP_PARSE_TREE_ELEMENT* parse_tree_element, size_t parse_tree_element_num)
 {
-    TP_PARSE_TREE* parse_subtree = (TP_PARSE_TREE*)calloc(1, sizeof(TP_PARSE_TREE));
+    TP_PARSE_TREE* parse_subtree = (TP_PARSE_TREE*)TP_CALLOC(symbol_table, 1, sizeof(TP_PARSE_TREE));
 
     if (NULL == parse_subtree){
 
@@ -139,7 +139,7 @@ static TP_PARSE_TREE* make_parse_subtree(
 
     parse_subtree->member_grammer = grammer;
     parse_subtree->member_element_num = parse_tree_element_num;
-    parse_subtree->member_element = (TP_PARSE_TREE_ELEMENT*)calloc(
+    parse_subtree->member_element = (TP_PARSE_TREE_ELEMENT*)TP_CALLOC(symbol_table,
         parse_tree_element_num + 1, sizeof(TP_PARSE_TREE)
     );
 
@@ -152,6 +152,8 @@ static TP_PARSE_TREE* make_parse_subtree(
         return NULL;
     }
 
+    ++(symbol_table->member_tp_parse_tree_node_num);
+
     memcpy(
         parse_subtree->member_element, parse_tree_element,
         sizeof(TP_PARSE_TREE_ELEMENT) * parse_tree_element_num
@@ -569,6 +571,9 @@ static TP_PARSE_TREE* parse_expression(TP_SYMBOL_TABLE* symbol_table)
                 }
             }
 
+            // NOTE: The nesting level is of the parentheses, not of the statements.
+            --(symbol_table->member_nesting_level_of_expression);
+
             if (tmp_expression_1){
 
                 return tmp_expression_1;
@@ -581,6 +586,8 @@ skip:
         TP_POS(symbol_table) = backup_token_position;
     }
 
+    --(symbol_table->member_nesting_level_of_expression);
+
     return NULL;
 }
 
@@ -336,7 +336,7 @@ out:
 
     token->member_symbol = TP_SYMBOL_ID;
 
-    rsize_t id_length = id_pos - (*current_pos);
+    rsize_t id_length = id_pos - (uint8_t*)(*current_pos);
 
     if (TP_MAX_ID_BYTES < id_length){
 
@@ -370,7 +370,7 @@ static bool append_token(TP_SYMBOL_TABLE* symbol_table, TP_TOKEN* token)
 
         rsize_t tp_token_size =  symbol_table->member_tp_token_size + tp_token_size_allocate_unit;
 
-        TP_TOKEN* tp_token = (TP_TOKEN*)realloc(
+        TP_TOKEN* tp_token = (TP_TOKEN*)TP_REALLOC(symbol_table,
             symbol_table->member_tp_token, tp_token_size
         );
 
@@ -46,7 +46,7 @@
         size += payload_len; \
 \
         (section) = \
-            (TP_WASM_MODULE_SECTION*)calloc(1, sizeof(TP_WASM_MODULE_SECTION)); \
+            (TP_WASM_MODULE_SECTION*)TP_CALLOC(symbol_table, 1, sizeof(TP_WASM_MODULE_SECTION)); \
 \
         if (NULL == section){ \
 \
@@ -59,7 +59,7 @@
         (section)->member_id = (id); \
         (section)->member_payload_len = payload_len; \
 \
-        (section_buffer) = (section)->member_name_len_name_payload_data = (uint8_t*)calloc(size, sizeof(uint8_t)); \
+        (section_buffer) = (section)->member_name_len_name_payload_data = (uint8_t*)TP_CALLOC(symbol_table, size, sizeof(uint8_t)); \
 \
         if (NULL == (section_buffer)){ \
 \
@@ -132,6 +132,14 @@ static TP_WASM_MODULE_SECTION* make_section_memory(TP_SYMBOL_TABLE* symbol_table
 static TP_WASM_MODULE_SECTION* make_section_export(TP_SYMBOL_TABLE* symbol_table);
 static TP_WASM_MODULE_SECTION* make_section_code_origin_wasm(TP_SYMBOL_TABLE* symbol_table);
 static TP_WASM_MODULE_SECTION* make_section_code(TP_SYMBOL_TABLE* symbol_table);
+static bool wasm_gen_code(TP_SYMBOL_TABLE* symbol_table, TP_WASM_MODULE_SECTION* section);
+static bool wasm_gen_ir(TP_SYMBOL_TABLE* symbol_table, TP_WASM_MODULE_SECTION* section);
+static bool wasm_gen_ir_value(
+    TP_SYMBOL_TABLE* symbol_table, uint32_t value, bool is_operand, TP_WASM_MODULE_SECTION* section
+);
+static bool wasm_gen_opcode(
+    TP_SYMBOL_TABLE* symbol_table, TP_WASM_MODULE_SECTION* section, uint32_t wasm_opcode, int32_t immediate
+);
 static bool search_parse_tree(
     TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_WASM_MODULE_SECTION* section
 );
@@ -153,9 +161,13 @@ static bool wasm_gen_factor_1(
 static bool wasm_gen_factor_2_and_3(
     TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_WASM_MODULE_SECTION* section
 );
+static bool wasm_gen_common_subexpression(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_WASM_MODULE_SECTION* section, uint32_t wasm_opcode
+);
 static bool get_var_value(
     TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, size_t index, uint32_t* var_value
 );
+static bool append_wasm_instruction(TP_SYMBOL_TABLE* symbol_table, uint32_t wasm_opcode, int32_t immediate);
 static uint32_t make_get_local_code(uint8_t* buffer, size_t offset, uint32_t value);
 static uint32_t make_set_local_code(uint8_t* buffer, size_t offset, uint32_t value);
 static uint32_t make_tee_local_code(uint8_t* buffer, size_t offset, uint32_t value);
@@ -179,12 +191,63 @@ bool tp_make_wasm(TP_SYMBOL_TABLE* symbol_table, bool is_origin_wasm)
     return true;
 }
 
+bool tp_make_wasm_instruction(TP_SYMBOL_TABLE* symbol_table)
+{
+    // NOTE: When the wasm module is not needed, the wasm instructions are made of the parse tree
+    // or the SSA IR without encoding and decoding the wasm module(see tp_get_wasm_instruction).
+
+    if (symbol_table->member_wasm_instruction){
+
+        TP_FREE(symbol_table, &(symbol_table->member_wasm_instruction), symbol_table->member_wasm_instruction_size);
+    }
+
+    symbol_table->member_wasm_instruction_num = 0;
+    symbol_table->member_wasm_instruction_size = TP_WASM_INSTRUCTION_SIZE_ALLOCATE_UNIT * sizeof(TP_WASM_INSTRUCTION);
+
+    symbol_table->member_wasm_instruction = (TP_WASM_INSTRUCTION*)TP_CALLOC(symbol_table,
+        TP_WASM_INSTRUCTION_SIZE_ALLOCATE_UNIT, sizeof(TP_WASM_INSTRUCTION)
+    );
+
+    if (NULL == symbol_table->member_wasm_instruction){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        symbol_table->member_wasm_instruction_size = 0;
+
+        return false;
+    }
+
+    if ( ! wasm_gen_code(symbol_table, NULL)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! append_wasm_instruction(symbol_table, TP_WASM_OPCODE_END, 0)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    // Calculated by semantic analysis.
+    if ( ! tp_validate_wasm_instruction(symbol_table, symbol_table->member_param_count, symbol_table->member_var_count)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
+
 static bool wasm_gen(TP_SYMBOL_TABLE* symbol_table, bool is_origin_wasm)
 {
     TP_WASM_MODULE* module = &(symbol_table->member_wasm_module);
 
     TP_WASM_MODULE_SECTION** section =
-        (TP_WASM_MODULE_SECTION**)calloc(TP_SECTION_NUM, sizeof(TP_WASM_MODULE_SECTION*));
+        (TP_WASM_MODULE_SECTION**)TP_CALLOC(symbol_table, TP_SECTION_NUM, sizeof(TP_WASM_MODULE_SECTION*));
 
     if (NULL == section){
 
@@ -222,7 +285,7 @@ static bool wasm_gen(TP_SYMBOL_TABLE* symbol_table, bool is_origin_wasm)
             sizeof(module->member_module_content->member_version));
 
         {
-            TP_WASM_MODULE_CONTENT* tmp = (TP_WASM_MODULE_CONTENT*)calloc(
+            TP_WASM_MODULE_CONTENT* tmp = (TP_WASM_MODULE_CONTENT*)TP_CALLOC(symbol_table,
                 sizeof(TP_WASM_MODULE_CONTENT) + module->member_content_size, sizeof(uint8_t)
             );
 
@@ -302,15 +365,15 @@ static TP_WASM_MODULE_SECTION* make_section_type(TP_SYMBOL_TABLE* symbol_table)
 {
     uint32_t count = TP_WASM_MODULE_SECTION_TYPE_COUNT;
     uint32_t form = TP_WASM_MODULE_SECTION_TYPE_FORM_FUNC;
-    uint32_t param_count = TP_WASM_MODULE_SECTION_TYPE_PARAM_COUNT;
-//  uint32_t param_types;
+    uint32_t param_count = symbol_table->member_param_count; // Calculated by semantic analysis.
+    uint32_t param_type = TP_WASM_MODULE_SECTION_TYPE_PARAM_TYPE_I32;
     uint32_t return_count = TP_WASM_MODULE_SECTION_TYPE_RETURN_COUNT;
     uint32_t return_type = TP_WASM_MODULE_SECTION_TYPE_RETURN_TYPE_I32;
 
     uint32_t payload_len = tp_encode_ui32leb128(NULL, 0, count);
     payload_len += tp_encode_ui32leb128(NULL, 0, form);
     payload_len += tp_encode_ui32leb128(NULL, 0, param_count);
-//  payload_len += tp_encode_si64leb128(NULL, 0, param_types);
+    payload_len += (param_count * tp_encode_ui32leb128(NULL, 0, param_type));
     payload_len += tp_encode_ui32leb128(NULL, 0, return_count);
     payload_len += tp_encode_ui32leb128(NULL, 0, return_type);
 
@@ -326,7 +389,12 @@ static TP_WASM_MODULE_SECTION* make_section_type(TP_SYMBOL_TABLE* symbol_table)
     index += tp_encode_ui32leb128(section_buffer, index, count);
     index += tp_encode_ui32leb128(section_buffer, index, form);
     index += tp_encode_ui32leb128(section_buffer, index, param_count);
-//  index += tp_encode_si64leb128(section_buffer, index, param_types);
+
+    for (uint32_t i = 0; param_count > i; ++i){
+
+        index += tp_encode_ui32leb128(section_buffer, index, param_type);
+    }
+
     index += tp_encode_ui32leb128(section_buffer, index, return_count);
     (void)tp_encode_ui32leb128(section_buffer, index, return_type);
 
@@ -544,7 +612,7 @@ static TP_WASM_MODULE_SECTION* make_section_code(TP_SYMBOL_TABLE* symbol_table)
     body_size += tp_encode_ui32leb128(NULL, 0, var_type);
     symbol_table->member_code_body_size = body_size;
 
-    if ( ! search_parse_tree(symbol_table, symbol_table->member_tp_parse_tree, NULL)){
+    if ( ! wasm_gen_code(symbol_table, NULL)){
 
         TP_PUT_LOG_MSG_TRACE(symbol_table);
 
@@ -575,7 +643,7 @@ static TP_WASM_MODULE_SECTION* make_section_code(TP_SYMBOL_TABLE* symbol_table)
     index += tp_encode_ui32leb128(section_buffer, index, var_type);
     symbol_table->member_code_index = index;
 
-    if ( ! search_parse_tree(symbol_table, symbol_table->member_tp_parse_tree, section)){
+    if ( ! wasm_gen_code(symbol_table, section)){
 
         if (symbol_table->member_code_section_buffer){
 
@@ -597,6 +665,223 @@ static TP_WASM_MODULE_SECTION* make_section_code(TP_SYMBOL_TABLE* symbol_table)
     return section;
 }
 
+static bool wasm_gen_code(TP_SYMBOL_TABLE* symbol_table, TP_WASM_MODULE_SECTION* section)
+{
+    // NOTE: The SSA IR is made by -O2 only(see tp_make_ir.c).
+    if (symbol_table->member_ir_instruction){
+
+        if ( ! wasm_gen_ir(symbol_table, section)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        return true;
+    }
+
+    if ( ! search_parse_tree(symbol_table, symbol_table->member_tp_parse_tree, section)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool wasm_gen_ir(TP_SYMBOL_TABLE* symbol_table, TP_WASM_MODULE_SECTION* section)
+{
+    TP_IR_INSTRUCTION* ir = symbol_table->member_ir_instruction;
+    uint32_t instruction_num = symbol_table->member_ir_instruction_num;
+    uint32_t return_value = symbol_table->member_ir_return_value;
+
+    if (instruction_num <= return_value){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    // NOTE: The values of the local variables are evaluated in order of the values
+    // (see allocate_ir_local_variable function of tp_optimize_ir.c).
+    uint32_t last_local_value = TP_IR_VALUE_NULL;
+
+    for (uint32_t i = 0; instruction_num > i; ++i){
+
+        if (TP_IR_VALUE_NULL != ir[i].member_local_index){
+
+            last_local_value = i;
+        }
+    }
+
+    for (uint32_t i = 0; instruction_num > i; ++i){
+
+        uint32_t local_index = ir[i].member_local_index;
+
+        if (TP_IR_VALUE_NULL == local_index){
+
+            continue;
+        }
+
+        if ( ! wasm_gen_ir_value(symbol_table, i, false, section)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        // NOTE: The returned value of the last local variable remains on the wasm value stack.
+        uint32_t wasm_opcode = (((return_value == i) && (last_local_value == i)) ?
+            TP_WASM_OPCODE_TEE_LOCAL : TP_WASM_OPCODE_SET_LOCAL);
+
+        if ( ! wasm_gen_opcode(symbol_table, section, wasm_opcode, (int32_t)local_index)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+    }
+
+    if ((TP_IR_VALUE_NULL != ir[return_value].member_local_index) && (last_local_value == return_value)){
+
+        return true;
+    }
+
+    if ( ! wasm_gen_ir_value(symbol_table, return_value, true, section)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool wasm_gen_ir_value(
+    TP_SYMBOL_TABLE* symbol_table, uint32_t value, bool is_operand, TP_WASM_MODULE_SECTION* section)
+{
+    TP_IR_INSTRUCTION* instruction = &(symbol_table->member_ir_instruction[value]);
+
+    if (is_operand && (TP_IR_VALUE_NULL != instruction->member_local_index)){
+
+        return wasm_gen_opcode(symbol_table, section, TP_WASM_OPCODE_GET_LOCAL, (int32_t)(instruction->member_local_index));
+    }
+
+    uint32_t wasm_opcode = TP_WASM_OPCODE_END;
+
+    switch (instruction->member_opcode){
+    case TP_IR_OPCODE_PARAM:
+        return wasm_gen_opcode(symbol_table, section, TP_WASM_OPCODE_GET_LOCAL, instruction->member_i32);
+    case TP_IR_OPCODE_CONST:
+        return wasm_gen_opcode(symbol_table, section, TP_WASM_OPCODE_I32_CONST, instruction->member_i32);
+    case TP_IR_OPCODE_NEG:
+
+        // Change of sign.
+        if ( ! (wasm_gen_opcode(symbol_table, section, TP_WASM_OPCODE_I32_CONST, 0) &&
+            wasm_gen_ir_value(symbol_table, instruction->member_op1, true, section) &&
+            wasm_gen_opcode(symbol_table, section, TP_WASM_OPCODE_I32_SUB, 0))){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        return true;
+    case TP_IR_OPCODE_ADD:
+        wasm_opcode = TP_WASM_OPCODE_I32_ADD;
+        break;
+    case TP_IR_OPCODE_SUB:
+        wasm_opcode = TP_WASM_OPCODE_I32_SUB;
+        break;
+    case TP_IR_OPCODE_MUL:
+        wasm_opcode = TP_WASM_OPCODE_I32_MUL;
+        break;
+    case TP_IR_OPCODE_DIV:
+        wasm_opcode = TP_WASM_OPCODE_I32_DIV;
+        break;
+    default:
+
+        // NOTE: NOP and COPY are removed by tp_optimize_ir.
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! (wasm_gen_ir_value(symbol_table, instruction->member_op1, true, section) &&
+        wasm_gen_ir_value(symbol_table, instruction->member_op2, true, section) &&
+        wasm_gen_opcode(symbol_table, section, wasm_opcode, 0))){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool wasm_gen_opcode(
+    TP_SYMBOL_TABLE* symbol_table, TP_WASM_MODULE_SECTION* section, uint32_t wasm_opcode, int32_t immediate)
+{
+    if (symbol_table->member_wasm_instruction){
+
+        if ( ! append_wasm_instruction(symbol_table, wasm_opcode, immediate)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        return true;
+    }
+
+    uint8_t* buffer = (section ? symbol_table->member_code_section_buffer : NULL);
+    size_t offset = (section ? symbol_table->member_code_index : 0);
+    uint32_t size = 0;
+
+    switch (wasm_opcode){
+    case TP_WASM_OPCODE_GET_LOCAL:
+        size = make_get_local_code(buffer, offset, (uint32_t)immediate);
+        break;
+    case TP_WASM_OPCODE_SET_LOCAL:
+        size = make_set_local_code(buffer, offset, (uint32_t)immediate);
+        break;
+    case TP_WASM_OPCODE_TEE_LOCAL:
+        size = make_tee_local_code(buffer, offset, (uint32_t)immediate);
+        break;
+    case TP_WASM_OPCODE_I32_CONST:
+        size = make_i32_const_code(buffer, offset, immediate);
+        break;
+    case TP_WASM_OPCODE_I32_ADD:
+        size = make_i32_add_code(buffer, offset);
+        break;
+    case TP_WASM_OPCODE_I32_SUB:
+        size = make_i32_sub_code(buffer, offset);
+        break;
+    case TP_WASM_OPCODE_I32_MUL:
+        size = make_i32_mul_code(buffer, offset);
+        break;
+    case TP_WASM_OPCODE_I32_DIV:
+        size = make_i32_div_code(buffer, offset);
+        break;
+    default:
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    if (section){
+
+        symbol_table->member_code_index += size;
+    }else{
+
+        symbol_table->member_code_body_size += size;
+    }
+
+    return true;
+}
+
 static bool search_parse_tree(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_WASM_MODULE_SECTION* section)
 {
     bool is_make_section_code_success = true;
@@ -605,6 +890,12 @@ static bool search_parse_tree(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* pars
 
     size_t element_num = parse_tree->member_element_num;
 
+    // NOTE: The reused common subexpression is not evaluated again.
+    if (TP_PARSE_TREE_CSE_GET_LOCAL == parse_tree->member_cse_kind){
+
+        element_num = 0;
+    }
+
     for (size_t i = 0; element_num > i; ++i){
 
         if (TP_PARSE_TREE_TYPE_NULL == element[i].member_type){
@@ -631,6 +922,18 @@ static bool search_parse_tree(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* pars
 
 static bool make_section_code_content(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_WASM_MODULE_SECTION* section)
 {
+    if (TP_PARSE_TREE_CSE_GET_LOCAL == parse_tree->member_cse_kind){
+
+        if ( ! wasm_gen_common_subexpression(symbol_table, parse_tree, section, TP_WASM_OPCODE_GET_LOCAL)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        return true;
+    }
+
     switch (parse_tree->member_grammer){
     case TP_PARSE_TREE_GRAMMER_PROGRAM:
         break;
@@ -689,6 +992,16 @@ static bool make_section_code_content(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TR
         return false;
     }
 
+    if (TP_PARSE_TREE_CSE_TEE_LOCAL == parse_tree->member_cse_kind){
+
+        if ( ! wasm_gen_common_subexpression(symbol_table, parse_tree, section, TP_WASM_OPCODE_TEE_LOCAL)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+    }
+
     return true;
 }
 
@@ -744,6 +1057,21 @@ static bool wasm_gen_statement_1_and_2(
         return false;
     }
 
+    if (symbol_table->member_wasm_instruction){
+
+        uint32_t wasm_opcode = ((symbol_table->member_last_statement == parse_tree) ?
+            TP_WASM_OPCODE_TEE_LOCAL : TP_WASM_OPCODE_SET_LOCAL);
+
+        if ( ! append_wasm_instruction(symbol_table, wasm_opcode, (int32_t)var_value)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        return true;
+    }
+
     if (symbol_table->member_last_statement == parse_tree){
 
         if (section){
@@ -814,6 +1142,18 @@ static bool wasm_gen_expression_1_and_2(
 
     bool is_add = (TP_SYMBOL_PLUS == parse_tree->member_element[1].member_body.member_tp_token->member_symbol);
 
+    if (symbol_table->member_wasm_instruction){
+
+        if ( ! append_wasm_instruction(symbol_table, (is_add ? TP_WASM_OPCODE_I32_ADD : TP_WASM_OPCODE_I32_SUB), 0)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        return true;
+    }
+
     if (section){
 
         if (is_add){
@@ -884,6 +1224,18 @@ static bool wasm_gen_term_1_and_2(
 
     bool is_mul = (TP_SYMBOL_MUL == parse_tree->member_element[1].member_body.member_tp_token->member_symbol);
 
+    if (symbol_table->member_wasm_instruction){
+
+        if ( ! append_wasm_instruction(symbol_table, (is_mul ? TP_WASM_OPCODE_I32_MUL : TP_WASM_OPCODE_I32_DIV), 0)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        return true;
+    }
+
     if (section){
 
         if (is_mul){
@@ -1016,6 +1368,39 @@ static bool wasm_gen_factor_2_and_3(
         return false;
     }
 
+    if (symbol_table->member_wasm_instruction){
+
+        bool is_append_success = true;
+
+        if (is_const){
+
+            is_append_success = append_wasm_instruction(
+                symbol_table, TP_WASM_OPCODE_I32_CONST, (is_minus ? -const_value : const_value)
+            );
+        }else if (is_minus){
+
+            // Change of sign.
+            is_append_success =
+                append_wasm_instruction(symbol_table, TP_WASM_OPCODE_I32_CONST, -1) &&
+                append_wasm_instruction(symbol_table, TP_WASM_OPCODE_GET_LOCAL, (int32_t)var_value) &&
+                append_wasm_instruction(symbol_table, TP_WASM_OPCODE_I32_XOR, 0) &&
+                append_wasm_instruction(symbol_table, TP_WASM_OPCODE_I32_CONST, 1) &&
+                append_wasm_instruction(symbol_table, TP_WASM_OPCODE_I32_ADD, 0);
+        }else{
+
+            is_append_success = append_wasm_instruction(symbol_table, TP_WASM_OPCODE_GET_LOCAL, (int32_t)var_value);
+        }
+
+        if ( ! is_append_success){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        return true;
+    }
+
     uint8_t* p = symbol_table->member_code_section_buffer;
     size_t code_index = symbol_table->member_code_index;
     uint32_t code_body_size = symbol_table->member_code_body_size;
@@ -1067,6 +1452,66 @@ static bool wasm_gen_factor_2_and_3(
     return true;
 }
 
+static bool wasm_gen_common_subexpression(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_WASM_MODULE_SECTION* section, uint32_t wasm_opcode)
+{
+    // NOTE: The temporary variable is appended to the local variables(see tp_optimize_parse_tree.c).
+    uint32_t var_value = parse_tree->member_cse_local_index;
+
+    if ((symbol_table->member_param_count + symbol_table->member_var_count) <= var_value){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    if (symbol_table->member_wasm_instruction){
+
+        if ( ! append_wasm_instruction(symbol_table, wasm_opcode, (int32_t)var_value)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        return true;
+    }
+
+    switch (wasm_opcode){
+    case TP_WASM_OPCODE_GET_LOCAL:
+
+        if (section){
+
+            symbol_table->member_code_index += make_get_local_code(
+                symbol_table->member_code_section_buffer, symbol_table->member_code_index, var_value
+            );
+        }else{
+
+            symbol_table->member_code_body_size += make_get_local_code(NULL, 0, var_value);
+        }
+        break;
+    case TP_WASM_OPCODE_TEE_LOCAL:
+
+        if (section){
+
+            symbol_table->member_code_index += make_tee_local_code(
+                symbol_table->member_code_section_buffer, symbol_table->member_code_index, var_value
+            );
+        }else{
+
+            symbol_table->member_code_body_size += make_tee_local_code(NULL, 0, var_value);
+        }
+        break;
+    default:
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
+
 static bool get_var_value(
     TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, size_t index, uint32_t* var_value)
 {
@@ -1086,18 +1531,16 @@ static bool get_var_value(
         switch (register_object.member_register_object_type){
         case DEFINED_REGISTER_OBJECT:
 
-            *var_value = register_object.member_var_index; // Calculated by semantic analysis.
+            // Local variables follow the parameters.
+            *var_value = symbol_table->member_param_count + register_object.member_var_index; // Calculated by semantic analysis.
 
             break;
         case UNDEFINED_REGISTER_OBJECT:
 
-            TP_PUT_LOG_MSG(
-                symbol_table, TP_LOG_TYPE_DISP_FORCE,
-                TP_MSG_FMT("ERROR: use undefined symbol(%1)."),
-                TP_LOG_PARAM_STRING(token->member_string)
-            );
+            // Input parameter.
+            *var_value = register_object.member_var_index; // Calculated by semantic analysis.
 
-            return false;
+            break;
         default:
 
             TP_PUT_LOG_MSG_ICE(symbol_table);
@@ -1114,6 +1557,67 @@ static bool get_var_value(
     return true;
 }
 
+static bool append_wasm_instruction(TP_SYMBOL_TABLE* symbol_table, uint32_t wasm_opcode, int32_t immediate)
+{
+    uint32_t instruction_num_max =
+        (uint32_t)(symbol_table->member_wasm_instruction_size / sizeof(TP_WASM_INSTRUCTION));
+
+    if (instruction_num_max == symbol_table->member_wasm_instruction_num){
+
+        uint32_t size_allocate_unit = TP_WASM_INSTRUCTION_SIZE_ALLOCATE_UNIT * sizeof(TP_WASM_INSTRUCTION);
+
+        uint32_t size = symbol_table->member_wasm_instruction_size + size_allocate_unit;
+
+        if (symbol_table->member_wasm_instruction_size > size){
+
+            TP_PUT_LOG_MSG(
+                symbol_table, TP_LOG_TYPE_DISP_FORCE,
+                TP_MSG_FMT("ERROR: symbol_table->member_wasm_instruction_size(%1) > size(%2)"),
+                TP_LOG_PARAM_UINT64_VALUE(symbol_table->member_wasm_instruction_size),
+                TP_LOG_PARAM_UINT64_VALUE(size)
+            );
+
+            return false;
+        }
+
+        TP_WASM_INSTRUCTION* wasm_instruction = (TP_WASM_INSTRUCTION*)TP_REALLOC(symbol_table,
+            symbol_table->member_wasm_instruction, size
+        );
+
+        if (NULL == wasm_instruction){
+
+            TP_PRINT_CRT_ERROR(symbol_table);
+
+            return false;
+        }
+
+        symbol_table->member_wasm_instruction = wasm_instruction;
+        symbol_table->member_wasm_instruction_size = size;
+    }
+
+    TP_WASM_INSTRUCTION* instruction =
+        &(symbol_table->member_wasm_instruction[symbol_table->member_wasm_instruction_num]);
+
+    instruction->member_wasm_opcode = wasm_opcode;
+
+    switch (wasm_opcode){
+    case TP_WASM_OPCODE_GET_LOCAL:
+//      break;
+    case TP_WASM_OPCODE_SET_LOCAL:
+//      break;
+    case TP_WASM_OPCODE_TEE_LOCAL:
+        instruction->member_immediate.member_local_index = (uint32_t)immediate;
+        break;
+    default:
+        instruction->member_immediate.member_i32 = immediate;
+        break;
+    }
+
+    ++(symbol_table->member_wasm_instruction_num);
+
+    return true;
+}
+
 static uint32_t make_get_local_code(uint8_t* buffer, size_t offset, uint32_t value)
 {
     TP_MAKE_ULEB128_CODE(buffer, offset, TP_WASM_OPCODE_GET_LOCAL, value);
@@ -83,13 +83,24 @@
         } \
     }while (false)
 
-static uint32_t convert_section_code_content2x64(TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer);
-
-static bool wasm_stack_and_use_register_init(
+static bool get_wasm_export_code_body(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t** wasm_code_body_buffer, uint32_t* wasm_code_body_size,
+    uint32_t* param_count, uint32_t* var_count
+);
+static bool decode_wasm_instruction(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* wasm_code_body_buffer, uint32_t wasm_code_body_size
 );
+static uint32_t convert_section_code_content2x64(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t** x64_code_body_buffer, uint32_t* x64_code_body_buffer_size,
+    uint32_t* param_count
+);
+static bool reserve_x64_code_buffer(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t** x64_code_buffer, uint32_t* x64_code_buffer_size,
+    uint32_t x64_code_size, uint64_t reserve_size
+);
+
+static bool wasm_stack_and_use_register_init(TP_SYMBOL_TABLE* symbol_table);
 static bool wasm_stack_and_wasm_code_is_empty(TP_SYMBOL_TABLE* symbol_table);
-static bool wasm_stack_is_empty(TP_SYMBOL_TABLE* symbol_table);
 
 typedef enum tp_wasm_stack_pop_{
     TP_WASM_STACK_POP_MODE_DEFAULT,
@@ -98,37 +109,35 @@ typedef enum tp_wasm_stack_pop_{
 
 static TP_WASM_STACK_ELEMENT wasm_stack_pop(TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_POP_MODE pop_mode);
 
-static bool allocate_variable_common(
-    TP_SYMBOL_TABLE* symbol_table, TP_X64_ALLOCATE_MODE allocate_mode,
-    uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t* x64_code_size,
-    TP_WASM_STACK_ELEMENT* wasm_stack_element
-);
-static bool get_free_register(
-    TP_SYMBOL_TABLE* symbol_table,
-    TP_X86_32_REGISTER* x86_32_register, TP_X64_32_REGISTER* x64_32_register, bool* is_zero_free_register
-);
-static bool spilling_variable(
-    TP_SYMBOL_TABLE* symbol_table,
-    uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t* x64_code_size,
-    TP_X86_32_REGISTER* x86_32_register, TP_X64_32_REGISTER* x64_32_register,
-    TP_WASM_STACK_ELEMENT* wasm_stack_element
-);
-static bool get_free_register_in_wasm_stack(
-    TP_SYMBOL_TABLE* symbol_table,
-    TP_X86_32_REGISTER* free_x86_32_register, TP_X64_32_REGISTER* free_x64_32_register,
-    bool* is_zero_free_register_in_wasm_stack
-);
-static bool get_spill_register(
-    TP_SYMBOL_TABLE* symbol_table,
-    TP_X86_32_REGISTER* x86_32_register, TP_X64_32_REGISTER* x64_32_register
-);
-static bool set_nv_register(
-    TP_SYMBOL_TABLE* symbol_table,
-    TP_X86_32_REGISTER x86_32_register, TP_X64_32_REGISTER x64_32_register
+static bool allocate_x64_register(TP_SYMBOL_TABLE* symbol_table);
+static int compare_x64_live_range(const void* param1, const void* param2);
+static bool is_free_x64_register(
+    TP_X64_LIVE_RANGE* live_range, TP_X64_LIVE_RANGE** register_owner, TP_X64_64_REGISTER x64_register
 );
+static bool make_x64_live_range(TP_SYMBOL_TABLE* symbol_table);
+static bool is_spill_x64_live_range(TP_X64_LIVE_RANGE* live_range, TP_X64_LIVE_RANGE* spill_live_range);
+static bool is_use_x64_register(TP_SYMBOL_TABLE* symbol_table, TP_X64_64_REGISTER x64_register);
+static bool use_x64_param_register(TP_SYMBOL_TABLE* symbol_table, uint32_t param_count);
+static void set_x64_register_item(TP_WASM_STACK_ELEMENT* wasm_stack_element, TP_X64_64_REGISTER x64_register);
+static void set_nv_register(TP_SYMBOL_TABLE* symbol_table, TP_X64_64_REGISTER x64_register);
+
+// NOTE: Volatile registers come first because non-volatile registers are saved by the prologue,
+// and EAX is the last of them because the dividend of IDIV and the return value prefer it.
+static const TP_X64_64_REGISTER x64_allocatable_register[] = {
+    TP_X64_64_REGISTER_RCX, TP_X64_64_REGISTER_RDX,
+    TP_X64_64_REGISTER_R8, TP_X64_64_REGISTER_R9, TP_X64_64_REGISTER_R10, TP_X64_64_REGISTER_R11,
+    TP_X64_64_REGISTER_RAX,
+    TP_X64_64_REGISTER_RBX, TP_X64_64_REGISTER_RSI, TP_X64_64_REGISTER_RDI,
+    TP_X64_64_REGISTER_R12, TP_X64_64_REGISTER_R13, TP_X64_64_REGISTER_R14, TP_X64_64_REGISTER_R15
+};
+
+#define TP_X64_ALLOCATABLE_REGISTER_NUM (sizeof(x64_allocatable_register) / sizeof(TP_X64_64_REGISTER))
+#define TP_X64_LIVE_RANGE_NONE UINT32_MAX
+#define TP_X64_TEMPORARY_VARIABLE_NUM_MAX (TP_WASM_TEMPORARY_VARIABLE_MAX_DEFAULT / sizeof(int32_t))
 
 static bool get_wasm_export_code_section(
-    TP_SYMBOL_TABLE* symbol_table, TP_WASM_MODULE_SECTION** code_section, uint32_t* return_type
+    TP_SYMBOL_TABLE* symbol_table, TP_WASM_MODULE_SECTION** code_section,
+    uint32_t* param_count, uint32_t* return_type
 );
 static bool make_wasm_module_section(
     TP_SYMBOL_TABLE* symbol_table, TP_WASM_MODULE* module, TP_WASM_MODULE_SECTION*** section
@@ -141,7 +150,8 @@ static void free_wasm_module_section(
 );
 static bool get_wasm_module_code_section(
     TP_SYMBOL_TABLE* symbol_table,
-    TP_WASM_MODULE_SECTION** section, uint32_t section_num, uint32_t* code_section_index, uint32_t* return_type
+    TP_WASM_MODULE_SECTION** section, uint32_t section_num, uint32_t* code_section_index,
+    uint32_t* param_count, uint32_t* return_type
 );
 static bool get_wasm_module_export_section_item_index(
     TP_SYMBOL_TABLE* symbol_table,
@@ -151,142 +161,249 @@ static bool get_wasm_module_function_section_type(
     TP_SYMBOL_TABLE* symbol_table,
     TP_WASM_MODULE_SECTION** section, uint32_t section_num, uint32_t item_index, uint32_t* type
 );
-static bool get_wasm_module_type_section_return_type(
+static bool get_wasm_module_type_section_signature(
     TP_SYMBOL_TABLE* symbol_table,
-    TP_WASM_MODULE_SECTION** section, uint32_t section_num, uint32_t type, uint32_t* return_type
+    TP_WASM_MODULE_SECTION** section, uint32_t section_num, uint32_t type,
+    uint32_t* param_count, uint32_t* return_type
 );
 static bool get_wasm_module_code_section_index(
     TP_SYMBOL_TABLE* symbol_table,
     TP_WASM_MODULE_SECTION** section, uint32_t section_num, uint32_t* code_section_index
 );
 
-typedef int (*x64_jit_func)(void);
-
 bool tp_make_x64_code(TP_SYMBOL_TABLE* symbol_table, int32_t* return_value)
 {
     uint8_t* x64_code_buffer = NULL;
+    uint32_t x64_code_buffer_size = 0;
 
-    memset(
-        symbol_table->member_use_nv_register,
-        TP_X64_NV64_REGISTER_NULL, sizeof(symbol_table->member_use_nv_register)
-    );
+    tp_begin_compile_phase(symbol_table);
 
-    uint32_t x64_code_buffer_size1 = convert_section_code_content2x64(symbol_table, NULL);
+    if ( ! tp_make_x64_function(symbol_table, &x64_code_buffer, &x64_code_buffer_size)){
 
-    if (0 == x64_code_buffer_size1){
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-        TP_PUT_LOG_MSG(
-            symbol_table, TP_LOG_TYPE_DISP_FORCE,
-            TP_MSG_FMT("%1"), TP_LOG_PARAM_STRING("ERROR: 0 == x64_code_buffer_size1")
+        return false;
+    }
+
+    // NOTE: The call of the x64 code is not a compile phase.
+    tp_end_compile_phase(symbol_table, TP_COMPILE_PHASE_X64_CODE, x64_code_buffer_size);
+
+    int32_t value = 0;
+
+    if ((0 == symbol_table->member_param_count) &&
+        (TP_X64_ENTRY_MODE_BATCH != symbol_table->member_x64_entry_mode)){
+
+        TP_X64_JIT_FUNC func = (TP_X64_JIT_FUNC)x64_code_buffer;
+
+        value = func();
+    }else{
+
+        // All input variables are zero on the command line(batch mode: one row).
+        TP_COMPILED_FUNCTION function = {
+            .member_x64_code = x64_code_buffer,
+            .member_x64_code_size = x64_code_buffer_size,
+            .member_param_count = symbol_table->member_param_count,
+            .member_entry_mode = symbol_table->member_x64_entry_mode,
+            .member_x64_jit_func = (TP_X64_JIT_FUNC)x64_code_buffer
+        };
+
+        rsize_t inputs_size = symbol_table->member_param_count * sizeof(int32_t);
+
+        int32_t* inputs = NULL;
+
+        if (inputs_size){
+
+            inputs = (int32_t*)TP_CALLOC(symbol_table, symbol_table->member_param_count, sizeof(int32_t));
+
+            if (NULL == inputs){
+
+                TP_PRINT_CRT_ERROR(symbol_table);
+
+                (void)tp_code_arena_free(symbol_table, x64_code_buffer);
+
+                return false;
+            }
+        }
+
+        bool is_call_success = tp_call_compiled_function_with_inputs(
+            &function, inputs, symbol_table->member_param_count, &value
         );
 
-        goto convert_error;
-    }
+        TP_FREE(symbol_table, &inputs, inputs_size);
+
+        if ( ! is_call_success){
 
-    for (rsize_t i = 0; TP_X64_NV64_REGISTER_NUM > i; ++i){
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-        if (TP_X64_NV64_REGISTER_NULL != symbol_table->member_use_nv_register[i]){
+            (void)tp_code_arena_free(symbol_table, x64_code_buffer);
 
-            ++x64_code_buffer_size1;
+            return false;
         }
     }
 
-    x64_code_buffer = (uint8_t*)VirtualAlloc(
-        NULL, x64_code_buffer_size1,
-        MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE
-    );
+    if ( ! symbol_table->member_is_no_output_messages){
 
-    if (NULL == x64_code_buffer){
+        printf("x64_jit_func() = %d\n", value);
+    }
 
-        TP_GET_LAST_ERROR(symbol_table);
+    if (return_value){
 
-        goto convert_error;
+        *return_value = value;
     }
 
-    // Temporary variables.
-    {
-        int32_t v = symbol_table->member_register_bytes +
-            symbol_table->member_padding_register_bytes +
-            symbol_table->member_temporary_variable_size;
+    errno_t err = _set_errno(0);
+
+    if ( ! tp_code_arena_free(symbol_table, x64_code_buffer)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-        symbol_table->member_padding_temporary_variable_bytes = ((-v) & TP_PADDING_MASK);
+        return false;
     }
 
-    uint32_t x64_code_buffer_size2 = convert_section_code_content2x64(symbol_table, x64_code_buffer);
+    x64_code_buffer = NULL;
+
+    return true;
+}
+
+bool tp_make_x64_function(TP_SYMBOL_TABLE* symbol_table, uint8_t** x64_code, uint32_t* x64_code_size)
+{
+    uint8_t* x64_code_body_buffer = NULL;
+    uint32_t x64_code_body_buffer_size = 0;
+    uint32_t param_count = 0;
+    uint8_t* x64_code_buffer = NULL;
+    uint8_t* writable_x64_code_buffer = NULL;
+
+    memset(
+        symbol_table->member_use_nv_register,
+        TP_X64_NV64_REGISTER_NULL, sizeof(symbol_table->member_use_nv_register)
+    );
+
+    symbol_table->member_is_record_x64_instruction = false;
+
+    // Single pass: the function body is encoded into a growable buffer, and the prologue is
+    // encoded after that because the stack frame is fixed at the end of the function body.
+    uint32_t x64_code_body_size = convert_section_code_content2x64(
+        symbol_table, &x64_code_body_buffer, &x64_code_body_buffer_size, &param_count
+    );
 
-    if (0 == x64_code_buffer_size2){
+    if (0 == x64_code_body_size){
 
         TP_PUT_LOG_MSG(
             symbol_table, TP_LOG_TYPE_DISP_FORCE,
-            TP_MSG_FMT("%1"), TP_LOG_PARAM_STRING("ERROR: 0 == x64_code_buffer_size2")
+            TP_MSG_FMT("%1"), TP_LOG_PARAM_STRING("ERROR: 0 == x64_code_body_size")
         );
 
         goto convert_error;
     }
 
-    if (x64_code_buffer_size1 != x64_code_buffer_size2){
+    uint32_t x64_code_prologue_size = 0;
+
+    if ( ! tp_encode_allocate_stack(symbol_table, NULL, 0, param_count, &x64_code_prologue_size)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto convert_error;
+    }
+
+    uint32_t x64_code_buffer_size = x64_code_prologue_size + x64_code_body_size;
+
+    if (x64_code_buffer_size < x64_code_body_size){
 
         TP_PUT_LOG_MSG(
             symbol_table, TP_LOG_TYPE_DISP_FORCE,
-            TP_MSG_FMT("%1"), TP_LOG_PARAM_STRING("ERROR: x64_code_buffer_size1 != x64_code_buffer_size2")
+            TP_MSG_FMT("ERROR: x64_code_buffer_size(%1) < x64_code_body_size(%2)"),
+            TP_LOG_PARAM_UINT64_VALUE(x64_code_buffer_size),
+            TP_LOG_PARAM_UINT64_VALUE(x64_code_body_size)
         );
 
         goto convert_error;
     }
 
-    if ((false ==  symbol_table->member_is_no_output_files) ||
-        (symbol_table->member_is_no_output_files && symbol_table->member_is_output_x64_file)){
+    if ( ! tp_code_arena_allocate(
+        symbol_table, x64_code_buffer_size, &x64_code_buffer, &writable_x64_code_buffer)){
 
-        if ( ! tp_write_file(
-            symbol_table, symbol_table->member_x64_file_path, x64_code_buffer, x64_code_buffer_size2)){
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-            goto convert_error;
-        }
+        goto convert_error;
     }
 
-    DWORD old_protect = 0;
+    uint32_t x64_code_prologue_write_size = 0;
 
-    if ( ! VirtualProtect(x64_code_buffer, x64_code_buffer_size2, PAGE_EXECUTE_READ, &old_protect)){
+    if ( ! tp_encode_allocate_stack(
+        symbol_table, writable_x64_code_buffer, 0, param_count, &x64_code_prologue_write_size)){
 
-        TP_GET_LAST_ERROR(symbol_table);
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
 
         goto convert_error;
     }
 
-    x64_jit_func func = (x64_jit_func)x64_code_buffer;
+    if (x64_code_prologue_size != x64_code_prologue_write_size){
 
-    int value = func();
+        TP_PUT_LOG_MSG_ICE(symbol_table);
 
-    if ( ! symbol_table->member_is_no_output_messages){
+        goto convert_error;
+    }
 
-        printf("x64_jit_func() = %d\n", value);
+    memcpy(writable_x64_code_buffer + x64_code_prologue_size, x64_code_body_buffer, x64_code_body_size);
+
+    TP_FREE(symbol_table, &x64_code_body_buffer, x64_code_body_buffer_size);
+
+    if ( ! tp_code_arena_publish(symbol_table, x64_code_buffer, x64_code_buffer_size)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto convert_error;
     }
 
-    if (return_value){
+    if ((false ==  symbol_table->member_is_no_output_files) ||
+        (symbol_table->member_is_no_output_files && symbol_table->member_is_output_x64_file)){
 
-        *return_value = value;
+        if ( ! tp_write_file(
+            symbol_table, symbol_table->member_x64_file_path, x64_code_buffer, x64_code_buffer_size)){
+
+            goto convert_error;
+        }
     }
 
-    errno_t err = _set_errno(0);
+    if (symbol_table->member_is_output_elf_object_file){
+
+        if ( ! tp_make_elf_file(
+            symbol_table, symbol_table->member_elf_object_file_path, TP_ELF_DEFAULT_SYMBOL_NAME,
+            x64_code_buffer, x64_code_buffer_size,
+            symbol_table->member_param_count, symbol_table->member_x64_entry_mode, false)){
+
+            goto convert_error;
+        }
+    }
 
-    if ( ! VirtualFree(x64_code_buffer, 0, MEM_RELEASE)){
+    if (symbol_table->member_is_output_elf_shared_object_file){
 
-        TP_GET_LAST_ERROR(symbol_table);
+        if ( ! tp_make_elf_file(
+            symbol_table, symbol_table->member_elf_shared_object_file_path, TP_ELF_DEFAULT_SYMBOL_NAME,
+            x64_code_buffer, x64_code_buffer_size,
+            symbol_table->member_param_count, symbol_table->member_x64_entry_mode, true)){
 
-        return false;
+            goto convert_error;
+        }
     }
 
-    x64_code_buffer = NULL;
+    *x64_code = x64_code_buffer;
+    *x64_code_size = x64_code_buffer_size;
 
     return true;
 
 convert_error:
 
+    if (x64_code_body_buffer){
+
+        TP_FREE(symbol_table, &x64_code_body_buffer, x64_code_body_buffer_size);
+    }
+
     if (x64_code_buffer){
 
-        if ( ! VirtualFree(x64_code_buffer, 0, MEM_RELEASE)){
+        if ( ! tp_code_arena_free(symbol_table, x64_code_buffer)){
 
-            TP_GET_LAST_ERROR(symbol_table);
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
         }
 
         x64_code_buffer = NULL;
@@ -295,162 +412,684 @@ convert_error:
     return false;
 }
 
-static uint32_t convert_section_code_content2x64(TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer)
+bool tp_get_wasm_instruction(TP_SYMBOL_TABLE* symbol_table)
 {
-    uint32_t x64_code_size = 0;
+    // NOTE: The wasm instructions of the parse tree(see tp_make_wasm_instruction) or of
+    // the previous translation are reused.
+    if (symbol_table->member_wasm_instruction){
 
-    TP_WASM_MODULE_SECTION* code_section = NULL;
-    uint32_t return_type = 0;
+        return true;
+    }
+
+    uint8_t* wasm_code_body_buffer = NULL;
+    uint32_t wasm_code_body_size = 0;
+    uint32_t param_count = 0;
+    uint32_t var_count = 0;
 
-    if ( ! get_wasm_export_code_section(symbol_table, &code_section, &return_type)){
+    if ( ! get_wasm_export_code_body(
+        symbol_table, &wasm_code_body_buffer, &wasm_code_body_size, &param_count, &var_count)){
 
         TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-        goto error_proc;
+        return false;
     }
 
-    uint8_t* payload = code_section->member_name_len_name_payload_data;
-    uint32_t offset = 0;
-
-    TP_DECODE_UI32LEB128_CHECK_VALUE(symbol_table, code_section, payload, offset, TP_WASM_SECTION_TYPE_CODE);
-
-    uint32_t payload_len = 0;
-    TP_DECODE_UI32LEB128_GET_VALUE(symbol_table, code_section, payload, offset, payload_len);
+    if ( ! decode_wasm_instruction(symbol_table, wasm_code_body_buffer, wasm_code_body_size)){
 
-    TP_DECODE_UI32LEB128_CHECK_VALUE(symbol_table, code_section, payload, offset, TP_WASM_MODULE_SECTION_CODE_COUNT);
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-    uint32_t body_size = 0;
-    TP_DECODE_UI32LEB128_GET_VALUE(symbol_table, code_section, payload, offset, body_size);
+        goto error_proc;
+    }
 
-    if (0 == body_size){
+    if ( ! tp_validate_wasm_instruction(symbol_table, param_count, var_count)){
 
-        TP_PUT_LOG_MSG(
-            symbol_table, TP_LOG_TYPE_DISP_FORCE,
-            TP_MSG_FMT("%1"), TP_LOG_PARAM_STRING("ERROR: 0 == body_size")
-        );
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
 
         goto error_proc;
     }
 
-    uint32_t local_count = TP_WASM_MODULE_SECTION_CODE_LOCAL_COUNT;
-    uint32_t var_type = TP_WASM_MODULE_SECTION_CODE_VAR_TYPE_I32;
+    return true;
 
-    TP_DECODE_UI32LEB128_CHECK_VALUE(symbol_table, code_section, payload, offset, local_count);
+error_proc:
 
-    uint32_t var_count = 0;
-    TP_DECODE_UI32LEB128_GET_VALUE(symbol_table, code_section, payload, offset, var_count);
+    if (symbol_table->member_wasm_instruction){
 
-    TP_DECODE_UI32LEB128_CHECK_VALUE(symbol_table, code_section, payload, offset, var_type);
+        TP_FREE(symbol_table, &(symbol_table->member_wasm_instruction), symbol_table->member_wasm_instruction_size);
+    }
 
-    uint32_t wasm_code_body_size = body_size;
+    symbol_table->member_wasm_instruction_num = 0;
+    symbol_table->member_wasm_instruction_size = 0;
 
-    wasm_code_body_size -= tp_encode_ui32leb128(NULL, 0, local_count);
-    wasm_code_body_size -= tp_encode_ui32leb128(NULL, 0, var_count);
-    wasm_code_body_size -= tp_encode_ui32leb128(NULL, 0, var_type);
+    return false;
+}
 
-    uint8_t* wasm_code_body_buffer = payload + offset;
+bool tp_validate_wasm_instruction(TP_SYMBOL_TABLE* symbol_table, uint32_t param_count, uint32_t var_count)
+{
+    // NOTE: Local indexes and the wasm stack depth are checked here once,
+    // so the passes over the wasm instructions do not check them.
 
-    if ( ! wasm_stack_and_use_register_init(symbol_table, wasm_code_body_buffer, wasm_code_body_size)){
+    uint32_t local_num = param_count + var_count;
 
-        TP_PUT_LOG_MSG_TRACE(symbol_table);
+    if ((local_num < param_count) || (INT32_MAX < local_num)){
 
-        goto error_proc;
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE,
+            TP_MSG_FMT("ERROR: Bad number of local variables(param_count: %1, var_count: %2)."),
+            TP_LOG_PARAM_UINT64_VALUE(param_count),
+            TP_LOG_PARAM_UINT64_VALUE(var_count)
+        );
+
+        return false;
     }
 
-    uint32_t tmp_x64_code_size = tp_encode_allocate_stack(
-        symbol_table, x64_code_buffer, x64_code_size, var_count, var_type
-    );
+    uint32_t stack_depth = 0;
+    uint32_t stack_depth_max = 0;
 
-    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    for (uint32_t i = 0; symbol_table->member_wasm_instruction_num > i; ++i){
 
-    do{
-        TP_WASM_STACK_ELEMENT op1 = { 0 };
-        TP_WASM_STACK_ELEMENT op2 = { 0 };
+        TP_WASM_INSTRUCTION* instruction = &(symbol_table->member_wasm_instruction[i]);
 
-        TP_WASM_STACK_ELEMENT opcode = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_DEFAULT);
+        uint32_t pop_num = 0;
+        uint32_t push_num = 0;
 
-        switch (opcode.member_wasm_opcode){
+        switch (instruction->member_wasm_opcode){
         case TP_WASM_OPCODE_GET_LOCAL:
-            tmp_x64_code_size = tp_encode_get_local_code(
-                symbol_table, x64_code_buffer, x64_code_size, opcode.member_local_index
-            );
-            break;
+            push_num = 1;
+//          break;
         case TP_WASM_OPCODE_SET_LOCAL:
-            op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
-            tmp_x64_code_size = tp_encode_set_local_code(
-                symbol_table, x64_code_buffer, x64_code_size, opcode.member_local_index, &op1
-            );
-            break;
+//          break;
         case TP_WASM_OPCODE_TEE_LOCAL:
-            op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
-            tmp_x64_code_size = tp_encode_tee_local_code(
-                symbol_table, x64_code_buffer, x64_code_size, opcode.member_local_index, &op1
-            );
+
+            if (local_num <= instruction->member_immediate.member_local_index){
+
+                TP_PUT_LOG_MSG(
+                    symbol_table, TP_LOG_TYPE_DISP_FORCE,
+                    TP_MSG_FMT("ERROR: Bad local index(%1) of wasm opcode(%2)."),
+                    TP_LOG_PARAM_UINT64_VALUE(instruction->member_immediate.member_local_index),
+                    TP_LOG_PARAM_UINT64_VALUE(instruction->member_wasm_opcode)
+                );
+
+                return false;
+            }
+
+            if (TP_WASM_OPCODE_SET_LOCAL == instruction->member_wasm_opcode){
+
+                pop_num = 1;
+            }else if (TP_WASM_OPCODE_TEE_LOCAL == instruction->member_wasm_opcode){
+
+                pop_num = 1;
+                push_num = 1;
+            }
             break;
         case TP_WASM_OPCODE_I32_CONST:
-            tmp_x64_code_size = tp_encode_i32_const_code(symbol_table, x64_code_buffer, x64_code_size, opcode.member_i32);
+            push_num = 1;
             break;
         case TP_WASM_OPCODE_I32_ADD:
-            op2 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
-            op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
-            tmp_x64_code_size = tp_encode_i32_add_code(symbol_table, x64_code_buffer, x64_code_size, &op1, &op2);
-            break;
+//          break;
         case TP_WASM_OPCODE_I32_SUB:
-            op2 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
-            op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
-            tmp_x64_code_size = tp_encode_i32_sub_code(symbol_table, x64_code_buffer, x64_code_size, &op1, &op2);
-            break;
+//          break;
         case TP_WASM_OPCODE_I32_MUL:
-            op2 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
-            op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
-            tmp_x64_code_size = tp_encode_i32_mul_code(symbol_table, x64_code_buffer, x64_code_size, &op1, &op2);
-            break;
+//          break;
         case TP_WASM_OPCODE_I32_DIV:
-            op2 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
-            op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
-            tmp_x64_code_size = tp_encode_i32_div_code(symbol_table, x64_code_buffer, x64_code_size, &op1, &op2);
-            break;
+//          break;
         case TP_WASM_OPCODE_I32_XOR:
-            op2 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
-            op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
-            tmp_x64_code_size = tp_encode_i32_xor_code(symbol_table, x64_code_buffer, x64_code_size, &op1, &op2);
+            pop_num = 2;
+            push_num = 1;
             break;
         case TP_WASM_OPCODE_END:
 
-            tmp_x64_code_size = tp_encode_end_code(symbol_table, x64_code_buffer, x64_code_size);
+            // NOTE: The return value is the only value of the wasm stack.
+            if (((symbol_table->member_wasm_instruction_num - 1) != i) || (1 != stack_depth)){
 
-            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+                TP_PUT_LOG_MSG(
+                    symbol_table, TP_LOG_TYPE_DISP_FORCE,
+                    TP_MSG_FMT("ERROR: Bad end of wasm code(index: %1, stack_depth: %2)."),
+                    TP_LOG_PARAM_UINT64_VALUE(i),
+                    TP_LOG_PARAM_UINT64_VALUE(stack_depth)
+                );
 
-            op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
+                return false;
+            }
 
-            if ( ! wasm_stack_and_wasm_code_is_empty(symbol_table)){
+            symbol_table->member_wasm_instruction_param_count = param_count;
+            symbol_table->member_wasm_instruction_var_count = var_count;
+            symbol_table->member_wasm_instruction_stack_depth_max = stack_depth_max;
 
-                TP_PUT_LOG_MSG_TRACE(symbol_table);
+            return true;
+        default:
 
-                goto error_proc;
-            }
+            TP_PUT_LOG_MSG(
+                symbol_table, TP_LOG_TYPE_DISP_FORCE,
+                TP_MSG_FMT("ERROR: Not supported wasm opcode(%1)."),
+                TP_LOG_PARAM_UINT64_VALUE(instruction->member_wasm_opcode)
+            );
 
-            return x64_code_size;
-        default:
+            return false;
+        }
 
-            TP_PUT_LOG_MSG_ICE(symbol_table);
+        if (stack_depth < pop_num){
 
-            goto error_proc;
+            TP_PUT_LOG_MSG(
+                symbol_table, TP_LOG_TYPE_DISP_FORCE,
+                TP_MSG_FMT("ERROR: wasm stack underflow of wasm opcode(%1)."),
+                TP_LOG_PARAM_UINT64_VALUE(instruction->member_wasm_opcode)
+            );
+
+            return false;
         }
 
-        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+        stack_depth = stack_depth - pop_num + push_num;
 
-    }while (true);
+        if (stack_depth_max < stack_depth){
 
-error_proc:
+            stack_depth_max = stack_depth;
+        }
+    }
 
-    return 0;
+    TP_PUT_LOG_MSG(
+        symbol_table, TP_LOG_TYPE_DISP_FORCE,
+        TP_MSG_FMT("%1"), TP_LOG_PARAM_STRING("ERROR: No end of wasm code.")
+    );
+
+    return false;
 }
 
-static bool wasm_stack_and_use_register_init(
-    TP_SYMBOL_TABLE* symbol_table, uint8_t* wasm_code_body_buffer, uint32_t wasm_code_body_size)
+static bool get_wasm_export_code_body(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t** wasm_code_body_buffer, uint32_t* wasm_code_body_size,
+    uint32_t* param_count, uint32_t* var_count)
 {
-    // wasm_stack_init
+    TP_WASM_MODULE_SECTION* code_section = NULL;
+    uint32_t return_type = 0;
+
+    if ( ! get_wasm_export_code_section(symbol_table, &code_section, param_count, &return_type)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    uint8_t* payload = code_section->member_name_len_name_payload_data;
+    uint32_t offset = 0;
+
+    TP_DECODE_UI32LEB128_CHECK_VALUE(symbol_table, code_section, payload, offset, TP_WASM_SECTION_TYPE_CODE);
+
+    uint32_t payload_len = 0;
+    TP_DECODE_UI32LEB128_GET_VALUE(symbol_table, code_section, payload, offset, payload_len);
+
+    TP_DECODE_UI32LEB128_CHECK_VALUE(symbol_table, code_section, payload, offset, TP_WASM_MODULE_SECTION_CODE_COUNT);
+
+    uint32_t body_size = 0;
+    TP_DECODE_UI32LEB128_GET_VALUE(symbol_table, code_section, payload, offset, body_size);
+
+    if (0 == body_size){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE,
+            TP_MSG_FMT("%1"), TP_LOG_PARAM_STRING("ERROR: 0 == body_size")
+        );
+
+        goto error_proc;
+    }
+
+    uint32_t local_count = TP_WASM_MODULE_SECTION_CODE_LOCAL_COUNT;
+    uint32_t var_type = TP_WASM_MODULE_SECTION_CODE_VAR_TYPE_I32;
+
+    TP_DECODE_UI32LEB128_CHECK_VALUE(symbol_table, code_section, payload, offset, local_count);
+
+    TP_DECODE_UI32LEB128_GET_VALUE(symbol_table, code_section, payload, offset, *var_count);
+
+    TP_DECODE_UI32LEB128_CHECK_VALUE(symbol_table, code_section, payload, offset, var_type);
+
+    uint32_t tmp_wasm_code_body_size = body_size;
+
+    tmp_wasm_code_body_size -= tp_encode_ui32leb128(NULL, 0, local_count);
+    tmp_wasm_code_body_size -= tp_encode_ui32leb128(NULL, 0, *var_count);
+    tmp_wasm_code_body_size -= tp_encode_ui32leb128(NULL, 0, var_type);
+
+    *wasm_code_body_buffer = payload + offset;
+    *wasm_code_body_size = tmp_wasm_code_body_size;
+
+    return true;
+
+error_proc:
+
+    return false;
+}
+
+static bool decode_wasm_instruction(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* wasm_code_body_buffer, uint32_t wasm_code_body_size)
+{
+    // NOTE: The number of instructions is not more than the wasm code body size.
+    symbol_table->member_wasm_instruction = (TP_WASM_INSTRUCTION*)TP_CALLOC(symbol_table,
+        wasm_code_body_size, sizeof(TP_WASM_INSTRUCTION)
+    );
+
+    if (NULL == symbol_table->member_wasm_instruction){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    symbol_table->member_wasm_instruction_num = 0;
+    symbol_table->member_wasm_instruction_size = wasm_code_body_size * sizeof(TP_WASM_INSTRUCTION);
+
+    uint32_t pos = 0;
+
+    while (wasm_code_body_size > pos){
+
+        TP_WASM_INSTRUCTION* instruction =
+            &(symbol_table->member_wasm_instruction[symbol_table->member_wasm_instruction_num]);
+
+        instruction->member_wasm_opcode = wasm_code_body_buffer[pos];
+
+        ++pos;
+
+        uint32_t param_size = 0;
+
+        switch (instruction->member_wasm_opcode){
+        case TP_WASM_OPCODE_GET_LOCAL:
+//          break;
+        case TP_WASM_OPCODE_SET_LOCAL:
+//          break;
+        case TP_WASM_OPCODE_TEE_LOCAL:
+            instruction->member_immediate.member_local_index = tp_decode_ui32leb128(
+                &(wasm_code_body_buffer[pos]), &param_size
+            );
+            break;
+        case TP_WASM_OPCODE_I32_CONST:
+            instruction->member_immediate.member_i32 = tp_decode_si32leb128(
+                &(wasm_code_body_buffer[pos]), &param_size
+            );
+            break;
+        default:
+            // NOTE: Opcodes are checked by tp_validate_wasm_instruction.
+            break;
+        }
+
+        // NOTE: The end opcode follows immediates.
+        if (param_size && (wasm_code_body_size <= (pos + param_size))){
+
+            TP_PUT_LOG_MSG(
+                symbol_table, TP_LOG_TYPE_DISP_FORCE,
+                TP_MSG_FMT("ERROR: wasm_code_body_size(%1) <= pos(%2) of wasm opcode(%3)."),
+                TP_LOG_PARAM_UINT64_VALUE(wasm_code_body_size),
+                TP_LOG_PARAM_UINT64_VALUE((uint64_t)pos + param_size),
+                TP_LOG_PARAM_UINT64_VALUE(instruction->member_wasm_opcode)
+            );
+
+            return false;
+        }
+
+        pos += param_size;
+
+        ++(symbol_table->member_wasm_instruction_num);
+    }
+
+    return true;
+}
+
+static uint32_t convert_section_code_content2x64(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t** x64_code_body_buffer, uint32_t* x64_code_body_buffer_size,
+    uint32_t* param_count)
+{
+    uint32_t x64_code_size = 0;
+    uint8_t* x64_code_buffer = NULL;
+
+    uint32_t var_type = TP_WASM_MODULE_SECTION_CODE_VAR_TYPE_I32;
+
+    if ( ! tp_get_wasm_instruction(symbol_table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    *param_count = symbol_table->member_wasm_instruction_param_count;
+    uint32_t var_count = symbol_table->member_wasm_instruction_var_count;
+
+    if ( ! wasm_stack_and_use_register_init(symbol_table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    if ( ! allocate_x64_register(symbol_table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    if (TP_X64_ENTRY_MODE_BATCH == symbol_table->member_x64_entry_mode){
+
+        tp_prepare_x64_simd_code(symbol_table);
+    }
+
+    // NOTE: The prologue is encoded after the function body(see tp_make_x64_function).
+    if ( ! tp_prepare_x64_stack_frame(symbol_table, *param_count, var_count, var_type)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    if ( ! use_x64_param_register(symbol_table, *param_count)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    uint32_t tmp_x64_code_size = 0;
+
+    if (TP_X64_ENTRY_MODE_BATCH == symbol_table->member_x64_entry_mode){
+
+        // The vector loop processes rows while the rest rows are not less than the number of lanes,
+        // and the scalar loop processes the tail rows.
+        if (TP_X64_SIMD_ISA_NONE != symbol_table->member_x64_simd_isa){
+
+            if ( ! reserve_x64_code_buffer(
+                symbol_table, x64_code_body_buffer, x64_code_body_buffer_size, x64_code_size,
+                ((uint64_t)(symbol_table->member_wasm_instruction_num) + *param_count + TP_X64_SIMD_REGISTER_NUM) *
+                TP_X64_CODE_SIZE_WASM_OPCODE_MAX)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                goto error_proc;
+            }
+
+            x64_code_buffer = *x64_code_body_buffer;
+
+            tmp_x64_code_size = tp_encode_x64_simd_batch_loop(
+                symbol_table, x64_code_buffer, x64_code_size, *param_count
+            );
+
+            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+        }
+
+        if ( ! reserve_x64_code_buffer(
+            symbol_table, x64_code_body_buffer, x64_code_body_buffer_size, x64_code_size,
+            ((uint64_t)(*param_count) + 1) * TP_X64_CODE_SIZE_WASM_OPCODE_MAX)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            goto error_proc;
+        }
+
+        x64_code_buffer = *x64_code_body_buffer;
+
+        tmp_x64_code_size = tp_encode_batch_loop_begin(symbol_table, x64_code_buffer, x64_code_size, *param_count);
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    // NOTE: The instructions from the first wasm opcode to END are optimized
+    // by the peephole optimization(see tp_optimize_x64_code function).
+    uint32_t x64_code_body_begin = x64_code_size;
+    uint32_t x64_code_end_max = 0;
+
+    symbol_table->member_x64_instruction_num = 0;
+    symbol_table->member_is_record_x64_instruction = true;
+
+    do{
+        TP_WASM_STACK_ELEMENT op1 = { 0 };
+        TP_WASM_STACK_ELEMENT op2 = { 0 };
+
+        if ( ! reserve_x64_code_buffer(
+            symbol_table, x64_code_body_buffer, x64_code_body_buffer_size, x64_code_size,
+            TP_X64_CODE_SIZE_WASM_OPCODE_MAX)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            goto error_proc;
+        }
+
+        x64_code_buffer = *x64_code_body_buffer;
+
+        TP_WASM_STACK_ELEMENT opcode = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_DEFAULT);
+
+        switch (opcode.member_wasm_opcode){
+        case TP_WASM_OPCODE_GET_LOCAL:
+            if ( ! tp_encode_get_local_code(
+                symbol_table, x64_code_buffer, x64_code_size, opcode.member_local_index, &tmp_x64_code_size)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                goto error_proc;
+            }
+            x64_code_size += tmp_x64_code_size;
+            continue;
+        case TP_WASM_OPCODE_SET_LOCAL:
+            op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
+            if ( ! tp_encode_set_local_code(
+                symbol_table, x64_code_buffer, x64_code_size, opcode.member_local_index, &op1, &tmp_x64_code_size)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                goto error_proc;
+            }
+            x64_code_size += tmp_x64_code_size;
+            continue;
+        case TP_WASM_OPCODE_TEE_LOCAL:
+            op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
+            if ( ! tp_encode_tee_local_code(
+                symbol_table, x64_code_buffer, x64_code_size, opcode.member_local_index, &op1, &tmp_x64_code_size)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                goto error_proc;
+            }
+            x64_code_size += tmp_x64_code_size;
+            continue;
+        case TP_WASM_OPCODE_I32_CONST:
+            if ( ! tp_encode_i32_const_code(
+                symbol_table, x64_code_buffer, x64_code_size, opcode.member_i32, &tmp_x64_code_size)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                goto error_proc;
+            }
+            x64_code_size += tmp_x64_code_size;
+            continue;
+        case TP_WASM_OPCODE_I32_ADD:
+            op2 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
+            op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
+            tmp_x64_code_size = tp_encode_i32_add_code(symbol_table, x64_code_buffer, x64_code_size, &op1, &op2);
+            break;
+        case TP_WASM_OPCODE_I32_SUB:
+            op2 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
+            op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
+            tmp_x64_code_size = tp_encode_i32_sub_code(symbol_table, x64_code_buffer, x64_code_size, &op1, &op2);
+            break;
+        case TP_WASM_OPCODE_I32_MUL:
+            op2 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
+            op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
+            tmp_x64_code_size = tp_encode_i32_mul_code(symbol_table, x64_code_buffer, x64_code_size, &op1, &op2);
+            break;
+        case TP_WASM_OPCODE_I32_DIV:
+            op2 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
+            op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
+            tmp_x64_code_size = tp_encode_i32_div_code(symbol_table, x64_code_buffer, x64_code_size, &op1, &op2);
+            break;
+        case TP_WASM_OPCODE_I32_XOR:
+            op2 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
+            op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
+            tmp_x64_code_size = tp_encode_i32_xor_code(symbol_table, x64_code_buffer, x64_code_size, &op1, &op2);
+            break;
+        case TP_WASM_OPCODE_END:
+
+            // NOTE: The peephole optimization does not grow the code(see encode_x64_code_again function).
+            if ( ! reserve_x64_code_buffer(
+                symbol_table, x64_code_body_buffer, x64_code_body_buffer_size, x64_code_size,
+                TP_X64_CODE_SIZE_END_MAX)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                goto error_proc;
+            }
+
+            x64_code_buffer = *x64_code_body_buffer;
+
+            x64_code_end_max = x64_code_size + TP_X64_CODE_SIZE_END_MAX;
+
+            if (TP_X64_ENTRY_MODE_BATCH == symbol_table->member_x64_entry_mode){
+
+                op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
+
+                if ( ! tp_optimize_x64_code(symbol_table, x64_code_buffer, x64_code_body_begin, &x64_code_size, &op1)){
+
+                    TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                    goto error_proc;
+                }
+
+                tmp_x64_code_size = tp_encode_batch_loop_end(symbol_table, x64_code_buffer, x64_code_size, &op1);
+
+                TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+                tmp_x64_code_size = tp_encode_end_code(symbol_table, x64_code_buffer, x64_code_size);
+
+                TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+            }else{
+
+                op1 = wasm_stack_pop(symbol_table, TP_WASM_STACK_POP_MODE_PARAM);
+
+                TP_WASM_STACK_ELEMENT eax = {
+                    .member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE,
+                    .member_x64_item_kind = TP_X64_ITEM_KIND_X86_32_REGISTER,
+                    .member_x64_item.member_x86_32_register = TP_X86_32_REGISTER_EAX
+                };
+
+                // The return value(see allocate_x64_register function).
+                if ((TP_X64_ITEM_KIND_X86_32_REGISTER != op1.member_x64_item_kind) ||
+                    (TP_X86_32_REGISTER_EAX != op1.member_x64_item.member_x86_32_register)){
+
+                    // mov eax, op1
+                    tmp_x64_code_size = tp_encode_x64_2_operand(
+                        symbol_table, x64_code_buffer, x64_code_size, TP_X64_MOV, &eax, &op1
+                    );
+
+                    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+                }
+
+                if ( ! tp_optimize_x64_code(symbol_table, x64_code_buffer, x64_code_body_begin, &x64_code_size, &eax)){
+
+                    TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                    goto error_proc;
+                }
+
+                tmp_x64_code_size = tp_encode_end_code(symbol_table, x64_code_buffer, x64_code_size);
+
+                TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+            }
+
+            if ( ! wasm_stack_and_wasm_code_is_empty(symbol_table)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                goto error_proc;
+            }
+
+            if (x64_code_end_max < x64_code_size){
+
+                TP_PUT_LOG_MSG(
+                    symbol_table, TP_LOG_TYPE_DISP_FORCE,
+                    TP_MSG_FMT("ERROR: x64_code_end_max(%1) < x64_code_size(%2)"),
+                    TP_LOG_PARAM_UINT64_VALUE(x64_code_end_max),
+                    TP_LOG_PARAM_UINT64_VALUE(x64_code_size)
+                );
+
+                goto error_proc;
+            }
+
+            return x64_code_size;
+        default:
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            goto error_proc;
+        }
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    }while (true);
+
+error_proc:
+
+    symbol_table->member_is_record_x64_instruction = false;
+
+    return 0;
+}
+
+static bool reserve_x64_code_buffer(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t** x64_code_buffer, uint32_t* x64_code_buffer_size,
+    uint32_t x64_code_size, uint64_t reserve_size)
+{
+    // NOTE: The encoders write x64 code without bounds checking, so each caller reserves
+    // the upper bound of the code, and the code size of the previous wasm opcode is checked here.
+    if (*x64_code_buffer_size < x64_code_size){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE,
+            TP_MSG_FMT("ERROR: x64_code_buffer_size(%1) < x64_code_size(%2)"),
+            TP_LOG_PARAM_UINT64_VALUE(*x64_code_buffer_size),
+            TP_LOG_PARAM_UINT64_VALUE(x64_code_size)
+        );
+
+        return false;
+    }
+
+    uint64_t size = (uint64_t)x64_code_size + reserve_size;
+
+    if (*x64_code_buffer_size >= size){
+
+        return true;
+    }
+
+    if (UINT32_MAX < size){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE,
+            TP_MSG_FMT("ERROR: UINT32_MAX < size(%1)"),
+            TP_LOG_PARAM_UINT64_VALUE(size)
+        );
+
+        return false;
+    }
+
+    uint64_t new_size = ((*x64_code_buffer_size) ? (uint64_t)(*x64_code_buffer_size) : TP_X64_CODE_BUFFER_SIZE_MIN);
+
+    while (new_size < size){
+
+        new_size *= 2;
+    }
+
+    if (UINT32_MAX < new_size){
+
+        new_size = UINT32_MAX;
+    }
+
+    uint8_t* tmp_x64_code_buffer = (uint8_t*)TP_REALLOC(symbol_table, *x64_code_buffer, (size_t)new_size);
+
+    if (NULL == tmp_x64_code_buffer){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    *x64_code_buffer = tmp_x64_code_buffer;
+    *x64_code_buffer_size = (uint32_t)new_size;
+
+    return true;
+}
+
+static bool wasm_stack_and_use_register_init(TP_SYMBOL_TABLE* symbol_table)
+{
+    // wasm_stack_init
 
     if (symbol_table->member_stack){
 
@@ -460,7 +1099,7 @@ static bool wasm_stack_and_use_register_init(
         symbol_table->member_stack_size = 0;
     }
 
-    symbol_table->member_stack = (TP_WASM_STACK_ELEMENT*)calloc(
+    symbol_table->member_stack = (TP_WASM_STACK_ELEMENT*)TP_CALLOC(symbol_table,
         symbol_table->member_stack_size_allocate_unit, sizeof(TP_WASM_STACK_ELEMENT)
     );
 
@@ -468,9 +1107,7 @@ static bool wasm_stack_and_use_register_init(
 
         TP_PRINT_CRT_ERROR(symbol_table);
 
-        symbol_table->member_wasm_code_body_buffer = NULL;
-        symbol_table->member_wasm_code_body_size = 0;
-        symbol_table->member_wasm_code_body_pos = 0;
+        symbol_table->member_wasm_instruction_pos = 0;
 
         symbol_table->member_stack_pos = TP_WASM_STACK_EMPTY;
         symbol_table->member_stack_size = 0;
@@ -483,9 +1120,7 @@ static bool wasm_stack_and_use_register_init(
         return false;
     }
 
-    symbol_table->member_wasm_code_body_buffer = wasm_code_body_buffer;
-    symbol_table->member_wasm_code_body_size = wasm_code_body_size;
-    symbol_table->member_wasm_code_body_pos = 0;
+    symbol_table->member_wasm_instruction_pos = 0;
 
     symbol_table->member_stack_pos = TP_WASM_STACK_EMPTY;
     symbol_table->member_stack_size =
@@ -497,7 +1132,7 @@ static bool wasm_stack_and_use_register_init(
     symbol_table->member_local_variable_size_max = TP_WASM_LOCAL_VARIABLE_MAX_DEFAULT;
     symbol_table->member_padding_local_variable_bytes = 0;
 
-//  symbol_table->member_temporary_variable_size = 0;
+    symbol_table->member_temporary_variable_size = 0;
     symbol_table->member_temporary_variable_size_max = TP_WASM_TEMPORARY_VARIABLE_MAX_DEFAULT;
     symbol_table->member_padding_temporary_variable_bytes = 0;
 
@@ -509,6 +1144,7 @@ static bool wasm_stack_and_use_register_init(
     symbol_table->member_padding_register_bytes = 0;
 
     symbol_table->member_stack_imm32 = 0;
+    symbol_table->member_is_x64_frame_elision = false;
 
     return true;
 }
@@ -517,7 +1153,7 @@ static bool wasm_stack_and_wasm_code_is_empty(TP_SYMBOL_TABLE* symbol_table)
 {
     if (TP_WASM_STACK_EMPTY == symbol_table->member_stack_pos){
 
-        if (symbol_table->member_wasm_code_body_pos == symbol_table->member_wasm_code_body_size){
+        if (symbol_table->member_wasm_instruction_pos == symbol_table->member_wasm_instruction_num){
 
             return true;
         }
@@ -526,16 +1162,6 @@ static bool wasm_stack_and_wasm_code_is_empty(TP_SYMBOL_TABLE* symbol_table)
     return false;
 }
 
-static bool wasm_stack_is_empty(TP_SYMBOL_TABLE* symbol_table)
-{
-    if (TP_WASM_STACK_EMPTY == symbol_table->member_stack_pos){
-
-        return true;
-    }
-
-    return false;
-}
-
 bool tp_wasm_stack_push(TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_ELEMENT* value)
 {
     if (symbol_table->member_stack_pos ==
@@ -558,7 +1184,7 @@ bool tp_wasm_stack_push(TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_ELEMENT* va
             goto error_out;
         }
 
-        TP_WASM_STACK_ELEMENT* wasm_stack = (TP_WASM_STACK_ELEMENT*)realloc(
+        TP_WASM_STACK_ELEMENT* wasm_stack = (TP_WASM_STACK_ELEMENT*)TP_REALLOC(symbol_table,
             symbol_table->member_stack, wasm_stack_size
         );
 
@@ -597,537 +1223,914 @@ error_out:
     return false;
 }
 
-static TP_WASM_STACK_ELEMENT wasm_stack_pop(TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_POP_MODE pop_mode)
-{
-    TP_WASM_STACK_ELEMENT result = { 0 };
+static TP_WASM_STACK_ELEMENT wasm_stack_pop(TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_POP_MODE pop_mode)
+{
+    TP_WASM_STACK_ELEMENT result = { 0 };
+
+    if (wasm_stack_and_wasm_code_is_empty(symbol_table)){
+
+        return result;
+    }
+
+    if (TP_WASM_STACK_EMPTY < symbol_table->member_stack_pos){
+
+        if (TP_WASM_STACK_POP_MODE_PARAM == pop_mode){
+
+            result = symbol_table->member_stack[symbol_table->member_stack_pos];
+
+            --(symbol_table->member_stack_pos);
+
+            return result;
+        }
+    }
+
+    if (symbol_table->member_wasm_instruction_pos >= symbol_table->member_wasm_instruction_num){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE,
+            TP_MSG_FMT(
+                "ERROR: symbol_table->member_wasm_instruction_pos: %1 >= "
+                "symbol_table->member_wasm_instruction_num: %2"
+            ),
+            TP_LOG_PARAM_UINT64_VALUE(symbol_table->member_wasm_instruction_pos),
+            TP_LOG_PARAM_UINT64_VALUE(symbol_table->member_wasm_instruction_num)
+        );
+
+        goto error_out;
+    }
+
+    TP_WASM_INSTRUCTION* instruction =
+        &(symbol_table->member_wasm_instruction[symbol_table->member_wasm_instruction_pos]);
+
+    ++(symbol_table->member_wasm_instruction_pos);
+
+    result.member_wasm_opcode = instruction->member_wasm_opcode;
+
+    switch (result.member_wasm_opcode){
+    case TP_WASM_OPCODE_GET_LOCAL:
+//      break;
+    case TP_WASM_OPCODE_SET_LOCAL:
+//      break;
+    case TP_WASM_OPCODE_TEE_LOCAL:
+        result.member_local_index = instruction->member_immediate.member_local_index;
+        break;
+    case TP_WASM_OPCODE_I32_CONST:
+        result.member_i32 = instruction->member_immediate.member_i32;
+        break;
+    default:
+        break;
+    }
+
+    return result;
+
+error_out:
+
+    memset(&result, 0, sizeof(result));
+
+    return result;
+}
+
+bool tp_get_local_variable_offset(
+    TP_SYMBOL_TABLE* symbol_table, uint32_t local_index, int32_t* local_variable_offset)
+{
+    int32_t offset = ((int32_t)local_index) * sizeof(int32_t);
+
+    if (symbol_table->member_local_variable_size_max < offset){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE,
+            TP_MSG_FMT("ERROR: symbol_table->member_local_variable_size_max(%1) < offset(%2)"),
+            TP_LOG_PARAM_INT32_VALUE(symbol_table->member_local_variable_size_max),
+            TP_LOG_PARAM_INT32_VALUE(offset)
+        );
+
+        return false;
+    }
+
+    *local_variable_offset = offset;
+
+    return true;
+}
+
+static bool allocate_x64_register(TP_SYMBOL_TABLE* symbol_table)
+{
+    TP_X64_LIVE_RANGE** sorted_live_range = NULL;
+    uint32_t sorted_live_range_size = 0;
+
+    // Linear scan register allocation over the whole function: the live ranges of the values of
+    // the wasm value stack and the live ranges of the local variables share the registers.
+    if ( ! make_x64_live_range(symbol_table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    uint32_t live_range_num = symbol_table->member_x64_live_range_num;
+    uint32_t local_num =
+        symbol_table->member_wasm_instruction_param_count + symbol_table->member_wasm_instruction_var_count;
+    uint32_t sorted_live_range_num = 0;
+
+    sorted_live_range = (TP_X64_LIVE_RANGE**)TP_CALLOC(symbol_table, live_range_num + local_num, sizeof(TP_X64_LIVE_RANGE*));
+
+    if (NULL == sorted_live_range){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        goto error_proc;
+    }
+
+    sorted_live_range_size = (live_range_num + local_num) * sizeof(TP_X64_LIVE_RANGE*);
+
+    for (uint32_t i = 0; live_range_num > i; ++i){
+
+        // NOTE: The immediate operand has no register and no temporary variable.
+        if (symbol_table->member_x64_live_range[i].member_is_immediate){
+
+            continue;
+        }
+
+        sorted_live_range[sorted_live_range_num] = &(symbol_table->member_x64_live_range[i]);
+        ++sorted_live_range_num;
+    }
+
+    for (uint32_t i = 0; local_num > i; ++i){
+
+        // NOTE: The local variable which is not accessed has no live range.
+        if (symbol_table->member_x64_local_live_range[i].member_use_count){
+
+            sorted_live_range[sorted_live_range_num] = &(symbol_table->member_x64_local_live_range[i]);
+            ++sorted_live_range_num;
+        }
+    }
+
+    qsort(sorted_live_range, sorted_live_range_num, sizeof(TP_X64_LIVE_RANGE*), compare_x64_live_range);
+
+    TP_X64_LIVE_RANGE* register_owner[TP_X64_64_REGISTER_NULL] = { NULL };
+
+    // NOTE: A temporary variable is reused by the live range which begins after
+    // the end of the last live range of it.
+    uint32_t temporary_variable_end[TP_X64_TEMPORARY_VARIABLE_NUM_MAX] = { 0 };
+    uint32_t temporary_variable_num = 0;
+    uint32_t temporary_variable_num_max = (uint32_t)(symbol_table->member_temporary_variable_size_max / sizeof(int32_t));
+
+    if (TP_X64_TEMPORARY_VARIABLE_NUM_MAX < temporary_variable_num_max){
+
+        temporary_variable_num_max = TP_X64_TEMPORARY_VARIABLE_NUM_MAX;
+    }
+
+    for (uint32_t i = 0; sorted_live_range_num > i; ++i){
+
+        TP_X64_LIVE_RANGE* current = sorted_live_range[i];
+
+        // Expires the live ranges which end before the current live range.
+        // NOTE: The local variables which begin at 0 are the parameters loaded by the prologue
+        // at the same time, so they do not share the register.
+        bool is_prologue_load = (current->member_is_local_variable && (0 == current->member_begin));
+
+        for (uint32_t j = 0; TP_X64_64_REGISTER_NULL > j; ++j){
+
+            if (is_prologue_load && register_owner[j] &&
+                register_owner[j]->member_is_local_variable && (0 == register_owner[j]->member_begin)){
+
+                continue;
+            }
+
+            if (register_owner[j] && (register_owner[j]->member_end <= current->member_begin)){
+
+                register_owner[j] = NULL;
+            }
+        }
+
+        TP_X64_64_REGISTER x64_register = TP_X64_64_REGISTER_NULL;
+
+        if (is_free_x64_register(current, register_owner, current->member_hint_register)){
+
+            x64_register = current->member_hint_register;
+        }else if (current->member_hint_live_range &&
+            is_free_x64_register(current, register_owner, current->member_hint_live_range->member_register)){
+
+            x64_register = current->member_hint_live_range->member_register;
+        }else{
+
+            for (uint32_t j = 0; TP_X64_ALLOCATABLE_REGISTER_NUM > j; ++j){
+
+                if (is_free_x64_register(current, register_owner, x64_allocatable_register[j])){
+
+                    x64_register = x64_allocatable_register[j];
+
+                    break;
+                }
+            }
+        }
+
+        TP_X64_LIVE_RANGE* spill_live_range = NULL;
+
+        if (TP_X64_64_REGISTER_NULL == x64_register){
+
+            // Spills the live range of the lowest spill cost: the current live range or
+            // the live range which holds the register allowed for the current live range.
+            spill_live_range = current;
+
+            for (uint32_t j = 0; TP_X64_ALLOCATABLE_REGISTER_NUM > j; ++j){
+
+                TP_X64_64_REGISTER spill_register = x64_allocatable_register[j];
+
+                if ((current->member_forbidden_register_mask & (1 << spill_register)) ||
+                    (NULL == register_owner[spill_register])){
+
+                    continue;
+                }
+
+                TP_X64_LIVE_RANGE* owner = register_owner[spill_register];
+
+                if (is_spill_x64_live_range(owner, spill_live_range)){
+
+                    spill_live_range = owner;
+
+                    x64_register = spill_register;
+                }
+            }
+
+            spill_live_range->member_register = TP_X64_64_REGISTER_NULL;
+        }
+
+        if (TP_X64_64_REGISTER_NULL != x64_register){
+
+            register_owner[x64_register] = current;
+
+            current->member_register = x64_register;
+        }
+
+        // NOTE: The spilled local variable stays in the stack frame.
+        if ((NULL == spill_live_range) || spill_live_range->member_is_local_variable){
+
+            continue;
+        }
+
+        // NOTE: The spilled live range is in the temporary variable from the beginning to the end.
+        uint32_t temporary_variable_index = 0;
+
+        for (; temporary_variable_num > temporary_variable_index; ++temporary_variable_index){
+
+            if (temporary_variable_end[temporary_variable_index] <= spill_live_range->member_begin){
+
+                break;
+            }
+        }
+
+        if (temporary_variable_num == temporary_variable_index){
+
+            if (temporary_variable_num_max <= temporary_variable_num){
+
+                TP_PUT_LOG_MSG(
+                    symbol_table, TP_LOG_TYPE_DISP_FORCE,
+                    TP_MSG_FMT("ERROR: temporary_variable_num_max(%1) <= temporary_variable_num(%2)"),
+                    TP_LOG_PARAM_UINT64_VALUE(temporary_variable_num_max),
+                    TP_LOG_PARAM_UINT64_VALUE(temporary_variable_num)
+                );
+
+                goto error_proc;
+            }
+
+            ++temporary_variable_num;
+        }
+
+        temporary_variable_end[temporary_variable_index] = spill_live_range->member_end;
+
+        spill_live_range->member_offset = (int32_t)(temporary_variable_index * sizeof(int32_t));
+    }
+
+    symbol_table->member_temporary_variable_size = (int32_t)(temporary_variable_num * sizeof(int32_t));
+
+    TP_FREE(symbol_table, &sorted_live_range, sorted_live_range_size);
+
+    return true;
+
+error_proc:
+
+    if (sorted_live_range){
+
+        TP_FREE(symbol_table, &sorted_live_range, sorted_live_range_size);
+    }
+
+    return false;
+}
+
+static int compare_x64_live_range(const void* param1, const void* param2)
+{
+    const TP_X64_LIVE_RANGE* live_range1 = *(const TP_X64_LIVE_RANGE**)param1;
+    const TP_X64_LIVE_RANGE* live_range2 = *(const TP_X64_LIVE_RANGE**)param2;
+
+    if (live_range1->member_begin != live_range2->member_begin){
+
+        return (live_range1->member_begin < live_range2->member_begin) ? -1 : 1;
+    }
+
+    // NOTE: The local variable accessed first by get_local or tee_local precedes the pushed value,
+    // because the value prefers the register of the local variable.
+    if (live_range1->member_is_local_variable != live_range2->member_is_local_variable){
+
+        return live_range1->member_is_local_variable ? -1 : 1;
+    }
+
+    return 0;
+}
+
+static bool is_free_x64_register(
+    TP_X64_LIVE_RANGE* live_range, TP_X64_LIVE_RANGE** register_owner, TP_X64_64_REGISTER x64_register)
+{
+    if (TP_X64_64_REGISTER_NULL <= x64_register){
+
+        return false;
+    }
+
+    if (live_range->member_forbidden_register_mask & (1 << x64_register)){
+
+        return false;
+    }
+
+    return (NULL == register_owner[x64_register]);
+}
+
+static bool make_x64_live_range(TP_SYMBOL_TABLE* symbol_table)
+{
+    uint32_t* value_stack = NULL;
+    uint32_t value_stack_size = 0;
+    uint32_t* div_num = NULL;
+    uint32_t div_num_size = 0;
+
+    if (symbol_table->member_x64_live_range){
+
+        TP_FREE(symbol_table, &(symbol_table->member_x64_live_range), symbol_table->member_x64_live_range_size);
+    }
+
+    if (symbol_table->member_x64_local_live_range){
+
+        TP_FREE(
+            symbol_table, &(symbol_table->member_x64_local_live_range),
+            symbol_table->member_x64_local_live_range_size
+        );
+    }
+
+    symbol_table->member_x64_live_range_num = 0;
+    symbol_table->member_x64_live_range_size = 0;
+    symbol_table->member_x64_live_range_pos = 0;
+    symbol_table->member_x64_local_live_range_size = 0;
+
+    uint32_t wasm_instruction_num = symbol_table->member_wasm_instruction_num;
+
+    if (0 == wasm_instruction_num){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE,
+            TP_MSG_FMT("%1"), TP_LOG_PARAM_STRING("ERROR: 0 == wasm_instruction_num")
+        );
+
+        goto error_proc;
+    }
+
+    // NOTE: A wasm instruction pushes one value at most.
+    TP_X64_LIVE_RANGE* live_range = (TP_X64_LIVE_RANGE*)TP_CALLOC(symbol_table, wasm_instruction_num, sizeof(TP_X64_LIVE_RANGE));
+
+    if (NULL == live_range){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        goto error_proc;
+    }
+
+    symbol_table->member_x64_live_range = live_range;
+    symbol_table->member_x64_live_range_size = wasm_instruction_num * sizeof(TP_X64_LIVE_RANGE);
+
+    // NOTE: The local indexes are checked by tp_validate_wasm_instruction function.
+    uint32_t local_num =
+        symbol_table->member_wasm_instruction_param_count + symbol_table->member_wasm_instruction_var_count;
+
+    TP_X64_LIVE_RANGE* local_live_range = (TP_X64_LIVE_RANGE*)TP_CALLOC(symbol_table, local_num + 1, sizeof(TP_X64_LIVE_RANGE));
+
+    if (NULL == local_live_range){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        goto error_proc;
+    }
 
-    if (wasm_stack_and_wasm_code_is_empty(symbol_table)){
+    symbol_table->member_x64_local_live_range = local_live_range;
+    symbol_table->member_x64_local_live_range_size = (local_num + 1) * sizeof(TP_X64_LIVE_RANGE);
 
-        return result;
+    for (uint32_t i = 0; local_num > i; ++i){
+
+        local_live_range[i].member_register = TP_X64_64_REGISTER_NULL;
+        local_live_range[i].member_hint_register = TP_X64_64_REGISTER_NULL;
+        local_live_range[i].member_is_local_variable = true;
     }
 
-    if (TP_WASM_STACK_EMPTY < symbol_table->member_stack_pos){
+    uint32_t stack_depth_max = symbol_table->member_wasm_instruction_stack_depth_max;
 
-        if (TP_WASM_STACK_POP_MODE_PARAM == pop_mode){
+    value_stack = (uint32_t*)TP_CALLOC(symbol_table, stack_depth_max + 1, sizeof(uint32_t));
 
-            result = symbol_table->member_stack[symbol_table->member_stack_pos];
+    if (NULL == value_stack){
 
-            --(symbol_table->member_stack_pos);
+        TP_PRINT_CRT_ERROR(symbol_table);
 
-            return result;
-        }
+        goto error_proc;
     }
 
-    result.member_wasm_opcode = symbol_table->member_wasm_code_body_buffer[symbol_table->member_wasm_code_body_pos];
+    value_stack_size = (stack_depth_max + 1) * sizeof(uint32_t);
 
-    ++(symbol_table->member_wasm_code_body_pos);
+    // div_num[i]: The number of I32_DIV before the wasm instruction of the index i.
+    div_num = (uint32_t*)TP_CALLOC(symbol_table, wasm_instruction_num + 1, sizeof(uint32_t));
 
-    uint32_t param_size = 0;
+    if (NULL == div_num){
 
-    switch (result.member_wasm_opcode){
-    case TP_WASM_OPCODE_GET_LOCAL:
-//      break;
-    case TP_WASM_OPCODE_SET_LOCAL:
-//      break;
-    case TP_WASM_OPCODE_TEE_LOCAL:
-
-        result.member_local_index = tp_decode_ui32leb128(
-            &(symbol_table->member_wasm_code_body_buffer[symbol_table->member_wasm_code_body_pos]),
-            &param_size
-        );
+        TP_PRINT_CRT_ERROR(symbol_table);
 
-        if ((symbol_table->member_wasm_code_body_pos + param_size) >= symbol_table->member_wasm_code_body_size){
+        goto error_proc;
+    }
 
-            uint64_t param1 = (uint64_t)(symbol_table->member_wasm_code_body_pos);
-            uint64_t param2 = (uint64_t)param_size;
+    div_num_size = (wasm_instruction_num + 1) * sizeof(uint32_t);
 
-            TP_PUT_LOG_MSG(
-                symbol_table, TP_LOG_TYPE_DISP_FORCE,
-                TP_MSG_FMT(
-                    "ERROR: TP_WASM_OPCODE_GET/SET/TEE_LOCAL: symbol_table->member_wasm_code_body_pos + param_size: %1 >= "
-                    "symbol_table->member_wasm_code_body_size: %2"
-                ),
-                TP_LOG_PARAM_UINT64_VALUE(param1 + param2),
-                TP_LOG_PARAM_UINT64_VALUE(symbol_table->member_wasm_code_body_size)
-            );
+    uint32_t live_range_num = 0;
+    uint32_t depth = 0;
 
-            goto error_out;
-        }
+    for (uint32_t i = 0; wasm_instruction_num > i; ++i){
 
-        symbol_table->member_wasm_code_body_pos += param_size;
+        TP_WASM_INSTRUCTION* instruction = &(symbol_table->member_wasm_instruction[i]);
+        uint32_t wasm_opcode = instruction->member_wasm_opcode;
 
-        break;
-    case TP_WASM_OPCODE_I32_CONST:
+        uint32_t pop_num = 0;
+        bool is_push = false;
+        TP_X64_LIVE_RANGE* local_variable = NULL;
 
-        result.member_i32 = tp_decode_si32leb128(
-            &(symbol_table->member_wasm_code_body_buffer[symbol_table->member_wasm_code_body_pos]),
-            &param_size
-        );
+        div_num[i + 1] = div_num[i];
 
-        if ((symbol_table->member_wasm_code_body_pos + param_size) >= symbol_table->member_wasm_code_body_size){
+        switch (wasm_opcode){
+        case TP_WASM_OPCODE_GET_LOCAL:
+            local_variable = &(local_live_range[instruction->member_immediate.member_local_index]);
+            is_push = true;
+            break;
+        case TP_WASM_OPCODE_I32_CONST:
+            is_push = true;
+            break;
+        case TP_WASM_OPCODE_TEE_LOCAL:
+            local_variable = &(local_live_range[instruction->member_immediate.member_local_index]);
+            pop_num = 1;
+            is_push = true;
+            break;
+        case TP_WASM_OPCODE_SET_LOCAL:
+            local_variable = &(local_live_range[instruction->member_immediate.member_local_index]);
+//          break;
+        case TP_WASM_OPCODE_END:
+            pop_num = 1;
+            break;
+        case TP_WASM_OPCODE_I32_DIV:
+            ++(div_num[i + 1]);
+//          break;
+        case TP_WASM_OPCODE_I32_ADD:
+//          break;
+        case TP_WASM_OPCODE_I32_SUB:
+//          break;
+        case TP_WASM_OPCODE_I32_MUL:
+//          break;
+        case TP_WASM_OPCODE_I32_XOR:
+            // NOTE: The result continues the live range of op1.
+            pop_num = 2;
+            break;
+        default:
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+            goto error_proc;
+        }
 
-            uint64_t param1 = (uint64_t)(symbol_table->member_wasm_code_body_pos);
-            uint64_t param2 = (uint64_t)param_size;
+        if ((depth < pop_num) || (is_push && ((depth - pop_num) >= stack_depth_max))){
 
             TP_PUT_LOG_MSG(
                 symbol_table, TP_LOG_TYPE_DISP_FORCE,
-                TP_MSG_FMT(
-                    "ERROR: TP_WASM_OPCODE_I32_CONST: symbol_table->member_wasm_code_body_pos + param_size: %1 >= "
-                    "symbol_table->member_wasm_code_body_size: %2"
-                ),
-                TP_LOG_PARAM_UINT64_VALUE(param1 + param2),
-                TP_LOG_PARAM_UINT64_VALUE(symbol_table->member_wasm_code_body_size)
+                TP_MSG_FMT("ERROR: bad stack depth(%1) at wasm instruction(%2)."),
+                TP_LOG_PARAM_UINT64_VALUE(depth),
+                TP_LOG_PARAM_UINT64_VALUE(i)
             );
 
-            goto error_out;
+            goto error_proc;
         }
 
-        symbol_table->member_wasm_code_body_pos += param_size;
-
-        break;
-    default:
-        break;
-    }
-
-    return result;
-
-error_out:
-
-    memset(&result, 0, sizeof(result));
+        if (local_variable){
 
-    return result;
-}
+            if (0 == local_variable->member_use_count){
 
-bool tp_get_local_variable_offset(
-    TP_SYMBOL_TABLE* symbol_table, uint32_t local_index, int32_t* local_variable_offset)
-{
-    int32_t offset = ((int32_t)local_index) * sizeof(int32_t);
+                local_variable->member_begin = i;
 
-    if (symbol_table->member_local_variable_size_max < offset){
+                // NOTE: The parameter is loaded by the prologue
+                // (or stored to the stack frame by the beginning of the batch loop).
+                local_variable->member_is_load = (TP_WASM_OPCODE_GET_LOCAL == wasm_opcode);
 
-        TP_PUT_LOG_MSG(
-            symbol_table, TP_LOG_TYPE_DISP_FORCE,
-            TP_MSG_FMT("ERROR: symbol_table->member_local_variable_size_max(%1) < offset(%2)"),
-            TP_LOG_PARAM_INT32_VALUE(symbol_table->member_local_variable_size_max),
-            TP_LOG_PARAM_INT32_VALUE(offset)
-        );
+                if (pop_num){
 
-        return false;
-    }
+                    // The stored value prefers the register of the local variable.
+                    local_variable->member_hint_live_range = &(live_range[value_stack[depth - 1]]);
+                }
+            }
 
-    *local_variable_offset = offset;
+            local_variable->member_end = i;
+            ++(local_variable->member_use_count);
+        }
 
-    return true;
-}
+        if (2 == pop_num){
 
-bool tp_allocate_temporary_variable(
-    TP_SYMBOL_TABLE* symbol_table, TP_X64_ALLOCATE_MODE allocate_mode,
-    uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t* x64_code_size,
-    TP_WASM_STACK_ELEMENT* wasm_stack_element)
-{
-    int32_t offset =
-          symbol_table->member_local_variable_size
-        + symbol_table->member_padding_local_variable_bytes
-        + symbol_table->member_temporary_variable_size;
+            TP_X64_LIVE_RANGE* op1 = &(live_range[value_stack[depth - 2]]);
+            TP_X64_LIVE_RANGE* op2 = &(live_range[value_stack[depth - 1]]);
 
-    int32_t max_size = 
-        symbol_table->member_temporary_variable_size_max + symbol_table->member_local_variable_size_max;
+            if ((TP_WASM_OPCODE_I32_DIV == wasm_opcode) && op2->member_is_immediate){
 
-    if (max_size < (offset + sizeof(int32_t))){
+                // NOTE: The division by the constant uses RDX(or RAX) as the scratch register
+                // (see tp_encode_i32_div_code function).
+                op1->member_forbidden_register_mask |= (1 << TP_X64_64_REGISTER_RDX);
 
-        TP_PUT_LOG_MSG(
-            symbol_table, TP_LOG_TYPE_DISP_FORCE,
-            TP_MSG_FMT("ERROR: max_size: %1 < (offset + sizeof(int32_t)): %2"),
-            TP_LOG_PARAM_INT32_VALUE(max_size),
-            TP_LOG_PARAM_INT32_VALUE(offset + sizeof(int32_t))
-        );
+                for (uint32_t j = 0; (depth - 2) > j; ++j){
 
-        return false;
-    }
+                    live_range[value_stack[j]].member_forbidden_register_mask |= (1 << TP_X64_64_REGISTER_RDX);
+                }
+            }else if (TP_WASM_OPCODE_I32_DIV == wasm_opcode){
 
-    wasm_stack_element->member_x64_memory_kind = TP_X64_ITEM_MEMORY_KIND_TEMP;
+                // IDIV – Signed Divide: EDX:EAX by op2, EAX is the quotient and EDX is the remainder.
+                op1->member_hint_register = TP_X64_64_REGISTER_RAX;
+                op1->member_forbidden_register_mask |= (1 << TP_X64_64_REGISTER_RDX);
+                op2->member_forbidden_register_mask |=
+                    ((1 << TP_X64_64_REGISTER_RAX) | (1 << TP_X64_64_REGISTER_RDX));
 
-    wasm_stack_element->member_offset = offset;
+                for (uint32_t j = 0; (depth - 2) > j; ++j){
 
-    symbol_table->member_temporary_variable_size += sizeof(int32_t);
+                    live_range[value_stack[j]].member_forbidden_register_mask |= (1 << TP_X64_64_REGISTER_RDX);
+                }
+            }
 
-    if ( ! allocate_variable_common(symbol_table, allocate_mode,
-        x64_code_buffer, x64_code_offset, x64_code_size, wasm_stack_element)){
+            ++(op1->member_use_count);
 
-        TP_PUT_LOG_MSG_TRACE(symbol_table);
+            op2->member_end = i;
+            ++(op2->member_use_count);
 
-        return false;
-    }
+            --depth;
+        }else if (1 == pop_num){
 
-    return true;
-}
+            TP_X64_LIVE_RANGE* op1 = &(live_range[value_stack[depth - 1]]);
 
-static bool allocate_variable_common(
-    TP_SYMBOL_TABLE* symbol_table, TP_X64_ALLOCATE_MODE allocate_mode,
-    uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t* x64_code_size,
-    TP_WASM_STACK_ELEMENT* wasm_stack_element)
-{
-    switch (allocate_mode){
-    case TP_X64_ALLOCATE_DEFAULT:
-        break;
-    case TP_X64_ALLOCATE_MEMORY:
-        wasm_stack_element->member_x64_item_kind = TP_X64_ITEM_KIND_MEMORY;
-        return true;
-    default:
-        TP_PUT_LOG_MSG_ICE(symbol_table);
-        return false;
-    }
+            if (TP_WASM_OPCODE_END == wasm_opcode){
 
-    bool is_zero_free_register = true;
+                // The return value.
+                op1->member_hint_register = TP_X64_64_REGISTER_RAX;
 
-    TP_X86_32_REGISTER x86_32_register = TP_X86_32_REGISTER_NULL;
-    TP_X64_32_REGISTER x64_32_register = TP_X64_32_REGISTER_NULL;
+                // NOTE: When the variable of the last statement is accessed only by tee_local,
+                // the stored value is also returned in RAX without moves.
+                TP_X64_LIVE_RANGE* tee_local_variable = op1->member_hint_live_range;
 
-    if ( ! get_free_register(symbol_table, &x86_32_register, &x64_32_register, &is_zero_free_register)){
+                if (tee_local_variable && (1 == tee_local_variable->member_use_count) &&
+                    (tee_local_variable->member_begin == op1->member_begin)){
 
-        TP_PUT_LOG_MSG_TRACE(symbol_table);
+                    tee_local_variable->member_hint_register = TP_X64_64_REGISTER_RAX;
 
-        return false;
-    }
+                    TP_X64_LIVE_RANGE* stored_value = tee_local_variable->member_hint_live_range;
 
-    if (is_zero_free_register){
+                    if (stored_value && (TP_X64_64_REGISTER_NULL == stored_value->member_hint_register)){
 
-        if ( ! spilling_variable(
-            symbol_table, x64_code_buffer, x64_code_offset, x64_code_size,
-            &x86_32_register, &x64_32_register, wasm_stack_element)){
+                        stored_value->member_hint_register = TP_X64_64_REGISTER_RAX;
+                    }
+                }
+            }
 
-            TP_PUT_LOG_MSG_TRACE(symbol_table);
+            op1->member_end = i;
+            ++(op1->member_use_count);
 
-            return false;
+            --depth;
         }
-    }
 
-    if (TP_X86_32_REGISTER_NULL != x86_32_register){
+        if (is_push){
 
-        wasm_stack_element->member_x64_item_kind = TP_X64_ITEM_KIND_X86_32_REGISTER;
-        wasm_stack_element->member_x64_item.member_x86_32_register = x86_32_register;
+            TP_X64_LIVE_RANGE* value = &(live_range[live_range_num]);
 
-        symbol_table->member_use_X86_32_register[x86_32_register] = *wasm_stack_element;
+            value->member_begin = i;
+            value->member_end = i;
+            value->member_use_count = 1;
+            value->member_forbidden_register_mask = 0;
+            value->member_hint_register = TP_X64_64_REGISTER_NULL;
+            value->member_register = TP_X64_64_REGISTER_NULL;
+            value->member_offset = 0;
 
-    }else if (TP_X64_32_REGISTER_NULL != x64_32_register){
+            // The constant operand of the next wasm instruction is not materialized.
+            value->member_is_immediate = ((TP_WASM_OPCODE_I32_CONST == wasm_opcode) &&
+                ((wasm_instruction_num - 1) > i) && tp_is_x64_immediate_operand(
+                    symbol_table->member_wasm_instruction[i + 1].member_wasm_opcode,
+                    instruction->member_immediate.member_i32
+                )
+            );
 
-        wasm_stack_element->member_x64_item_kind = TP_X64_ITEM_KIND_X64_32_REGISTER;
-        wasm_stack_element->member_x64_item.member_x64_32_register = x64_32_register;
+            // NOTE: The loaded value takes over the register of the local variable at the last access of it.
+            value->member_hint_live_range = local_variable;
 
-        symbol_table->member_use_X64_32_register[x64_32_register] = *wasm_stack_element;
-    }else{
+            value_stack[depth] = live_range_num;
 
-        return true;
+            ++live_range_num;
+            ++depth;
+        }
     }
 
-    if ( ! set_nv_register(symbol_table, x86_32_register, x64_32_register)){
-
-        TP_PUT_LOG_MSG_TRACE(symbol_table);
+    // NOTE: The parameters read before written are loaded to the registers by the prologue
+    // (see encode_x64_load_params function), except for batch mode which loads them at the beginning of the loop.
+    if (TP_X64_ENTRY_MODE_BATCH != symbol_table->member_x64_entry_mode){
 
-        return false;
-    }
+        static const TP_X64_64_REGISTER param_register[TP_X64_PARAM_REGISTER_NUM] = {
+            TP_X64_64_REGISTER_RCX, TP_X64_64_REGISTER_RDX, TP_X64_64_REGISTER_R8, TP_X64_64_REGISTER_R9
+        };
 
-    return true;
-}
+        for (uint32_t i = 0; symbol_table->member_wasm_instruction_param_count > i; ++i){
 
-static bool get_free_register(
-    TP_SYMBOL_TABLE* symbol_table,
-    TP_X86_32_REGISTER* x86_32_register, TP_X64_32_REGISTER* x64_32_register, bool* is_zero_free_register)
-{
-    for (uint32_t i = 0; TP_X86_32_REGISTER_NUM > i; ++i){
+            TP_X64_LIVE_RANGE* param = &(local_live_range[i]);
 
-        TP_WASM_STACK_ELEMENT* use_x86_32_register = &(symbol_table->member_use_X86_32_register[i]);
+            if ((0 == param->member_use_count) || (false == param->member_is_load)){
 
-        if (TP_X64_ITEM_KIND_X86_32_REGISTER != use_x86_32_register->member_x64_item_kind){
+                continue;
+            }
 
-            TP_X64_ITEM* x64_item = &(use_x86_32_register->member_x64_item);
+            param->member_begin = 0;
 
-            if ((TP_X86_32_REGISTER_ESP == x64_item->member_x86_32_register) ||
-                (TP_X86_32_REGISTER_EBP == x64_item->member_x86_32_register)){
+            // The parameter prefers the register of the argument(no move at the prologue).
+            if ((TP_X64_ENTRY_MODE_ARGS == symbol_table->member_x64_entry_mode) && (TP_X64_PARAM_REGISTER_NUM > i)){
 
-                continue;
+                param->member_hint_register = param_register[i];
             }
+        }
+    }
 
-            *is_zero_free_register = false;
+    // NOTE: IDIV clobbers EDX, so the local variables live across I32_DIV do not use RDX.
+    for (uint32_t i = 0; local_num > i; ++i){
 
-            *x86_32_register = (TP_X86_32_REGISTER)i;
+        TP_X64_LIVE_RANGE* local_variable = &(local_live_range[i]);
 
-            break;
+        if (local_variable->member_use_count &&
+            (div_num[local_variable->member_end] != div_num[local_variable->member_begin + 1])){
+
+            local_variable->member_forbidden_register_mask |= (1 << TP_X64_64_REGISTER_RDX);
         }
     }
 
-    if (*is_zero_free_register){
+    symbol_table->member_x64_live_range_num = live_range_num;
 
-        for (uint32_t i = 0; TP_X64_32_REGISTER_NUM > i; ++i){
+    TP_FREE(symbol_table, &value_stack, value_stack_size);
+    TP_FREE(symbol_table, &div_num, div_num_size);
 
-            TP_WASM_STACK_ELEMENT* use_x64_32_register = &(symbol_table->member_use_X64_32_register[i]);
+    return true;
 
-            if (TP_X64_ITEM_KIND_X64_32_REGISTER != use_x64_32_register->member_x64_item_kind){
+error_proc:
 
-                *is_zero_free_register = false;
+    if (value_stack){
 
-                *x64_32_register = (TP_X64_32_REGISTER)i;
+        TP_FREE(symbol_table, &value_stack, value_stack_size);
+    }
 
-                break;
-            }
-        }
+    if (div_num){
+
+        TP_FREE(symbol_table, &div_num, div_num_size);
     }
 
-    return true;
+    return false;
 }
 
-static bool spilling_variable(
-    TP_SYMBOL_TABLE* symbol_table,
-    uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t* x64_code_size,
-    TP_X86_32_REGISTER* x86_32_register, TP_X64_32_REGISTER* x64_32_register,
-    TP_WASM_STACK_ELEMENT* wasm_stack_element)
+static bool is_spill_x64_live_range(TP_X64_LIVE_RANGE* live_range, TP_X64_LIVE_RANGE* spill_live_range)
 {
-    TP_X86_32_REGISTER spill_x86_32_register = TP_X86_32_REGISTER_NULL;
-    TP_X64_32_REGISTER spill_x64_32_register = TP_X64_32_REGISTER_NULL;
-
-    if ( ! wasm_stack_is_empty(symbol_table)){
-
-        bool is_zero_free_register_in_wasm_stack = true;
+    // Spill cost: the use count per the length of the live range.
+    uint64_t cost = (uint64_t)(live_range->member_use_count) *
+        ((uint64_t)(spill_live_range->member_end) - spill_live_range->member_begin + 1);
+    uint64_t spill_cost = (uint64_t)(spill_live_range->member_use_count) *
+        ((uint64_t)(live_range->member_end) - live_range->member_begin + 1);
 
-        if ( ! get_free_register_in_wasm_stack(
-            symbol_table, &spill_x86_32_register, &spill_x64_32_register,
-            &is_zero_free_register_in_wasm_stack)){
+    if (cost < spill_cost){
 
-            TP_PUT_LOG_MSG_TRACE(symbol_table);
+        return true;
+    }
 
-            return false;
-        }
+    if ((cost == spill_cost) && (live_range->member_end > spill_live_range->member_end)){
 
-        if (is_zero_free_register_in_wasm_stack){
+        return true;
+    }
 
-            wasm_stack_element->member_x64_item_kind = TP_X64_ITEM_KIND_MEMORY;
+    return false;
+}
 
-            return true;
-        }
-    }
+bool tp_allocate_temporary_variable(TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_ELEMENT* wasm_stack_element)
+{
+    // NOTE: The live ranges are in order of the wasm instructions which push the values
+    // (see allocate_x64_register function).
+    uint32_t live_range_pos = symbol_table->member_x64_live_range_pos;
 
-    if ((TP_X86_32_REGISTER_NULL == spill_x86_32_register) &&
-        (TP_X64_32_REGISTER_NULL == spill_x64_32_register)){
+    if (symbol_table->member_x64_live_range_num <= live_range_pos){
 
         TP_PUT_LOG_MSG(
             symbol_table, TP_LOG_TYPE_DISP_FORCE,
-            TP_MSG_FMT("%1"),
-            TP_LOG_PARAM_STRING(
-                "ERROR: (TP_X86_32_REGISTER_NULL == spill_x86_32_register) && "
-                "(TP_X64_32_REGISTER_NULL == spill_x64_32_register)"
-            )
+            TP_MSG_FMT("ERROR: symbol_table->member_x64_live_range_num(%1) <= live_range_pos(%2)"),
+            TP_LOG_PARAM_UINT64_VALUE(symbol_table->member_x64_live_range_num),
+            TP_LOG_PARAM_UINT64_VALUE(live_range_pos)
         );
 
         return false;
     }
 
-    TP_WASM_STACK_ELEMENT dst = { 0 };
-    TP_WASM_STACK_ELEMENT* src = NULL;
-
-    if (TP_X86_32_REGISTER_NULL != spill_x86_32_register){
-
-        dst = symbol_table->member_use_X86_32_register[spill_x86_32_register];
-        src = &(symbol_table->member_use_X86_32_register[spill_x86_32_register]);
-    }else if (TP_X64_32_REGISTER_NULL != spill_x64_32_register){
+    TP_X64_LIVE_RANGE* live_range = &(symbol_table->member_x64_live_range[live_range_pos]);
 
-        dst = symbol_table->member_use_X64_32_register[spill_x64_32_register];
-        src = &(symbol_table->member_use_X64_32_register[spill_x64_32_register]);
-    }else{
+    if ((live_range->member_begin + 1) != symbol_table->member_wasm_instruction_pos){
 
         TP_PUT_LOG_MSG(
             symbol_table, TP_LOG_TYPE_DISP_FORCE,
-            TP_MSG_FMT(
-                "ERROR: (false == (TP_X86_32_REGISTER_NULL != spill_x86_32_register: %1)) &&"
-                "(false == (TP_X64_32_REGISTER_NULL != spill_x64_32_register: %2))"
-            ),
-            TP_LOG_PARAM_INT32_VALUE(spill_x86_32_register),
-            TP_LOG_PARAM_INT32_VALUE(spill_x64_32_register)
+            TP_MSG_FMT("ERROR: live_range->member_begin(%1) + 1 != symbol_table->member_wasm_instruction_pos(%2)"),
+            TP_LOG_PARAM_UINT64_VALUE(live_range->member_begin),
+            TP_LOG_PARAM_UINT64_VALUE(symbol_table->member_wasm_instruction_pos)
         );
 
         return false;
     }
 
-    dst.member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE;
-    dst.member_x64_item_kind = TP_X64_ITEM_KIND_MEMORY;
+    ++(symbol_table->member_x64_live_range_pos);
 
-    src->member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE;
+    if (live_range->member_is_immediate){
 
-    // NOTE: Call tp_free_register(src) in tp_encode_x64_2_operand().
-    uint32_t mov_code_size = tp_encode_x64_2_operand(
-        symbol_table, x64_code_buffer, x64_code_offset,
-        TP_X64_MOV, &dst, src
-    );
+        wasm_stack_element->member_x64_item_kind = TP_X64_ITEM_KIND_IMMEDIATE;
 
-    if (0 == mov_code_size){
+        return true;
+    }
 
-        TP_PUT_LOG_MSG(
-            symbol_table, TP_LOG_TYPE_DISP_FORCE,
-            TP_MSG_FMT("%1"),
-            TP_LOG_PARAM_STRING("ERROR: 0 == mov_code_size")
-        );
+    // NOTE: Temporary variables follow local variables, so the offset does not depend on
+    // the paddings of the stack frame(fixed after the function body).
+    wasm_stack_element->member_x64_memory_kind = TP_X64_ITEM_MEMORY_KIND_TEMP;
+    wasm_stack_element->member_offset = symbol_table->member_local_variable_size + live_range->member_offset;
 
-        return false;
-    }
+    if (TP_X64_64_REGISTER_NULL == live_range->member_register){
+
+        wasm_stack_element->member_x64_item_kind = TP_X64_ITEM_KIND_MEMORY;
 
-    *x64_code_size += mov_code_size;
+        return true;
+    }
 
-    src->member_x64_item_kind = TP_X64_ITEM_KIND_MEMORY;
+    tp_use_x64_register(symbol_table, wasm_stack_element, live_range->member_register);
 
     return true;
 }
 
-static bool get_free_register_in_wasm_stack(
-    TP_SYMBOL_TABLE* symbol_table,
-    TP_X86_32_REGISTER* free_x86_32_register, TP_X64_32_REGISTER* free_x64_32_register, bool* is_zero_free_register_in_wasm_stack)
+static bool use_x64_param_register(TP_SYMBOL_TABLE* symbol_table, uint32_t param_count)
 {
-    bool x86_32_register[TP_X86_32_REGISTER_NUM] = { false };
-    bool x64_32_register[TP_X64_32_REGISTER_NUM] = { false };
-
-    for (size_t i = 0; symbol_table->member_stack_size > i; ++i){
-
-        TP_WASM_STACK_ELEMENT* wasm_stack_element = &(symbol_table->member_stack[i]);
+    if (TP_X64_ENTRY_MODE_BATCH == symbol_table->member_x64_entry_mode){
 
-        switch (wasm_stack_element->member_x64_item_kind){
-        case TP_X64_ITEM_KIND_X86_32_REGISTER:{
-
-            TP_X86_32_REGISTER temp_x86_32_register = wasm_stack_element->member_x64_item.member_x86_32_register;
-
-            if (TP_X86_32_REGISTER_NULL <= temp_x86_32_register){
+        return true;
+    }
 
-                TP_PUT_LOG_MSG(
-                    symbol_table, TP_LOG_TYPE_DISP_FORCE,
-                    TP_MSG_FMT("ERROR: TP_X86_32_REGISTER_NULL <= temp_x86_32_register(%1)"),
-                    TP_LOG_PARAM_INT32_VALUE(temp_x86_32_register)
-                );
+    // NOTE: The parameters loaded by the prologue hold the registers from the beginning of
+    // the function body, so the registers are saved by the scratch uses before the first access
+    // (e.g. EAX and EDX of IDIV, see tp_encode_i32_div_code function).
+    for (uint32_t i = 0; param_count > i; ++i){
 
-                return false;
-            }
+        TP_X64_LIVE_RANGE* param = &(symbol_table->member_x64_local_live_range[i]);
 
-            x86_32_register[temp_x86_32_register] = true;
+        if ((0 == param->member_use_count) || (false == param->member_is_load) ||
+            (TP_X64_64_REGISTER_NULL == param->member_register)){
 
-            break;
+            continue;
         }
-        case TP_X64_ITEM_KIND_X64_32_REGISTER:{
-
-            TP_X64_32_REGISTER temp_x64_32_register = wasm_stack_element->member_x64_item.member_x64_32_register;
-
-            if (TP_X64_32_REGISTER_NULL <= temp_x64_32_register){
 
-                TP_PUT_LOG_MSG(
-                    symbol_table, TP_LOG_TYPE_DISP_FORCE,
-                    TP_MSG_FMT("ERROR: TP_X64_32_REGISTER_NULL <= temp_x64_32_register(%1)"),
-                    TP_LOG_PARAM_INT32_VALUE(temp_x64_32_register)
-                );
+        TP_WASM_STACK_ELEMENT param_register = {
+            .member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE,
+            .member_local_index = i,
+            .member_x64_item_kind = TP_X64_ITEM_KIND_MEMORY,
+            .member_x64_memory_kind = TP_X64_ITEM_MEMORY_KIND_LOCAL
+        };
 
-                return false;
-            }
+        if ( ! tp_get_local_variable_offset(symbol_table, i, &(param_register.member_offset))){
 
-            x64_32_register[temp_x64_32_register] = true;
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-            break;
-        }
-        default:
-            break;
+            return false;
         }
+
+        tp_use_x64_register(symbol_table, &param_register, param->member_register);
     }
 
-    bool is_zero_free_x86_32_register = true;
+    return true;
+}
 
-    const int32_t bad_index = -1;
-    int32_t free_x86_32_index = bad_index;
+void tp_use_x64_register(
+    TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_ELEMENT* wasm_stack_element, TP_X64_64_REGISTER x64_register)
+{
+    set_x64_register_item(wasm_stack_element, x64_register);
 
-    for (int32_t i = 0; TP_X86_32_REGISTER_NUM > i; ++i){
+    if (TP_X64_ITEM_KIND_X86_32_REGISTER == wasm_stack_element->member_x64_item_kind){
 
-        if (false == x86_32_register[i]){
+        symbol_table->member_use_X86_32_register[
+            wasm_stack_element->member_x64_item.member_x86_32_register
+        ] = *wasm_stack_element;
+    }else{
 
-            is_zero_free_x86_32_register = false;
+        symbol_table->member_use_X64_32_register[
+            wasm_stack_element->member_x64_item.member_x64_32_register
+        ] = *wasm_stack_element;
+    }
 
-            free_x86_32_index = i;
+    set_nv_register(symbol_table, x64_register);
+}
 
-            break;
-        }
+TP_X64_64_REGISTER tp_get_x64_64_register(TP_WASM_STACK_ELEMENT* wasm_stack_element)
+{
+    switch (wasm_stack_element->member_x64_item_kind){
+    case TP_X64_ITEM_KIND_X86_32_REGISTER:
+        return (TP_X64_64_REGISTER)(wasm_stack_element->member_x64_item.member_x86_32_register);
+    case TP_X64_ITEM_KIND_X64_32_REGISTER:
+        return (TP_X64_64_REGISTER)(TP_X64_64_REGISTER_R8 + wasm_stack_element->member_x64_item.member_x64_32_register);
+    default:
+        break;
     }
 
-    bool is_zero_free_x64_32_register = true;
-    int32_t free_x64_32_index = bad_index;
+    return TP_X64_64_REGISTER_NULL;
+}
 
-    for (int32_t i = 0; TP_X64_32_REGISTER_NUM > i; ++i){
+bool tp_get_scratch_register(
+    TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_ELEMENT* scratch_register, bool* is_zero_free_register)
+{
+    // NOTE: The scratch register is not marked as used, so use it only in the x64 code of a wasm instruction.
+    *is_zero_free_register = true;
 
-        if (false == x64_32_register[i]){
+    for (uint32_t i = 0; TP_X64_ALLOCATABLE_REGISTER_NUM > i; ++i){
 
-            is_zero_free_x64_32_register = false;
+        TP_X64_64_REGISTER x64_register = x64_allocatable_register[i];
 
-            free_x64_32_index = i;
+        if (is_use_x64_register(symbol_table, x64_register)){
 
-            break;
+            continue;
         }
-    }
-
-    if (is_zero_free_x86_32_register && is_zero_free_x64_32_register){
 
-        *is_zero_free_register_in_wasm_stack = true;
+        scratch_register->member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE;
 
-        return true;
-    }
+        set_x64_register_item(scratch_register, x64_register);
 
-    if ((false == is_zero_free_x86_32_register) && (bad_index != free_x86_32_index)){
+        set_nv_register(symbol_table, x64_register);
 
-        *free_x86_32_register = free_x86_32_index;
+        *is_zero_free_register = false;
 
-        return true;
+        break;
     }
 
-    if ((false == is_zero_free_x64_32_register) && (bad_index != free_x64_32_index)){
+    return true;
+}
 
-        *free_x64_32_register = free_x64_32_index;
+static bool is_use_x64_register(TP_SYMBOL_TABLE* symbol_table, TP_X64_64_REGISTER x64_register)
+{
+    if (TP_X64_64_REGISTER_R8 > x64_register){
 
-        return true;
+        return (TP_X64_ITEM_KIND_X86_32_REGISTER ==
+            symbol_table->member_use_X86_32_register[x64_register].member_x64_item_kind
+        );
     }
 
-    TP_PUT_LOG_MSG(
-        symbol_table, TP_LOG_TYPE_DISP_FORCE,
-        TP_MSG_FMT("ERROR: at %1"), TP_LOG_PARAM_STRING(__func__)
+    return (TP_X64_ITEM_KIND_X64_32_REGISTER ==
+        symbol_table->member_use_X64_32_register[x64_register - TP_X64_64_REGISTER_R8].member_x64_item_kind
     );
+}
 
-    return false;
+static void set_x64_register_item(TP_WASM_STACK_ELEMENT* wasm_stack_element, TP_X64_64_REGISTER x64_register)
+{
+    if (TP_X64_64_REGISTER_R8 > x64_register){
+
+        wasm_stack_element->member_x64_item_kind = TP_X64_ITEM_KIND_X86_32_REGISTER;
+        wasm_stack_element->member_x64_item.member_x86_32_register = (TP_X86_32_REGISTER)x64_register;
+    }else{
+
+        wasm_stack_element->member_x64_item_kind = TP_X64_ITEM_KIND_X64_32_REGISTER;
+        wasm_stack_element->member_x64_item.member_x64_32_register =
+            (TP_X64_32_REGISTER)(x64_register - TP_X64_64_REGISTER_R8);
+    }
 }
 
-static bool set_nv_register(
-    TP_SYMBOL_TABLE* symbol_table,
-    TP_X86_32_REGISTER x86_32_register, TP_X64_32_REGISTER x64_32_register)
+static void set_nv_register(TP_SYMBOL_TABLE* symbol_table, TP_X64_64_REGISTER x64_register)
 {
-    switch (x86_32_register){
-    case TP_X86_32_REGISTER_EBX:
+    switch (x64_register){
+    case TP_X64_64_REGISTER_RBX:
         symbol_table->member_use_nv_register[TP_X64_NV64_REGISTER_RBX_INDEX] = TP_X64_NV64_REGISTER_RBX;
         break;
-    case TP_X86_32_REGISTER_ESI:
+    case TP_X64_64_REGISTER_RSI:
         symbol_table->member_use_nv_register[TP_X64_NV64_REGISTER_RSI_INDEX] = TP_X64_NV64_REGISTER_RSI;
         break;
-    case TP_X86_32_REGISTER_EDI:
+    case TP_X64_64_REGISTER_RDI:
         symbol_table->member_use_nv_register[TP_X64_NV64_REGISTER_RDI_INDEX] = TP_X64_NV64_REGISTER_RDI;
         break;
-    default:
-        break;
-    }
-
-    switch (x64_32_register){
-    case TP_X64_32_REGISTER_R12D:
+    case TP_X64_64_REGISTER_R12:
         symbol_table->member_use_nv_register[TP_X64_NV64_REGISTER_R12_INDEX] = TP_X64_NV64_REGISTER_R12;
         break;
-    case TP_X64_32_REGISTER_R13D:
+    case TP_X64_64_REGISTER_R13:
         symbol_table->member_use_nv_register[TP_X64_NV64_REGISTER_R13_INDEX] = TP_X64_NV64_REGISTER_R13;
         break;
-    case TP_X64_32_REGISTER_R14D:
+    case TP_X64_64_REGISTER_R14:
         symbol_table->member_use_nv_register[TP_X64_NV64_REGISTER_R14_INDEX] = TP_X64_NV64_REGISTER_R14;
         break;
-    case TP_X64_32_REGISTER_R15D:
+    case TP_X64_64_REGISTER_R15:
         symbol_table->member_use_nv_register[TP_X64_NV64_REGISTER_R15_INDEX] = TP_X64_NV64_REGISTER_R15;
         break;
     default:
         break;
     }
-
-    return true;
 }
 
 bool tp_free_register(TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_ELEMENT* stack_element)
@@ -1172,7 +2175,7 @@ bool tp_free_register(TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_ELEMENT* stac
         }
 
         symbol_table->member_use_X64_32_register[x64_32_register].member_x64_item_kind = TP_X64_ITEM_KIND_MEMORY;
-        symbol_table->member_use_X86_32_register[x64_32_register].member_x64_item.member_x64_32_register
+        symbol_table->member_use_X64_32_register[x64_32_register].member_x64_item.member_x64_32_register
             = TP_X64_32_REGISTER_NULL;
 
         stack_element->member_x64_item_kind = TP_X64_ITEM_KIND_MEMORY;
@@ -1180,6 +2183,8 @@ bool tp_free_register(TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_ELEMENT* stac
         break;
     }
     case TP_X64_ITEM_KIND_MEMORY:
+//      break;
+    case TP_X64_ITEM_KIND_IMMEDIATE:
         break;
     default:
         TP_PUT_LOG_MSG_ICE(symbol_table);
@@ -1190,7 +2195,8 @@ bool tp_free_register(TP_SYMBOL_TABLE* symbol_table, TP_WASM_STACK_ELEMENT* stac
 }
 
 static bool get_wasm_export_code_section(
-    TP_SYMBOL_TABLE* symbol_table, TP_WASM_MODULE_SECTION** code_section, uint32_t* return_type)
+    TP_SYMBOL_TABLE* symbol_table, TP_WASM_MODULE_SECTION** code_section,
+    uint32_t* param_count, uint32_t* return_type)
 {
     TP_WASM_MODULE* module = &(symbol_table->member_wasm_module);
 
@@ -1243,7 +2249,7 @@ static bool get_wasm_export_code_section(
 
     if ( ! get_wasm_module_code_section(
         symbol_table,
-        module->member_section, module->member_section_num, &code_section_index, return_type)){
+        module->member_section, module->member_section_num, &code_section_index, param_count, return_type)){
 
         TP_PUT_LOG_MSG_TRACE(symbol_table);
 
@@ -1325,7 +2331,8 @@ static bool make_wasm_module_section(
             // name_len: 0 == member_id
             // name: 0 == member_id
 
-            uint8_t* tmp_payload = (uint8_t*)calloc(payload_len, sizeof(uint8_t));
+            // NOTE: Same as tp_make_wasm(): id, payload_len and payload_data.
+            uint8_t* tmp_payload = (uint8_t*)TP_CALLOC(symbol_table, section_size, sizeof(uint8_t));
 
             if (NULL == tmp_payload){
 
@@ -1339,7 +2346,7 @@ static bool make_wasm_module_section(
             (*section)[section_num]->member_name_len_name_payload_data = tmp_payload;
 
             memcpy((*section)[section_num]->member_name_len_name_payload_data,
-                module_content_payload + size_id + size_payload_len, payload_len
+                module_content_payload, section_size
             );
         }
 
@@ -1357,7 +2364,7 @@ static bool make_wasm_module_section(
             return false;
         }
 
-        module_content_payload -= section_size;
+        module_content_payload += section_size;
 
         ++section_num;
 
@@ -1372,7 +2379,7 @@ static TP_WASM_MODULE_SECTION** allocate_wasm_module_section(
     TP_SYMBOL_TABLE* symbol_table, TP_WASM_MODULE* module)
 {
     TP_WASM_MODULE_SECTION** tmp_section =
-        (TP_WASM_MODULE_SECTION**)calloc(module->member_section_num, sizeof(TP_WASM_MODULE_SECTION*));
+        (TP_WASM_MODULE_SECTION**)TP_CALLOC(symbol_table, module->member_section_num, sizeof(TP_WASM_MODULE_SECTION*));
 
     if (NULL == tmp_section){
 
@@ -1387,7 +2394,7 @@ static TP_WASM_MODULE_SECTION** allocate_wasm_module_section(
 
     for (uint32_t i = 0; module->member_section_num > i; ++i){
 
-        tmp_section[i] = (TP_WASM_MODULE_SECTION*)calloc(1, sizeof(TP_WASM_MODULE_SECTION));
+        tmp_section[i] = (TP_WASM_MODULE_SECTION*)TP_CALLOC(symbol_table, 1, sizeof(TP_WASM_MODULE_SECTION));
 
         if (NULL == tmp_section[i]){
 
@@ -1432,7 +2439,8 @@ static void free_wasm_module_section(
 
 static bool get_wasm_module_code_section(
     TP_SYMBOL_TABLE* symbol_table,
-    TP_WASM_MODULE_SECTION** section, uint32_t section_num, uint32_t* code_section_index, uint32_t* return_type)
+    TP_WASM_MODULE_SECTION** section, uint32_t section_num, uint32_t* code_section_index,
+    uint32_t* param_count, uint32_t* return_type)
 {
     uint32_t item_index = 0;
 
@@ -1454,7 +2462,8 @@ static bool get_wasm_module_code_section(
         return false;
     }
 
-    if ( ! get_wasm_module_type_section_return_type(symbol_table, section, section_num, type, return_type)){
+    if ( ! get_wasm_module_type_section_signature(
+        symbol_table, section, section_num, type, param_count, return_type)){
 
         TP_PUT_LOG_MSG_TRACE(symbol_table);
 
@@ -1598,9 +2607,10 @@ static bool get_wasm_module_function_section_type(
     return true;
 }
 
-static bool get_wasm_module_type_section_return_type(
+static bool get_wasm_module_type_section_signature(
     TP_SYMBOL_TABLE* symbol_table,
-    TP_WASM_MODULE_SECTION** section, uint32_t section_num, uint32_t type, uint32_t* return_type)
+    TP_WASM_MODULE_SECTION** section, uint32_t section_num, uint32_t type,
+    uint32_t* param_count, uint32_t* return_type)
 {
     TP_WASM_MODULE_SECTION* type_section = NULL;
 
@@ -1635,13 +2645,18 @@ static bool get_wasm_module_type_section_return_type(
 
     TP_DECODE_UI32LEB128_CHECK_VALUE(symbol_table, type_section, payload, offset, TP_WASM_MODULE_SECTION_TYPE_COUNT);
     TP_DECODE_UI32LEB128_CHECK_VALUE(symbol_table, type_section, payload, offset, TP_WASM_MODULE_SECTION_TYPE_FORM_FUNC);
-    TP_DECODE_UI32LEB128_CHECK_VALUE(symbol_table, type_section, payload, offset, TP_WASM_MODULE_SECTION_TYPE_PARAM_COUNT);
+    uint32_t count = 0;
+    TP_DECODE_UI32LEB128_GET_VALUE(symbol_table, type_section, payload, offset, count);
+
+    for (uint32_t i = 0; count > i; ++i){
 
-//  uint32_t param_types;
+        TP_DECODE_UI32LEB128_CHECK_VALUE(symbol_table, type_section, payload, offset, TP_WASM_MODULE_SECTION_TYPE_PARAM_TYPE_I32);
+    }
 
     TP_DECODE_UI32LEB128_CHECK_VALUE(symbol_table, type_section, payload, offset, TP_WASM_MODULE_SECTION_TYPE_RETURN_COUNT);
     TP_DECODE_UI32LEB128_CHECK_VALUE(symbol_table, type_section, payload, offset, TP_WASM_MODULE_SECTION_TYPE_RETURN_TYPE_I32);
 
+    *param_count = count;
     *return_type = TP_WASM_MODULE_SECTION_TYPE_RETURN_TYPE_I32;
 
     return true;
@@ -3,6 +3,18 @@
 
 #include "tp_compiler.h"
 
+// Home space of function arguments register.
+#define TP_X64_STACK_PARAM_SIZE ((int32_t)(sizeof(uint64_t) * TP_X64_PARAM_REGISTER_NUM))
+
+static uint32_t encode_x64_2_operand_common(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* op1, TP_WASM_STACK_ELEMENT* op2
+);
+static uint32_t encode_x64_32_memory_to_memory(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src
+);
+static bool is_same_x64_register(TP_WASM_STACK_ELEMENT* op1, TP_WASM_STACK_ELEMENT* op2);
 static uint32_t encode_x64_32_register_to_x64_32_register(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
     TP_X64 x64_op, TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src
@@ -20,11 +32,6 @@ static uint32_t encode_x64_32_memory_offset_common(
     TP_X64 x64_op, TP_X64_DIRECTION x64_direction, TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src
 );
 
-typedef enum tp_x64_mov_imm_mode_{
-    TP_X64_MOV_IMM_MODE_DEFAULT,
-    TP_X64_MOV_IMM_MODE_FORCE_IMM32
-}TP_X64_MOV_IMM_MODE;
-
 static uint32_t encode_x64_mov_imm(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
     int32_t imm, TP_X64_MOV_IMM_MODE x64_mov_imm_mode, TP_WASM_STACK_ELEMENT* result
@@ -44,6 +51,71 @@ static uint32_t encode_x64_lea(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
     TP_X64_64_REGISTER reg64_dst_reg, TP_X64_64_REGISTER reg64_src_index, TP_X64_64_REGISTER reg64_src_base, int32_t offset
 );
+static uint32_t encode_x64_address(
+    uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint8_t reg,
+    TP_X64_64_REGISTER reg64_base, TP_X64_64_REGISTER reg64_index, uint8_t scale, int32_t offset,
+    TP_X64_DISP_MODE x64_disp_mode
+);
+
+static uint32_t encode_x64_alu_imm(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* dst, int32_t imm
+);
+static uint32_t encode_x64_imul_imm(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src, int32_t imm
+);
+static uint32_t encode_x64_mul_imm(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_WASM_STACK_ELEMENT* op1, int32_t value
+);
+static uint32_t encode_x64_div_imm(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_WASM_STACK_ELEMENT* op1, int32_t divisor
+);
+static uint32_t get_x64_shift_count(uint32_t value);
+static void calc_x64_magic_number(int32_t divisor, int32_t* magic, uint32_t* shift);
+static uint32_t encode_x64_rm_operand(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_OPERAND_SIZE x64_operand_size, uint8_t opcode, TP_X64_64_REGISTER reg64, TP_WASM_STACK_ELEMENT* rm
+);
+static uint32_t encode_x64_shift_imm(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* dst, uint8_t imm8
+);
+static uint32_t encode_x64_neg(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, TP_WASM_STACK_ELEMENT* dst
+);
+static uint32_t encode_x64_lea_scale(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src, uint8_t scale
+);
+static uint32_t encode_x64_mul_high(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src, int32_t imm
+);
+static uint32_t encode_x64_cdq(TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset);
+
+static void calc_x64_stack_frame(TP_SYMBOL_TABLE* symbol_table, int32_t stack_param_size);
+static uint32_t encode_x64_stack_frame(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, int32_t stack_param_size
+);
+static bool is_x64_frame_elision(TP_SYMBOL_TABLE* symbol_table);
+static bool encode_x64_load_params(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    uint32_t param_count, int32_t stack_param_size, uint32_t* x64_code_size
+);
+static uint32_t encode_x64_load_stack_param(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_64_REGISTER reg64, uint32_t param_index, int32_t stack_param_size
+);
+static uint32_t encode_x64_32_register_operand(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    uint8_t opcode, TP_X64_64_REGISTER reg64, TP_X64_64_REGISTER rm64
+);
+static uint32_t encode_x64_batch_init(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset
+);
 static uint32_t encode_x64_push_reg64(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, TP_X64_64_REGISTER reg64
 );
@@ -53,10 +125,12 @@ static uint32_t encode_x64_pop_reg64(
 static uint32_t encode_x64_1_opcode(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint8_t opcode
 );
+static bool record_x64_instruction(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, TP_X64_INSTRUCTION* x64_instruction
+);
 
-uint32_t tp_encode_allocate_stack(
-    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
-    uint32_t var_count, uint32_t var_type)
+bool tp_prepare_x64_stack_frame(
+    TP_SYMBOL_TABLE* symbol_table, uint32_t param_count, uint32_t var_count, uint32_t var_type)
 {
     if (TP_WASM_MODULE_SECTION_CODE_VAR_TYPE_I32 != var_type){
 
@@ -67,10 +141,45 @@ uint32_t tp_encode_allocate_stack(
             TP_LOG_PARAM_UINT64_VALUE(var_type)
         );
 
-        return 0;
+        return false;
     }
 
-    uint32_t local_variable_size = var_count * sizeof(int32_t);
+    // Parameters are copied to the first local variables.
+    uint32_t local_variable_size = (param_count + var_count) * sizeof(int32_t);
+
+    if (TP_X64_ENTRY_MODE_BATCH == symbol_table->member_x64_entry_mode){
+
+        // Loop state of batch mode.
+        local_variable_size = ((local_variable_size + (sizeof(uint64_t) - 1)) & ~((uint32_t)sizeof(uint64_t) - 1));
+
+        symbol_table->member_batch_slot_offset = (int32_t)local_variable_size;
+
+        local_variable_size += (TP_X64_BATCH_SLOT_NUM * sizeof(uint64_t));
+
+        if (symbol_table->member_local_variable_size_max < (int32_t)local_variable_size){
+
+            TP_PUT_LOG_MSG(
+                symbol_table, TP_LOG_TYPE_DISP_FORCE,
+                TP_MSG_FMT("ERROR: symbol_table->member_local_variable_size_max(%1) < local_variable_size(%2)"),
+                TP_LOG_PARAM_INT32_VALUE(symbol_table->member_local_variable_size_max),
+                TP_LOG_PARAM_UINT64_VALUE(local_variable_size)
+            );
+
+            return false;
+        }
+
+        // Vector local variables and non-volatile vector registers(see tp_prepare_x64_simd_code function).
+        if (TP_X64_SIMD_ISA_NONE != symbol_table->member_x64_simd_isa){
+
+            symbol_table->member_simd_local_variable_offset = (int32_t)local_variable_size;
+
+            local_variable_size += symbol_table->member_simd_local_variable_size;
+
+            symbol_table->member_simd_nv_register_offset = (int32_t)local_variable_size;
+
+            local_variable_size += symbol_table->member_simd_nv_register_size;
+        }
+    }
 
     if (INT32_MAX < local_variable_size){
 
@@ -81,35 +190,44 @@ uint32_t tp_encode_allocate_stack(
             TP_LOG_PARAM_UINT64_VALUE(local_variable_size)
         );
 
-        return 0;
+        return false;
     }
 
-    uint32_t x64_code_size = 0;
+    symbol_table->member_local_variable_size = (int32_t)local_variable_size;
+
+    return true;
+}
+
+bool tp_encode_allocate_stack(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t param_count,
+    uint32_t* x64_code_size)
+{
+    // NOTE: The prologue is encoded after the function body(see tp_make_x64_function),
+    // so the non-volatile registers and the temporary variables of the function body are fixed.
+    *x64_code_size = 0;
+    uint32_t tmp_x64_code_size = 0;
 
 #if TP_DEBUG_BREAK
     // int 3
     if (x64_code_buffer){
  
-        x64_code_buffer[x64_code_offset + x64_code_size] = 0xcc;
+        x64_code_buffer[x64_code_offset + *x64_code_size] = 0xcc;
     }
 
-    ++x64_code_size;
+    ++(*x64_code_size);
 #endif
-    // Return Address
-    symbol_table->member_register_bytes = (int32_t)sizeof(uint64_t);
+    // NOTE: The stack frame is fixed at the end of the function body(see calc_x64_stack_frame function).
+    if (false == symbol_table->member_is_x64_frame_elision){
 
-    // PUSH – Push Operand onto the Stack
-    uint32_t tmp_x64_code_size = encode_x64_push_reg64(
-        symbol_table, x64_code_buffer, x64_code_offset, TP_X64_64_REGISTER_RBP
-    );
-    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
-    {
-        // RBP register.
-        symbol_table->member_register_bytes += (int32_t)sizeof(uint64_t);
+        // PUSH – Push Operand onto the Stack
+        tmp_x64_code_size = encode_x64_push_reg64(
+            symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size, TP_X64_64_REGISTER_RBP
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
+    }
 
+    {
         // Other non-volatile registers.
-        int32_t nv_register_bytes = 0;
-
         for (int32_t i = TP_X64_NV64_REGISTER_NUM - 1; 0 <= i; --i){
 
             switch (symbol_table->member_use_nv_register[i]){
@@ -130,31 +248,112 @@ uint32_t tp_encode_allocate_stack(
             case TP_X64_NV64_REGISTER_R15:{
                 // PUSH – Push Operand onto the Stack
                 tmp_x64_code_size = encode_x64_push_reg64(
-                    symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                    symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size,
                     (TP_X64_64_REGISTER)(symbol_table->member_use_nv_register[i])
                 );
-                TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
-                ++nv_register_bytes;
+                TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
                 break;
             }
             default:
                 TP_PUT_LOG_MSG_ICE(symbol_table);
-                return 0;
+                return false;
             }
         }
+    }
+
+    const int32_t stack_param_size = TP_X64_STACK_PARAM_SIZE;
+
+    if (symbol_table->member_is_x64_frame_elision){
+
+        if (x64_code_buffer){
+
+            TP_PUT_LOG_MSG(
+                symbol_table, TP_LOG_TYPE_HIDE,
+                TP_MSG_FMT(
+                    "frame elision(no push rbp and no sub rsp, imm)\n"
+                    "symbol_table->member_register_bytes: %1\n"
+                    "functions without the stack frame: %2"
+                ),
+                TP_LOG_PARAM_INT32_VALUE(symbol_table->member_register_bytes),
+                TP_LOG_PARAM_UINT64_VALUE(symbol_table->member_optimization_statistics.member_frame_elision_num)
+            );
+        }
+    }else{
+
+        tmp_x64_code_size = encode_x64_stack_frame(
+            symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size, stack_param_size
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
+    }
+
+    if (TP_X64_ENTRY_MODE_BATCH == symbol_table->member_x64_entry_mode){
+
+        tmp_x64_code_size = encode_x64_batch_init(
+            symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
+    }else if (param_count){
+
+        // NOTE: No code is encoded if the parameters are in the registers of the arguments already.
+        if ( ! encode_x64_load_params(
+            symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size,
+            param_count, stack_param_size, &tmp_x64_code_size)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        *x64_code_size += tmp_x64_code_size;
+    }
+
+#if TP_DEBUG_BREAK
+    // int 3
+    if (x64_code_buffer){
+
+        x64_code_buffer[x64_code_offset + *x64_code_size] = 0xcc;
+    }
+
+    ++(*x64_code_size);
+#endif
+
+    return true;
+}
+
+static void calc_x64_stack_frame(TP_SYMBOL_TABLE* symbol_table, int32_t stack_param_size)
+{
+    // Return Address
+    symbol_table->member_register_bytes = (int32_t)sizeof(uint64_t);
+
+    if (false == symbol_table->member_is_x64_frame_elision){
+
+        // RBP register.
+        symbol_table->member_register_bytes += (int32_t)sizeof(uint64_t);
+    }
+
+    // Other non-volatile registers.
+    for (int32_t i = 0; TP_X64_NV64_REGISTER_NUM > i; ++i){
 
-        symbol_table->member_register_bytes += (nv_register_bytes * sizeof(uint64_t));
+        if (TP_X64_NV64_REGISTER_NULL != symbol_table->member_use_nv_register[i]){
 
-        symbol_table->member_padding_register_bytes =
-            ((-(symbol_table->member_register_bytes)) & TP_PADDING_MASK);
+            symbol_table->member_register_bytes += (int32_t)sizeof(uint64_t);
+        }
     }
 
-    // Temporary variables(see tp_make_x64_code function).
+    symbol_table->member_padding_register_bytes =
+        ((-(symbol_table->member_register_bytes)) & TP_PADDING_MASK);
 
-    // Local variables.
+    // Temporary variables.
     {
-        symbol_table->member_local_variable_size = (int32_t)local_variable_size;
+        int32_t v = symbol_table->member_register_bytes +
+            symbol_table->member_padding_register_bytes +
+            symbol_table->member_temporary_variable_size;
+
+        symbol_table->member_padding_temporary_variable_bytes = ((-v) & TP_PADDING_MASK);
+    }
 
+    // Local variables(see tp_prepare_x64_stack_frame function).
+    {
         int32_t v = symbol_table->member_register_bytes +
             symbol_table->member_padding_register_bytes +
             symbol_table->member_temporary_variable_size +
@@ -164,9 +363,6 @@ uint32_t tp_encode_allocate_stack(
         symbol_table->member_padding_local_variable_bytes = ((-v) & TP_PADDING_MASK);
     }
 
-    // Home space of function arguments register.
-    const int32_t stack_param_size = (int32_t)(sizeof(uint64_t) * 4);
-
     symbol_table->member_stack_imm32 =
 //      symbol_table->member_register_bytes +
         symbol_table->member_padding_register_bytes +
@@ -177,18 +373,27 @@ uint32_t tp_encode_allocate_stack(
         stack_param_size;
 
     // Last padding bytes.
+    symbol_table->member_last_padding_bytes = 0;
+
     if (0 == ((symbol_table->member_stack_imm32) % 16)){
 
         symbol_table->member_last_padding_bytes = sizeof(uint64_t);
         symbol_table->member_stack_imm32 += sizeof(uint64_t);
     }
+}
+
+static uint32_t encode_x64_stack_frame(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, int32_t stack_param_size)
+{
+    uint32_t x64_code_size = 0;
+    uint32_t tmp_x64_code_size = 0;
 
     if (x64_code_buffer){
 
         TP_PUT_LOG_MSG(
             symbol_table, TP_LOG_TYPE_HIDE,
             TP_MSG_FMT(
-                "sub rsp, imm32\n"
+                "sub rsp, imm\n"
                 "symbol_table->member_stack_imm32(member_register_bytes is not included): %1\n"
                 "symbol_table->member_register_bytes: %2\n"
                 "symbol_table->member_padding_register_bytes: %3\n"
@@ -214,7 +419,7 @@ uint32_t tp_encode_allocate_stack(
     // SUB – Integer Subtraction
     tmp_x64_code_size = encode_x64_add_sub_imm(
         symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
-        TP_X64_SUB, TP_X64_64_REGISTER_RSP, symbol_table->member_stack_imm32, TP_X64_ADD_SUB_IMM_MODE_FORCE_IMM32
+        TP_X64_SUB, TP_X64_64_REGISTER_RSP, symbol_table->member_stack_imm32, TP_X64_ADD_SUB_IMM_MODE_DEFAULT
     );
     TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
 
@@ -227,33 +432,14 @@ uint32_t tp_encode_allocate_stack(
     );
     TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
 
-#if TP_DEBUG_BREAK
-    // int 3
-    if (x64_code_buffer){
-
-        x64_code_buffer[x64_code_offset + x64_code_size] = 0xcc;
-    }
-
-    ++x64_code_size;
-#endif
-
     return x64_code_size;
 }
 
-uint32_t tp_encode_get_local_code(
-    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t local_index)
+bool tp_encode_get_local_code(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t local_index,
+    uint32_t* x64_code_size)
 {
-    TP_WASM_STACK_ELEMENT dst = { .member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE };
-
-    uint32_t x64_code_size = 0;
-
-    if ( ! tp_allocate_temporary_variable(
-        symbol_table, TP_X64_ALLOCATE_DEFAULT, x64_code_buffer, x64_code_offset, &x64_code_size, &dst)){
-
-        TP_PUT_LOG_MSG_TRACE(symbol_table);
-
-        return 0;
-    }
+    *x64_code_size = 0;
 
     TP_WASM_STACK_ELEMENT src = {
         .member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE,
@@ -268,32 +454,86 @@ uint32_t tp_encode_get_local_code(
 
         TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-        return 0;
+        return false;
     }
 
     src.member_offset = offset;
 
-    uint32_t tmp_x64_code_size = tp_encode_x64_2_operand(
-        symbol_table, x64_code_buffer, x64_code_offset,
-        TP_X64_MOV, &dst, &src
-    );
+    uint32_t wasm_instruction_index = symbol_table->member_wasm_instruction_pos - 1;
+    TP_X64_LIVE_RANGE* local_variable = &(symbol_table->member_x64_local_live_range[local_index]);
 
-    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    if (TP_X64_64_REGISTER_NULL != local_variable->member_register){
+
+        TP_WASM_STACK_ELEMENT local_variable_register = src;
+
+        tp_use_x64_register(symbol_table, &local_variable_register, local_variable->member_register);
+
+        // NOTE: The parameters except for batch mode are loaded by the prologue(see encode_x64_load_params function).
+        bool is_load_param = ((TP_X64_ENTRY_MODE_BATCH != symbol_table->member_x64_entry_mode) &&
+            (symbol_table->member_wasm_instruction_param_count > local_index)
+        );
+
+        if (local_variable->member_is_load && (false == is_load_param) &&
+            (local_variable->member_begin == wasm_instruction_index)){
+
+            // mov local_variable_register, [rbp+local_variable]
+            uint32_t tmp_x64_code_size = encode_x64_2_operand_common(
+                symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size,
+                TP_X64_MOV, &local_variable_register, &src
+            );
+
+            TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
+        }
+
+        src = local_variable_register;
+
+        // NOTE: The value takes over the register at the last access of the local variable.
+        if (local_variable->member_end == wasm_instruction_index){
+
+            if ( ! tp_free_register(symbol_table, &local_variable_register)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                return false;
+            }
+        }
+    }
+
+    TP_WASM_STACK_ELEMENT dst = { .member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE };
+
+    if ( ! tp_allocate_temporary_variable(symbol_table, &dst)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! is_same_x64_register(&dst, &src)){
+
+        uint32_t tmp_x64_code_size = encode_x64_2_operand_common(
+            symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size,
+            TP_X64_MOV, &dst, &src
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
+    }
 
     if ( ! tp_wasm_stack_push(symbol_table, &dst)){
 
         TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-        return 0;
+        return false;
     }
 
-    return x64_code_size;
+    return true;
 }
 
-uint32_t tp_encode_set_local_code(
+bool tp_encode_set_local_code(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
-    uint32_t local_index, TP_WASM_STACK_ELEMENT* op1)
+    uint32_t local_index, TP_WASM_STACK_ELEMENT* op1, uint32_t* x64_code_size)
 {
+    *x64_code_size = 0;
+
     if (TP_WASM_OPCODE_I32_VALUE != op1->member_wasm_opcode){
 
         TP_PUT_LOG_MSG(
@@ -303,7 +543,7 @@ uint32_t tp_encode_set_local_code(
             TP_LOG_PARAM_UINT64_VALUE(op1->member_wasm_opcode)
         );
 
-        return 0;
+        return false;
     }
 
     TP_WASM_STACK_ELEMENT dst = {
@@ -319,98 +559,203 @@ uint32_t tp_encode_set_local_code(
 
         TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-        return 0;
+        return false;
     }
 
     dst.member_offset = offset;
 
-    uint32_t x64_code_size = 0;
+    uint32_t wasm_instruction_index = symbol_table->member_wasm_instruction_pos - 1;
+    TP_X64_LIVE_RANGE* local_variable = &(symbol_table->member_x64_local_live_range[local_index]);
+
+    // NOTE: The local variable in the register is not stored to the stack frame.
+    if (TP_X64_64_REGISTER_NULL != local_variable->member_register){
+
+        TP_WASM_STACK_ELEMENT local_variable_register = dst;
+
+        // NOTE: The local variable takes over the register of op1 if they are the same register.
+        tp_use_x64_register(symbol_table, &local_variable_register, local_variable->member_register);
+
+        if ( ! is_same_x64_register(&local_variable_register, op1)){
+
+            uint32_t tmp_x64_code_size = tp_encode_x64_2_operand(
+                symbol_table, x64_code_buffer, x64_code_offset,
+                TP_X64_MOV, &local_variable_register, op1
+            );
+
+            TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
+        }
+
+        // NOTE: tee_local loads the local variable after this.
+        if ((local_variable->member_end == wasm_instruction_index) &&
+            (TP_WASM_OPCODE_SET_LOCAL ==
+                symbol_table->member_wasm_instruction[wasm_instruction_index].member_wasm_opcode)){
+
+            if ( ! tp_free_register(symbol_table, &local_variable_register)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                return false;
+            }
+        }
+
+        return true;
+    }
 
     uint32_t tmp_x64_code_size = tp_encode_x64_2_operand(
         symbol_table, x64_code_buffer, x64_code_offset,
         TP_X64_MOV, &dst, op1
     );
 
-    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
 
-    return x64_code_size;
+    return true;
 }
 
-uint32_t tp_encode_tee_local_code(
+bool tp_encode_tee_local_code(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
-    uint32_t local_index, TP_WASM_STACK_ELEMENT* op1)
+    uint32_t local_index, TP_WASM_STACK_ELEMENT* op1, uint32_t* x64_code_size)
 {
-    uint32_t x64_code_size = 0;
+    *x64_code_size = 0;
+
+    uint32_t tmp_x64_code_size = 0;
 
-    uint32_t tmp_x64_code_size = tp_encode_set_local_code(
+    if ( ! tp_encode_set_local_code(
         symbol_table, x64_code_buffer, x64_code_offset,
-        local_index, op1
-    );
-    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+        local_index, op1, &tmp_x64_code_size)){
 
-    tmp_x64_code_size = tp_encode_get_local_code(
-        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
-        local_index
-    );
-    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-    return x64_code_size;
+        return false;
+    }
+
+    *x64_code_size += tmp_x64_code_size;
+
+    if ( ! tp_encode_get_local_code(
+        symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size,
+        local_index, &tmp_x64_code_size)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    *x64_code_size += tmp_x64_code_size;
+
+    return true;
 }
 
-uint32_t tp_encode_i32_const_code(
-    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, int32_t value)
+bool tp_encode_i32_const_code(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, int32_t value,
+    uint32_t* x64_code_size)
 {
+    *x64_code_size = 0;
+
     TP_WASM_STACK_ELEMENT result = {
-        .member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE
+        .member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE,
+        .member_i32 = value
     };
 
-    uint32_t x64_code_size = 0;
-
-    if ( ! tp_allocate_temporary_variable(symbol_table, TP_X64_ALLOCATE_DEFAULT,
-        x64_code_buffer, x64_code_offset, &x64_code_size, &result)){
+    if ( ! tp_allocate_temporary_variable(symbol_table, &result)){
 
         TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-        return 0;
+        return false;
     }
 
-    uint32_t tmp_x64_code_size = encode_x64_mov_imm(
-        symbol_table, x64_code_buffer, x64_code_offset,
-        value, TP_X64_MOV_IMM_MODE_FORCE_IMM32, &result
-    );
+    // NOTE: The immediate operand of the next wasm instruction is not loaded.
+    if (TP_X64_ITEM_KIND_IMMEDIATE == result.member_x64_item_kind){
 
-    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+        if (x64_code_buffer){
 
-    if ( ! tp_wasm_stack_push(symbol_table, &result)){
+            ++(symbol_table->member_optimization_statistics.member_immediate_operand_num);
+        }
+    }else{
 
-        TP_PUT_LOG_MSG_TRACE(symbol_table);
+        *x64_code_size = encode_x64_mov_imm(
+            symbol_table, x64_code_buffer, x64_code_offset,
+            value, TP_X64_MOV_IMM_MODE_DEFAULT, &result
+        );
 
-        return 0;
-    }
+        if (0 == *x64_code_size){
 
-    return x64_code_size;
-}
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-uint32_t tp_encode_i32_add_code(
-    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
-    TP_WASM_STACK_ELEMENT* op1, TP_WASM_STACK_ELEMENT* op2)
-{
-    // ADD
-    uint32_t x64_code_size = tp_encode_x64_2_operand(
-        symbol_table, x64_code_buffer, x64_code_offset, TP_X64_ADD, op1, op2
-    );
+            return false;
+        }
+    }
 
-    if ( ! tp_wasm_stack_push(symbol_table, op1)){
+    if ( ! tp_wasm_stack_push(symbol_table, &result)){
 
         TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-        return 0;
+        return false;
     }
 
-    return x64_code_size;
+    return true;
 }
 
-uint32_t tp_encode_i32_sub_code(
+bool tp_is_x64_immediate_operand(uint32_t wasm_opcode, int32_t value)
+{
+    switch (wasm_opcode){
+    case TP_WASM_OPCODE_SET_LOCAL:
+//      break;
+    case TP_WASM_OPCODE_TEE_LOCAL:
+//      break;
+    case TP_WASM_OPCODE_END:
+//      break;
+    case TP_WASM_OPCODE_I32_ADD:
+//      break;
+    case TP_WASM_OPCODE_I32_SUB:
+//      break;
+    case TP_WASM_OPCODE_I32_MUL:
+//      break;
+    case TP_WASM_OPCODE_I32_XOR:
+        return true;
+    case TP_WASM_OPCODE_I32_DIV:
+        // NOTE: IDIV has no immediate operand.
+        return tp_is_x64_strength_reduction(wasm_opcode, value);
+    default:
+        break;
+    }
+
+    return false;
+}
+
+bool tp_is_x64_strength_reduction(uint32_t wasm_opcode, int32_t value)
+{
+    switch (wasm_opcode){
+    case TP_WASM_OPCODE_I32_MUL:
+        return (get_x64_shift_count((uint32_t)value) || (3 == value) || (5 == value) || (9 == value));
+    case TP_WASM_OPCODE_I32_DIV:
+        // NOTE: The division by 0 and INT32_MIN / -1 raise the exception of IDIV.
+        return ((0 != value) && (1 != value) && (-1 != value));
+    default:
+        break;
+    }
+
+    return false;
+}
+
+uint32_t tp_encode_i32_add_code(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_WASM_STACK_ELEMENT* op1, TP_WASM_STACK_ELEMENT* op2)
+{
+    // ADD
+    uint32_t x64_code_size = tp_encode_x64_2_operand(
+        symbol_table, x64_code_buffer, x64_code_offset, TP_X64_ADD, op1, op2
+    );
+
+    if ( ! tp_wasm_stack_push(symbol_table, op1)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    return x64_code_size;
+}
+
+uint32_t tp_encode_i32_sub_code(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
     TP_WASM_STACK_ELEMENT* op1, TP_WASM_STACK_ELEMENT* op2)
 {
@@ -433,10 +778,18 @@ uint32_t tp_encode_i32_mul_code(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
     TP_WASM_STACK_ELEMENT* op1, TP_WASM_STACK_ELEMENT* op2)
 {
-    // IMUL – Signed Multiply
-    uint32_t x64_code_size = tp_encode_x64_2_operand(
-        symbol_table, x64_code_buffer, x64_code_offset, TP_X64_IMUL, op1, op2
-    );
+    uint32_t x64_code_size = 0;
+
+    if (TP_X64_ITEM_KIND_IMMEDIATE == op2->member_x64_item_kind){
+
+        x64_code_size = encode_x64_mul_imm(symbol_table, x64_code_buffer, x64_code_offset, op1, op2->member_i32);
+    }else{
+
+        // IMUL – Signed Multiply
+        x64_code_size = tp_encode_x64_2_operand(
+            symbol_table, x64_code_buffer, x64_code_offset, TP_X64_IMUL, op1, op2
+        );
+    }
 
     if ( ! tp_wasm_stack_push(symbol_table, op1)){
 
@@ -452,11 +805,125 @@ uint32_t tp_encode_i32_div_code(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
     TP_WASM_STACK_ELEMENT* op1, TP_WASM_STACK_ELEMENT* op2)
 {
+    uint32_t x64_code_size = 0;
+    uint32_t tmp_x64_code_size = 0;
+
+    if (TP_X64_ITEM_KIND_IMMEDIATE == op2->member_x64_item_kind){
+
+        x64_code_size = encode_x64_div_imm(symbol_table, x64_code_buffer, x64_code_offset, op1, op2->member_i32);
+
+        if ( ! tp_wasm_stack_push(symbol_table, op1)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return 0;
+        }
+
+        return x64_code_size;
+    }
+
+    // NOTE: op1 prefers EAX, and EDX is not allocated to op2 and the values across IDIV
+    // (see allocate_x64_register function).
+    bool is_op1_EAX_register = ((TP_X64_ITEM_KIND_X86_32_REGISTER == op1->member_x64_item_kind) &&
+        (TP_X86_32_REGISTER_EAX == op1->member_x64_item.member_x86_32_register)
+    );
+    bool is_op1_EDX_register = ((TP_X64_ITEM_KIND_X86_32_REGISTER == op1->member_x64_item_kind) &&
+        (TP_X86_32_REGISTER_EDX == op1->member_x64_item.member_x86_32_register)
+    );
+    bool is_save_RAX_register = ((false == is_op1_EAX_register) && (TP_X64_ITEM_KIND_X86_32_REGISTER ==
+        symbol_table->member_use_X86_32_register[TP_X86_32_REGISTER_EAX].member_x64_item_kind)
+    );
+    bool is_save_RDX_register = ((false == is_op1_EDX_register) && (TP_X64_ITEM_KIND_X86_32_REGISTER ==
+        symbol_table->member_use_X86_32_register[TP_X86_32_REGISTER_EDX].member_x64_item_kind)
+    );
+
+    if ((TP_X64_ITEM_KIND_X86_32_REGISTER == op2->member_x64_item_kind) &&
+        ((TP_X86_32_REGISTER_EAX == op2->member_x64_item.member_x86_32_register) ||
+        (TP_X86_32_REGISTER_EDX == op2->member_x64_item.member_x86_32_register))){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE,
+            TP_MSG_FMT("ERROR: op2 of IDIV is EAX or EDX(%1)."),
+            TP_LOG_PARAM_INT32_VALUE(op2->member_x64_item.member_x86_32_register)
+        );
+
+        return 0;
+    }
+
+    if (is_save_RAX_register){
+
+        tmp_x64_code_size = encode_x64_push_reg64(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RAX
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    if (is_save_RDX_register){
+
+        tmp_x64_code_size = encode_x64_push_reg64(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RDX
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    TP_WASM_STACK_ELEMENT eax_op = {
+        .member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE,
+        .member_x64_item_kind = TP_X64_ITEM_KIND_X86_32_REGISTER,
+        .member_x64_item.member_x86_32_register = TP_X86_32_REGISTER_EAX
+    };
+
+    if (false == is_op1_EAX_register){
+
+        // mov eax, op1
+        tmp_x64_code_size = encode_x64_2_operand_common(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_MOV, &eax_op, op1
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    // EDX:EAX is the sign extended dividend.
+    tmp_x64_code_size = encode_x64_cdq(symbol_table, x64_code_buffer, x64_code_offset + x64_code_size);
+
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
     // IDIV – Signed Divide
-    uint32_t x64_code_size = tp_encode_x64_2_operand(
-        symbol_table, x64_code_buffer, x64_code_offset, TP_X64_IDIV, op1, op2
+    tmp_x64_code_size = tp_encode_x64_2_operand(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_IDIV, &eax_op, op2
     );
 
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    if (false == is_op1_EAX_register){
+
+        // mov op1, eax
+        tmp_x64_code_size = encode_x64_2_operand_common(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_MOV, op1, &eax_op
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    if (is_save_RDX_register){
+
+        tmp_x64_code_size = encode_x64_pop_reg64(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RDX
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    if (is_save_RAX_register){
+
+        tmp_x64_code_size = encode_x64_pop_reg64(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RAX
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
     if ( ! tp_wasm_stack_push(symbol_table, op1)){
 
         TP_PUT_LOG_MSG_TRACE(symbol_table);
@@ -490,6 +957,31 @@ uint32_t tp_encode_end_code(TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buf
 {
     uint32_t x64_code_size = 0;
 
+    // NOTE: The function body is encoded already, so the prologue follows this(see tp_make_x64_function).
+    symbol_table->member_is_x64_frame_elision = is_x64_frame_elision(symbol_table);
+
+    // NOTE: The size of the stack frame is fixed here, so add rsp, imm of the epilogue and
+    // sub rsp, imm of the prologue are the shortest forms.
+    calc_x64_stack_frame(symbol_table, TP_X64_STACK_PARAM_SIZE);
+
+    if (symbol_table->member_is_x64_frame_elision){
+
+        ++(symbol_table->member_optimization_statistics.member_frame_elision_num);
+    }else{
+
+//      // LEA - Load Effective Address
+//      // lea rsp, QWORD PTR [rbp+32]
+//      x64_code_size += encode_x64_lea(
+//          symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+//          TP_X64_64_REGISTER_RSP, TP_X64_64_REGISTER_INDEX_NONE, TP_X64_64_REGISTER_RBP, stack_param_size
+//      );
+        // ADD
+        x64_code_size += encode_x64_add_sub_imm(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            TP_X64_ADD, TP_X64_64_REGISTER_RSP, symbol_table->member_stack_imm32, TP_X64_ADD_SUB_IMM_MODE_DEFAULT
+        );
+    }
+
     for (int32_t i = 0; TP_X64_NV64_REGISTER_NUM > i; ++i){
 
         switch (symbol_table->member_use_nv_register[i]){
@@ -520,22 +1012,13 @@ uint32_t tp_encode_end_code(TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buf
         }
     }
 
-//  // LEA - Load Effective Address
-//  // lea rsp, QWORD PTR [rbp+32]
-//  x64_code_size += encode_x64_lea(
-//      symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
-//      TP_X64_64_REGISTER_RSP, TP_X64_64_REGISTER_INDEX_NONE, TP_X64_64_REGISTER_RBP, stack_param_size
-//  );
-    // ADD
-    x64_code_size += encode_x64_add_sub_imm(
-        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
-        TP_X64_ADD, TP_X64_64_REGISTER_RSP, symbol_table->member_stack_imm32, TP_X64_ADD_SUB_IMM_MODE_FORCE_IMM32
-    );
+    if (false == symbol_table->member_is_x64_frame_elision){
 
-    // POP – Pop a Value from the Stack
-    x64_code_size += encode_x64_pop_reg64(
-        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RBP
-    );
+        // POP – Pop a Value from the Stack
+        x64_code_size += encode_x64_pop_reg64(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RBP
+        );
+    }
 
     // RET - Return from Procedure(near return)
     x64_code_size += encode_x64_1_opcode(
@@ -545,966 +1028,2445 @@ uint32_t tp_encode_end_code(TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buf
     return x64_code_size;
 }
 
-uint32_t tp_encode_x64_2_operand(
-    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
-    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* op1, TP_WASM_STACK_ELEMENT* op2)
+static bool is_x64_frame_elision(TP_SYMBOL_TABLE* symbol_table)
 {
-    uint32_t x64_code_size = 0;
-    uint32_t tmp_x64_code_size = 0;
-
-    if ((TP_WASM_OPCODE_I32_VALUE != op1->member_wasm_opcode) ||
-        (TP_WASM_OPCODE_I32_VALUE != op2->member_wasm_opcode)){
-
-        TP_PUT_LOG_MSG(
-            symbol_table, TP_LOG_TYPE_DISP_FORCE,
-            TP_MSG_FMT("ERROR: TP_WASM_OPCODE_I32_VALUE(%1) != (op1(%2) || op2(%3))"),
-            TP_LOG_PARAM_UINT64_VALUE(TP_WASM_OPCODE_I32_VALUE),
-            TP_LOG_PARAM_UINT64_VALUE(op1->member_wasm_opcode),
-            TP_LOG_PARAM_UINT64_VALUE(op2->member_wasm_opcode)
-        );
+    // NOTE: The loop state of batch mode is in the stack frame.
+    if (TP_X64_ENTRY_MODE_BATCH == symbol_table->member_x64_entry_mode){
 
-        return 0;
+        return false;
     }
 
-    switch (op1->member_x64_item_kind){
-    case TP_X64_ITEM_KIND_X86_32_REGISTER:
-//      break;
-    case TP_X64_ITEM_KIND_X64_32_REGISTER:
-        switch (op2->member_x64_item_kind){
-        case TP_X64_ITEM_KIND_X86_32_REGISTER:
-//          break;
-        case TP_X64_ITEM_KIND_X64_32_REGISTER:
-            x64_code_size = encode_x64_32_register_to_x64_32_register(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
-                x64_op, op1, op2
-            );
-            break;
-        case TP_X64_ITEM_KIND_MEMORY:
-            x64_code_size = encode_x64_32_memory_offset_to_register(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
-                x64_op, op1, op2
-            );
-            break;
-        default:
-            TP_PUT_LOG_MSG_ICE(symbol_table);
-            return 0;
-        }
-        break;
-    case TP_X64_ITEM_KIND_MEMORY:
-        switch (op2->member_x64_item_kind){
-        case TP_X64_ITEM_KIND_X86_32_REGISTER:
-//          break;
-        case TP_X64_ITEM_KIND_X64_32_REGISTER:
-            x64_code_size = encode_x64_32_register_to_memory_offset(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
-                x64_op, op1, op2
-            );
-            break;
-        case TP_X64_ITEM_KIND_MEMORY:
-        {
-            tmp_x64_code_size = encode_x64_push_reg64(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RAX
-            );
-
-            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
-
-            TP_WASM_STACK_ELEMENT eax_op = {
-                .member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE,
-                .member_x64_item_kind = TP_X64_ITEM_KIND_X86_32_REGISTER,
-                .member_x64_item.member_x86_32_register = TP_X86_32_REGISTER_EAX
-            };
+    // The spilled values.
+    if (symbol_table->member_temporary_variable_size){
 
-            tmp_x64_code_size = encode_x64_32_memory_offset_to_register(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
-                TP_X64_MOV, &eax_op, op1
-            );
+        return false;
+    }
 
-            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    uint32_t param_count = symbol_table->member_wasm_instruction_param_count;
+    uint32_t local_num = param_count + symbol_table->member_wasm_instruction_var_count;
 
-            tmp_x64_code_size = encode_x64_32_memory_offset_to_register(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
-                x64_op, &eax_op, op2
-            );
+    for (uint32_t i = 0; local_num > i; ++i){
 
-            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+        TP_X64_LIVE_RANGE* local_variable = &(symbol_table->member_x64_local_live_range[i]);
 
-            tmp_x64_code_size = encode_x64_32_register_to_memory_offset(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
-                TP_X64_MOV, op1, &eax_op
-            );
+        if (0 == local_variable->member_use_count){
 
-            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+            continue;
+        }
 
-            tmp_x64_code_size = encode_x64_pop_reg64(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RAX
-            );
+        // The spilled local variables and the local variables loaded from the stack frame.
+        if ((TP_X64_64_REGISTER_NULL == local_variable->member_register) ||
+            (local_variable->member_is_load && (param_count <= i))){
 
-            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
-            break;
+            return false;
         }
-        default:
-            TP_PUT_LOG_MSG_ICE(symbol_table);
-            return 0;
-        }
-        break;
-    default:
-        TP_PUT_LOG_MSG_ICE(symbol_table);
-        return 0;
     }
 
-    if ( ! tp_free_register(symbol_table, op2)){
+    // NOTE: CFA of the function without the stack frame is based on RSP(see make_body_cfa_instructions
+    // function of tp_make_elf.c), so the function body does not push the registers.
+    for (uint32_t i = 0; symbol_table->member_x64_instruction_num > i; ++i){
 
-        TP_PUT_LOG_MSG_TRACE(symbol_table);
+        TP_X64_INSTRUCTION* x64_instruction = &(symbol_table->member_x64_instruction[i]);
 
-        return 0;
+        if ((false == x64_instruction->member_is_remove) &&
+            (TP_X64_INSTRUCTION_KIND_PUSH == x64_instruction->member_kind)){
+
+            return false;
+        }
     }
 
-    return x64_code_size;
+    return true;
 }
 
-static uint32_t encode_x64_32_register_to_x64_32_register(
-    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
-    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src)
+uint32_t tp_encode_batch_loop_begin(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t param_count)
 {
     uint32_t x64_code_size = 0;
     uint32_t tmp_x64_code_size = 0;
 
-    bool is_dst_x86_32_register = (TP_X64_ITEM_KIND_X86_32_REGISTER == dst->member_x64_item_kind);
-    bool is_dst_EAX_register = (is_dst_x86_32_register &&
-        (TP_X86_32_REGISTER_EAX == dst->member_x64_item.member_x86_32_register)
-    );
-    bool is_use_EDX_register = (TP_X64_ITEM_KIND_X86_32_REGISTER ==
-        symbol_table->member_use_X86_32_register[TP_X86_32_REGISTER_EDX].member_x64_item_kind
+    int32_t slot_offset = symbol_table->member_batch_slot_offset;
+    int32_t row_index_offset = slot_offset + TP_X64_BATCH_SLOT_ROW_INDEX * (int32_t)sizeof(uint64_t);
+    int32_t row_count_offset = slot_offset + TP_X64_BATCH_SLOT_ROW_COUNT * (int32_t)sizeof(uint64_t);
+    int32_t columns_offset = slot_offset + TP_X64_BATCH_SLOT_COLUMNS * (int32_t)sizeof(uint64_t);
+
+    // Loop head.
+    symbol_table->member_batch_loop_offset = x64_code_offset + x64_code_size;
+
+    // mov rax, QWORD PTR [rbp+row_index]
+    tmp_x64_code_size = tp_encode_x64_mov_memory(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_DIRECTION_SOURCE_MEMORY, TP_X64_OPERAND_SIZE_64,
+        TP_X64_64_REGISTER_RAX, TP_X64_64_REGISTER_RBP, row_index_offset, TP_X64_DISP_MODE_DEFAULT
     );
-    bool is_dst_x64_32_register = (TP_X64_ITEM_KIND_X64_32_REGISTER == dst->member_x64_item_kind);
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
 
-    bool is_src_x86_32_register = (TP_X64_ITEM_KIND_X86_32_REGISTER == src->member_x64_item_kind);
-    bool is_src_x64_32_register = (TP_X64_ITEM_KIND_X64_32_REGISTER == src->member_x64_item_kind);
+    // CMP – Compare Two Operands : REX.W + 3B /r CMP r64, r/m64
+    // cmp rax, QWORD PTR [rbp+row_count]
+    tmp_x64_code_size = tp_encode_x64_memory_operand(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_OPERAND_SIZE_64, 0x3b, TP_X64_64_REGISTER_RAX,
+        TP_X64_64_REGISTER_RBP, TP_X64_64_REGISTER_INDEX_NONE, 0, row_count_offset, TP_X64_DISP_MODE_DEFAULT
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
 
-    if (TP_X64_IDIV == x64_op){
+    // Jcc – Jump if Condition is Met : 0F 83 cd JAE rel32
+    // NOTE: rel32 is patched at the loop exit(see tp_encode_batch_loop_end function).
+    tmp_x64_code_size = tp_encode_x64_jcc_rel32(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, 0x83, 0
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
 
-        if (false == is_dst_EAX_register){
+    symbol_table->member_batch_exit_jump_offset = x64_code_offset + x64_code_size;
 
-            tmp_x64_code_size = encode_x64_push_reg64(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RAX
-            );
+    // Columns to parameters: RAX is the row index.
+    for (uint32_t i = 0; param_count > i; ++i){
 
-            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
-        }
+        int32_t local_variable_offset = 0;
 
-        if (is_use_EDX_register){
+        if ( ! tp_get_local_variable_offset(symbol_table, i, &local_variable_offset)){
 
-            tmp_x64_code_size = encode_x64_push_reg64(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RDX
-            );
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+            return 0;
         }
 
-        TP_WASM_STACK_ELEMENT edx_op = {
-            .member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE,
-            .member_x64_item_kind = TP_X64_ITEM_KIND_X86_32_REGISTER,
-            .member_x64_item.member_x86_32_register = TP_X86_32_REGISTER_EDX
-        };
-
-        // xor edx, edx
-        tmp_x64_code_size = tp_encode_x64_2_operand(
-            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_XOR, &edx_op, &edx_op
+        // mov rcx, QWORD PTR [rbp+columns]
+        tmp_x64_code_size = tp_encode_x64_mov_memory(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            TP_X64_DIRECTION_SOURCE_MEMORY, TP_X64_OPERAND_SIZE_64,
+            TP_X64_64_REGISTER_RCX, TP_X64_64_REGISTER_RBP, columns_offset, TP_X64_DISP_MODE_DEFAULT
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        // mov rcx, QWORD PTR [rcx+i*8]
+        tmp_x64_code_size = tp_encode_x64_mov_memory(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            TP_X64_DIRECTION_SOURCE_MEMORY, TP_X64_OPERAND_SIZE_64,
+            TP_X64_64_REGISTER_RCX, TP_X64_64_REGISTER_RCX,
+            (int32_t)(i * sizeof(uint64_t)), TP_X64_DISP_MODE_DEFAULT
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        // mov edx, DWORD PTR [rcx+rax*4]
+        tmp_x64_code_size = tp_encode_x64_memory_operand(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            TP_X64_OPERAND_SIZE_32, 0x8b, TP_X64_64_REGISTER_RDX,
+            TP_X64_64_REGISTER_RCX, TP_X64_64_REGISTER_RAX, 2, 0, TP_X64_DISP_MODE_DEFAULT
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        // mov DWORD PTR [rbp+local_variable_offset], edx
+        tmp_x64_code_size = tp_encode_x64_mov_memory(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            TP_X64_DIRECTION_SOURCE_REGISTER, TP_X64_OPERAND_SIZE_32,
+            TP_X64_64_REGISTER_RDX, TP_X64_64_REGISTER_RBP, local_variable_offset, TP_X64_DISP_MODE_DEFAULT
         );
-
         TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
     }
 
-    if (x64_code_buffer){
+    return x64_code_size;
+}
 
-        if (is_dst_x64_32_register || is_src_x64_32_register){
+uint32_t tp_encode_batch_loop_end(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, TP_WASM_STACK_ELEMENT* op1)
+{
+    uint32_t x64_code_size = 0;
+    uint32_t tmp_x64_code_size = 0;
 
-            switch (x64_op){
-            case TP_X64_IMUL:
-                if ( ! is_dst_EAX_register){
+    if ((TP_X64_ITEM_KIND_X86_32_REGISTER != op1->member_x64_item_kind) ||
+        (TP_X86_32_REGISTER_EAX != op1->member_x64_item.member_x86_32_register)){
 
-                    goto rex_common;
-                }
-//              break;
-            case TP_X64_IDIV:
-                x64_code_buffer[x64_code_offset + x64_code_size] = (0x40 |
-                    /* B */ (is_src_x64_32_register ? 0x01 : 0x00)
-                );
-                break;
-            default:
-rex_common:
-                x64_code_buffer[x64_code_offset + x64_code_size] = (0x40 |
-                    /* R */ (is_dst_x64_32_register ? 0x04 : 0x00) |
-                    /* B */ (is_src_x64_32_register ? 0x01 : 0x00)
-                );
-                break;
-            }
+        TP_WASM_STACK_ELEMENT eax = {
+            .member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE,
+            .member_x64_item_kind = TP_X64_ITEM_KIND_X86_32_REGISTER,
+            .member_x64_item.member_x86_32_register = TP_X86_32_REGISTER_EAX
+        };
 
-            ++x64_code_size;
-        }
+        // mov eax, op1
+        tmp_x64_code_size = tp_encode_x64_2_operand(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            TP_X64_MOV, &eax, op1
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    int32_t slot_offset = symbol_table->member_batch_slot_offset;
+    int32_t outputs_offset = slot_offset + TP_X64_BATCH_SLOT_OUTPUTS * (int32_t)sizeof(uint64_t);
+    int32_t row_index_offset = slot_offset + TP_X64_BATCH_SLOT_ROW_INDEX * (int32_t)sizeof(uint64_t);
+
+    // mov rcx, QWORD PTR [rbp+outputs]
+    tmp_x64_code_size = tp_encode_x64_mov_memory(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_DIRECTION_SOURCE_MEMORY, TP_X64_OPERAND_SIZE_64,
+        TP_X64_64_REGISTER_RCX, TP_X64_64_REGISTER_RBP, outputs_offset, TP_X64_DISP_MODE_DEFAULT
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    // mov rdx, QWORD PTR [rbp+row_index]
+    tmp_x64_code_size = tp_encode_x64_mov_memory(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_DIRECTION_SOURCE_MEMORY, TP_X64_OPERAND_SIZE_64,
+        TP_X64_64_REGISTER_RDX, TP_X64_64_REGISTER_RBP, row_index_offset, TP_X64_DISP_MODE_DEFAULT
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    // mov DWORD PTR [rcx+rdx*4], eax
+    tmp_x64_code_size = tp_encode_x64_memory_operand(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_OPERAND_SIZE_32, 0x89, TP_X64_64_REGISTER_RAX,
+        TP_X64_64_REGISTER_RCX, TP_X64_64_REGISTER_RDX, 2, 0, TP_X64_DISP_MODE_DEFAULT
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    // INC – Increment by 1 : REX.W + FF /0 INC r/m64
+    // inc QWORD PTR [rbp+row_index]
+    tmp_x64_code_size = tp_encode_x64_memory_operand(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_OPERAND_SIZE_64, 0xff, TP_X64_64_REGISTER_RAX/* /0 */,
+        TP_X64_64_REGISTER_RBP, TP_X64_64_REGISTER_INDEX_NONE, 0, row_index_offset, TP_X64_DISP_MODE_DEFAULT
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    // JMP – Unconditional Jump : back to the loop head.
+    uint32_t jmp_end_offset = x64_code_offset + x64_code_size + 5;
+
+    tmp_x64_code_size = tp_encode_x64_jmp_rel32(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        (int32_t)(symbol_table->member_batch_loop_offset - jmp_end_offset)
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    // Loop exit.
+    tp_patch_x64_imm32(
+        x64_code_buffer, symbol_table->member_batch_exit_jump_offset,
+        (int32_t)((x64_code_offset + x64_code_size) - symbol_table->member_batch_exit_jump_offset)
+    );
+
+    return x64_code_size;
+}
+
+uint32_t tp_encode_x64_2_operand(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* op1, TP_WASM_STACK_ELEMENT* op2)
+{
+    uint32_t x64_code_size = 0;
+
+    if (TP_X64_ITEM_KIND_IMMEDIATE == op2->member_x64_item_kind){
 
         switch (x64_op){
         case TP_X64_MOV:
-            // MOV – Move Data
-            // register2 to register1 1000 101w : 11 reg1 reg2
-            x64_code_buffer[x64_code_offset + x64_code_size] = 0x8b;
+            x64_code_size = encode_x64_mov_imm(
+                symbol_table, x64_code_buffer, x64_code_offset,
+                op2->member_i32, TP_X64_MOV_IMM_MODE_DEFAULT, op1
+            );
             break;
         case TP_X64_ADD:
-            // ADD
-            // register2 to register1 0000 001w : 11 reg1 reg2
-            x64_code_buffer[x64_code_offset + x64_code_size] = 0x03;
-            break;
+//          break;
         case TP_X64_SUB:
-            // SUB – Integer Subtraction
-            // register2 to register1 0010 101w : 11 reg1 reg2
-            x64_code_buffer[x64_code_offset + x64_code_size] = 0x2b;
+//          break;
+        case TP_X64_XOR:
+            x64_code_size = encode_x64_alu_imm(
+                symbol_table, x64_code_buffer, x64_code_offset, x64_op, op1, op2->member_i32
+            );
             break;
-        case TP_X64_IMUL:
-            // IMUL – Signed Multiply
-            if (is_dst_EAX_register){
+        default:
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+            return 0;
+        }
+    }else{
 
-                // AL, AX, or EAX with register 1111 011w : 11 101 reg
-                x64_code_buffer[x64_code_offset + x64_code_size] = 0xf7;
-            }else{
+        x64_code_size = encode_x64_2_operand_common(
+            symbol_table, x64_code_buffer, x64_code_offset, x64_op, op1, op2
+        );
+    }
 
-                // register1 with register2 0000 1111 : 1010 1111 : 11 : reg1 reg2
-                x64_code_buffer[x64_code_offset + x64_code_size] = 0x0f;
+    if (0 == x64_code_size){
 
-                ++x64_code_size;
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    if ( ! tp_free_register(symbol_table, op2)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    return x64_code_size;
+}
+
+static uint32_t encode_x64_mul_imm(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_WASM_STACK_ELEMENT* op1, int32_t value)
+{
+    uint32_t x64_code_size = 0;
+    uint32_t tmp_x64_code_size = 0;
+
+    uint32_t shift = get_x64_shift_count((uint32_t)value);
+
+    bool is_strength_reduction = tp_is_x64_strength_reduction(TP_WASM_OPCODE_I32_MUL, value);
+
+    if (shift){
+
+        // shl op1, k(op1 * 2^k)
+        tmp_x64_code_size = encode_x64_shift_imm(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_SHL, op1, (uint8_t)shift
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }else if ((TP_X64_ITEM_KIND_MEMORY != op1->member_x64_item_kind) && is_strength_reduction){
+
+        // lea op1, [op1+op1*(2, 4 or 8)](op1 * 3, 5 or 9)
+        tmp_x64_code_size = encode_x64_lea_scale(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, op1, op1, (uint8_t)(value - 1)
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }else if (TP_X64_ITEM_KIND_MEMORY != op1->member_x64_item_kind){
+
+        // imul op1, op1, value
+        tmp_x64_code_size = encode_x64_imul_imm(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, op1, op1, value
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }else{
+
+        // NOTE: LEA and IMUL have no form of the memory destination, so the spilled value is
+        // operated in the free register(or saved RAX).
+        TP_WASM_STACK_ELEMENT scratch = { .member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE };
+
+        bool is_zero_free_register = true;
+
+        if ( ! tp_get_scratch_register(symbol_table, &scratch, &is_zero_free_register)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-                x64_code_buffer[x64_code_offset + x64_code_size] = 0xaf;
-            }
-            break;
-        case TP_X64_IDIV:
-            // IDIV – Signed Divide
-            // AL, AX, or EAX by register 1111 011w : 11 111 reg
-            x64_code_buffer[x64_code_offset + x64_code_size] = 0xf7;
-            break;
-        case TP_X64_XOR:
-            // XOR – Logical Exclusive OR
-            // register2 to register1 0011 001w : 11 reg1 reg2
-            x64_code_buffer[x64_code_offset + x64_code_size] = 0x33;
-            break;
-        default:
-            TP_PUT_LOG_MSG_ICE(symbol_table);
             return 0;
         }
 
-        ++x64_code_size;
+        if (is_zero_free_register){
 
-        // ModR/M
-        switch (x64_op){
-        case TP_X64_IMUL:
-            if (is_dst_EAX_register){
+            scratch.member_x64_item_kind = TP_X64_ITEM_KIND_X86_32_REGISTER;
+            scratch.member_x64_item.member_x86_32_register = TP_X86_32_REGISTER_EAX;
 
-                // AL, AX, or EAX with register : 11 101 reg
-                x64_code_buffer[x64_code_offset + x64_code_size] = (0xe8 |
-                    ((is_src_x86_32_register ? src->member_x64_item.member_x86_32_register :
-                    src->member_x64_item.member_x64_32_register) & 0x07)
-                );
-            }else{
+            tmp_x64_code_size = encode_x64_push_reg64(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RAX
+            );
 
-                goto mod_rm_common;
-            }
-            break;
-        case TP_X64_IDIV:
-            // AL, AX, or EAX by register : 11 111 reg
-            x64_code_buffer[x64_code_offset + x64_code_size] = (0xf8 |
-                ((is_src_x86_32_register ? src->member_x64_item.member_x86_32_register :
-                src->member_x64_item.member_x64_32_register) & 0x07)
+            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+        }
+
+        if (is_strength_reduction){
+
+            // mov scratch, DWORD PTR [rbp+op1]
+            tmp_x64_code_size = encode_x64_32_memory_offset_to_register(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_MOV, &scratch, op1
             );
-            break;
-        default:
-mod_rm_common:
-            // register2 to register1 : 11 reg1 reg2
-            x64_code_buffer[x64_code_offset + x64_code_size] = ((0x03 << 6) |
-                (((is_dst_x86_32_register ? dst->member_x64_item.member_x86_32_register :
-                dst->member_x64_item.member_x64_32_register) & 0x07) << 3) |
-                ((is_src_x86_32_register ? src->member_x64_item.member_x86_32_register :
-                src->member_x64_item.member_x64_32_register) & 0x07)
+
+            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+            // lea scratch, [scratch+scratch*(2, 4 or 8)]
+            tmp_x64_code_size = encode_x64_lea_scale(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, &scratch, &scratch, (uint8_t)(value - 1)
             );
-            break;
+
+            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+        }else{
+
+            // imul scratch, DWORD PTR [rbp+op1], value
+            tmp_x64_code_size = encode_x64_imul_imm(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, &scratch, op1, value
+            );
+
+            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
         }
 
-        ++x64_code_size;
-    }else{
+        // mov DWORD PTR [rbp+op1], scratch
+        tmp_x64_code_size = encode_x64_32_register_to_memory_offset(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_MOV, op1, &scratch
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        if (is_zero_free_register){
+
+            tmp_x64_code_size = encode_x64_pop_reg64(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RAX
+            );
+
+            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+        }
+    }
+
+    if (x64_code_buffer && is_strength_reduction){
+
+        ++(symbol_table->member_optimization_statistics.member_strength_reduced_mul_num);
+    }
+
+    return x64_code_size;
+}
+
+static uint32_t encode_x64_div_imm(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_WASM_STACK_ELEMENT* op1, int32_t divisor)
+{
+    uint32_t x64_code_size = 0;
+    uint32_t tmp_x64_code_size = 0;
+
+    // NOTE: EDX is not allocated to op1 and the values across the division
+    // (see allocate_x64_register function), so EDX is the scratch register.
+    bool is_op1_EDX_register = ((TP_X64_ITEM_KIND_X86_32_REGISTER == op1->member_x64_item_kind) &&
+        (TP_X86_32_REGISTER_EDX == op1->member_x64_item.member_x86_32_register)
+    );
+
+    TP_X86_32_REGISTER scratch_register = (is_op1_EDX_register ? TP_X86_32_REGISTER_EAX : TP_X86_32_REGISTER_EDX);
+
+    bool is_save_scratch_register = (TP_X64_ITEM_KIND_X86_32_REGISTER ==
+        symbol_table->member_use_X86_32_register[scratch_register].member_x64_item_kind
+    );
+
+    TP_WASM_STACK_ELEMENT scratch = {
+        .member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE,
+        .member_x64_item_kind = TP_X64_ITEM_KIND_X86_32_REGISTER,
+        .member_x64_item.member_x86_32_register = scratch_register
+    };
+
+    if (is_save_scratch_register){
+
+        tmp_x64_code_size = encode_x64_push_reg64(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, (TP_X64_64_REGISTER)scratch_register
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    uint32_t abs_divisor = ((0 > divisor) ? (0U - (uint32_t)divisor) : (uint32_t)divisor);
+
+    uint32_t shift = get_x64_shift_count(abs_divisor);
+
+    if (shift){
+
+        // Rounding toward zero: op1 + (2^k - 1) if op1 is negative, and then arithmetic shift right.
+        // mov scratch, op1
+        tmp_x64_code_size = encode_x64_2_operand_common(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_MOV, &scratch, op1
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        if (1 < shift){
+
+            // sar scratch, 31
+            tmp_x64_code_size = encode_x64_shift_imm(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_SAR, &scratch, 31
+            );
+
+            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+        }
+
+        // shr scratch, 32 - k
+        tmp_x64_code_size = encode_x64_shift_imm(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_SHR, &scratch, (uint8_t)(32 - shift)
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        // add op1, scratch
+        tmp_x64_code_size = encode_x64_2_operand_common(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_ADD, op1, &scratch
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        // sar op1, k
+        tmp_x64_code_size = encode_x64_shift_imm(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_SAR, op1, (uint8_t)shift
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        if (0 > divisor){
+
+            // neg op1
+            tmp_x64_code_size = encode_x64_neg(symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, op1);
+
+            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+        }
+    }else{
+
+        // Hacker's Delight, 10-4 Signed Division by Divisors >= 2 and 10-5 Signed Division by Divisors <= -2.
+        int32_t magic = 0;
+        uint32_t magic_shift = 0;
+
+        calc_x64_magic_number(divisor, &magic, &magic_shift);
+
+        // scratch = mulhs(magic, op1)
+        tmp_x64_code_size = encode_x64_mul_high(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, &scratch, op1, magic
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        if ((0 < divisor) && (0 > magic)){
+
+            // add scratch, op1
+            tmp_x64_code_size = encode_x64_2_operand_common(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_ADD, &scratch, op1
+            );
+
+            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+        }else if ((0 > divisor) && (0 < magic)){
+
+            // sub scratch, op1
+            tmp_x64_code_size = encode_x64_2_operand_common(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_SUB, &scratch, op1
+            );
+
+            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+        }
+
+        if (magic_shift){
+
+            // sar scratch, s
+            tmp_x64_code_size = encode_x64_shift_imm(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                TP_X64_SAR, &scratch, (uint8_t)magic_shift
+            );
+
+            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+        }
+
+        // Adds 1 to the negative quotient(rounding toward zero).
+        // mov op1, scratch
+        tmp_x64_code_size = encode_x64_2_operand_common(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_MOV, op1, &scratch
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        // shr op1, 31
+        tmp_x64_code_size = encode_x64_shift_imm(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_SHR, op1, 31
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        // add op1, scratch
+        tmp_x64_code_size = encode_x64_2_operand_common(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_ADD, op1, &scratch
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    if (is_save_scratch_register){
+
+        tmp_x64_code_size = encode_x64_pop_reg64(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, (TP_X64_64_REGISTER)scratch_register
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    if (x64_code_buffer){
+
+        ++(symbol_table->member_optimization_statistics.member_strength_reduced_div_num);
+    }
+
+    return x64_code_size;
+}
+
+static uint32_t get_x64_shift_count(uint32_t value)
+{
+    // k of value == 2^k(1 <= k <= 31), or 0.
+    if ((2 > value) || (value & (value - 1))){
+
+        return 0;
+    }
+
+    uint32_t shift = 0;
+
+    while (1 < value){
+
+        value >>= 1;
+        ++shift;
+    }
+
+    return shift;
+}
+
+static void calc_x64_magic_number(int32_t divisor, int32_t* magic, uint32_t* shift)
+{
+    // Hacker's Delight, Figure 10-1 Computing the magic number for signed division.
+    // NOTE: 2 <= divisor or divisor <= -2.
+    const uint32_t two31 = 0x80000000;
+
+    uint32_t ad = ((0 > divisor) ? (0U - (uint32_t)divisor) : (uint32_t)divisor);
+    uint32_t t = two31 + ((uint32_t)divisor >> 31);
+    uint32_t anc = t - 1 - (t % ad); // Absolute value of nc.
+    uint32_t p = 31;
+    uint32_t q1 = two31 / anc; // 2^p / |nc|
+    uint32_t r1 = two31 - (q1 * anc); // rem(2^p, |nc|)
+    uint32_t q2 = two31 / ad; // 2^p / |d|
+    uint32_t r2 = two31 - (q2 * ad); // rem(2^p, |d|)
+    uint32_t delta = 0;
+
+    do{
+        ++p;
+
+        q1 *= 2;
+        r1 *= 2;
+
+        if (r1 >= anc){
+
+            ++q1;
+            r1 -= anc;
+        }
+
+        q2 *= 2;
+        r2 *= 2;
+
+        if (r2 >= ad){
+
+            ++q2;
+            r2 -= ad;
+        }
+
+        delta = ad - r2;
+    }while ((q1 < delta) || ((q1 == delta) && (0 == r1)));
+
+    uint32_t m = q2 + 1;
+
+    *magic = (int32_t)((0 > divisor) ? (0U - m) : m);
+    *shift = p - 32;
+}
+
+static uint32_t encode_x64_2_operand_common(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* op1, TP_WASM_STACK_ELEMENT* op2)
+{
+    uint32_t x64_code_size = 0;
+
+    if ((TP_WASM_OPCODE_I32_VALUE != op1->member_wasm_opcode) ||
+        (TP_WASM_OPCODE_I32_VALUE != op2->member_wasm_opcode)){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE,
+            TP_MSG_FMT("ERROR: TP_WASM_OPCODE_I32_VALUE(%1) != (op1(%2) || op2(%3))"),
+            TP_LOG_PARAM_UINT64_VALUE(TP_WASM_OPCODE_I32_VALUE),
+            TP_LOG_PARAM_UINT64_VALUE(op1->member_wasm_opcode),
+            TP_LOG_PARAM_UINT64_VALUE(op2->member_wasm_opcode)
+        );
+
+        return 0;
+    }
+
+    switch (op1->member_x64_item_kind){
+    case TP_X64_ITEM_KIND_X86_32_REGISTER:
+//      break;
+    case TP_X64_ITEM_KIND_X64_32_REGISTER:
+        switch (op2->member_x64_item_kind){
+        case TP_X64_ITEM_KIND_X86_32_REGISTER:
+//          break;
+        case TP_X64_ITEM_KIND_X64_32_REGISTER:
+            x64_code_size = encode_x64_32_register_to_x64_32_register(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                x64_op, op1, op2
+            );
+            break;
+        case TP_X64_ITEM_KIND_MEMORY:
+            x64_code_size = encode_x64_32_memory_offset_to_register(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                x64_op, op1, op2
+            );
+            break;
+        default:
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+            return 0;
+        }
+        break;
+    case TP_X64_ITEM_KIND_MEMORY:
+        switch (op2->member_x64_item_kind){
+        case TP_X64_ITEM_KIND_X86_32_REGISTER:
+//          break;
+        case TP_X64_ITEM_KIND_X64_32_REGISTER:
+            // NOTE: IMUL has no form of the memory destination.
+            if (TP_X64_IMUL != x64_op){
+
+                x64_code_size = encode_x64_32_register_to_memory_offset(
+                    symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                    x64_op, op1, op2
+                );
+                break;
+            }
+//          break;
+        case TP_X64_ITEM_KIND_MEMORY:
+            x64_code_size = encode_x64_32_memory_to_memory(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                x64_op, op1, op2
+            );
+            break;
+        default:
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+            return 0;
+        }
+        break;
+    default:
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+        return 0;
+    }
+
+    return x64_code_size;
+}
+
+static bool is_same_x64_register(TP_WASM_STACK_ELEMENT* op1, TP_WASM_STACK_ELEMENT* op2)
+{
+    if (op1->member_x64_item_kind != op2->member_x64_item_kind){
+
+        return false;
+    }
+
+    switch (op1->member_x64_item_kind){
+    case TP_X64_ITEM_KIND_X86_32_REGISTER:
+        return (op1->member_x64_item.member_x86_32_register == op2->member_x64_item.member_x86_32_register);
+    case TP_X64_ITEM_KIND_X64_32_REGISTER:
+        return (op1->member_x64_item.member_x64_32_register == op2->member_x64_item.member_x64_32_register);
+    default:
+        break;
+    }
+
+    return false;
+}
+
+static uint32_t encode_x64_32_memory_to_memory(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src)
+{
+    uint32_t x64_code_size = 0;
+    uint32_t tmp_x64_code_size = 0;
+
+    // NOTE: The spilled values are operated in the free register, and RAX(or RCX) is saved
+    // only when all registers hold live values.
+    TP_WASM_STACK_ELEMENT scratch = { .member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE };
+
+    bool is_zero_free_register = true;
+
+    if ( ! tp_get_scratch_register(symbol_table, &scratch, &is_zero_free_register)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    TP_X64_64_REGISTER save_register = TP_X64_64_REGISTER_RAX;
+
+    if (is_zero_free_register){
+
+        if ((TP_X64_ITEM_KIND_X86_32_REGISTER == src->member_x64_item_kind) &&
+            (TP_X86_32_REGISTER_EAX == src->member_x64_item.member_x86_32_register)){
+
+            save_register = TP_X64_64_REGISTER_RCX;
+        }
+
+        scratch.member_x64_item_kind = TP_X64_ITEM_KIND_X86_32_REGISTER;
+        scratch.member_x64_item.member_x86_32_register = (TP_X86_32_REGISTER)save_register;
+
+        tmp_x64_code_size = encode_x64_push_reg64(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, save_register
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    if (TP_X64_MOV != x64_op){
+
+        // mov scratch, DWORD PTR [rbp+dst]
+        tmp_x64_code_size = encode_x64_32_memory_offset_to_register(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            TP_X64_MOV, &scratch, dst
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    tmp_x64_code_size = encode_x64_2_operand_common(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        x64_op, &scratch, src
+    );
+
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    // mov DWORD PTR [rbp+dst], scratch
+    tmp_x64_code_size = encode_x64_32_register_to_memory_offset(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_MOV, dst, &scratch
+    );
+
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    if (is_zero_free_register){
+
+        tmp_x64_code_size = encode_x64_pop_reg64(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, save_register
+        );
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    return x64_code_size;
+}
+
+static uint32_t encode_x64_32_register_to_x64_32_register(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src)
+{
+    uint32_t x64_code_size = 0;
+
+    bool is_dst_x86_32_register = (TP_X64_ITEM_KIND_X86_32_REGISTER == dst->member_x64_item_kind);
+    bool is_dst_EAX_register = (is_dst_x86_32_register &&
+        (TP_X86_32_REGISTER_EAX == dst->member_x64_item.member_x86_32_register)
+    );
+    bool is_dst_x64_32_register = (TP_X64_ITEM_KIND_X64_32_REGISTER == dst->member_x64_item_kind);
+
+    bool is_src_x86_32_register = (TP_X64_ITEM_KIND_X86_32_REGISTER == src->member_x64_item_kind);
+    bool is_src_x64_32_register = (TP_X64_ITEM_KIND_X64_32_REGISTER == src->member_x64_item_kind);
+
+    // NOTE: EDX:EAX is the dividend of IDIV(see tp_encode_i32_div_code function).
+    if ((TP_X64_IDIV == x64_op) && (false == is_dst_EAX_register)){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE, TP_MSG_FMT("%1"),
+            TP_LOG_PARAM_STRING("ERROR: (TP_X64_IDIV == x64_op) && (false == is_dst_EAX_register)")
+        );
+
+        return 0;
+    }
+
+    if (x64_code_buffer){
+
+        if (is_dst_x64_32_register || is_src_x64_32_register){
+
+            switch (x64_op){
+            case TP_X64_IDIV:
+                x64_code_buffer[x64_code_offset + x64_code_size] = (0x40 |
+                    /* B */ (is_src_x64_32_register ? 0x01 : 0x00)
+                );
+                break;
+            default:
+                x64_code_buffer[x64_code_offset + x64_code_size] = (0x40 |
+                    /* R */ (is_dst_x64_32_register ? 0x04 : 0x00) |
+                    /* B */ (is_src_x64_32_register ? 0x01 : 0x00)
+                );
+                break;
+            }
+
+            ++x64_code_size;
+        }
+
+        switch (x64_op){
+        case TP_X64_MOV:
+            // MOV – Move Data
+            // register2 to register1 1000 101w : 11 reg1 reg2
+            x64_code_buffer[x64_code_offset + x64_code_size] = 0x8b;
+            break;
+        case TP_X64_ADD:
+            // ADD
+            // register2 to register1 0000 001w : 11 reg1 reg2
+            x64_code_buffer[x64_code_offset + x64_code_size] = 0x03;
+            break;
+        case TP_X64_SUB:
+            // SUB – Integer Subtraction
+            // register2 to register1 0010 101w : 11 reg1 reg2
+            x64_code_buffer[x64_code_offset + x64_code_size] = 0x2b;
+            break;
+        case TP_X64_IMUL:
+            // IMUL – Signed Multiply
+            // NOTE: AL, AX, or EAX with register(1111 011w : 11 101 reg) changes EDX.
+            // register1 with register2 0000 1111 : 1010 1111 : 11 : reg1 reg2
+            x64_code_buffer[x64_code_offset + x64_code_size] = 0x0f;
+
+            ++x64_code_size;
+
+            x64_code_buffer[x64_code_offset + x64_code_size] = 0xaf;
+            break;
+        case TP_X64_IDIV:
+            // IDIV – Signed Divide
+            // AL, AX, or EAX by register 1111 011w : 11 111 reg
+            x64_code_buffer[x64_code_offset + x64_code_size] = 0xf7;
+            break;
+        case TP_X64_XOR:
+            // XOR – Logical Exclusive OR
+            // register2 to register1 0011 001w : 11 reg1 reg2
+            x64_code_buffer[x64_code_offset + x64_code_size] = 0x33;
+            break;
+        default:
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+            return 0;
+        }
+
+        ++x64_code_size;
+
+        // ModR/M
+        switch (x64_op){
+        case TP_X64_IDIV:
+            // AL, AX, or EAX by register : 11 111 reg
+            x64_code_buffer[x64_code_offset + x64_code_size] = (0xf8 |
+                ((is_src_x86_32_register ? src->member_x64_item.member_x86_32_register :
+                src->member_x64_item.member_x64_32_register) & 0x07)
+            );
+            break;
+        default:
+            // register2 to register1 : 11 reg1 reg2
+            x64_code_buffer[x64_code_offset + x64_code_size] = ((0x03 << 6) |
+                (((is_dst_x86_32_register ? dst->member_x64_item.member_x86_32_register :
+                dst->member_x64_item.member_x64_32_register) & 0x07) << 3) |
+                ((is_src_x86_32_register ? src->member_x64_item.member_x86_32_register :
+                src->member_x64_item.member_x64_32_register) & 0x07)
+            );
+            break;
+        }
+
+        ++x64_code_size;
+    }else{
+
+        if (is_dst_x64_32_register || is_src_x64_32_register){
+
+            ++x64_code_size;
+        }
+
+        x64_code_size += 2;
+
+        if (TP_X64_IMUL == x64_op){
+
+            ++x64_code_size;
+        }
+
+        if (TP_X64_NULL <= x64_op){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return 0;
+        }
+    }
+
+    TP_X64_INSTRUCTION x64_instruction = {
+        .member_offset = x64_code_offset,
+        .member_size = x64_code_size,
+        .member_kind = TP_X64_INSTRUCTION_KIND_2_OPERAND,
+        .member_x64_op = x64_op,
+        .member_dst = *dst,
+        .member_src = *src
+    };
+
+    if ( ! record_x64_instruction(symbol_table, x64_code_buffer, &x64_instruction)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    return x64_code_size;
+}
+
+static uint32_t encode_x64_32_register_to_memory_offset(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src)
+{
+    return encode_x64_32_memory_offset_common(
+        symbol_table, x64_code_buffer, x64_code_offset,
+        x64_op, TP_X64_DIRECTION_SOURCE_REGISTER, dst, src
+    );
+}
+
+static uint32_t encode_x64_32_memory_offset_to_register(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src)
+{
+    return encode_x64_32_memory_offset_common(
+        symbol_table, x64_code_buffer, x64_code_offset,
+        x64_op, TP_X64_DIRECTION_SOURCE_MEMORY, dst, src
+    );
+}
+
+static uint32_t encode_x64_32_memory_offset_common(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64 x64_op, TP_X64_DIRECTION x64_direction, TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src)
+{
+    uint32_t x64_code_size = 0;
+
+    bool is_source_memory = (TP_X64_DIRECTION_SOURCE_MEMORY == x64_direction);
+
+    // NOTE: The register operand is the reg field of ModR/M, and the memory operand is [rbp+disp].
+    TP_WASM_STACK_ELEMENT* register_operand = (is_source_memory ? dst : src);
+    TP_WASM_STACK_ELEMENT* memory_operand = (is_source_memory ? src : dst);
+
+    if ((TP_X64_ITEM_KIND_MEMORY != memory_operand->member_x64_item_kind) ||
+        (TP_X64_ITEM_KIND_MEMORY == register_operand->member_x64_item_kind)){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE,
+            TP_MSG_FMT("TP_X64_ITEM_KIND_MEMORY(%1) != dst_op(%2), src_op(%3)"),
+            TP_LOG_PARAM_INT32_VALUE(TP_X64_ITEM_KIND_MEMORY),
+            TP_LOG_PARAM_INT32_VALUE(dst->member_x64_item_kind),
+            TP_LOG_PARAM_INT32_VALUE(src->member_x64_item_kind)
+        );
+
+        return 0;
+    }
+
+    int32_t offset = memory_operand->member_offset;
+
+    bool is_dst_EAX_register = ((TP_X64_ITEM_KIND_X86_32_REGISTER == dst->member_x64_item_kind) &&
+        (TP_X86_32_REGISTER_EAX == dst->member_x64_item.member_x86_32_register)
+    );
+
+    bool is_x64_32_register = (TP_X64_ITEM_KIND_X64_32_REGISTER == register_operand->member_x64_item_kind);
+
+    uint8_t reg = (uint8_t)((is_x64_32_register ?
+        register_operand->member_x64_item.member_x64_32_register :
+        register_operand->member_x64_item.member_x86_32_register) & 0x07
+    );
+
+    if ((false == is_source_memory) && ((TP_X64_IMUL == x64_op) || (TP_X64_IDIV == x64_op))){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE, TP_MSG_FMT("%1"),
+            TP_LOG_PARAM_STRING("ERROR: (false == is_source_memory) && ((TP_X64_IMUL == x64_op) || (TP_X64_IDIV == x64_op))")
+        );
+
+        return 0;
+    }
+
+    // NOTE: EDX:EAX is the dividend of IDIV(see tp_encode_i32_div_code function).
+    if ((TP_X64_IDIV == x64_op) && (false == is_dst_EAX_register)){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_DISP_FORCE, TP_MSG_FMT("%1"),
+            TP_LOG_PARAM_STRING("ERROR: (TP_X64_IDIV == x64_op) && (false == is_dst_EAX_register)")
+        );
+
+        return 0;
+    }
+
+    if (x64_code_buffer){
+
+        if (is_x64_32_register){
+
+            x64_code_buffer[x64_code_offset + x64_code_size] = (0x40 | /* R */ 0x04);
+
+            ++x64_code_size;
+        }
+
+        switch (x64_op){
+        case TP_X64_MOV:
+            // MOV – Move Data
+            // memory to reg 1000 101w : mod reg r/m
+            // reg to memory 1000 100w : mod reg r/m
+            x64_code_buffer[x64_code_offset + x64_code_size] = (0x89 | (is_source_memory ? 0x02 : 0x00));
+            break;
+        case TP_X64_ADD:
+            // ADD
+            // memory to register 0000 001w : mod reg r/m
+            // register to memory 0000 000w : mod reg r/m
+            x64_code_buffer[x64_code_offset + x64_code_size] = (0x01 | (is_source_memory ? 0x02 : 0x00));
+            break;
+        case TP_X64_SUB:
+            // SUB – Integer Subtraction
+            // memory to register 0010 101w : mod reg r/m
+            // register to memory 0010 100w : mod reg r/m
+            x64_code_buffer[x64_code_offset + x64_code_size] = (0x29 | (is_source_memory ? 0x02 : 0x00));
+            break;
+        case TP_X64_IMUL:
+            // IMUL – Signed Multiply
+            // NOTE: AL, AX, or EAX with memory(1111 011w : mod 101 reg) changes EDX.
+            // register with memory 0000 1111 : 1010 1111 : mod reg r/m
+            x64_code_buffer[x64_code_offset + x64_code_size] = 0x0f;
+
+            ++x64_code_size;
+
+            x64_code_buffer[x64_code_offset + x64_code_size] = 0xaf;
+            break;
+        case TP_X64_IDIV:
+            // IDIV – Signed Divide
+            // AL, AX, or EAX by memory 1111 011w : mod 111 r/m
+            x64_code_buffer[x64_code_offset + x64_code_size] = 0xf7;
+            break;
+        case TP_X64_XOR:
+            // XOR – Logical Exclusive OR
+            // memory to register 0011 001w : mod reg r/m
+            // register to memory 0011 000w : mod reg r/m
+            x64_code_buffer[x64_code_offset + x64_code_size] = (0x31 | (is_source_memory ? 0x02 : 0x00));
+            break;
+        default:
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+            return 0;
+        }
+
+        ++x64_code_size;
+    }else{
+
+        if (is_x64_32_register){
+
+            ++x64_code_size;
+        }
+
+        ++x64_code_size;
+
+        if (TP_X64_IMUL == x64_op){
+
+            ++x64_code_size;
+        }
+
+        if (TP_X64_NULL <= x64_op){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return 0;
+        }
+    }
+
+    // ModR/M, SIB and address displacement of [rbp+offset]
+    // NOTE: AL, AX, or EAX by memory of IDIV is 1111 011w : mod 111 r/m.
+    x64_code_size += encode_x64_address(
+        x64_code_buffer, x64_code_offset + x64_code_size, ((TP_X64_IDIV == x64_op) ? 0x07 : reg),
+        TP_X64_64_REGISTER_RBP, TP_X64_64_REGISTER_INDEX_NONE, 0, offset, TP_X64_DISP_MODE_DEFAULT
+    );
+
+    TP_X64_INSTRUCTION x64_instruction = {
+        .member_offset = x64_code_offset,
+        .member_size = x64_code_size,
+        .member_kind = TP_X64_INSTRUCTION_KIND_2_OPERAND,
+        .member_x64_op = x64_op,
+        .member_dst = *dst,
+        .member_src = *src
+    };
+
+    if ( ! record_x64_instruction(symbol_table, x64_code_buffer, &x64_instruction)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    return x64_code_size;
+}
+
+static uint32_t encode_x64_mov_imm(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    int32_t imm, TP_X64_MOV_IMM_MODE x64_mov_imm_mode, TP_WASM_STACK_ELEMENT* result)
+{
+    uint32_t x64_code_size = 0;
+
+    bool is_zero = false;
+
+    switch (x64_mov_imm_mode){
+    case TP_X64_MOV_IMM_MODE_DEFAULT:
+        is_zero = (0 == imm);
+        break;
+    case TP_X64_MOV_IMM_MODE_FORCE_IMM32:
+        break;
+    default:
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+        return 0;
+    }
+
+    switch (result->member_x64_item_kind){
+    case TP_X64_ITEM_KIND_X86_32_REGISTER:
+//      break;
+    case TP_X64_ITEM_KIND_X64_32_REGISTER:{
+
+        TP_X64_64_REGISTER reg64 = tp_get_x64_64_register(result);
+
+        if (is_zero){
+
+            // XOR – Logical Exclusive OR : 33 /r XOR r32, r/m32
+            x64_code_size = encode_x64_rm_operand(
+                symbol_table, x64_code_buffer, x64_code_offset, TP_X64_OPERAND_SIZE_32, 0x33, reg64, result
+            );
+
+            if (0 == x64_code_size){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                return 0;
+            }
+
+            break;
+        }
+
+        // MOV – Move Data : B8+rd id MOV r32, imm32
+        if (x64_code_buffer){
+
+            if (TP_X64_64_REGISTER_R8 <= reg64){
+
+                // 0100 000B
+                x64_code_buffer[x64_code_offset + x64_code_size] = (0x40 | /* B */ 0x01);
+
+                ++x64_code_size;
+            }
+
+            x64_code_buffer[x64_code_offset + x64_code_size] = (0xb8 | (reg64 & 0x07));
+
+            ++x64_code_size;
+
+            memcpy(&(x64_code_buffer[x64_code_offset + x64_code_size]), &imm, sizeof(imm));
+        }else{
+
+            if (TP_X64_64_REGISTER_R8 <= reg64){
+
+                ++x64_code_size;
+            }
+
+            ++x64_code_size;
+        }
+
+        x64_code_size += sizeof(imm);
+        break;
+    }
+    case TP_X64_ITEM_KIND_MEMORY:
+
+        // MOV – Move Data : C7 /0 id MOV r/m32, imm32
+        // NOTE: The memory operand is not zeroed by xor, and C6(imm8) is the byte operation.
+        x64_code_size = encode_x64_rm_operand(
+            symbol_table, x64_code_buffer, x64_code_offset,
+            TP_X64_OPERAND_SIZE_32, 0xc7, (TP_X64_64_REGISTER)0, result
+        );
+
+        if (0 == x64_code_size){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return 0;
+        }
+
+        if (x64_code_buffer){
+
+            memcpy(&(x64_code_buffer[x64_code_offset + x64_code_size]), &imm, sizeof(imm));
+        }
+
+        x64_code_size += sizeof(imm);
+        break;
+    default:
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+        return 0;
+    }
+
+    TP_X64_INSTRUCTION x64_instruction = {
+        .member_offset = x64_code_offset,
+        .member_size = x64_code_size,
+        .member_kind = TP_X64_INSTRUCTION_KIND_MOV_IMM,
+        .member_x64_op = TP_X64_MOV,
+        .member_dst = *result,
+        .member_imm = imm,
+        .member_x64_mov_imm_mode = x64_mov_imm_mode
+    };
+
+    if ( ! record_x64_instruction(symbol_table, x64_code_buffer, &x64_instruction)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    return x64_code_size;
+}
+
+static uint32_t encode_x64_alu_imm(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* dst, int32_t imm)
+{
+    // ADD – Add : 83 /0 ib ADD r/m32, imm8 or 81 /0 id ADD r/m32, imm32
+    // SUB – Integer Subtraction : 83 /5 ib SUB r/m32, imm8 or 81 /5 id SUB r/m32, imm32
+    // XOR – Logical Exclusive OR : 83 /6 ib XOR r/m32, imm8 or 81 /6 id XOR r/m32, imm32
+    // NOTE: imm8 is sign extended.
+    uint8_t opcode_extension = 0;
+
+    switch (x64_op){
+    case TP_X64_ADD:
+        opcode_extension = 0;
+        break;
+    case TP_X64_SUB:
+        opcode_extension = 5;
+        break;
+    case TP_X64_XOR:
+        opcode_extension = 6;
+        break;
+    default:
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+        return 0;
+    }
+
+    bool is_imm8 = ((INT8_MIN <= imm) && (INT8_MAX >= imm));
+
+    uint32_t x64_code_size = encode_x64_rm_operand(
+        symbol_table, x64_code_buffer, x64_code_offset,
+        TP_X64_OPERAND_SIZE_32, (is_imm8 ? 0x83 : 0x81), (TP_X64_64_REGISTER)opcode_extension, dst
+    );
+
+    if (0 == x64_code_size){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    if (is_imm8){
+
+        if (x64_code_buffer){
+
+            x64_code_buffer[x64_code_offset + x64_code_size] = (uint8_t)imm;
+        }
+
+        ++x64_code_size;
+    }else{
+
+        if (x64_code_buffer){
+
+            memcpy(&(x64_code_buffer[x64_code_offset + x64_code_size]), &imm, sizeof(imm));
+        }
+
+        x64_code_size += sizeof(imm);
+    }
+
+    TP_X64_INSTRUCTION x64_instruction = {
+        .member_offset = x64_code_offset,
+        .member_size = x64_code_size,
+        .member_kind = TP_X64_INSTRUCTION_KIND_ALU_IMM,
+        .member_x64_op = x64_op,
+        .member_dst = *dst,
+        .member_imm = imm
+    };
+
+    if ( ! record_x64_instruction(symbol_table, x64_code_buffer, &x64_instruction)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    return x64_code_size;
+}
+
+static uint32_t encode_x64_imul_imm(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src, int32_t imm)
+{
+    // IMUL – Signed Multiply : 6B /r ib IMUL r32, r/m32, imm8 or 69 /r id IMUL r32, r/m32, imm32
+    TP_X64_64_REGISTER dst64 = tp_get_x64_64_register(dst);
+
+    if (TP_X64_64_REGISTER_NULL == dst64){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return 0;
+    }
+
+    bool is_imm8 = ((INT8_MIN <= imm) && (INT8_MAX >= imm));
+
+    uint32_t x64_code_size = encode_x64_rm_operand(
+        symbol_table, x64_code_buffer, x64_code_offset,
+        TP_X64_OPERAND_SIZE_32, (is_imm8 ? 0x6b : 0x69), dst64, src
+    );
+
+    if (0 == x64_code_size){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    if (is_imm8){
+
+        if (x64_code_buffer){
+
+            x64_code_buffer[x64_code_offset + x64_code_size] = (uint8_t)imm;
+        }
+
+        ++x64_code_size;
+    }else{
+
+        if (x64_code_buffer){
+
+            memcpy(&(x64_code_buffer[x64_code_offset + x64_code_size]), &imm, sizeof(imm));
+        }
+
+        x64_code_size += sizeof(imm);
+    }
+
+    TP_X64_INSTRUCTION x64_instruction = {
+        .member_offset = x64_code_offset,
+        .member_size = x64_code_size,
+        .member_kind = TP_X64_INSTRUCTION_KIND_IMUL_IMM,
+        .member_x64_op = TP_X64_IMUL,
+        .member_dst = *dst,
+        .member_src = *src,
+        .member_imm = imm
+    };
+
+    if ( ! record_x64_instruction(symbol_table, x64_code_buffer, &x64_instruction)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    return x64_code_size;
+}
+
+static uint32_t encode_x64_add_sub_imm(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64 x64_op, TP_X64_64_REGISTER reg64, int32_t imm, TP_X64_ADD_SUB_IMM_MODE x64_add_sub_imm_mode)
+{
+    uint32_t x64_code_size = 3;
+
+    bool is_add = false;
+
+    switch (x64_op){
+    case TP_X64_ADD:
+        is_add = true;
+        break;
+    case TP_X64_SUB:
+        break;
+    default:
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+        return 0;
+    }
+
+    bool is_imm8 = false;
+
+    switch (x64_add_sub_imm_mode){
+    case TP_X64_ADD_SUB_IMM_MODE_DEFAULT:
+        is_imm8 = ((INT8_MIN <= imm) && (INT8_MAX >= imm));
+        break;
+    case TP_X64_ADD_SUB_IMM_MODE_FORCE_IMM32:
+        break;
+    default:
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+        return 0;
+    }
+
+    if (x64_code_buffer){
+
+        x64_code_buffer[x64_code_offset] = (0x48 | ((TP_X64_64_REGISTER_R8 <= reg64) ? 0x01 : 0x00));
+
+        if (is_imm8){
+
+            // ADD: immediate8 to qwordregister 0100 100B : 1000 0011 : 11 000 qwordreg : imm8
+            // SUB: immediate8 from qwordregister 0100 100B 1000 0011 : 11 101 qwordreg : imm8
+            x64_code_buffer[x64_code_offset + 1] = 0x83;
+            x64_code_buffer[x64_code_offset + 2] = ((is_add ? 0xc0 : 0xe8) | (reg64 & 0x07));
+            x64_code_buffer[x64_code_offset + 3] = (uint8_t)imm;
+
+            ++x64_code_size;
+        }else{
+
+            // ADD: immediate32 to qwordregister 0100 100B : 1000 0001 : 11 000 qwordreg : imm
+            // SUB: immediate32 from qwordregister 0100 100B 1000 0001 : 11 101 qwordreg : imm32
+            x64_code_buffer[x64_code_offset + 1] = 0x81;
+            x64_code_buffer[x64_code_offset + 2] = ((is_add ? 0xc0 : 0xe8) | (reg64 & 0x07));
+            memcpy(&(x64_code_buffer[x64_code_offset + 3]), &imm, sizeof(imm));
+
+            x64_code_size += 4;
+        }
+    }else{
+
+        if (is_imm8){
+
+            // imm8
+            ++x64_code_size;
+        }else{
+
+            // imm32
+            x64_code_size += 4;
+        }
+    }
+
+    return x64_code_size;
+}
+
+static uint32_t encode_x64_lea(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_64_REGISTER reg64_dst_reg, TP_X64_64_REGISTER reg64_src_index, TP_X64_64_REGISTER reg64_src_base, int32_t offset)
+{
+    if (x64_code_buffer){
+
+        // LEA - Load Effective Address : 8D /r LEA r64,m 
+        // in qwordregister 0100 1RXB : 1000 1101 : modA qwordreg r/m
+        x64_code_buffer[x64_code_offset] = (0x48 |
+            /* R */ ((TP_X64_64_REGISTER_R8 <= reg64_dst_reg) ? 0x04 : 0x00) |
+            /* X */ (((TP_X64_64_REGISTER_INDEX_NONE != reg64_src_index) &&
+                (TP_X64_64_REGISTER_R8 <= reg64_src_index)) ? 0x02 : 0x00) |
+            /* B */ ((TP_X64_64_REGISTER_R8 <= reg64_src_base) ? 0x01 : 0x00)
+        );
+        x64_code_buffer[x64_code_offset + 1] = 0x8d;
+    }
+
+    return 2 + encode_x64_address(
+        x64_code_buffer, x64_code_offset + 2, (uint8_t)(reg64_dst_reg & 0x07),
+        reg64_src_base, reg64_src_index, 0, offset, TP_X64_DISP_MODE_DEFAULT
+    );
+}
+
+static uint32_t encode_x64_rm_operand(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_OPERAND_SIZE x64_operand_size, uint8_t opcode, TP_X64_64_REGISTER reg64, TP_WASM_STACK_ELEMENT* rm)
+{
+    // NOTE: reg64 is the reg field of ModR/M(register or opcode extension).
+    if (TP_X64_ITEM_KIND_MEMORY == rm->member_x64_item_kind){
+
+        return tp_encode_x64_memory_operand(
+            symbol_table, x64_code_buffer, x64_code_offset,
+            x64_operand_size, opcode, reg64,
+            TP_X64_64_REGISTER_RBP, TP_X64_64_REGISTER_INDEX_NONE, 0, rm->member_offset, TP_X64_DISP_MODE_DEFAULT
+        );
+    }
+
+    TP_X64_64_REGISTER rm64 = tp_get_x64_64_register(rm);
+
+    if (TP_X64_64_REGISTER_NULL == rm64){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return 0;
+    }
+
+    uint32_t x64_code_size = 0;
+
+    bool is_rex_w = (TP_X64_OPERAND_SIZE_64 == x64_operand_size);
+
+    bool is_rex = (is_rex_w || (TP_X64_64_REGISTER_R8 <= reg64) || (TP_X64_64_REGISTER_R8 <= rm64));
+
+    if (x64_code_buffer){
+
+        if (is_rex){
+
+            // 0100 WR0B
+            x64_code_buffer[x64_code_offset + x64_code_size] = (0x40 |
+                /* W */ (is_rex_w ? 0x08 : 0x00) |
+                /* R */ ((TP_X64_64_REGISTER_R8 <= reg64) ? 0x04 : 0x00) |
+                /* B */ ((TP_X64_64_REGISTER_R8 <= rm64) ? 0x01 : 0x00)
+            );
+
+            ++x64_code_size;
+        }
+
+        x64_code_buffer[x64_code_offset + x64_code_size] = opcode;
+
+        ++x64_code_size;
+
+        // ModR/M : 11 reg r/m
+        x64_code_buffer[x64_code_offset + x64_code_size] = ((0x03 << 6) | ((reg64 & 0x07) << 3) | (rm64 & 0x07));
+
+        ++x64_code_size;
+    }else{
+
+        if (is_rex){
+
+            ++x64_code_size;
+        }
+
+        x64_code_size += 2;
+    }
+
+    return x64_code_size;
+}
+
+static uint32_t encode_x64_shift_imm(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* dst, uint8_t imm8)
+{
+    // SAL/SAR/SHL/SHR – Shift
+    // C1 /4 ib SHL r/m32, imm8
+    // C1 /7 ib SAR r/m32, imm8
+    // C1 /5 ib SHR r/m32, imm8
+    uint8_t opcode_extension = 0;
+
+    switch (x64_op){
+    case TP_X64_SHL:
+        opcode_extension = 4;
+        break;
+    case TP_X64_SAR:
+        opcode_extension = 7;
+        break;
+    case TP_X64_SHR:
+        opcode_extension = 5;
+        break;
+    default:
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+        return 0;
+    }
+
+    uint32_t x64_code_size = encode_x64_rm_operand(
+        symbol_table, x64_code_buffer, x64_code_offset,
+        TP_X64_OPERAND_SIZE_32, 0xc1, (TP_X64_64_REGISTER)opcode_extension, dst
+    );
+
+    if (0 == x64_code_size){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    if (x64_code_buffer){
+
+        x64_code_buffer[x64_code_offset + x64_code_size] = imm8;
+    }
+
+    ++x64_code_size;
+
+    TP_X64_INSTRUCTION x64_instruction = {
+        .member_offset = x64_code_offset,
+        .member_size = x64_code_size,
+        .member_kind = TP_X64_INSTRUCTION_KIND_SHIFT_IMM,
+        .member_x64_op = x64_op,
+        .member_dst = *dst,
+        .member_imm = imm8
+    };
+
+    if ( ! record_x64_instruction(symbol_table, x64_code_buffer, &x64_instruction)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    return x64_code_size;
+}
+
+static uint32_t encode_x64_neg(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, TP_WASM_STACK_ELEMENT* dst)
+{
+    // NEG – Two's Complement Negation : F7 /3 NEG r/m32
+    uint32_t x64_code_size = encode_x64_rm_operand(
+        symbol_table, x64_code_buffer, x64_code_offset,
+        TP_X64_OPERAND_SIZE_32, 0xf7, (TP_X64_64_REGISTER)3, dst
+    );
+
+    if (0 == x64_code_size){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    TP_X64_INSTRUCTION x64_instruction = {
+        .member_offset = x64_code_offset,
+        .member_size = x64_code_size,
+        .member_kind = TP_X64_INSTRUCTION_KIND_NEG,
+        .member_dst = *dst
+    };
+
+    if ( ! record_x64_instruction(symbol_table, x64_code_buffer, &x64_instruction)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    return x64_code_size;
+}
+
+static uint32_t encode_x64_lea_scale(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src, uint8_t scale)
+{
+    TP_X64_64_REGISTER dst64 = tp_get_x64_64_register(dst);
+    TP_X64_64_REGISTER src64 = tp_get_x64_64_register(src);
+
+    uint8_t ss = 0;
+
+    switch (scale){
+    case 2:
+        ss = 1;
+        break;
+    case 4:
+        ss = 2;
+        break;
+    case 8:
+        ss = 3;
+        break;
+    default:
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+        return 0;
+    }
+
+    if ((TP_X64_64_REGISTER_NULL == dst64) || (TP_X64_64_REGISTER_NULL == src64)){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return 0;
+    }
+
+    // NOTE: The base of RBP or R13 has no form of disp0.
+    bool is_disp8 = ((TP_X64_64_REGISTER_RBP & 0x07) == (src64 & 0x07));
+
+    bool is_rex = ((TP_X64_64_REGISTER_R8 <= dst64) || (TP_X64_64_REGISTER_R8 <= src64));
+
+    uint32_t x64_code_size = 0;
+
+    if (x64_code_buffer){
 
-        if (is_dst_x64_32_register || is_src_x64_32_register){
+        // LEA - Load Effective Address : 8D /r LEA r32,m
+        if (is_rex){
+
+            // 0100 0RXB
+            x64_code_buffer[x64_code_offset + x64_code_size] = (0x40 |
+                /* R */ ((TP_X64_64_REGISTER_R8 <= dst64) ? 0x04 : 0x00) |
+                /* X */ ((TP_X64_64_REGISTER_R8 <= src64) ? 0x02 : 0x00) |
+                /* B */ ((TP_X64_64_REGISTER_R8 <= src64) ? 0x01 : 0x00)
+            );
 
             ++x64_code_size;
         }
 
-        x64_code_size += 2;
+        x64_code_buffer[x64_code_offset + x64_code_size] = 0x8d;
 
-        if ((TP_X64_IMUL == x64_op) && (false == is_dst_EAX_register)){
+        ++x64_code_size;
 
-            ++x64_code_size;
-        }
+        // ModR/M
+        x64_code_buffer[x64_code_offset + x64_code_size] = ((is_disp8 ? 0x44 : 0x04) | ((dst64 & 0x07) << 3));
 
-        if (TP_X64_NULL <= x64_op){
+        ++x64_code_size;
 
-            TP_PUT_LOG_MSG_ICE(symbol_table);
+        // SIB : [src+src*scale]
+        x64_code_buffer[x64_code_offset + x64_code_size] = ((ss << 6) | ((src64 & 0x07) << 3) | (src64 & 0x07));
 
-            return 0;
-        }
-    }
+        ++x64_code_size;
+
+        if (is_disp8){
 
-    if (TP_X64_IDIV == x64_op){
+            x64_code_buffer[x64_code_offset + x64_code_size] = 0x00;
 
-        if (is_use_EDX_register){
+            ++x64_code_size;
+        }
+    }else{
 
-            tmp_x64_code_size = encode_x64_pop_reg64(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RDX
-            );
+        if (is_rex){
 
-            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+            ++x64_code_size;
         }
 
-        if (false == is_dst_EAX_register){
+        x64_code_size += 3;
 
-            tmp_x64_code_size = encode_x64_pop_reg64(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RAX
-            );
+        if (is_disp8){
 
-            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+            ++x64_code_size;
         }
     }
 
-    return x64_code_size;
-}
+    TP_X64_INSTRUCTION x64_instruction = {
+        .member_offset = x64_code_offset,
+        .member_size = x64_code_size,
+        .member_kind = TP_X64_INSTRUCTION_KIND_LEA_SCALE,
+        .member_dst = *dst,
+        .member_src = *src,
+        .member_imm = scale
+    };
 
-static uint32_t encode_x64_32_register_to_memory_offset(
-    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
-    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src)
-{
-    return encode_x64_32_memory_offset_common(
-        symbol_table, x64_code_buffer, x64_code_offset,
-        x64_op, TP_X64_DIRECTION_SOURCE_REGISTER, dst, src
-    );
-}
+    if ( ! record_x64_instruction(symbol_table, x64_code_buffer, &x64_instruction)){
 
-static uint32_t encode_x64_32_memory_offset_to_register(
-    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
-    TP_X64 x64_op, TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src)
-{
-    return encode_x64_32_memory_offset_common(
-        symbol_table, x64_code_buffer, x64_code_offset,
-        x64_op, TP_X64_DIRECTION_SOURCE_MEMORY, dst, src
-    );
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    return x64_code_size;
 }
 
-static uint32_t encode_x64_32_memory_offset_common(
+static uint32_t encode_x64_mul_high(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
-    TP_X64 x64_op, TP_X64_DIRECTION x64_direction, TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src)
+    TP_WASM_STACK_ELEMENT* dst, TP_WASM_STACK_ELEMENT* src, int32_t imm)
 {
     uint32_t x64_code_size = 0;
     uint32_t tmp_x64_code_size = 0;
 
-    if ((TP_X64_ITEM_KIND_MEMORY != dst->member_x64_item_kind) &&
-        (TP_X64_ITEM_KIND_MEMORY != src->member_x64_item_kind)){
+    TP_X64_64_REGISTER dst64 = tp_get_x64_64_register(dst);
 
-        TP_PUT_LOG_MSG(
-            symbol_table, TP_LOG_TYPE_DISP_FORCE,
-            TP_MSG_FMT("TP_X64_ITEM_KIND_MEMORY(%1) != dst_op(%2), src_op(%3)"),
-            TP_LOG_PARAM_INT32_VALUE(TP_X64_ITEM_KIND_MEMORY),
-            TP_LOG_PARAM_INT32_VALUE(dst->member_x64_item_kind),
-            TP_LOG_PARAM_INT32_VALUE(src->member_x64_item_kind)
-        );
+    if (TP_X64_64_REGISTER_NULL == dst64){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
 
         return 0;
     }
 
-    bool is_source_memory = (TP_X64_DIRECTION_SOURCE_MEMORY == x64_direction);
-
-    int32_t offset = (is_source_memory ? src->member_offset : dst->member_offset);
+    // NOTE: The product of 64 bits is exact, and the high 32 bits of it is the signed multiply high.
+    // MOVSXD – Move with Sign-Extension : REX.W + 63 /r MOVSXD r64, r/m32
+    tmp_x64_code_size = encode_x64_rm_operand(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_OPERAND_SIZE_64, 0x63, dst64, src
+    );
 
-    bool is_disp8 = (is_source_memory ? (
-        (INT8_MIN <= src->member_offset) &&
-        (INT8_MAX >= src->member_offset)
-    ) : (
-        (INT8_MIN <= dst->member_offset) &&
-        (INT8_MAX >= dst->member_offset)
-    ));
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
 
-    bool is_dst_x86_32_register = (TP_X64_ITEM_KIND_X86_32_REGISTER == dst->member_x64_item_kind);
-    bool is_dst_EAX_register = (is_dst_x86_32_register &&
-        (TP_X86_32_REGISTER_EAX == dst->member_x64_item.member_x86_32_register)
-    );
-    bool is_use_EDX_register = (TP_X64_ITEM_KIND_X86_32_REGISTER ==
-        symbol_table->member_use_X86_32_register[TP_X86_32_REGISTER_EDX].member_x64_item_kind
+    // IMUL – Signed Multiply : REX.W + 69 /r id IMUL r64, r/m64, imm32
+    tmp_x64_code_size = encode_x64_rm_operand(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_OPERAND_SIZE_64, 0x69, dst64, dst
     );
-    bool is_dst_x64_32_register = (TP_X64_ITEM_KIND_X64_32_REGISTER == dst->member_x64_item_kind);
-
-    bool is_src_x86_32_register = (TP_X64_ITEM_KIND_X86_32_REGISTER == src->member_x64_item_kind);
-    bool is_src_x64_32_register = (TP_X64_ITEM_KIND_X64_32_REGISTER == src->member_x64_item_kind);
 
-    if ((false == is_source_memory) && (TP_X64_IMUL == x64_op)){
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
 
-        TP_PUT_LOG_MSG(
-            symbol_table, TP_LOG_TYPE_DISP_FORCE, TP_MSG_FMT("%1"),
-            TP_LOG_PARAM_STRING("ERROR: (false == is_source_memory) && (TP_X64_IMUL == x64_op)")
-        );
+    if (x64_code_buffer){
 
-        return 0;
+        memcpy(&(x64_code_buffer[x64_code_offset + x64_code_size]), &imm, sizeof(imm));
     }
 
-    if (TP_X64_IDIV == x64_op){
+    x64_code_size += sizeof(imm);
 
-        if (false == is_dst_EAX_register){
+    // SAR – Shift : REX.W + C1 /7 ib SAR r/m64, imm8
+    tmp_x64_code_size = encode_x64_rm_operand(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_OPERAND_SIZE_64, 0xc1, (TP_X64_64_REGISTER)7, dst
+    );
 
-            tmp_x64_code_size = encode_x64_push_reg64(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RAX
-            );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
 
-            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
-        }
+    if (x64_code_buffer){
 
-        if (is_use_EDX_register){
+        x64_code_buffer[x64_code_offset + x64_code_size] = 32;
+    }
 
-            tmp_x64_code_size = encode_x64_push_reg64(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RDX
-            );
+    ++x64_code_size;
 
-            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
-        }
+    TP_X64_INSTRUCTION x64_instruction = {
+        .member_offset = x64_code_offset,
+        .member_size = x64_code_size,
+        .member_kind = TP_X64_INSTRUCTION_KIND_MUL_HIGH,
+        .member_dst = *dst,
+        .member_src = *src,
+        .member_imm = imm
+    };
 
-        TP_WASM_STACK_ELEMENT edx_op = {
-            .member_wasm_opcode = TP_WASM_OPCODE_I32_VALUE,
-            .member_x64_item_kind = TP_X64_ITEM_KIND_X86_32_REGISTER,
-            .member_x64_item.member_x86_32_register = TP_X86_32_REGISTER_EDX
-        };
+    if ( ! record_x64_instruction(symbol_table, x64_code_buffer, &x64_instruction)){
 
-        // xor edx, edx
-        tmp_x64_code_size = tp_encode_x64_2_operand(
-            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_XOR, &edx_op, &edx_op
-        );
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+        return 0;
     }
 
-    if (x64_code_buffer){
-
-        if (is_dst_x64_32_register || is_src_x64_32_register){
+    return x64_code_size;
+}
 
-            switch (x64_op){
-            case TP_X64_IMUL:
-                if ( ! is_dst_EAX_register){
+static uint32_t encode_x64_cdq(TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset)
+{
+    // CWD/CDQ – Convert Word to Doubleword/Convert Doubleword to Quadword : 99 CDQ
+    uint32_t x64_code_size = encode_x64_1_opcode(symbol_table, x64_code_buffer, x64_code_offset, 0x99);
 
-                    goto rex_common;
-                }
-//              break;
-            case TP_X64_IDIV:
-                x64_code_buffer[x64_code_offset + x64_code_size] = (0x40 |
-                    /* B */ (is_src_x64_32_register ? 0x01 : 0x00)
-                );
-                break;
-            default:
-rex_common:
-                x64_code_buffer[x64_code_offset + x64_code_size] = (0x40 |
-                    /* R */ (is_dst_x64_32_register ? 0x04 : 0x00) |
-                    /* B */ (is_src_x64_32_register ? 0x01 : 0x00)
-                );
-                break;
-            }
+    TP_X64_INSTRUCTION x64_instruction = {
+        .member_offset = x64_code_offset,
+        .member_size = x64_code_size,
+        .member_kind = TP_X64_INSTRUCTION_KIND_CDQ
+    };
 
-            ++x64_code_size;
-        }
+    if ( ! record_x64_instruction(symbol_table, x64_code_buffer, &x64_instruction)){
 
-        switch (x64_op){
-        case TP_X64_MOV:
-            // MOV – Move Data
-            // memory to reg 1000 101w : mod reg r/m
-            // reg to memory 1000 100w : mod reg r/m
-            x64_code_buffer[x64_code_offset + x64_code_size] = (0x89 | (is_source_memory ? 0x02 : 0x00));
-            break;
-        case TP_X64_ADD:
-            // ADD
-            // memory to register 0000 001w : mod reg r/m
-            // register to memory 0000 000w : mod reg r/m
-            x64_code_buffer[x64_code_offset + x64_code_size] = (0x01 | (is_source_memory ? 0x02 : 0x00));
-            break;
-        case TP_X64_SUB:
-            // SUB – Integer Subtraction
-            // memory to register 0010 101w : mod reg r/m
-            // register to memory 0010 100w : mod reg r/m
-            x64_code_buffer[x64_code_offset + x64_code_size] = (0x29 | (is_source_memory ? 0x02 : 0x00));
-            break;
-        case TP_X64_IMUL:
-            // IMUL – Signed Multiply
-            // AL, AX, or EAX with memory 1111 011w : mod 101 reg
-            // register with memory 0000 1111 : 1010 1111 : mod reg r/m
-            if (is_dst_EAX_register){
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-                x64_code_buffer[x64_code_offset + x64_code_size] = 0xf7;
-            }else{
+        return 0;
+    }
 
-                x64_code_buffer[x64_code_offset + x64_code_size] = 0x0f;
+    return x64_code_size;
+}
 
-                ++x64_code_size;
+uint32_t tp_encode_x64_memory_operand(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_OPERAND_SIZE x64_operand_size, uint8_t opcode, TP_X64_64_REGISTER reg64,
+    TP_X64_64_REGISTER reg64_base, TP_X64_64_REGISTER reg64_index, uint8_t scale, int32_t offset,
+    TP_X64_DISP_MODE x64_disp_mode)
+{
+    uint32_t x64_code_size = 0;
 
-                x64_code_buffer[x64_code_offset + x64_code_size] = 0xaf;
-            }
-            break;
-        case TP_X64_IDIV:
-            // IDIV – Signed Divide
-            // AL, AX, or EAX by memory 1111 011w : mod 111 r/m
-            x64_code_buffer[x64_code_offset + x64_code_size] = 0xf7;
-            break;
-        case TP_X64_XOR:
-            // XOR – Logical Exclusive OR
-            // memory to register 0011 001w : mod reg r/m
-            // register to memory 0011 000w : mod reg r/m
-            x64_code_buffer[x64_code_offset + x64_code_size] = (0x31 | (is_source_memory ? 0x02 : 0x00));
-            break;
-        default:
-            TP_PUT_LOG_MSG_ICE(symbol_table);
-            return 0;
-        }
+    bool is_rex_w = (TP_X64_OPERAND_SIZE_64 == x64_operand_size);
 
-        ++x64_code_size;
+    bool is_rex = (is_rex_w ||
+        (TP_X64_64_REGISTER_R8 <= reg64) ||
+        ((TP_X64_64_REGISTER_INDEX_NONE != reg64_index) && (TP_X64_64_REGISTER_R8 <= reg64_index)) ||
+        (TP_X64_64_REGISTER_R8 <= reg64_base)
+    );
 
-        // ModR/M
-        switch (x64_op){
-        case TP_X64_IMUL:
-            if (is_dst_EAX_register){
+    if (x64_code_buffer){
 
-                // AL, AX, or EAX with memory 1111 011w : mod 101 reg
-                x64_code_buffer[x64_code_offset + x64_code_size] = (
-                    (is_disp8 ? 0x44 : 0x84) | ((TP_X86_32_REGISTER_EAX & 0x07) << 3)
-                );
-            }else{
+        if (is_rex){
 
-                goto mod_rm_common;
-            }
-            break;
-        case TP_X64_IDIV:
-            // AL, AX, or EAX by memory 1111 011w : mod 111 r/m
-            x64_code_buffer[x64_code_offset + x64_code_size] = (
-                (is_disp8 ? 0x44 : 0x84) | ((TP_X86_32_REGISTER_EAX & 0x07) << 3)
-            );
-            break;
-        default:
-mod_rm_common:
-            // mod reg r/m
-            x64_code_buffer[x64_code_offset + x64_code_size] = ((is_disp8 ? 0x44 : 0x84) |
-                (((is_dst_x86_32_register ? dst->member_x64_item.member_x86_32_register :
-                dst->member_x64_item.member_x64_32_register) & 0x07) << 3) |
-                ((is_src_x86_32_register ? src->member_x64_item.member_x86_32_register :
-                src->member_x64_item.member_x64_32_register) & 0x07)
+            // 0100 WRXB
+            x64_code_buffer[x64_code_offset + x64_code_size] = (0x40 |
+                /* W */ (is_rex_w ? 0x08 : 0x00) |
+                /* R */ ((TP_X64_64_REGISTER_R8 <= reg64) ? 0x04 : 0x00) |
+                /* X */ (((TP_X64_64_REGISTER_INDEX_NONE != reg64_index) &&
+                    (TP_X64_64_REGISTER_R8 <= reg64_index)) ? 0x02 : 0x00) |
+                /* B */ ((TP_X64_64_REGISTER_R8 <= reg64_base) ? 0x01 : 0x00)
             );
-            break;
+
+            ++x64_code_size;
         }
 
-        ++x64_code_size;
+        x64_code_buffer[x64_code_offset + x64_code_size] = opcode;
+    }else{
 
-        // SIB
-        x64_code_buffer[x64_code_offset + x64_code_size] = (
-            ((TP_X64_64_REGISTER_INDEX_NONE & 0x07) << 3) | (TP_X64_64_REGISTER_RBP & 0x07)
-        );
+        if (is_rex){
 
-        ++x64_code_size;
+            ++x64_code_size;
+        }
+    }
 
-        // Address displacement
-        if (is_disp8){
+    ++x64_code_size;
 
-            x64_code_buffer[x64_code_offset + x64_code_size] = (uint8_t)offset;
+    x64_code_size += encode_x64_address(
+        x64_code_buffer, x64_code_offset + x64_code_size, (uint8_t)(reg64 & 0x07),
+        reg64_base, reg64_index, scale, offset, x64_disp_mode
+    );
 
-            x64_code_size += 1;
-        }else{
+    return x64_code_size;
+}
 
-            memcpy(
-                &(x64_code_buffer[x64_code_offset + x64_code_size]), &offset,
-                sizeof(offset)
-            );
+static uint32_t encode_x64_address(
+    uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint8_t reg,
+    TP_X64_64_REGISTER reg64_base, TP_X64_64_REGISTER reg64_index, uint8_t scale, int32_t offset,
+    TP_X64_DISP_MODE x64_disp_mode)
+{
+    // NOTE: The SIB byte is needed for the index register and the base of RSP or R12(r/m 100).
+    bool is_sib = ((TP_X64_64_REGISTER_INDEX_NONE != reg64_index) ||
+        ((TP_X64_64_REGISTER_RSP & 0x07) == (reg64_base & 0x07))
+    );
 
-            x64_code_size += 4;
-        }
-    }else{
+    // NOTE: The base of RBP or R13(r/m 101) has no form of disp0(mod 00 is RIP relative or disp32 only).
+    uint32_t disp_size = sizeof(int32_t);
+    uint8_t mod = 0x80;
 
-        if (is_dst_x64_32_register || is_src_x64_32_register){
+    if (TP_X64_DISP_MODE_DEFAULT == x64_disp_mode){
 
-            ++x64_code_size;
+        if ((0 == offset) && ((TP_X64_64_REGISTER_RBP & 0x07) != (reg64_base & 0x07))){
+
+            disp_size = 0;
+            mod = 0x00;
+        }else if ((INT8_MIN <= offset) && (INT8_MAX >= offset)){
+
+            disp_size = sizeof(int8_t);
+            mod = 0x40;
         }
+    }
 
-        x64_code_size += 3;
+    uint32_t x64_code_size = 1 + (is_sib ? 1 : 0) + disp_size;
 
-        if ((TP_X64_IMUL == x64_op) && (false == is_dst_EAX_register)){
+    if (NULL == x64_code_buffer){
 
-            ++x64_code_size;
-        }
+        return x64_code_size;
+    }
 
-        if (TP_X64_NULL <= x64_op){
+    // ModR/M : mod reg r/m
+    x64_code_buffer[x64_code_offset] = (mod | ((reg & 0x07) << 3) | (is_sib ? 0x04 : (reg64_base & 0x07)));
 
-            TP_PUT_LOG_MSG_ICE(symbol_table);
+    ++x64_code_offset;
 
-            return 0;
-        }
+    if (is_sib){
 
-        if (is_disp8){
+        // SIB : scale index base
+        x64_code_buffer[x64_code_offset] = (
+            ((scale & 0x03) << 6) | ((reg64_index & 0x07) << 3) | (reg64_base & 0x07)
+        );
 
-            x64_code_size += 1;
-        }else{
+        ++x64_code_offset;
+    }
 
-            x64_code_size += 4;
-        }
+    // Address displacement
+    if (sizeof(int8_t) == disp_size){
+
+        x64_code_buffer[x64_code_offset] = (uint8_t)offset;
+    }else if (sizeof(int32_t) == disp_size){
+
+        memcpy(&(x64_code_buffer[x64_code_offset]), &offset, sizeof(offset));
     }
 
-    if (TP_X64_IDIV == x64_op){
+    return x64_code_size;
+}
+
+uint32_t tp_encode_x64_mov_memory(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_DIRECTION x64_direction, TP_X64_OPERAND_SIZE x64_operand_size,
+    TP_X64_64_REGISTER reg64, TP_X64_64_REGISTER reg64_base, int32_t offset, TP_X64_DISP_MODE x64_disp_mode)
+{
+    // MOV – Move Data
+    // memory to reg 1000 101w : mod reg r/m
+    // reg to memory 1000 100w : mod reg r/m
+    return tp_encode_x64_memory_operand(
+        symbol_table, x64_code_buffer, x64_code_offset,
+        x64_operand_size, ((TP_X64_DIRECTION_SOURCE_MEMORY == x64_direction) ? 0x8b : 0x89), reg64,
+        reg64_base, TP_X64_64_REGISTER_INDEX_NONE, 0, offset, x64_disp_mode
+    );
+}
+
+static bool encode_x64_load_params(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    uint32_t param_count, int32_t stack_param_size, uint32_t* x64_code_size)
+{
+    // Windows x64 calling convention: RCX, RDX, R8, R9 and stack.
+    static const TP_X64_64_REGISTER param_register[TP_X64_PARAM_REGISTER_NUM] = {
+        TP_X64_64_REGISTER_RCX, TP_X64_64_REGISTER_RDX, TP_X64_64_REGISTER_R8, TP_X64_64_REGISTER_R9
+    };
 
-        if (is_use_EDX_register){
+    *x64_code_size = 0;
 
-            tmp_x64_code_size = encode_x64_pop_reg64(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RDX
-            );
+    TP_X64_LIVE_RANGE* local_live_range = symbol_table->member_x64_local_live_range;
+    uint32_t tmp_x64_code_size = 0;
 
-            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
-        }
+    // The spilled parameters are stored to the stack frame first, because the stores clobber EAX only.
+    for (uint32_t i = 0; param_count > i; ++i){
 
-        if (false == is_dst_EAX_register){
+        TP_X64_LIVE_RANGE* param = &(local_live_range[i]);
 
-            tmp_x64_code_size = encode_x64_pop_reg64(
-                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_64_REGISTER_RAX
-            );
+        if ((0 == param->member_use_count) || (false == param->member_is_load) ||
+            (TP_X64_64_REGISTER_NULL != param->member_register)){
 
-            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+            continue;
         }
-    }
 
-    return x64_code_size;
-}
+        int32_t local_variable_offset = 0;
 
-static uint32_t encode_x64_mov_imm(
-    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
-    int32_t imm, TP_X64_MOV_IMM_MODE x64_mov_imm_mode, TP_WASM_STACK_ELEMENT* result)
-{
-    uint32_t x64_code_size = 0;
+        if ( ! tp_get_local_variable_offset(symbol_table, i, &local_variable_offset)){
 
-    bool is_disp8 = (
-        (INT8_MIN <= result->member_offset) &&
-        (INT8_MAX >= result->member_offset)
-    );
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
 
-    bool is_imm8 = false;
+            return false;
+        }
 
-    switch (x64_mov_imm_mode){
-    case TP_X64_MOV_IMM_MODE_DEFAULT:
-        is_imm8 = ((INT8_MIN <= imm) && (INT8_MAX >= imm));
-        break;
-    case TP_X64_MOV_IMM_MODE_FORCE_IMM32:
-        break;
-    default:
-        TP_PUT_LOG_MSG_ICE(symbol_table);
-        return 0;
-    }
+        TP_X64_64_REGISTER src = TP_X64_64_REGISTER_RAX;
 
-    // MOV – Move Data
-    if (x64_code_buffer){
+        if (TP_X64_ENTRY_MODE_INPUTS_POINTER == symbol_table->member_x64_entry_mode){
 
-        switch (result->member_x64_item_kind){
-        case TP_X64_ITEM_KIND_X86_32_REGISTER:
+            // mov eax, DWORD PTR [rcx+i*4]
+            tmp_x64_code_size = tp_encode_x64_mov_memory(
+                symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size,
+                TP_X64_DIRECTION_SOURCE_MEMORY, TP_X64_OPERAND_SIZE_32,
+                TP_X64_64_REGISTER_RAX, TP_X64_64_REGISTER_RCX,
+                (int32_t)(i * sizeof(int32_t)), TP_X64_DISP_MODE_DEFAULT
+            );
+            TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
+        }else if (TP_X64_PARAM_REGISTER_NUM > i){
 
-            // immediate to register (alternate encoding) 1011 w reg : immediate data
-            x64_code_buffer[x64_code_offset] = (
-                0xb0 | (is_imm8 ? 0x00 : 0x08) |
-                (result->member_x64_item.member_x86_32_register & 0x07)
+            src = param_register[i];
+        }else{
+
+            // mov eax, DWORD PTR [rbp+stack_offset]
+            tmp_x64_code_size = encode_x64_load_stack_param(
+                symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size,
+                TP_X64_64_REGISTER_RAX, i, stack_param_size
             );
+            TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
+        }
+
+        // mov DWORD PTR [rbp+local_variable_offset], src
+        tmp_x64_code_size = tp_encode_x64_mov_memory(
+            symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size,
+            TP_X64_DIRECTION_SOURCE_REGISTER, TP_X64_OPERAND_SIZE_32,
+            src, TP_X64_64_REGISTER_RBP, local_variable_offset, TP_X64_DISP_MODE_DEFAULT
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
+    }
 
-            x64_code_size = 1;
+    // The parameters in the registers of the arguments are moved at the same time(parallel moves).
+    TP_X64_64_REGISTER move_dst[TP_X64_PARAM_REGISTER_NUM] = { TP_X64_64_REGISTER_NULL };
+    TP_X64_64_REGISTER move_src[TP_X64_PARAM_REGISTER_NUM] = { TP_X64_64_REGISTER_NULL };
+    uint32_t move_num = 0;
 
-            // Immediate data
-            if (is_imm8){
+    if (TP_X64_ENTRY_MODE_ARGS == symbol_table->member_x64_entry_mode){
 
-                x64_code_buffer[x64_code_offset + x64_code_size] = (uint8_t)imm;
+        for (uint32_t i = 0; (param_count > i) && (TP_X64_PARAM_REGISTER_NUM > i); ++i){
 
-                x64_code_size += 1;
-            }else{
+            TP_X64_LIVE_RANGE* param = &(local_live_range[i]);
 
-                memcpy(&(x64_code_buffer[x64_code_offset + x64_code_size]), &imm, sizeof(imm));
+            if (param->member_use_count && param->member_is_load &&
+                (TP_X64_64_REGISTER_NULL != param->member_register) && (param_register[i] != param->member_register)){
 
-                x64_code_size += 4;
+                move_dst[move_num] = param->member_register;
+                move_src[move_num] = param_register[i];
+                ++move_num;
             }
+        }
+    }
 
-            break;
-        case TP_X64_ITEM_KIND_X64_32_REGISTER:
+    while (move_num){
 
-            // immediate to register (alternate encoding) 0100 000B : 1011 w reg : imm
-            x64_code_buffer[x64_code_offset] = 0x41;
-            x64_code_buffer[x64_code_offset + 1] = (
-                0xb0 | (is_imm8 ? 0x00 : 0x08) |
-                (result->member_x64_item.member_x64_32_register & 0x07)
-            );
+        // Moves to the register which is not the source of the other moves.
+        uint32_t index = move_num;
 
-            x64_code_size = 2;
+        for (uint32_t i = 0; move_num > i; ++i){
 
-            // Immediate data
-            if (is_imm8){
+            bool is_source = false;
 
-                x64_code_buffer[x64_code_offset + x64_code_size] = (uint8_t)imm;
+            for (uint32_t j = 0; move_num > j; ++j){
 
-                x64_code_size += 1;
-            }else{
+                if (move_dst[i] == move_src[j]){
 
-                memcpy(&(x64_code_buffer[x64_code_offset + x64_code_size]), &imm, sizeof(imm));
+                    is_source = true;
 
-                x64_code_size += 4;
+                    break;
+                }
             }
 
-            break;
-        case TP_X64_ITEM_KIND_MEMORY:
-
-            // immediate to memory 1100 011w : mod 000 r/m : immediate data
-            x64_code_buffer[x64_code_offset] = (0xc7 | (is_imm8 ? 0x00 : 0x01));
-
-           // ModR/M
-            if (is_disp8){
+            if ( ! is_source){
 
-                // disp8
-                x64_code_buffer[x64_code_offset + 1] = 0x44;
-            }else{
+                index = i;
 
-                // disp32
-                x64_code_buffer[x64_code_offset + 1] = 0x84;
+                break;
             }
+        }
 
-            // SIB
-            x64_code_buffer[x64_code_offset + 2] = (
-                ((TP_X64_64_REGISTER_INDEX_NONE & 0x07) << 3) | (TP_X64_64_REGISTER_RBP & 0x07)
-            );
+        if (move_num != index){
 
-            x64_code_size = 3;
+            // mov dst, src
+            tmp_x64_code_size = encode_x64_32_register_operand(
+                symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size,
+                0x8b, move_dst[index], move_src[index]
+            );
+            TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
+        }else{
 
-            // Address displacement
-            if (is_disp8){
+            // NOTE: All of the moves are cycles, so the first move is the exchange of the registers,
+            // and the other moves from the destination register read the source register instead.
+            index = 0;
 
-                x64_code_buffer[x64_code_offset + x64_code_size] = (uint8_t)(result->member_offset);
+            // XCHG – Exchange Register/Memory with Register
+            tmp_x64_code_size = encode_x64_32_register_operand(
+                symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size,
+                0x87, move_dst[index], move_src[index]
+            );
+            TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
 
-                x64_code_size += 1;
-            }else{
+            for (uint32_t i = 0; move_num > i; ++i){
 
-                memcpy(
-                    &(x64_code_buffer[x64_code_offset + x64_code_size]), &(result->member_offset),
-                    sizeof(result->member_offset)
-                );
+                if (move_dst[index] == move_src[i]){
 
-                x64_code_size += 4;
+                    move_src[i] = move_src[index];
+                }
             }
+        }
+
+        --move_num;
 
-            // Immediate data
-            if (is_imm8){
+        move_dst[index] = move_dst[move_num];
+        move_src[index] = move_src[move_num];
 
-                x64_code_buffer[x64_code_offset + x64_code_size] = (uint8_t)imm;
+        // The exchanged register may be in the place already.
+        for (uint32_t i = 0; move_num > i; ){
 
-                x64_code_size += 1;
-            }else{
+            if (move_dst[i] == move_src[i]){
 
-                memcpy(&(x64_code_buffer[x64_code_offset + x64_code_size]), &imm, sizeof(imm));
+                --move_num;
 
-                x64_code_size += 4;
+                move_dst[i] = move_dst[move_num];
+                move_src[i] = move_src[move_num];
+
+                continue;
             }
 
-            break;
-        default:
-            TP_PUT_LOG_MSG_ICE(symbol_table);
-            return 0;
+            ++i;
         }
-    }else{
-
-        switch (result->member_x64_item_kind){
-        case TP_X64_ITEM_KIND_X86_32_REGISTER:
-            x64_code_size = 1;
+    }
 
-            if (is_imm8){
+    // The parameters in the stack(or the inputs).
+    uint32_t rcx_param_index = param_count;
 
-                x64_code_size += 1;
-            }else{
+    for (uint32_t i = 0; param_count > i; ++i){
 
-                x64_code_size += 4;
-            }
-            break;
-        case TP_X64_ITEM_KIND_X64_32_REGISTER:
-            x64_code_size = 2;
+        TP_X64_LIVE_RANGE* param = &(local_live_range[i]);
 
-            if (is_imm8){
+        if ((0 == param->member_use_count) || (false == param->member_is_load) ||
+            (TP_X64_64_REGISTER_NULL == param->member_register)){
 
-                x64_code_size += 1;
-            }else{
+            continue;
+        }
 
-                x64_code_size += 4;
-            }
-            break;
-        case TP_X64_ITEM_KIND_MEMORY:
-            x64_code_size = 3;
+        if (TP_X64_ENTRY_MODE_INPUTS_POINTER == symbol_table->member_x64_entry_mode){
 
-            if (is_disp8){
+            // NOTE: RCX is the pointer to the inputs, so ECX is loaded last.
+            if (TP_X64_64_REGISTER_RCX == param->member_register){
 
-                x64_code_size += 1;
-            }else{
+                rcx_param_index = i;
 
-                x64_code_size += 4;
+                continue;
             }
 
-            if (is_imm8){
-
-                x64_code_size += 1;
-            }else{
+            // mov reg32, DWORD PTR [rcx+i*4]
+            tmp_x64_code_size = tp_encode_x64_mov_memory(
+                symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size,
+                TP_X64_DIRECTION_SOURCE_MEMORY, TP_X64_OPERAND_SIZE_32,
+                param->member_register, TP_X64_64_REGISTER_RCX,
+                (int32_t)(i * sizeof(int32_t)), TP_X64_DISP_MODE_DEFAULT
+            );
+            TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
+        }else if (TP_X64_PARAM_REGISTER_NUM <= i){
 
-                x64_code_size += 4;
-            }
-            break;
-        default:
-            TP_PUT_LOG_MSG_ICE(symbol_table);
-            return 0;
+            // mov reg32, DWORD PTR [rbp+stack_offset](or [rsp+stack_offset])
+            tmp_x64_code_size = encode_x64_load_stack_param(
+                symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size,
+                param->member_register, i, stack_param_size
+            );
+            TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
         }
     }
 
-    return x64_code_size;
+    if (param_count != rcx_param_index){
+
+        // mov ecx, DWORD PTR [rcx+i*4]
+        tmp_x64_code_size = tp_encode_x64_mov_memory(
+            symbol_table, x64_code_buffer, x64_code_offset + *x64_code_size,
+            TP_X64_DIRECTION_SOURCE_MEMORY, TP_X64_OPERAND_SIZE_32,
+            TP_X64_64_REGISTER_RCX, TP_X64_64_REGISTER_RCX,
+            (int32_t)(rcx_param_index * sizeof(int32_t)), TP_X64_DISP_MODE_DEFAULT
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, *x64_code_size, tmp_x64_code_size);
+    }
+
+    return true;
 }
 
-static uint32_t encode_x64_add_sub_imm(
+static uint32_t encode_x64_load_stack_param(
     TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
-    TP_X64 x64_op, TP_X64_64_REGISTER reg64, int32_t imm, TP_X64_ADD_SUB_IMM_MODE x64_add_sub_imm_mode)
+    TP_X64_64_REGISTER reg64, uint32_t param_index, int32_t stack_param_size)
 {
-    uint32_t x64_code_size = 3;
+    // Stack parameters are above the return address and home space of function arguments register.
+    if (symbol_table->member_is_x64_frame_elision){
 
-    bool is_add = false;
+        // NOTE: RSP is moved by the pushes of the non-volatile registers only.
+        int32_t stack_offset = symbol_table->member_register_bytes + (int32_t)(param_index * sizeof(uint64_t));
 
-    switch (x64_op){
-    case TP_X64_ADD:
-        is_add = true;
-        break;
-    case TP_X64_SUB:
-        break;
-    default:
-        TP_PUT_LOG_MSG_ICE(symbol_table);
-        return 0;
+        // mov reg32, DWORD PTR [rsp+stack_offset]
+        return tp_encode_x64_mov_memory(
+            symbol_table, x64_code_buffer, x64_code_offset,
+            TP_X64_DIRECTION_SOURCE_MEMORY, TP_X64_OPERAND_SIZE_32,
+            reg64, TP_X64_64_REGISTER_RSP, stack_offset, TP_X64_DISP_MODE_DEFAULT
+        );
     }
 
-    bool is_imm8 = false;
+    int32_t stack_offset =
+        symbol_table->member_stack_imm32 +
+        symbol_table->member_register_bytes - stack_param_size +
+        (int32_t)(param_index * sizeof(uint64_t));
 
-    switch (x64_add_sub_imm_mode){
-    case TP_X64_ADD_SUB_IMM_MODE_DEFAULT:
-        is_imm8 = ((INT8_MIN <= imm) && (INT8_MAX >= imm));
-        break;
-    case TP_X64_ADD_SUB_IMM_MODE_FORCE_IMM32:
-        break;
-    default:
-        TP_PUT_LOG_MSG_ICE(symbol_table);
-        return 0;
-    }
+    // mov reg32, DWORD PTR [rbp+stack_offset]
+    return tp_encode_x64_mov_memory(
+        symbol_table, x64_code_buffer, x64_code_offset,
+        TP_X64_DIRECTION_SOURCE_MEMORY, TP_X64_OPERAND_SIZE_32,
+        reg64, TP_X64_64_REGISTER_RBP, stack_offset, TP_X64_DISP_MODE_DEFAULT
+    );
+}
 
-    if (is_add){
+static uint32_t encode_x64_32_register_operand(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    uint8_t opcode, TP_X64_64_REGISTER reg64, TP_X64_64_REGISTER rm64)
+{
+    // opcode reg32, r/m32(mod: 11)
+    bool is_rex = ((TP_X64_64_REGISTER_R8 <= reg64) || (TP_X64_64_REGISTER_R8 <= rm64));
 
-        is_imm8 = false;
-    }
+    uint32_t x64_code_size = 0;
 
     if (x64_code_buffer){
 
-        x64_code_buffer[x64_code_offset] = (0x48 | ((TP_X64_64_REGISTER_R8 <= reg64) ? 0x01 : 0x00));
-
-        // SUB – Integer Subtraction
-        if (is_imm8){
+        if (is_rex){
 
-            // SUB: immediate8 from qwordregister 0100 100B 1000 0011 : 11 101 qwordreg : imm8
-            x64_code_buffer[x64_code_offset + 1] = 0x83;
-            x64_code_buffer[x64_code_offset + 2] = (0xe8 | (reg64 & 0x07));
-            x64_code_buffer[x64_code_offset + 3] = (uint8_t)imm;
+            // 0100 WRXB
+            x64_code_buffer[x64_code_offset + x64_code_size] = (0x40 |
+                /* R */ ((TP_X64_64_REGISTER_R8 <= reg64) ? 0x04 : 0x00) |
+                /* B */ ((TP_X64_64_REGISTER_R8 <= rm64) ? 0x01 : 0x00)
+            );
 
             ++x64_code_size;
-        }else{
+        }
 
-            // ADD: immediate32 to qwordregister 0100 100B : 1000 0001 : 11 000 qwordreg : imm
-            // SUB: immediate32 from qwordregister 0100 100B 1000 0001 : 11 101 qwordreg : imm32
-            x64_code_buffer[x64_code_offset + 1] = 0x81;
-            x64_code_buffer[x64_code_offset + 2] = ((is_add ? 0xc0 : 0xe8) | (reg64 & 0x07));
-            memcpy(&(x64_code_buffer[x64_code_offset + 3]), &imm, sizeof(imm));
+        x64_code_buffer[x64_code_offset + x64_code_size] = opcode;
 
-            x64_code_size += 4;
-        }
+        ++x64_code_size;
+
+        // ModR/M
+        x64_code_buffer[x64_code_offset + x64_code_size] = (0xc0 | ((reg64 & 0x07) << 3) | (rm64 & 0x07));
+
+        ++x64_code_size;
     }else{
 
-        if (is_imm8){
+        if (is_rex){
 
-            // imm8
             ++x64_code_size;
-        }else{
-
-            // imm32
-            x64_code_size += 4;
         }
+
+        x64_code_size += 2;
     }
 
     return x64_code_size;
 }
 
-static uint32_t encode_x64_lea(
-    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
-    TP_X64_64_REGISTER reg64_dst_reg, TP_X64_64_REGISTER reg64_src_index, TP_X64_64_REGISTER reg64_src_base, int32_t offset)
+static uint32_t encode_x64_batch_init(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset)
 {
-    uint32_t x64_code_size = 4;
+    // void f(const int32_t* const* columns(RCX), int32_t* outputs(RDX), uint64_t row_count(R8))
+    // NOTE: The frame is built once. The loop state lives in the frame
+    // because the code body may use every general purpose register.
 
-    bool is_disp8 = ((INT8_MIN <= offset) && (INT8_MAX >= offset));
+    static const TP_X64_64_REGISTER arg_register[] = {
+        TP_X64_64_REGISTER_RCX, TP_X64_64_REGISTER_RDX, TP_X64_64_REGISTER_R8
+    };
+    static const int32_t arg_slot[] = {
+        TP_X64_BATCH_SLOT_COLUMNS, TP_X64_BATCH_SLOT_OUTPUTS, TP_X64_BATCH_SLOT_ROW_COUNT
+    };
 
-    if (x64_code_buffer){
+    int32_t slot_offset = symbol_table->member_batch_slot_offset;
 
-        // LEA - Load Effective Address : 8D /r LEA r64,m 
-        // in qwordregister 0100 1RXB : 1000 1101 : modA qwordreg r/m
-        x64_code_buffer[x64_code_offset] = (0x48 |
-            /* R */ ((TP_X64_64_REGISTER_R8 <= reg64_dst_reg) ? 0x04 : 0x00) |
-            /* X */ ((TP_X64_64_REGISTER_R8 <= reg64_src_index) ? 0x02 : 0x00) |
-            /* B */ ((TP_X64_64_REGISTER_R8 <= reg64_src_base) ? 0x01 : 0x00)
+    uint32_t x64_code_size = 0;
+    uint32_t tmp_x64_code_size = 0;
+
+    for (rsize_t i = 0; (sizeof(arg_register) / sizeof(arg_register[0])) > i; ++i){
+
+        // mov QWORD PTR [rbp+slot], reg64
+        tmp_x64_code_size = tp_encode_x64_mov_memory(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            TP_X64_DIRECTION_SOURCE_REGISTER, TP_X64_OPERAND_SIZE_64,
+            arg_register[i], TP_X64_64_REGISTER_RBP,
+            slot_offset + arg_slot[i] * (int32_t)sizeof(uint64_t), TP_X64_DISP_MODE_DEFAULT
         );
-        x64_code_buffer[x64_code_offset + 1] = 0x8d;
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
 
-        // ModR/M
-        if (0 == offset){
+    // XOR – Logical Exclusive OR
+    // xor eax, eax
+    tmp_x64_code_size = encode_x64_1_opcode(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, 0x33
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
 
-            // disp0
-            x64_code_buffer[x64_code_offset + 2] = (((reg64_dst_reg & 0x07) << 3) | 0x04);
-        }else if (is_disp8){
+    tmp_x64_code_size = encode_x64_1_opcode(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, 0xc0
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
 
-            // disp8
-            x64_code_buffer[x64_code_offset + 2] = (((reg64_dst_reg & 0x07) << 3) | 0x44);
-        }else{
+    int32_t row_index_offset = slot_offset + TP_X64_BATCH_SLOT_ROW_INDEX * (int32_t)sizeof(uint64_t);
 
-            // disp32
-            x64_code_buffer[x64_code_offset + 2] = (((reg64_dst_reg & 0x07) << 3) | 0x84);
-        }
+    // mov QWORD PTR [rbp+row_index], rax
+    tmp_x64_code_size = tp_encode_x64_mov_memory(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_DIRECTION_SOURCE_REGISTER, TP_X64_OPERAND_SIZE_64,
+        TP_X64_64_REGISTER_RAX, TP_X64_64_REGISTER_RBP, row_index_offset, TP_X64_DISP_MODE_DEFAULT
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
 
-        // SIB
-        x64_code_buffer[x64_code_offset + 3] = (((reg64_src_index & 0x07) << 3) | (reg64_src_base & 0x07));
+    return x64_code_size;
+}
 
-        if (0 == offset){
+uint32_t tp_encode_x64_jcc_rel32(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint8_t opcode, int32_t rel32)
+{
+    uint32_t x64_code_size = 6;
 
-            // disp0
-            ;
-        }else if (is_disp8){
+    if (x64_code_buffer){
 
-            // disp8
-            x64_code_buffer[x64_code_offset + 4] = (uint8_t)offset;
+        // Jcc – Jump if Condition is Met : 0F 8x cd
+        x64_code_buffer[x64_code_offset] = 0x0f;
+        x64_code_buffer[x64_code_offset + 1] = opcode;
 
-            ++x64_code_size;
-        }else{
+        memcpy(&(x64_code_buffer[x64_code_offset + 2]), &rel32, sizeof(rel32));
+    }
 
-            // disp32
-            memcpy(&(x64_code_buffer[x64_code_offset + 4]), &offset, sizeof(offset));
+    return x64_code_size;
+}
 
-            x64_code_size += 4;
-        }
-    }else{
+void tp_patch_x64_imm32(uint8_t* x64_code_buffer, uint32_t x64_code_offset, int32_t imm32)
+{
+    // NOTE: x64_code_offset is the end of the instruction: imm32(or rel32) is the last 4 bytes.
+    if (x64_code_buffer){
 
-        if (0 == offset){
+        memcpy(&(x64_code_buffer[x64_code_offset - sizeof(imm32)]), &imm32, sizeof(imm32));
+    }
+}
 
-            // disp0
-            ;
-        }else if (is_disp8){
+uint32_t tp_encode_x64_instruction(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_INSTRUCTION* x64_instruction)
+{
+    TP_WASM_STACK_ELEMENT* dst = &(x64_instruction->member_dst);
+    TP_WASM_STACK_ELEMENT* src = &(x64_instruction->member_src);
 
-            // disp8
-            ++x64_code_size;
-        }else{
+    switch (x64_instruction->member_kind){
+    case TP_X64_INSTRUCTION_KIND_2_OPERAND:
 
-            // disp32
-            x64_code_size += 4;
+        // NOTE: The memory to memory operation is not an instruction.
+        if (TP_X64_ITEM_KIND_MEMORY == dst->member_x64_item_kind){
+
+            return encode_x64_32_register_to_memory_offset(
+                symbol_table, x64_code_buffer, x64_code_offset, x64_instruction->member_x64_op, dst, src
+            );
+        }
+
+        if (TP_X64_ITEM_KIND_MEMORY == src->member_x64_item_kind){
+
+            return encode_x64_32_memory_offset_to_register(
+                symbol_table, x64_code_buffer, x64_code_offset, x64_instruction->member_x64_op, dst, src
+            );
         }
+
+        return encode_x64_32_register_to_x64_32_register(
+            symbol_table, x64_code_buffer, x64_code_offset, x64_instruction->member_x64_op, dst, src
+        );
+    case TP_X64_INSTRUCTION_KIND_MOV_IMM:
+        return encode_x64_mov_imm(
+            symbol_table, x64_code_buffer, x64_code_offset,
+            x64_instruction->member_imm, x64_instruction->member_x64_mov_imm_mode, dst
+        );
+    case TP_X64_INSTRUCTION_KIND_ALU_IMM:
+        return encode_x64_alu_imm(
+            symbol_table, x64_code_buffer, x64_code_offset,
+            x64_instruction->member_x64_op, dst, x64_instruction->member_imm
+        );
+    case TP_X64_INSTRUCTION_KIND_IMUL_IMM:
+        return encode_x64_imul_imm(
+            symbol_table, x64_code_buffer, x64_code_offset, dst, src, x64_instruction->member_imm
+        );
+    case TP_X64_INSTRUCTION_KIND_PUSH:
+        return encode_x64_push_reg64(
+            symbol_table, x64_code_buffer, x64_code_offset, x64_instruction->member_register
+        );
+    case TP_X64_INSTRUCTION_KIND_POP:
+        return encode_x64_pop_reg64(
+            symbol_table, x64_code_buffer, x64_code_offset, x64_instruction->member_register
+        );
+    case TP_X64_INSTRUCTION_KIND_SHIFT_IMM:
+        return encode_x64_shift_imm(
+            symbol_table, x64_code_buffer, x64_code_offset,
+            x64_instruction->member_x64_op, dst, (uint8_t)(x64_instruction->member_imm)
+        );
+    case TP_X64_INSTRUCTION_KIND_NEG:
+        return encode_x64_neg(symbol_table, x64_code_buffer, x64_code_offset, dst);
+    case TP_X64_INSTRUCTION_KIND_LEA_SCALE:
+        return encode_x64_lea_scale(
+            symbol_table, x64_code_buffer, x64_code_offset, dst, src, (uint8_t)(x64_instruction->member_imm)
+        );
+    case TP_X64_INSTRUCTION_KIND_MUL_HIGH:
+        return encode_x64_mul_high(
+            symbol_table, x64_code_buffer, x64_code_offset, dst, src, x64_instruction->member_imm
+        );
+    case TP_X64_INSTRUCTION_KIND_CDQ:
+        return encode_x64_cdq(symbol_table, x64_code_buffer, x64_code_offset);
+    default:
+        break;
+    }
+
+    TP_PUT_LOG_MSG_ICE(symbol_table);
+
+    return 0;
+}
+
+uint32_t tp_encode_x64_jmp_rel32(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, int32_t rel32)
+{
+    uint32_t x64_code_size = 5;
+
+    if (x64_code_buffer){
+
+        // JMP – Unconditional Jump : E9 cd JMP rel32
+        x64_code_buffer[x64_code_offset] = 0xe9;
+
+        memcpy(&(x64_code_buffer[x64_code_offset + 1]), &rel32, sizeof(rel32));
     }
 
     return x64_code_size;
@@ -1518,10 +3480,11 @@ static uint32_t encode_x64_push_reg64(
     if (x64_code_buffer){
 
         // PUSH – Push Operand onto the Stack : 50+rd push r64
-        // qwordregister (alternate encoding) 0100 W00B : 0101 0 reg64
+        // qwordregister (alternate encoding) 0100 000B : 0101 0 reg64
+        // NOTE: The operand size is 64 bits without REX.W, so REX.B only is needed for R8-R15.
         if (TP_X64_64_REGISTER_R8 <= reg64){
 
-            x64_code_buffer[x64_code_offset] = (0x48 | 0x01);
+            x64_code_buffer[x64_code_offset] = (0x40 | /* B */ 0x01);
 
             ++x64_code_size;
         }
@@ -1539,6 +3502,20 @@ static uint32_t encode_x64_push_reg64(
         ++x64_code_size;
     }
 
+    TP_X64_INSTRUCTION x64_instruction = {
+        .member_offset = x64_code_offset,
+        .member_size = x64_code_size,
+        .member_kind = TP_X64_INSTRUCTION_KIND_PUSH,
+        .member_register = reg64
+    };
+
+    if ( ! record_x64_instruction(symbol_table, x64_code_buffer, &x64_instruction)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
     return x64_code_size;
 }
 
@@ -1551,10 +3528,11 @@ static uint32_t encode_x64_pop_reg64(
     if (x64_code_buffer){
 
         // POP – Pop a Value from the Stack : REX.W + 58+rd pop r64
-        // qwordregister (alternate encoding) 0100 W00B : 0101 1 reg64
+        // qwordregister (alternate encoding) 0100 000B : 0101 1 reg64
+        // NOTE: The operand size is 64 bits without REX.W, so REX.B only is needed for R8-R15.
         if (TP_X64_64_REGISTER_R8 <= reg64){
 
-            x64_code_buffer[x64_code_offset] = (0x48 | 0x01);
+            x64_code_buffer[x64_code_offset] = (0x40 | /* B */ 0x01);
 
             ++x64_code_size;
         }
@@ -1572,6 +3550,20 @@ static uint32_t encode_x64_pop_reg64(
         ++x64_code_size;
     }
 
+    TP_X64_INSTRUCTION x64_instruction = {
+        .member_offset = x64_code_offset,
+        .member_size = x64_code_size,
+        .member_kind = TP_X64_INSTRUCTION_KIND_POP,
+        .member_register = reg64
+    };
+
+    if ( ! record_x64_instruction(symbol_table, x64_code_buffer, &x64_instruction)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
     return x64_code_size;
 }
 
@@ -1588,3 +3580,22 @@ static uint32_t encode_x64_1_opcode(
     return x64_code_size;
 }
 
+static bool record_x64_instruction(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, TP_X64_INSTRUCTION* x64_instruction)
+{
+    // NOTE: The instructions are recorded only from the first wasm opcode to END
+    // (see convert_section_code_content2x64 function).
+    if ((NULL == x64_code_buffer) || (false == symbol_table->member_is_record_x64_instruction)){
+
+        return true;
+    }
+
+    if ( ! tp_append_x64_instruction(symbol_table, x64_instruction)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,974 @@
+
+// (C) Shin'ichi Ichikawa. Released under the MIT license.
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include "tp_compiler.h"
+
+// SIMD code of batch mode:
+// The wasm code body is lowered to AVX2(8 lanes of ymm) or AVX-512F(16 lanes of zmm)
+// instructions. The vector loop processes rows while the rest rows are not less than
+// the number of lanes, and the scalar loop(see tp_encode_batch_loop_begin function)
+// processes the tail rows. The ISA is selected by CPUID and XGETBV at compile time.
+// Depth n of the wasm stack is vector register n. Local variables are vector slots of the frame.
+// Division: x64 has no packed integer division, so each half of the lanes is converted to
+// double precision. The truncated quotient of int32_t values is exact.
+// NOTE: The double precision division does not raise an exception. Before each division,
+// the lanes of a zero divisor and of INT32_MIN / -1 are checked, and if any lane matches,
+// the vector loop exits to the scalar loop. The scalar loop restarts from the first row of
+// the vector and raises the exception(#DE) at the row as the scalar code does.
+
+typedef enum tp_x64_simd_length_{
+    TP_X64_SIMD_LENGTH_128 = 0,
+    TP_X64_SIMD_LENGTH_256,
+    TP_X64_SIMD_LENGTH_512
+}TP_X64_SIMD_LENGTH;
+
+typedef enum tp_x64_simd_op_{
+    TP_X64_SIMD_OP_VMOVDQU_LOAD = 0,
+    TP_X64_SIMD_OP_VMOVDQU_STORE,
+    TP_X64_SIMD_OP_VPADDD,
+    TP_X64_SIMD_OP_VPSUBD,
+    TP_X64_SIMD_OP_VPMULLD,
+    TP_X64_SIMD_OP_VPXORD,
+    TP_X64_SIMD_OP_VMOVD,
+    TP_X64_SIMD_OP_VPBROADCASTD,
+    TP_X64_SIMD_OP_VPBROADCASTD_GPR,
+    TP_X64_SIMD_OP_VCVTDQ2PD,
+    TP_X64_SIMD_OP_VDIVPD,
+    TP_X64_SIMD_OP_VCVTTPD2DQ,
+    TP_X64_SIMD_OP_VEXTRACT_HALF,
+    TP_X64_SIMD_OP_VINSERT_HALF,
+    TP_X64_SIMD_OP_VPCMPEQD,
+    TP_X64_SIMD_OP_VPSLLD_IMM8,
+    TP_X64_SIMD_OP_VPAND,
+    TP_X64_SIMD_OP_VPOR,
+    TP_X64_SIMD_OP_VPTEST,
+    TP_X64_SIMD_OP_VPTESTNMD,
+    TP_X64_SIMD_OP_VPTERNLOGD
+}TP_X64_SIMD_OP;
+
+typedef struct tp_x64_simd_opcode_{
+    uint8_t member_pp;      // 1: 66, 2: F3
+    uint8_t member_map;     // 1: 0F, 2: 0F38, 3: 0F3A
+    uint8_t member_vex_opcode;
+    uint8_t member_evex_opcode;
+    bool member_is_evex_w1;
+}TP_X64_SIMD_OPCODE;
+
+static const TP_X64_SIMD_OPCODE simd_opcode_table[] = {
+    { 2, 1, 0x6f, 0x6f, false },    // VMOVDQU/VMOVDQU32 xmm1, xmm2/m
+    { 2, 1, 0x7f, 0x7f, false },    // VMOVDQU/VMOVDQU32 xmm2/m, xmm1
+    { 1, 1, 0xfe, 0xfe, false },    // VPADDD
+    { 1, 1, 0xfa, 0xfa, false },    // VPSUBD
+    { 1, 2, 0x40, 0x40, false },    // VPMULLD
+    { 1, 1, 0xef, 0xef, false },    // VPXOR/VPXORD
+    { 1, 1, 0x6e, 0x6e, false },    // VMOVD xmm1, r32
+    { 1, 2, 0x58, 0x58, false },    // VPBROADCASTD ymm1, xmm2
+    { 1, 2, 0x7c, 0x7c, false },    // VPBROADCASTD zmm1, r32
+    { 2, 1, 0xe6, 0xe6, false },    // VCVTDQ2PD
+    { 1, 1, 0x5e, 0x5e, true },     // VDIVPD
+    { 1, 1, 0xe6, 0xe6, true },     // VCVTTPD2DQ
+    { 1, 3, 0x39, 0x3b, true },     // VEXTRACTI128/VEXTRACTI64X4 xmm1/m, ymm2, imm8
+    { 1, 3, 0x38, 0x3a, true },     // VINSERTI128/VINSERTI64X4 ymm1, ymm2, xmm3/m, imm8
+    { 1, 1, 0x76, 0x76, false },    // VPCMPEQD ymm1, ymm2, ymm3/m or VPCMPEQD k1, zmm2, zmm3/m
+    { 1, 1, 0x72, 0x72, false },    // VPSLLD ymm1(vvvv), ymm2/m, imm8 : /6
+    { 1, 1, 0xdb, 0xdb, false },    // VPAND(AVX2 only)
+    { 1, 1, 0xeb, 0xeb, false },    // VPOR(AVX2 only)
+    { 1, 2, 0x17, 0x17, false },    // VPTEST ymm1, ymm2/m(AVX2 only)
+    { 2, 2, 0x27, 0x27, false },    // VPTESTNMD k1, zmm2, zmm3/m(AVX-512F only)
+    { 1, 3, 0x25, 0x25, false }     // VPTERNLOGD zmm1, zmm2, zmm3/m, imm8(AVX-512F only)
+};
+
+typedef struct tp_x64_simd_rm_{
+    bool member_is_memory;
+    uint8_t member_register;            // Register direct: vector or general purpose register.
+    TP_X64_64_REGISTER member_base;
+    TP_X64_64_REGISTER member_index;    // TP_X64_64_REGISTER_INDEX_NONE: no index register.
+    uint8_t member_scale;
+    int32_t member_offset;
+}TP_X64_SIMD_RM;
+
+#define TP_X64_SIMD_NO_IMM8 (-1)
+
+static volatile TP_X64_SIMD_ISA simd_isa_max = TP_X64_SIMD_ISA_AVX512;
+static volatile TP_X64_SIMD_ISA simd_isa_cpu = TP_X64_SIMD_ISA_NONE;
+static volatile bool is_simd_isa_cpu_detected = false;
+
+static TP_X64_SIMD_ISA detect_cpu_simd_isa(void);
+static void get_cpuid(uint32_t cpu_info[4], uint32_t leaf, uint32_t sub_leaf);
+static uint64_t get_xcr0(void);
+static bool is_wasm_i32_div(TP_SYMBOL_TABLE* symbol_table);
+static uint32_t encode_x64_simd_code_body(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset
+);
+static uint32_t encode_x64_simd_div(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    uint8_t dst, uint8_t src, uint8_t scratch1, uint8_t scratch2
+);
+static uint32_t encode_x64_simd_div_check(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    uint8_t dst, uint8_t src, uint8_t scratch1, uint8_t scratch2
+);
+static uint32_t encode_x64_simd_nv_register(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, TP_X64_DIRECTION x64_direction
+);
+static uint32_t encode_x64_simd_local_variable(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_SIMD_OP simd_op, uint8_t reg, uint32_t local_index
+);
+static uint32_t encode_x64_simd_3_operand(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_SIMD_LENGTH length, TP_X64_SIMD_OP simd_op, uint8_t reg, uint8_t vvvv, uint8_t rm_reg, int32_t imm8
+);
+static uint32_t encode_x64_simd_instruction(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_SIMD_ISA simd_isa, TP_X64_SIMD_LENGTH length, TP_X64_SIMD_OP simd_op,
+    uint8_t reg, uint8_t vvvv, TP_X64_SIMD_RM* rm, int32_t imm8
+);
+static uint32_t encode_x64_simd_bytes(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    uint8_t* bytes, uint32_t bytes_size
+);
+
+TP_X64_SIMD_ISA tp_get_x64_simd_isa(void)
+{
+    if ( ! is_simd_isa_cpu_detected){
+
+        simd_isa_cpu = detect_cpu_simd_isa();
+
+        is_simd_isa_cpu_detected = true;
+    }
+
+    return ((simd_isa_max < simd_isa_cpu) ? simd_isa_max : simd_isa_cpu);
+}
+
+void tp_set_x64_simd_isa_max(TP_X64_SIMD_ISA simd_isa_max_value)
+{
+    simd_isa_max = simd_isa_max_value;
+}
+
+void tp_prepare_x64_simd_code(TP_SYMBOL_TABLE* symbol_table)
+{
+    symbol_table->member_x64_simd_isa = TP_X64_SIMD_ISA_NONE;
+    symbol_table->member_simd_lane_num = 0;
+    symbol_table->member_simd_register_num = 0;
+    symbol_table->member_simd_local_variable_size = 0;
+    symbol_table->member_simd_nv_register_size = 0;
+
+    if (TP_X64_ENTRY_MODE_BATCH != symbol_table->member_x64_entry_mode){
+
+        return;
+    }
+
+    // NOTE: The wasm instructions are validated(see tp_validate_wasm_instruction).
+    uint32_t local_count =
+        symbol_table->member_wasm_instruction_param_count + symbol_table->member_wasm_instruction_var_count;
+
+    // Division needs 2 scratch registers.
+    uint32_t register_num = symbol_table->member_wasm_instruction_stack_depth_max +
+        (is_wasm_i32_div(symbol_table) ? 2 : 0);
+
+    if (TP_X64_SIMD_REGISTER_NUM < register_num){
+
+        return;
+    }
+
+    uint32_t nv_register_size = 0;
+
+    if (TP_X64_SIMD_NV_REGISTER_BEGIN < register_num){
+
+        nv_register_size = (register_num - TP_X64_SIMD_NV_REGISTER_BEGIN) * TP_X64_SIMD_NV_REGISTER_BYTES;
+    }
+
+    for (TP_X64_SIMD_ISA simd_isa = tp_get_x64_simd_isa();
+        TP_X64_SIMD_ISA_NONE != simd_isa; simd_isa = (TP_X64_SIMD_ISA)(simd_isa - 1)){
+
+        uint32_t lane_num = ((TP_X64_SIMD_ISA_AVX512 == simd_isa) ? 16 : 8);
+
+        uint32_t local_variable_size = local_count * lane_num * sizeof(int32_t);
+
+        if (TP_X64_SIMD_FRAME_SIZE_MAX < (local_variable_size + nv_register_size)){
+
+            continue;
+        }
+
+        symbol_table->member_x64_simd_isa = simd_isa;
+        symbol_table->member_simd_lane_num = lane_num;
+        symbol_table->member_simd_register_num = register_num;
+        symbol_table->member_simd_local_variable_size = local_variable_size;
+        symbol_table->member_simd_nv_register_size = nv_register_size;
+
+        return;
+    }
+}
+
+uint32_t tp_encode_x64_simd_batch_loop(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, uint32_t param_count)
+{
+    uint32_t x64_code_size = 0;
+    uint32_t tmp_x64_code_size = 0;
+
+    int32_t slot_offset = symbol_table->member_batch_slot_offset;
+    int32_t columns_offset = slot_offset + TP_X64_BATCH_SLOT_COLUMNS * (int32_t)sizeof(uint64_t);
+    int32_t outputs_offset = slot_offset + TP_X64_BATCH_SLOT_OUTPUTS * (int32_t)sizeof(uint64_t);
+    int32_t row_count_offset = slot_offset + TP_X64_BATCH_SLOT_ROW_COUNT * (int32_t)sizeof(uint64_t);
+    int32_t row_index_offset = slot_offset + TP_X64_BATCH_SLOT_ROW_INDEX * (int32_t)sizeof(uint64_t);
+
+    int32_t lane_num = (int32_t)(symbol_table->member_simd_lane_num);
+
+    // Save xmm6-xmm15.
+    tmp_x64_code_size = encode_x64_simd_nv_register(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_DIRECTION_SOURCE_REGISTER
+    );
+    x64_code_size += tmp_x64_code_size;
+
+    // Exit of the division check: jumps over JMP rel32 to the loop head.
+    if (is_wasm_i32_div(symbol_table)){
+
+        // JMP – Unconditional Jump : EB cb JMP rel8
+        uint8_t jmp_rel8[] = { 0xeb, 5 };
+
+        tmp_x64_code_size = encode_x64_simd_bytes(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, jmp_rel8, sizeof(jmp_rel8)
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        // NOTE: rel32 is patched at the loop exit.
+        tmp_x64_code_size = tp_encode_x64_jmp_rel32(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, 0
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        symbol_table->member_simd_bail_jump_offset = x64_code_offset + x64_code_size;
+    }
+
+    // Loop head.
+    symbol_table->member_simd_loop_offset = x64_code_offset + x64_code_size;
+
+    // mov rax, QWORD PTR [rbp+row_index]
+    tmp_x64_code_size = tp_encode_x64_mov_memory(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_DIRECTION_SOURCE_MEMORY, TP_X64_OPERAND_SIZE_64,
+        TP_X64_64_REGISTER_RAX, TP_X64_64_REGISTER_RBP, row_index_offset, TP_X64_DISP_MODE_DEFAULT
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    // LEA - Load Effective Address : REX.W + 8D /r LEA r64, m
+    // lea rdx, QWORD PTR [rax+lane_num]
+    tmp_x64_code_size = tp_encode_x64_memory_operand(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_OPERAND_SIZE_64, 0x8d, TP_X64_64_REGISTER_RDX,
+        TP_X64_64_REGISTER_RAX, TP_X64_64_REGISTER_INDEX_NONE, 0, lane_num, TP_X64_DISP_MODE_DEFAULT
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    // CMP – Compare Two Operands : REX.W + 3B /r CMP r64, r/m64
+    // cmp rdx, QWORD PTR [rbp+row_count]
+    tmp_x64_code_size = tp_encode_x64_memory_operand(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_OPERAND_SIZE_64, 0x3b, TP_X64_64_REGISTER_RDX,
+        TP_X64_64_REGISTER_RBP, TP_X64_64_REGISTER_INDEX_NONE, 0, row_count_offset, TP_X64_DISP_MODE_DEFAULT
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    // Jcc – Jump if Condition is Met : 0F 87 cd JA rel32
+    // NOTE: rel32 is patched at the loop exit.
+    tmp_x64_code_size = tp_encode_x64_jcc_rel32(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, 0x87, 0
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    symbol_table->member_simd_exit_jump_offset = x64_code_offset + x64_code_size;
+
+    // Columns to vector parameters: RAX is the row index.
+    for (uint32_t i = 0; param_count > i; ++i){
+
+        // mov rcx, QWORD PTR [rbp+columns]
+        tmp_x64_code_size = tp_encode_x64_mov_memory(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            TP_X64_DIRECTION_SOURCE_MEMORY, TP_X64_OPERAND_SIZE_64,
+            TP_X64_64_REGISTER_RCX, TP_X64_64_REGISTER_RBP, columns_offset, TP_X64_DISP_MODE_DEFAULT
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        // mov rcx, QWORD PTR [rcx+i*8]
+        tmp_x64_code_size = tp_encode_x64_mov_memory(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            TP_X64_DIRECTION_SOURCE_MEMORY, TP_X64_OPERAND_SIZE_64,
+            TP_X64_64_REGISTER_RCX, TP_X64_64_REGISTER_RCX,
+            (int32_t)(i * sizeof(uint64_t)), TP_X64_DISP_MODE_DEFAULT
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        // vmovdqu ymm0/zmm0, [rcx+rax*4]
+        TP_X64_SIMD_RM column = {
+            .member_is_memory = true,
+            .member_base = TP_X64_64_REGISTER_RCX,
+            .member_index = TP_X64_64_REGISTER_RAX,
+            .member_scale = 2
+        };
+
+        tmp_x64_code_size = encode_x64_simd_instruction(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            symbol_table->member_x64_simd_isa,
+            ((TP_X64_SIMD_ISA_AVX512 == symbol_table->member_x64_simd_isa) ?
+                TP_X64_SIMD_LENGTH_512 : TP_X64_SIMD_LENGTH_256),
+            TP_X64_SIMD_OP_VMOVDQU_LOAD, 0, 0, &column, TP_X64_SIMD_NO_IMM8
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+        // vmovdqu [rbp+vector_local_variable], ymm0/zmm0
+        tmp_x64_code_size = encode_x64_simd_local_variable(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            TP_X64_SIMD_OP_VMOVDQU_STORE, 0, i
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    tmp_x64_code_size = encode_x64_simd_code_body(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    // mov rcx, QWORD PTR [rbp+outputs]
+    tmp_x64_code_size = tp_encode_x64_mov_memory(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_DIRECTION_SOURCE_MEMORY, TP_X64_OPERAND_SIZE_64,
+        TP_X64_64_REGISTER_RCX, TP_X64_64_REGISTER_RBP, outputs_offset, TP_X64_DISP_MODE_DEFAULT
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    // mov rax, QWORD PTR [rbp+row_index]
+    tmp_x64_code_size = tp_encode_x64_mov_memory(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_DIRECTION_SOURCE_MEMORY, TP_X64_OPERAND_SIZE_64,
+        TP_X64_64_REGISTER_RAX, TP_X64_64_REGISTER_RBP, row_index_offset, TP_X64_DISP_MODE_DEFAULT
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    // vmovdqu [rcx+rax*4], ymm0/zmm0
+    {
+        TP_X64_SIMD_RM output = {
+            .member_is_memory = true,
+            .member_base = TP_X64_64_REGISTER_RCX,
+            .member_index = TP_X64_64_REGISTER_RAX,
+            .member_scale = 2
+        };
+
+        tmp_x64_code_size = encode_x64_simd_instruction(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            symbol_table->member_x64_simd_isa,
+            ((TP_X64_SIMD_ISA_AVX512 == symbol_table->member_x64_simd_isa) ?
+                TP_X64_SIMD_LENGTH_512 : TP_X64_SIMD_LENGTH_256),
+            TP_X64_SIMD_OP_VMOVDQU_STORE, 0, 0, &output, TP_X64_SIMD_NO_IMM8
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    // ADD – Add : REX.W + 83 /0 ib ADD r/m64, imm8
+    // add QWORD PTR [rbp+row_index], lane_num
+    tmp_x64_code_size = tp_encode_x64_memory_operand(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        TP_X64_OPERAND_SIZE_64, 0x83, TP_X64_64_REGISTER_RAX/* /0 */,
+        TP_X64_64_REGISTER_RBP, TP_X64_64_REGISTER_INDEX_NONE, 0, row_index_offset, TP_X64_DISP_MODE_DEFAULT
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    {
+        uint8_t imm8 = (uint8_t)lane_num;
+
+        tmp_x64_code_size = encode_x64_simd_bytes(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, &imm8, sizeof(imm8)
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    // JMP – Unconditional Jump : back to the loop head.
+    uint32_t jmp_end_offset = x64_code_offset + x64_code_size + 5;
+
+    tmp_x64_code_size = tp_encode_x64_jmp_rel32(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+        (int32_t)(symbol_table->member_simd_loop_offset - jmp_end_offset)
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    // Loop exit.
+    tp_patch_x64_imm32(
+        x64_code_buffer, symbol_table->member_simd_exit_jump_offset,
+        (int32_t)((x64_code_offset + x64_code_size) - symbol_table->member_simd_exit_jump_offset)
+    );
+
+    if (is_wasm_i32_div(symbol_table)){
+
+        tp_patch_x64_imm32(
+            x64_code_buffer, symbol_table->member_simd_bail_jump_offset,
+            (int32_t)((x64_code_offset + x64_code_size) - symbol_table->member_simd_bail_jump_offset)
+        );
+    }
+
+    // Restore xmm6-xmm15.
+    tmp_x64_code_size = encode_x64_simd_nv_register(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, TP_X64_DIRECTION_SOURCE_MEMORY
+    );
+    x64_code_size += tmp_x64_code_size;
+
+    // VZEROUPPER : VEX.128.0F.WIG 77
+    {
+        uint8_t vzeroupper[] = { 0xc5, 0xf8, 0x77 };
+
+        tmp_x64_code_size = encode_x64_simd_bytes(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, vzeroupper, sizeof(vzeroupper)
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    return x64_code_size;
+}
+
+static TP_X64_SIMD_ISA detect_cpu_simd_isa(void)
+{
+    uint32_t cpu_info[4] = { 0 }; // EAX, EBX, ECX, EDX
+
+    get_cpuid(cpu_info, 0, 0);
+
+    if (7 > cpu_info[0]){
+
+        return TP_X64_SIMD_ISA_NONE;
+    }
+
+    get_cpuid(cpu_info, 1, 0);
+
+    bool is_osxsave = (cpu_info[2] & (1 << 27));
+    bool is_avx = (cpu_info[2] & (1 << 28));
+
+    if ( ! (is_osxsave && is_avx)){
+
+        return TP_X64_SIMD_ISA_NONE;
+    }
+
+    // XCR0: 0x06(XMM, YMM), 0xe0(opmask, ZMM_Hi256, Hi16_ZMM)
+    uint64_t xcr0 = get_xcr0();
+
+    if (0x06 != (xcr0 & 0x06)){
+
+        return TP_X64_SIMD_ISA_NONE;
+    }
+
+    get_cpuid(cpu_info, 7, 0);
+
+    bool is_avx2 = (cpu_info[1] & (1 << 5));
+    bool is_avx512f = (cpu_info[1] & (1 << 16));
+
+    if (is_avx512f && (0xe6 == (xcr0 & 0xe6))){
+
+        return TP_X64_SIMD_ISA_AVX512;
+    }
+
+    if (is_avx2){
+
+        return TP_X64_SIMD_ISA_AVX2;
+    }
+
+    return TP_X64_SIMD_ISA_NONE;
+}
+
+static void get_cpuid(uint32_t cpu_info[4], uint32_t leaf, uint32_t sub_leaf)
+{
+#if defined(_MSC_VER)
+    __cpuidex((int*)cpu_info, (int)leaf, (int)sub_leaf);
+#else
+    __cpuid_count(leaf, sub_leaf, cpu_info[0], cpu_info[1], cpu_info[2], cpu_info[3]);
+#endif
+}
+
+static uint64_t get_xcr0(void)
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax = 0;
+    uint32_t edx = 0;
+
+    __asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+
+    return (((uint64_t)edx) << 32) | eax;
+#endif
+}
+
+static bool is_wasm_i32_div(TP_SYMBOL_TABLE* symbol_table)
+{
+    for (uint32_t i = 0; symbol_table->member_wasm_instruction_num > i; ++i){
+
+        if (TP_WASM_OPCODE_I32_DIV == symbol_table->member_wasm_instruction[i].member_wasm_opcode){
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static uint32_t encode_x64_simd_code_body(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset)
+{
+    uint32_t x64_code_size = 0;
+    uint32_t tmp_x64_code_size = 0;
+
+    TP_X64_SIMD_LENGTH length = ((TP_X64_SIMD_ISA_AVX512 == symbol_table->member_x64_simd_isa) ?
+        TP_X64_SIMD_LENGTH_512 : TP_X64_SIMD_LENGTH_256);
+
+    // Scratch registers of division.
+    uint8_t scratch1 = (uint8_t)(symbol_table->member_simd_register_num - 2);
+    uint8_t scratch2 = (uint8_t)(symbol_table->member_simd_register_num - 1);
+
+    uint8_t stack_depth = 0;
+
+    for (uint32_t i = 0; symbol_table->member_wasm_instruction_num > i; ++i){
+
+        TP_WASM_INSTRUCTION* instruction = &(symbol_table->member_wasm_instruction[i]);
+
+        uint32_t opcode = instruction->member_wasm_opcode;
+
+        switch (opcode){
+        case TP_WASM_OPCODE_GET_LOCAL:{
+
+            uint32_t local_index = instruction->member_immediate.member_local_index;
+
+            // vmovdqu ymm(n)/zmm(n), [rbp+vector_local_variable]
+            tmp_x64_code_size = encode_x64_simd_local_variable(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                TP_X64_SIMD_OP_VMOVDQU_LOAD, stack_depth, local_index
+            );
+
+            ++stack_depth;
+            break;
+        }
+        case TP_WASM_OPCODE_SET_LOCAL:
+//          break;
+        case TP_WASM_OPCODE_TEE_LOCAL:{
+
+            uint32_t local_index = instruction->member_immediate.member_local_index;
+
+            // vmovdqu [rbp+vector_local_variable], ymm(n-1)/zmm(n-1)
+            tmp_x64_code_size = encode_x64_simd_local_variable(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                TP_X64_SIMD_OP_VMOVDQU_STORE, stack_depth - 1, local_index
+            );
+
+            if (TP_WASM_OPCODE_SET_LOCAL == opcode){
+
+                --stack_depth;
+            }
+            break;
+        }
+        case TP_WASM_OPCODE_I32_CONST:{
+
+            int32_t value = instruction->member_immediate.member_i32;
+
+            // MOV – Move Data : B8+rd id MOV r32, imm32
+            // mov eax, imm32
+            uint8_t mov_eax_imm32[5] = { 0xb8 };
+
+            memcpy(&(mov_eax_imm32[1]), &value, sizeof(value));
+
+            tmp_x64_code_size = encode_x64_simd_bytes(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, mov_eax_imm32, sizeof(mov_eax_imm32)
+            );
+            TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+            if (TP_X64_SIMD_ISA_AVX512 == symbol_table->member_x64_simd_isa){
+
+                // vpbroadcastd zmm(n), eax
+                tmp_x64_code_size = encode_x64_simd_3_operand(
+                    symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                    length, TP_X64_SIMD_OP_VPBROADCASTD_GPR, stack_depth, 0, TP_X64_64_REGISTER_RAX,
+                    TP_X64_SIMD_NO_IMM8
+                );
+            }else{
+
+                // vmovd xmm(n), eax
+                tmp_x64_code_size = encode_x64_simd_3_operand(
+                    symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                    TP_X64_SIMD_LENGTH_128, TP_X64_SIMD_OP_VMOVD, stack_depth, 0, TP_X64_64_REGISTER_RAX,
+                    TP_X64_SIMD_NO_IMM8
+                );
+                TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+                // vpbroadcastd ymm(n), xmm(n)
+                tmp_x64_code_size = encode_x64_simd_3_operand(
+                    symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                    length, TP_X64_SIMD_OP_VPBROADCASTD, stack_depth, 0, stack_depth,
+                    TP_X64_SIMD_NO_IMM8
+                );
+            }
+
+            ++stack_depth;
+            break;
+        }
+        case TP_WASM_OPCODE_I32_ADD:
+            --stack_depth;
+            tmp_x64_code_size = encode_x64_simd_3_operand(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                length, TP_X64_SIMD_OP_VPADDD, stack_depth - 1, stack_depth - 1, stack_depth, TP_X64_SIMD_NO_IMM8
+            );
+            break;
+        case TP_WASM_OPCODE_I32_SUB:
+            --stack_depth;
+            tmp_x64_code_size = encode_x64_simd_3_operand(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                length, TP_X64_SIMD_OP_VPSUBD, stack_depth - 1, stack_depth - 1, stack_depth, TP_X64_SIMD_NO_IMM8
+            );
+            break;
+        case TP_WASM_OPCODE_I32_MUL:
+            --stack_depth;
+            tmp_x64_code_size = encode_x64_simd_3_operand(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                length, TP_X64_SIMD_OP_VPMULLD, stack_depth - 1, stack_depth - 1, stack_depth, TP_X64_SIMD_NO_IMM8
+            );
+            break;
+        case TP_WASM_OPCODE_I32_DIV:
+            --stack_depth;
+            tmp_x64_code_size = encode_x64_simd_div(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                stack_depth - 1, stack_depth, scratch1, scratch2
+            );
+            break;
+        case TP_WASM_OPCODE_I32_XOR:
+            --stack_depth;
+            tmp_x64_code_size = encode_x64_simd_3_operand(
+                symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+                length, TP_X64_SIMD_OP_VPXORD, stack_depth - 1, stack_depth - 1, stack_depth, TP_X64_SIMD_NO_IMM8
+            );
+            break;
+        case TP_WASM_OPCODE_END:
+            // The result is ymm0/zmm0.
+            return x64_code_size;
+        default:
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+            return 0;
+        }
+
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    TP_PUT_LOG_MSG_ICE(symbol_table);
+
+    return 0;
+}
+
+static uint32_t encode_x64_simd_div(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    uint8_t dst, uint8_t src, uint8_t scratch1, uint8_t scratch2)
+{
+    // dst = dst / src: low half and high half of the lanes are divided by double precision.
+    TP_X64_SIMD_LENGTH length = ((TP_X64_SIMD_ISA_AVX512 == symbol_table->member_x64_simd_isa) ?
+        TP_X64_SIMD_LENGTH_512 : TP_X64_SIMD_LENGTH_256);
+
+    uint32_t x64_code_size = encode_x64_simd_div_check(
+        symbol_table, x64_code_buffer, x64_code_offset, dst, src, scratch1, scratch2
+    );
+
+    if (0 == x64_code_size){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return 0;
+    }
+
+    struct{
+        TP_X64_SIMD_OP member_simd_op;
+        uint8_t member_reg;
+        uint8_t member_vvvv;
+        uint8_t member_rm;
+        int32_t member_imm8;
+    }div_code[] = {
+        // Low half.
+        { TP_X64_SIMD_OP_VCVTDQ2PD, scratch1, 0, dst, TP_X64_SIMD_NO_IMM8 },
+        { TP_X64_SIMD_OP_VCVTDQ2PD, scratch2, 0, src, TP_X64_SIMD_NO_IMM8 },
+        { TP_X64_SIMD_OP_VDIVPD, scratch1, scratch1, scratch2, TP_X64_SIMD_NO_IMM8 },
+        { TP_X64_SIMD_OP_VCVTTPD2DQ, scratch1, 0, scratch1, TP_X64_SIMD_NO_IMM8 },
+        // High half: the source operand of VEXTRACT is the reg field.
+        { TP_X64_SIMD_OP_VEXTRACT_HALF, dst, 0, scratch2, 1 },
+        { TP_X64_SIMD_OP_VCVTDQ2PD, scratch2, 0, scratch2, TP_X64_SIMD_NO_IMM8 },
+        { TP_X64_SIMD_OP_VEXTRACT_HALF, src, 0, dst, 1 },
+        { TP_X64_SIMD_OP_VCVTDQ2PD, dst, 0, dst, TP_X64_SIMD_NO_IMM8 },
+        { TP_X64_SIMD_OP_VDIVPD, scratch2, scratch2, dst, TP_X64_SIMD_NO_IMM8 },
+        { TP_X64_SIMD_OP_VCVTTPD2DQ, scratch2, 0, scratch2, TP_X64_SIMD_NO_IMM8 },
+        // dst = low half of scratch1 : scratch2
+        { TP_X64_SIMD_OP_VINSERT_HALF, dst, scratch1, scratch2, 1 }
+    };
+
+    for (rsize_t i = 0; (sizeof(div_code) / sizeof(div_code[0])) > i; ++i){
+
+        uint32_t tmp_x64_code_size = encode_x64_simd_3_operand(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            length, div_code[i].member_simd_op,
+            div_code[i].member_reg, div_code[i].member_vvvv, div_code[i].member_rm, div_code[i].member_imm8
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    return x64_code_size;
+}
+
+static uint32_t encode_x64_simd_div_check(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    uint8_t dst, uint8_t src, uint8_t scratch1, uint8_t scratch2)
+{
+    // Exits the vector loop if (0 == src) or ((INT32_MIN == dst) && (-1 == src)) in any lane.
+    bool is_avx512 = (TP_X64_SIMD_ISA_AVX512 == symbol_table->member_x64_simd_isa);
+
+    TP_X64_SIMD_LENGTH length = (is_avx512 ? TP_X64_SIMD_LENGTH_512 : TP_X64_SIMD_LENGTH_256);
+
+    struct simd_check_code_{
+        TP_X64_SIMD_OP member_simd_op;
+        uint8_t member_reg;
+        uint8_t member_vvvv;
+        uint8_t member_rm;
+        int32_t member_imm8;
+    }check_code_avx2[] = {
+        // scratch1 = -1, scratch2 = INT32_MIN
+        { TP_X64_SIMD_OP_VPCMPEQD, scratch1, scratch1, scratch1, TP_X64_SIMD_NO_IMM8 },
+        { TP_X64_SIMD_OP_VPSLLD_IMM8, 6, scratch2, scratch1, 31 },
+        // scratch1 = (-1 == src) & (INT32_MIN == dst)
+        { TP_X64_SIMD_OP_VPCMPEQD, scratch1, scratch1, src, TP_X64_SIMD_NO_IMM8 },
+        { TP_X64_SIMD_OP_VPCMPEQD, scratch2, scratch2, dst, TP_X64_SIMD_NO_IMM8 },
+        { TP_X64_SIMD_OP_VPAND, scratch1, scratch1, scratch2, TP_X64_SIMD_NO_IMM8 },
+        // scratch1 |= (0 == src)
+        { TP_X64_SIMD_OP_VPXORD, scratch2, scratch2, scratch2, TP_X64_SIMD_NO_IMM8 },
+        { TP_X64_SIMD_OP_VPCMPEQD, scratch2, scratch2, src, TP_X64_SIMD_NO_IMM8 },
+        { TP_X64_SIMD_OP_VPOR, scratch1, scratch1, scratch2, TP_X64_SIMD_NO_IMM8 },
+        { TP_X64_SIMD_OP_VPTEST, scratch1, 0, scratch1, TP_X64_SIMD_NO_IMM8 }
+    }, check_code_avx512[] = {
+        // k1 = (0 == src)
+        { TP_X64_SIMD_OP_VPTESTNMD, 1, src, src, TP_X64_SIMD_NO_IMM8 },
+        // scratch1 = -1, k2 = (-1 == src)
+        { TP_X64_SIMD_OP_VPTERNLOGD, scratch1, scratch1, scratch1, 0xff },
+        { TP_X64_SIMD_OP_VPCMPEQD, 2, src, scratch1, TP_X64_SIMD_NO_IMM8 },
+        // scratch1 = INT32_MIN, k3 = (INT32_MIN == dst)
+        { TP_X64_SIMD_OP_VPSLLD_IMM8, 6, scratch1, scratch1, 31 },
+        { TP_X64_SIMD_OP_VPCMPEQD, 3, dst, scratch1, TP_X64_SIMD_NO_IMM8 }
+    };
+
+    struct simd_check_code_* check_code = (is_avx512 ? check_code_avx512 : check_code_avx2);
+
+    rsize_t check_code_num = (is_avx512 ?
+        (sizeof(check_code_avx512) / sizeof(check_code_avx512[0])) :
+        (sizeof(check_code_avx2) / sizeof(check_code_avx2[0])));
+
+    uint32_t x64_code_size = 0;
+    uint32_t tmp_x64_code_size = 0;
+
+    for (rsize_t i = 0; check_code_num > i; ++i){
+
+        tmp_x64_code_size = encode_x64_simd_3_operand(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            length, check_code[i].member_simd_op,
+            check_code[i].member_reg, check_code[i].member_vvvv, check_code[i].member_rm, check_code[i].member_imm8
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    if (is_avx512){
+
+        // KANDW k2, k2, k3 : VEX.L1.0F.W0 41 /r
+        // KORTESTW k1, k2 : VEX.L0.0F.W0 98 /r
+        uint8_t kandw_kortestw[] = { 0xc5, 0xec, 0x41, 0xd3, 0xc5, 0xf8, 0x98, 0xca };
+
+        tmp_x64_code_size = encode_x64_simd_bytes(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, kandw_kortestw, sizeof(kandw_kortestw)
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    // Jcc – Jump if Condition is Met : 0F 85 cd JNZ rel32
+    // jnz to JMP rel32 of the loop exit.
+    uint32_t jnz_end_offset = x64_code_offset + x64_code_size + 6;
+
+    tmp_x64_code_size = tp_encode_x64_jcc_rel32(
+        symbol_table, x64_code_buffer, x64_code_offset + x64_code_size, 0x85,
+        (int32_t)((symbol_table->member_simd_bail_jump_offset - 5) - jnz_end_offset)
+    );
+    TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+
+    return x64_code_size;
+}
+
+static uint32_t encode_x64_simd_nv_register(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset, TP_X64_DIRECTION x64_direction)
+{
+    // vmovdqu [rbp+nv_register], xmm(n) or vmovdqu xmm(n), [rbp+nv_register]
+    // NOTE: The lower 128 bits of xmm6-xmm15 are non-volatile(Windows x64 calling convention).
+    uint32_t x64_code_size = 0;
+
+    for (uint32_t i = TP_X64_SIMD_NV_REGISTER_BEGIN; symbol_table->member_simd_register_num > i; ++i){
+
+        TP_X64_SIMD_RM nv_register = {
+            .member_is_memory = true,
+            .member_base = TP_X64_64_REGISTER_RBP,
+            .member_index = TP_X64_64_REGISTER_INDEX_NONE,
+            .member_offset = symbol_table->member_simd_nv_register_offset +
+                (int32_t)((i - TP_X64_SIMD_NV_REGISTER_BEGIN) * TP_X64_SIMD_NV_REGISTER_BYTES)
+        };
+
+        uint32_t tmp_x64_code_size = encode_x64_simd_instruction(
+            symbol_table, x64_code_buffer, x64_code_offset + x64_code_size,
+            TP_X64_SIMD_ISA_AVX2, TP_X64_SIMD_LENGTH_128,
+            ((TP_X64_DIRECTION_SOURCE_REGISTER == x64_direction) ?
+                TP_X64_SIMD_OP_VMOVDQU_STORE : TP_X64_SIMD_OP_VMOVDQU_LOAD),
+            (uint8_t)i, 0, &nv_register, TP_X64_SIMD_NO_IMM8
+        );
+        TP_X64_CHECK_CODE_SIZE(symbol_table, x64_code_size, tmp_x64_code_size);
+    }
+
+    return x64_code_size;
+}
+
+static uint32_t encode_x64_simd_local_variable(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_SIMD_OP simd_op, uint8_t reg, uint32_t local_index)
+{
+    TP_X64_SIMD_RM local_variable = {
+        .member_is_memory = true,
+        .member_base = TP_X64_64_REGISTER_RBP,
+        .member_index = TP_X64_64_REGISTER_INDEX_NONE,
+        .member_offset = symbol_table->member_simd_local_variable_offset +
+            (int32_t)(local_index * symbol_table->member_simd_lane_num * sizeof(int32_t))
+    };
+
+    return encode_x64_simd_instruction(
+        symbol_table, x64_code_buffer, x64_code_offset,
+        symbol_table->member_x64_simd_isa,
+        ((TP_X64_SIMD_ISA_AVX512 == symbol_table->member_x64_simd_isa) ?
+            TP_X64_SIMD_LENGTH_512 : TP_X64_SIMD_LENGTH_256),
+        simd_op, reg, 0, &local_variable, TP_X64_SIMD_NO_IMM8
+    );
+}
+
+static uint32_t encode_x64_simd_3_operand(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_SIMD_LENGTH length, TP_X64_SIMD_OP simd_op, uint8_t reg, uint8_t vvvv, uint8_t rm_reg, int32_t imm8)
+{
+    TP_X64_SIMD_RM rm = {
+        .member_is_memory = false,
+        .member_register = rm_reg
+    };
+
+    return encode_x64_simd_instruction(
+        symbol_table, x64_code_buffer, x64_code_offset,
+        symbol_table->member_x64_simd_isa, length, simd_op, reg, vvvv, &rm, imm8
+    );
+}
+
+static uint32_t encode_x64_simd_instruction(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    TP_X64_SIMD_ISA simd_isa, TP_X64_SIMD_LENGTH length, TP_X64_SIMD_OP simd_op,
+    uint8_t reg, uint8_t vvvv, TP_X64_SIMD_RM* rm, int32_t imm8)
+{
+    if ((TP_X64_SIMD_REGISTER_NUM <= reg) || (TP_X64_SIMD_REGISTER_NUM <= vvvv) ||
+        ((false == rm->member_is_memory) && (TP_X64_SIMD_REGISTER_NUM <= rm->member_register))){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return 0;
+    }
+
+    const TP_X64_SIMD_OPCODE* simd_opcode = &(simd_opcode_table[simd_op]);
+
+    bool is_evex = (TP_X64_SIMD_ISA_AVX512 == simd_isa);
+
+    uint8_t rm_reg = (rm->member_is_memory ? (uint8_t)(rm->member_base) : rm->member_register);
+
+    uint8_t r = ((reg >> 3) & 0x01);
+    uint8_t x = ((rm->member_is_memory && (TP_X64_64_REGISTER_INDEX_NONE != rm->member_index)) ?
+        (((uint8_t)(rm->member_index) >> 3) & 0x01) : 0x00);
+    uint8_t b = ((rm_reg >> 3) & 0x01);
+
+    uint8_t code[16] = { 0 };
+    uint32_t x64_code_size = 0;
+
+    if (is_evex){
+
+        // EVEX prefix: 62 P0(R X B R' 0 0 m m) P1(W v v v v 1 p p) P2(z L' L b V' a a a)
+        code[x64_code_size++] = 0x62;
+        code[x64_code_size++] = (((r ^ 0x01) << 7) | ((x ^ 0x01) << 6) | ((b ^ 0x01) << 5) | 0x10 |
+            simd_opcode->member_map);
+        code[x64_code_size++] = ((simd_opcode->member_is_evex_w1 ? 0x80 : 0x00) |
+            (((~vvvv) & 0x0f) << 3) | 0x04 | simd_opcode->member_pp);
+        code[x64_code_size++] = (((length & 0x03) << 5) | 0x08);
+        code[x64_code_size++] = simd_opcode->member_evex_opcode;
+    }else{
+
+        // 3 bytes VEX prefix: C4 (R X B m m m m m) (W v v v v L p p)
+        code[x64_code_size++] = 0xc4;
+        code[x64_code_size++] = (((r ^ 0x01) << 7) | ((x ^ 0x01) << 6) | ((b ^ 0x01) << 5) |
+            simd_opcode->member_map);
+        code[x64_code_size++] = ((((~vvvv) & 0x0f) << 3) | ((length & 0x01) << 2) | simd_opcode->member_pp);
+        code[x64_code_size++] = simd_opcode->member_vex_opcode;
+    }
+
+    if (rm->member_is_memory){
+
+        // NOTE: The base of RBP or R13 has no form of disp0.
+        bool is_disp = ((0 != rm->member_offset) || (TP_X64_64_REGISTER_RBP == (rm_reg & 0x07)));
+
+        // NOTE: disp8 of EVEX is scaled(disp8*N), so the displacement of EVEX is disp32 or none.
+        bool is_disp8 = (is_disp && (false == is_evex) &&
+            (INT8_MIN <= rm->member_offset) && (INT8_MAX >= rm->member_offset)
+        );
+
+        // NOTE: The SIB byte is needed for the index register and the base of RSP or R12.
+        bool is_sib = ((TP_X64_64_REGISTER_INDEX_NONE != rm->member_index) ||
+            (TP_X64_64_REGISTER_RSP == (rm_reg & 0x07))
+        );
+
+        // ModR/M and SIB
+        code[x64_code_size++] = ((is_disp ? (is_disp8 ? 0x40 : 0x80) : 0x00) | ((reg & 0x07) << 3) |
+            (is_sib ? 0x04 : (rm_reg & 0x07))
+        );
+
+        if (is_sib){
+
+            code[x64_code_size++] = (
+                ((rm->member_scale & 0x03) << 6) | ((rm->member_index & 0x07) << 3) | (rm_reg & 0x07)
+            );
+        }
+
+        if (is_disp8){
+
+            code[x64_code_size++] = (uint8_t)(rm->member_offset);
+        }else if (is_disp){
+
+            memcpy(&(code[x64_code_size]), &(rm->member_offset), sizeof(rm->member_offset));
+
+            x64_code_size += sizeof(rm->member_offset);
+        }
+    }else{
+
+        // ModR/M
+        code[x64_code_size++] = (0xc0 | ((reg & 0x07) << 3) | (rm_reg & 0x07));
+    }
+
+    if (TP_X64_SIMD_NO_IMM8 != imm8){
+
+        code[x64_code_size++] = (uint8_t)imm8;
+    }
+
+    return encode_x64_simd_bytes(symbol_table, x64_code_buffer, x64_code_offset, code, x64_code_size);
+}
+
+static uint32_t encode_x64_simd_bytes(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_offset,
+    uint8_t* bytes, uint32_t bytes_size)
+{
+    if (x64_code_buffer){
+
+        memcpy(&(x64_code_buffer[x64_code_offset]), bytes, bytes_size);
+    }
+
+    return bytes_size;
+}
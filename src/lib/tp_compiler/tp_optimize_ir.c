@@ -0,0 +1,675 @@
+
+// (C) Shin'ichi Ichikawa. Released under the MIT license.
+
+#include "tp_compiler.h"
+
+// Functions:
+//  (1) Pass manager: the passes of ir_pass_table are repeated in order until no instruction
+//      is changed(TP_IR_PASS_ITERATION_MAX times at most).
+//  (2) Constant folding: the constants and the algebraic identities
+//      (x + 0, x - 0, x - x, 0 - x, x * 0, x * 1, x * -1, x / 1 and -(-x)) are folded.
+//  (3) Global value numbering: the instruction of the same opcode and operands as
+//      the previous instruction is replaced by the copy of it.
+//  (4) Copy propagation: the operands are replaced by the sources of the copies.
+//  (5) Dead code elimination: the instructions which do not reach the returned value are removed.
+//  (6) Local variable allocation: the values of the multiple uses are saved to the local variables.
+//      The values of the single use are evaluated at the use(see wasm_gen_ir function of tp_make_wasm.c).
+//
+// Note:
+//  (1) The value of the constant is calculated with the wrap-around of i32 same as the wasm opcodes.
+//  (2) The division which may trap(the divisor is not a constant except 0 and -1) is not folded
+//      nor removed.
+//  (3) The local variables of the source code are not needed by the SSA IR, so member_var_count is
+//      replaced by the number of the allocated local variables.
+
+#define TP_IR_PASS_ITERATION_MAX 8
+
+typedef bool (*TP_IR_PASS_FUNC)(TP_SYMBOL_TABLE* symbol_table, uint32_t* change_num);
+
+typedef struct tp_ir_pass_{
+    char* member_name;
+    TP_IR_PASS_FUNC member_func;
+}TP_IR_PASS;
+
+typedef struct tp_ir_value_number_{
+    TP_IR_OPCODE member_opcode;
+    uint32_t member_op1;
+    uint32_t member_op2;
+    int32_t member_i32;
+    uint32_t member_value; // TP_IR_VALUE_NULL: Empty.
+}TP_IR_VALUE_NUMBER;
+
+static bool fold_ir_const_value(TP_SYMBOL_TABLE* symbol_table, uint32_t* change_num);
+static bool number_ir_value(TP_SYMBOL_TABLE* symbol_table, uint32_t* change_num);
+static bool propagate_ir_copy(TP_SYMBOL_TABLE* symbol_table, uint32_t* change_num);
+static bool eliminate_ir_dead_code(TP_SYMBOL_TABLE* symbol_table, uint32_t* change_num);
+static bool allocate_ir_local_variable(TP_SYMBOL_TABLE* symbol_table);
+static uint32_t resolve_ir_copy(TP_SYMBOL_TABLE* symbol_table, uint32_t value);
+static bool get_ir_const_value(TP_SYMBOL_TABLE* symbol_table, uint32_t value, int32_t* const_value);
+static bool is_ir_may_trap(TP_SYMBOL_TABLE* symbol_table, TP_IR_INSTRUCTION* instruction);
+static void replace_ir_instruction(
+    TP_IR_INSTRUCTION* instruction, TP_IR_OPCODE opcode, uint32_t op1, uint32_t op2, int32_t i32
+);
+
+static const TP_IR_PASS ir_pass_table[] = {
+    { "constant folding", fold_ir_const_value },
+    { "global value numbering", number_ir_value },
+    { "copy propagation", propagate_ir_copy },
+    { "dead code elimination", eliminate_ir_dead_code }
+};
+
+#define TP_IR_PASS_NUM (sizeof(ir_pass_table) / sizeof(ir_pass_table[0]))
+
+bool tp_optimize_ir(TP_SYMBOL_TABLE* symbol_table)
+{
+    if ((NULL == symbol_table->member_ir_instruction) ||
+        (symbol_table->member_ir_instruction_num <= symbol_table->member_ir_return_value)){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    uint32_t pass_change_num[TP_IR_PASS_NUM] = { 0 };
+    uint32_t iteration_num = 0;
+
+    while (TP_IR_PASS_ITERATION_MAX > iteration_num){
+
+        ++iteration_num;
+
+        bool is_changed = false;
+
+        for (size_t i = 0; TP_IR_PASS_NUM > i; ++i){
+
+            uint32_t change_num = 0;
+
+            if ( ! ir_pass_table[i].member_func(symbol_table, &change_num)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                return false;
+            }
+
+            if (change_num){
+
+                pass_change_num[i] += change_num;
+
+                is_changed = true;
+            }
+        }
+
+        if ( ! is_changed){
+
+            break;
+        }
+    }
+
+    if ( ! allocate_ir_local_variable(symbol_table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    TP_PUT_LOG_MSG(
+        symbol_table, TP_LOG_TYPE_HIDE,
+        TP_MSG_FMT("optimization of SSA IR\ninstructions: %1\niterations: %2"),
+        TP_LOG_PARAM_UINT64_VALUE(symbol_table->member_ir_instruction_num),
+        TP_LOG_PARAM_UINT64_VALUE(iteration_num)
+    );
+
+    for (size_t i = 0; TP_IR_PASS_NUM > i; ++i){
+
+        TP_PUT_LOG_MSG(
+            symbol_table, TP_LOG_TYPE_HIDE,
+            TP_MSG_FMT("%1: %2"),
+            TP_LOG_PARAM_STRING(ir_pass_table[i].member_name),
+            TP_LOG_PARAM_UINT64_VALUE(pass_change_num[i])
+        );
+    }
+
+    TP_PUT_LOG_MSG(
+        symbol_table, TP_LOG_TYPE_HIDE,
+        TP_MSG_FMT("local variables of SSA IR: %1"),
+        TP_LOG_PARAM_UINT64_VALUE(symbol_table->member_optimization_statistics.member_ir_local_variable_num)
+    );
+
+    return true;
+}
+
+static bool fold_ir_const_value(TP_SYMBOL_TABLE* symbol_table, uint32_t* change_num)
+{
+    TP_IR_INSTRUCTION* ir = symbol_table->member_ir_instruction;
+
+    for (uint32_t i = 0; symbol_table->member_ir_instruction_num > i; ++i){
+
+        TP_IR_INSTRUCTION* instruction = &(ir[i]);
+
+        uint32_t op1 = TP_IR_VALUE_NULL;
+        uint32_t op2 = TP_IR_VALUE_NULL;
+        int32_t value1 = 0;
+        int32_t value2 = 0;
+        bool is_const1 = false;
+        bool is_const2 = false;
+
+        switch (instruction->member_opcode){
+        case TP_IR_OPCODE_NEG:
+
+            op1 = resolve_ir_copy(symbol_table, instruction->member_op1);
+
+            if (get_ir_const_value(symbol_table, op1, &value1)){
+
+                replace_ir_instruction(
+                    instruction, TP_IR_OPCODE_CONST, TP_IR_VALUE_NULL, TP_IR_VALUE_NULL,
+                    (int32_t)(0 - (uint32_t)value1)
+                );
+            }else if (TP_IR_OPCODE_NEG == ir[op1].member_opcode){
+
+                replace_ir_instruction(instruction, TP_IR_OPCODE_COPY, ir[op1].member_op1, TP_IR_VALUE_NULL, 0);
+            }else{
+
+                continue;
+            }
+
+            ++(*change_num);
+
+            continue;
+        case TP_IR_OPCODE_ADD:
+//          break;
+        case TP_IR_OPCODE_SUB:
+//          break;
+        case TP_IR_OPCODE_MUL:
+//          break;
+        case TP_IR_OPCODE_DIV:
+            break;
+        default:
+            continue;
+        }
+
+        op1 = resolve_ir_copy(symbol_table, instruction->member_op1);
+        op2 = resolve_ir_copy(symbol_table, instruction->member_op2);
+
+        is_const1 = get_ir_const_value(symbol_table, op1, &value1);
+        is_const2 = get_ir_const_value(symbol_table, op2, &value2);
+
+        // NOTE: The constant operand of the commutative operators is moved to op2.
+        if (((TP_IR_OPCODE_ADD == instruction->member_opcode) || (TP_IR_OPCODE_MUL == instruction->member_opcode)) &&
+            is_const1 && ( ! is_const2)){
+
+            instruction->member_op1 = op2;
+            instruction->member_op2 = op1;
+
+            op1 = instruction->member_op1;
+            op2 = instruction->member_op2;
+
+            is_const1 = false;
+            is_const2 = true;
+            value2 = value1;
+        }
+
+        uint32_t u1 = (uint32_t)value1;
+        uint32_t u2 = (uint32_t)value2;
+
+        switch (instruction->member_opcode){
+        case TP_IR_OPCODE_ADD:
+
+            if (is_const1 && is_const2){
+
+                replace_ir_instruction(instruction, TP_IR_OPCODE_CONST, TP_IR_VALUE_NULL, TP_IR_VALUE_NULL, (int32_t)(u1 + u2));
+            }else if (is_const2 && (0 == value2)){
+
+                replace_ir_instruction(instruction, TP_IR_OPCODE_COPY, op1, TP_IR_VALUE_NULL, 0);
+            }else{
+
+                continue;
+            }
+            break;
+        case TP_IR_OPCODE_SUB:
+
+            if (is_const1 && is_const2){
+
+                replace_ir_instruction(instruction, TP_IR_OPCODE_CONST, TP_IR_VALUE_NULL, TP_IR_VALUE_NULL, (int32_t)(u1 - u2));
+            }else if (is_const2 && (0 == value2)){
+
+                replace_ir_instruction(instruction, TP_IR_OPCODE_COPY, op1, TP_IR_VALUE_NULL, 0);
+            }else if (is_const1 && (0 == value1)){
+
+                replace_ir_instruction(instruction, TP_IR_OPCODE_NEG, op2, TP_IR_VALUE_NULL, 0);
+            }else if (op1 == op2){
+
+                replace_ir_instruction(instruction, TP_IR_OPCODE_CONST, TP_IR_VALUE_NULL, TP_IR_VALUE_NULL, 0);
+            }else{
+
+                continue;
+            }
+            break;
+        case TP_IR_OPCODE_MUL:
+
+            if (is_const1 && is_const2){
+
+                replace_ir_instruction(instruction, TP_IR_OPCODE_CONST, TP_IR_VALUE_NULL, TP_IR_VALUE_NULL, (int32_t)(u1 * u2));
+            }else if (is_const2 && (0 == value2)){
+
+                replace_ir_instruction(instruction, TP_IR_OPCODE_CONST, TP_IR_VALUE_NULL, TP_IR_VALUE_NULL, 0);
+            }else if (is_const2 && (1 == value2)){
+
+                replace_ir_instruction(instruction, TP_IR_OPCODE_COPY, op1, TP_IR_VALUE_NULL, 0);
+            }else if (is_const2 && (-1 == value2)){
+
+                replace_ir_instruction(instruction, TP_IR_OPCODE_NEG, op1, TP_IR_VALUE_NULL, 0);
+            }else{
+
+                continue;
+            }
+            break;
+        case TP_IR_OPCODE_DIV:
+
+            // NOTE: The division by zero and INT32_MIN / -1 are not folded(the trap occurs at run time).
+            if (is_const1 && is_const2 && (0 != value2) && ( ! ((INT32_MIN == value1) && (-1 == value2)))){
+
+                replace_ir_instruction(instruction, TP_IR_OPCODE_CONST, TP_IR_VALUE_NULL, TP_IR_VALUE_NULL, value1 / value2);
+            }else if (is_const2 && (1 == value2)){
+
+                replace_ir_instruction(instruction, TP_IR_OPCODE_COPY, op1, TP_IR_VALUE_NULL, 0);
+            }else{
+
+                continue;
+            }
+            break;
+        default:
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return false;
+        }
+
+        ++(*change_num);
+    }
+
+    symbol_table->member_optimization_statistics.member_ir_folded_num += *change_num;
+
+    return true;
+}
+
+static bool number_ir_value(TP_SYMBOL_TABLE* symbol_table, uint32_t* change_num)
+{
+    uint32_t instruction_num = symbol_table->member_ir_instruction_num;
+
+    uint32_t hash_table_size = 1;
+
+    while (hash_table_size < (instruction_num * 2)){
+
+        hash_table_size <<= 1;
+
+        if (0 == hash_table_size){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return false;
+        }
+    }
+
+    TP_IR_VALUE_NUMBER* hash_table = (TP_IR_VALUE_NUMBER*)TP_CALLOC(symbol_table, hash_table_size, sizeof(TP_IR_VALUE_NUMBER));
+
+    if (NULL == hash_table){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    for (uint32_t i = 0; hash_table_size > i; ++i){
+
+        hash_table[i].member_value = TP_IR_VALUE_NULL;
+    }
+
+    TP_IR_INSTRUCTION* ir = symbol_table->member_ir_instruction;
+
+    for (uint32_t i = 0; instruction_num > i; ++i){
+
+        TP_IR_INSTRUCTION* instruction = &(ir[i]);
+
+        TP_IR_OPCODE opcode = instruction->member_opcode;
+        uint32_t op1 = TP_IR_VALUE_NULL;
+        uint32_t op2 = TP_IR_VALUE_NULL;
+        int32_t i32 = 0;
+
+        switch (opcode){
+        case TP_IR_OPCODE_PARAM:
+//          break;
+        case TP_IR_OPCODE_CONST:
+            i32 = instruction->member_i32;
+            break;
+        case TP_IR_OPCODE_NEG:
+            op1 = resolve_ir_copy(symbol_table, instruction->member_op1);
+            break;
+        case TP_IR_OPCODE_ADD:
+//          break;
+        case TP_IR_OPCODE_MUL:
+            op1 = resolve_ir_copy(symbol_table, instruction->member_op1);
+            op2 = resolve_ir_copy(symbol_table, instruction->member_op2);
+
+            // NOTE: The operands of the commutative operators are sorted.
+            if (op1 > op2){
+
+                uint32_t tmp_op = op1;
+                op1 = op2;
+                op2 = tmp_op;
+            }
+            break;
+        case TP_IR_OPCODE_SUB:
+//          break;
+        case TP_IR_OPCODE_DIV:
+            op1 = resolve_ir_copy(symbol_table, instruction->member_op1);
+            op2 = resolve_ir_copy(symbol_table, instruction->member_op2);
+            break;
+        default:
+            continue;
+        }
+
+        uint32_t hash = (uint32_t)opcode * 0x9E3779B9;
+        hash = (hash ^ op1) * 0x85EBCA6B;
+        hash = (hash ^ op2) * 0xC2B2AE35;
+        hash = (hash ^ (uint32_t)i32) * 0x9E3779B9;
+
+        uint32_t mask = hash_table_size - 1;
+
+        for (uint32_t index = (hash >> 16) & mask; ; index = (index + 1) & mask){
+
+            TP_IR_VALUE_NUMBER* value_number = &(hash_table[index]);
+
+            if (TP_IR_VALUE_NULL == value_number->member_value){
+
+                value_number->member_opcode = opcode;
+                value_number->member_op1 = op1;
+                value_number->member_op2 = op2;
+                value_number->member_i32 = i32;
+                value_number->member_value = i;
+
+                break;
+            }
+
+            if ((opcode == value_number->member_opcode) &&
+                (op1 == value_number->member_op1) && (op2 == value_number->member_op2) &&
+                (i32 == value_number->member_i32)){
+
+                replace_ir_instruction(instruction, TP_IR_OPCODE_COPY, value_number->member_value, TP_IR_VALUE_NULL, 0);
+
+                ++(*change_num);
+
+                break;
+            }
+        }
+    }
+
+    TP_FREE(symbol_table, &hash_table, hash_table_size * sizeof(TP_IR_VALUE_NUMBER));
+
+    symbol_table->member_optimization_statistics.member_ir_numbered_num += *change_num;
+
+    return true;
+}
+
+static bool propagate_ir_copy(TP_SYMBOL_TABLE* symbol_table, uint32_t* change_num)
+{
+    TP_IR_INSTRUCTION* ir = symbol_table->member_ir_instruction;
+
+    for (uint32_t i = 0; symbol_table->member_ir_instruction_num > i; ++i){
+
+        TP_IR_INSTRUCTION* instruction = &(ir[i]);
+
+        if ((TP_IR_OPCODE_NOP == instruction->member_opcode) || (TP_IR_OPCODE_COPY == instruction->member_opcode)){
+
+            continue;
+        }
+
+        uint32_t op1 = resolve_ir_copy(symbol_table, instruction->member_op1);
+        uint32_t op2 = resolve_ir_copy(symbol_table, instruction->member_op2);
+
+        if (op1 != instruction->member_op1){
+
+            instruction->member_op1 = op1;
+
+            ++(*change_num);
+        }
+
+        if (op2 != instruction->member_op2){
+
+            instruction->member_op2 = op2;
+
+            ++(*change_num);
+        }
+    }
+
+    uint32_t return_value = resolve_ir_copy(symbol_table, symbol_table->member_ir_return_value);
+
+    if (return_value != symbol_table->member_ir_return_value){
+
+        symbol_table->member_ir_return_value = return_value;
+
+        ++(*change_num);
+    }
+
+    return true;
+}
+
+static bool eliminate_ir_dead_code(TP_SYMBOL_TABLE* symbol_table, uint32_t* change_num)
+{
+    uint32_t instruction_num = symbol_table->member_ir_instruction_num;
+
+    bool* is_live = (bool*)TP_CALLOC(symbol_table, instruction_num + 1, sizeof(bool));
+
+    if (NULL == is_live){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    TP_IR_INSTRUCTION* ir = symbol_table->member_ir_instruction;
+
+    is_live[symbol_table->member_ir_return_value] = true;
+
+    for (uint32_t i = 0; instruction_num > i; ++i){
+
+        if (is_ir_may_trap(symbol_table, &(ir[i]))){
+
+            is_live[i] = true;
+        }
+    }
+
+    // NOTE: The operands precede the instruction.
+    for (uint32_t i = instruction_num; 0 < i; --i){
+
+        TP_IR_INSTRUCTION* instruction = &(ir[i - 1]);
+
+        if (TP_IR_OPCODE_NOP == instruction->member_opcode){
+
+            continue;
+        }
+
+        if ( ! is_live[i - 1]){
+
+            replace_ir_instruction(instruction, TP_IR_OPCODE_NOP, TP_IR_VALUE_NULL, TP_IR_VALUE_NULL, 0);
+
+            ++(*change_num);
+
+            continue;
+        }
+
+        if (TP_IR_VALUE_NULL != instruction->member_op1){
+
+            is_live[instruction->member_op1] = true;
+        }
+
+        if (TP_IR_VALUE_NULL != instruction->member_op2){
+
+            is_live[instruction->member_op2] = true;
+        }
+    }
+
+    TP_FREE(symbol_table, &is_live, (instruction_num + 1) * sizeof(bool));
+
+    symbol_table->member_optimization_statistics.member_ir_removed_num += *change_num;
+
+    return true;
+}
+
+static bool allocate_ir_local_variable(TP_SYMBOL_TABLE* symbol_table)
+{
+    uint32_t instruction_num = symbol_table->member_ir_instruction_num;
+
+    // NOTE: The depth of the wasm value stack to evaluate the value at the use.
+    uint32_t* stack_depth = (uint32_t*)TP_CALLOC(symbol_table, instruction_num + 1, sizeof(uint32_t));
+
+    if (NULL == stack_depth){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    TP_IR_INSTRUCTION* ir = symbol_table->member_ir_instruction;
+
+    for (uint32_t i = 0; instruction_num > i; ++i){
+
+        ir[i].member_use_count = 0;
+        ir[i].member_local_index = TP_IR_VALUE_NULL;
+    }
+
+    for (uint32_t i = 0; instruction_num > i; ++i){
+
+        if (TP_IR_VALUE_NULL != ir[i].member_op1){
+
+            ++(ir[ir[i].member_op1].member_use_count);
+        }
+
+        if (TP_IR_VALUE_NULL != ir[i].member_op2){
+
+            ++(ir[ir[i].member_op2].member_use_count);
+        }
+    }
+
+    ++(ir[symbol_table->member_ir_return_value].member_use_count);
+
+    bool is_allocate_success = false;
+
+    // NOTE: The local variables follow the parameters.
+    uint32_t local_index = symbol_table->member_param_count;
+
+    for (uint32_t i = 0; instruction_num > i; ++i){
+
+        TP_IR_INSTRUCTION* instruction = &(ir[i]);
+
+        uint32_t depth1 = 0;
+        uint32_t depth2 = 0;
+
+        switch (instruction->member_opcode){
+        case TP_IR_OPCODE_NOP:
+            continue;
+        case TP_IR_OPCODE_PARAM:
+//          break;
+        case TP_IR_OPCODE_CONST:
+            // NOTE: The parameters and the constants are not saved to the local variables.
+            stack_depth[i] = 1;
+            continue;
+        case TP_IR_OPCODE_NEG:
+            // NOTE: i32.const 0, op1 and i32.sub.
+            depth1 = stack_depth[instruction->member_op1];
+            stack_depth[i] = depth1 + 1;
+            break;
+        case TP_IR_OPCODE_ADD:
+//          break;
+        case TP_IR_OPCODE_SUB:
+//          break;
+        case TP_IR_OPCODE_MUL:
+//          break;
+        case TP_IR_OPCODE_DIV:
+            depth1 = stack_depth[instruction->member_op1];
+            depth2 = stack_depth[instruction->member_op2] + 1;
+            stack_depth[i] = ((depth1 > depth2) ? depth1 : depth2);
+            break;
+        default:
+            // NOTE: The copies are removed by copy propagation and dead code elimination.
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+            goto error_proc;
+        }
+
+        // NOTE: The value of no use is the division which may trap.
+        if ((1 != instruction->member_use_count) || (TP_IR_WASM_STACK_DEPTH_MAX < stack_depth[i])){
+
+            instruction->member_local_index = local_index;
+
+            ++local_index;
+
+            stack_depth[i] = 1;
+        }
+    }
+
+    symbol_table->member_var_count = local_index - symbol_table->member_param_count;
+
+    symbol_table->member_optimization_statistics.member_ir_local_variable_num = symbol_table->member_var_count;
+
+    is_allocate_success = true;
+
+error_proc:
+    TP_FREE(symbol_table, &stack_depth, (instruction_num + 1) * sizeof(uint32_t));
+
+    return is_allocate_success;
+}
+
+static uint32_t resolve_ir_copy(TP_SYMBOL_TABLE* symbol_table, uint32_t value)
+{
+    if (TP_IR_VALUE_NULL == value){
+
+        return value;
+    }
+
+    TP_IR_INSTRUCTION* ir = symbol_table->member_ir_instruction;
+
+    while (TP_IR_OPCODE_COPY == ir[value].member_opcode){
+
+        value = ir[value].member_op1;
+    }
+
+    return value;
+}
+
+static bool get_ir_const_value(TP_SYMBOL_TABLE* symbol_table, uint32_t value, int32_t* const_value)
+{
+    TP_IR_INSTRUCTION* instruction = &(symbol_table->member_ir_instruction[value]);
+
+    if (TP_IR_OPCODE_CONST != instruction->member_opcode){
+
+        return false;
+    }
+
+    *const_value = instruction->member_i32;
+
+    return true;
+}
+
+static bool is_ir_may_trap(TP_SYMBOL_TABLE* symbol_table, TP_IR_INSTRUCTION* instruction)
+{
+    if (TP_IR_OPCODE_DIV != instruction->member_opcode){
+
+        return false;
+    }
+
+    int32_t value = 0;
+
+    if ( ! get_ir_const_value(symbol_table, resolve_ir_copy(symbol_table, instruction->member_op2), &value)){
+
+        return true;
+    }
+
+    return (0 == value) || (-1 == value);
+}
+
+static void replace_ir_instruction(
+    TP_IR_INSTRUCTION* instruction, TP_IR_OPCODE opcode, uint32_t op1, uint32_t op2, int32_t i32)
+{
+    instruction->member_opcode = opcode;
+    instruction->member_op1 = op1;
+    instruction->member_op2 = op2;
+    instruction->member_i32 = i32;
+}
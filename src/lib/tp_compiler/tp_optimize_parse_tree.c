@@ -0,0 +1,1338 @@
+// (C) Shin'ichi Ichikawa. Released under the MIT license.
+
+#include "tp_compiler.h"
+
+// Functions:
+//  (1) Constant folding: the constant subtrees are replaced by constants.
+//  (2) Constant propagation: the variables of the known values are replaced by constants
+//      in the later statements.
+//  (3) Dead statement elimination: the statements of the variables which do not reach
+//      the returned value(the value of the last statement) are removed.
+//  (4) Common subexpression elimination: the value numbers of the expressions are calculated
+//      by the hash table over the straight-line program. The first computation of the repeated
+//      value is saved by tee_local, and the later computations are replaced by get_local.
+//
+// Note:
+//  (1) The value of the constant is calculated with the wrap-around of i32 same as the wasm opcodes.
+//  (2) The division by zero and INT32_MIN / -1 are not folded(the trap occurs at run time).
+//  (3) The dead statement which may trap(the divisor is not a constant except 0 and -1) is not removed.
+//  (4) The temporary variables of the common subexpressions are appended to the local variables
+//      (member_var_count is increased).
+
+typedef struct tp_const_value_{
+    bool member_is_const;
+    int32_t member_value;
+}TP_CONST_VALUE;
+
+typedef enum TP_VALUE_NUMBER_KIND_
+{
+    TP_VALUE_NUMBER_KIND_NONE = 0,
+    TP_VALUE_NUMBER_KIND_CONST,
+    TP_VALUE_NUMBER_KIND_LOCAL, // The value of the parameter or the initial value of the variable.
+    TP_VALUE_NUMBER_KIND_NEG,
+    TP_VALUE_NUMBER_KIND_ADD,
+    TP_VALUE_NUMBER_KIND_SUB,
+    TP_VALUE_NUMBER_KIND_MUL,
+    TP_VALUE_NUMBER_KIND_DIV
+}TP_VALUE_NUMBER_KIND;
+
+typedef struct tp_value_number_{
+    TP_VALUE_NUMBER_KIND member_kind;
+    uint32_t member_op1;
+    uint32_t member_op2;
+    uint32_t member_value_number;
+}TP_VALUE_NUMBER;
+
+typedef struct tp_value_number_table_{
+    TP_VALUE_NUMBER* member_hash_table;
+    uint32_t member_hash_table_size; // Power of 2.
+    uint32_t member_value_number_num;
+    uint32_t* member_local_value_number; // Current value numbers of the local variables(0: Not calculated yet).
+    TP_PARSE_TREE** member_first_computation; // Indexed by the value number.
+}TP_VALUE_NUMBER_TABLE;
+
+static bool optimize_statement(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_CONST_VALUE* const_value
+);
+static bool fold_const_value(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE** parse_tree, TP_CONST_VALUE* const_value,
+    bool* is_const, int32_t* value
+);
+static bool fold_const_value_binary_operator(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_CONST_VALUE* const_value,
+    bool* is_const, int32_t* value
+);
+static bool fold_const_value_factor(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_CONST_VALUE* const_value,
+    bool* is_const, int32_t* value
+);
+static bool calc_const_value(TP_SYMBOL operator_symbol, int32_t op1, int32_t op2, int32_t* value);
+static bool replace_const_value(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE** parse_tree, int32_t value);
+static TP_TOKEN* get_first_token(TP_PARSE_TREE* parse_tree);
+static bool eliminate_dead_statement(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE** parse_tree, bool* is_live);
+static bool set_live_variable(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, bool* is_live);
+static bool is_may_trap(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree);
+static bool get_const_factor(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, int32_t* value);
+static bool eliminate_common_subexpression(TP_SYMBOL_TABLE* symbol_table);
+static uint32_t count_parse_tree(TP_PARSE_TREE* parse_tree);
+static bool calc_value_number_statement(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_VALUE_NUMBER_TABLE* table
+);
+static bool calc_value_number_expression(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_VALUE_NUMBER_TABLE* table
+);
+static bool calc_value_number_factor(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_VALUE_NUMBER_TABLE* table
+);
+static bool get_value_number(
+    TP_SYMBOL_TABLE* symbol_table, TP_VALUE_NUMBER_TABLE* table,
+    TP_VALUE_NUMBER_KIND kind, uint32_t op1, uint32_t op2, uint32_t* value_number
+);
+static bool replace_common_subexpression(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_VALUE_NUMBER_TABLE* table
+);
+static bool is_common_subexpression(TP_PARSE_TREE* parse_tree);
+
+bool tp_optimize_parse_tree(TP_SYMBOL_TABLE* symbol_table)
+{
+    // Calculated by semantic analysis.
+    uint32_t local_num = symbol_table->member_param_count + symbol_table->member_var_count;
+
+    TP_CONST_VALUE* const_value = (TP_CONST_VALUE*)TP_CALLOC(symbol_table, local_num + 1, sizeof(TP_CONST_VALUE));
+
+    if (NULL == const_value){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    // NOTE: The parameters are not known values.
+    bool is_optimize_success = optimize_statement(symbol_table, symbol_table->member_tp_parse_tree, const_value);
+
+    TP_FREE(symbol_table, &const_value, (local_num + 1) * sizeof(TP_CONST_VALUE));
+
+    if ( ! is_optimize_success){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    bool* is_live = (bool*)TP_CALLOC(symbol_table, local_num + 1, sizeof(bool));
+
+    if (NULL == is_live){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    // NOTE: The live variables are empty after the last statement.
+    is_optimize_success = eliminate_dead_statement(symbol_table, &(symbol_table->member_tp_parse_tree), is_live);
+
+    TP_FREE(symbol_table, &is_live, (local_num + 1) * sizeof(bool));
+
+    if ( ! is_optimize_success){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if (NULL == symbol_table->member_tp_parse_tree){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! eliminate_common_subexpression(symbol_table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    TP_OPTIMIZATION_STATISTICS* statistics = &(symbol_table->member_optimization_statistics);
+
+    TP_PUT_LOG_MSG(
+        symbol_table, TP_LOG_TYPE_HIDE,
+        TP_MSG_FMT(
+            "optimization of parse tree\n"
+            "removed dead statements: %1\n"
+            "eliminated common subexpressions: %2\n"
+            "temporary variables of common subexpressions: %3"
+        ),
+        TP_LOG_PARAM_UINT64_VALUE(statistics->member_removed_dead_statement_num),
+        TP_LOG_PARAM_UINT64_VALUE(statistics->member_eliminated_common_subexpression_num),
+        TP_LOG_PARAM_UINT64_VALUE(statistics->member_common_subexpression_variable_num)
+    );
+
+    return true;
+}
+
+static bool optimize_statement(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_CONST_VALUE* const_value)
+{
+    switch (parse_tree->member_grammer){
+    // Grammer: Program -> Statement+
+    case TP_PARSE_TREE_GRAMMER_PROGRAM:
+
+        // NOTE: The statements are visited in order of the source code.
+        for (size_t i = 0; parse_tree->member_element_num > i; ++i){
+
+            if (TP_PARSE_TREE_TYPE_NODE != parse_tree->member_element[i].member_type){
+
+                TP_PUT_LOG_MSG_ICE(symbol_table);
+
+                return false;
+            }
+
+            if ( ! optimize_statement(symbol_table, parse_tree->member_element[i].member_body.member_child, const_value)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                return false;
+            }
+        }
+        return true;
+    // Grammer: Statement -> variable '=' Expression ';'
+    case TP_PARSE_TREE_GRAMMER_STATEMENT_1:
+//      break;
+    // Grammer: Statement -> Type variable '=' Expression ';'
+    case TP_PARSE_TREE_GRAMMER_STATEMENT_2:
+        break;
+    default:
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    size_t element_num = parse_tree->member_element_num;
+
+    if (((TP_PARSE_TREE_GRAMMER_STATEMENT_1 == parse_tree->member_grammer) &&
+        (symbol_table->member_grammer_statement_1_num != element_num)) ||
+        ((TP_PARSE_TREE_GRAMMER_STATEMENT_2 == parse_tree->member_grammer) &&
+        (symbol_table->member_grammer_statement_2_num != element_num))){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    TP_PARSE_TREE_ELEMENT* variable = &(parse_tree->member_element[element_num - 4]);
+    TP_PARSE_TREE_ELEMENT* expression = &(parse_tree->member_element[element_num - 2]);
+
+    if ((TP_PARSE_TREE_TYPE_TOKEN != variable->member_type) || (TP_PARSE_TREE_TYPE_NODE != expression->member_type)){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    uint32_t local_index = 0;
+
+    if ( ! tp_get_local_index(symbol_table, variable->member_body.member_tp_token, &local_index)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    bool is_const = false;
+    int32_t value = 0;
+
+    if ( ! fold_const_value(symbol_table, &(expression->member_body.member_child), const_value, &is_const, &value)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if (is_const){
+
+        if ( ! replace_const_value(symbol_table, &(expression->member_body.member_child), value)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+    }
+
+    const_value[local_index].member_is_const = is_const;
+    const_value[local_index].member_value = value;
+
+    return true;
+}
+
+static bool fold_const_value(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE** parse_tree, TP_CONST_VALUE* const_value,
+    bool* is_const, int32_t* value)
+{
+    *is_const = false;
+    *value = 0;
+
+    switch ((*parse_tree)->member_grammer){
+    // Grammer: Expression -> Term (('+' | '-') Term)*
+    case TP_PARSE_TREE_GRAMMER_EXPRESSION_1:
+//      break;
+    case TP_PARSE_TREE_GRAMMER_EXPRESSION_2:
+//      break;
+    // Grammer: Term -> Factor (('*' | '/') Factor)*
+    case TP_PARSE_TREE_GRAMMER_TERM_1:
+//      break;
+    case TP_PARSE_TREE_GRAMMER_TERM_2:
+        return fold_const_value_binary_operator(symbol_table, *parse_tree, const_value, is_const, value);
+    // Grammer: Factor -> '(' Expression ')'
+    case TP_PARSE_TREE_GRAMMER_FACTOR_1:
+
+        if ((symbol_table->member_grammer_factor_1_num != (*parse_tree)->member_element_num) ||
+            (TP_PARSE_TREE_TYPE_NODE != (*parse_tree)->member_element[1].member_type)){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return false;
+        }
+
+        // NOTE: The constant expression in parens is replaced by the parent of it.
+        return fold_const_value(
+            symbol_table, &((*parse_tree)->member_element[1].member_body.member_child), const_value, is_const, value
+        );
+    // Grammer: Factor -> ('+' | '-')? (variable | constant)
+    case TP_PARSE_TREE_GRAMMER_FACTOR_2:
+//      break;
+    case TP_PARSE_TREE_GRAMMER_FACTOR_3:
+        return fold_const_value_factor(symbol_table, *parse_tree, const_value, is_const, value);
+    default:
+        break;
+    }
+
+    TP_PUT_LOG_MSG_ICE(symbol_table);
+
+    return false;
+}
+
+static bool fold_const_value_binary_operator(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_CONST_VALUE* const_value,
+    bool* is_const, int32_t* value)
+{
+    // Grammer: (Expression | Term) ('+' | '-' | '*' | '/') (Term | Factor)
+
+    if ((3 != parse_tree->member_element_num) ||
+        (TP_PARSE_TREE_TYPE_NODE != parse_tree->member_element[0].member_type) ||
+        (TP_PARSE_TREE_TYPE_TOKEN != parse_tree->member_element[1].member_type) ||
+        (TP_PARSE_TREE_TYPE_NODE != parse_tree->member_element[2].member_type)){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    TP_PARSE_TREE** op1_tree = &(parse_tree->member_element[0].member_body.member_child);
+    TP_PARSE_TREE** op2_tree = &(parse_tree->member_element[2].member_body.member_child);
+
+    bool is_const_op1 = false;
+    int32_t op1 = 0;
+    bool is_const_op2 = false;
+    int32_t op2 = 0;
+
+    if ( ! fold_const_value(symbol_table, op1_tree, const_value, &is_const_op1, &op1)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! fold_const_value(symbol_table, op2_tree, const_value, &is_const_op2, &op2)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if (is_const_op1 && is_const_op2 &&
+        calc_const_value(parse_tree->member_element[1].member_body.member_tp_token->member_symbol, op1, op2, value)){
+
+        *is_const = true;
+
+        return true;
+    }
+
+    // NOTE: The largest constant subtrees are replaced by constants.
+    if (is_const_op1){
+
+        if ( ! replace_const_value(symbol_table, op1_tree, op1)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+    }
+
+    if (is_const_op2){
+
+        if ( ! replace_const_value(symbol_table, op2_tree, op2)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool fold_const_value_factor(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_CONST_VALUE* const_value,
+    bool* is_const, int32_t* value)
+{
+    // Factor -> ('+' | '-')? (variable | constant)
+
+    bool is_minus = false;
+    TP_TOKEN* token = NULL;
+
+    if (TP_PARSE_TREE_GRAMMER_FACTOR_2 == parse_tree->member_grammer){
+
+        if ((symbol_table->member_grammer_factor_2_num != parse_tree->member_element_num) ||
+            (TP_PARSE_TREE_TYPE_TOKEN != parse_tree->member_element[0].member_type) ||
+            (TP_PARSE_TREE_TYPE_TOKEN != parse_tree->member_element[1].member_type)){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return false;
+        }
+
+        is_minus = IS_TOKEN_MINUS(parse_tree->member_element[0].member_body.member_tp_token);
+        token = parse_tree->member_element[1].member_body.member_tp_token;
+    }else{
+
+        if ((symbol_table->member_grammer_factor_3_num != parse_tree->member_element_num) ||
+            (TP_PARSE_TREE_TYPE_TOKEN != parse_tree->member_element[0].member_type)){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return false;
+        }
+
+        token = parse_tree->member_element[0].member_body.member_tp_token;
+    }
+
+    int32_t tmp_value = 0;
+
+    if (IS_TOKEN_CONST_VALUE(token)){
+
+        tmp_value = token->member_i32_value;
+    }else{
+
+        uint32_t local_index = 0;
+
+        if ( ! tp_get_local_index(symbol_table, token, &local_index)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        if ( ! const_value[local_index].member_is_const){
+
+            return true;
+        }
+
+        tmp_value = const_value[local_index].member_value;
+    }
+
+    *is_const = true;
+    *value = (is_minus ? (int32_t)(0 - (uint32_t)tmp_value) : tmp_value);
+
+    return true;
+}
+
+static bool calc_const_value(TP_SYMBOL operator_symbol, int32_t op1, int32_t op2, int32_t* value)
+{
+    switch (operator_symbol){
+    case TP_SYMBOL_PLUS:
+        *value = (int32_t)((uint32_t)op1 + (uint32_t)op2);
+        return true;
+    case TP_SYMBOL_MINUS:
+        *value = (int32_t)((uint32_t)op1 - (uint32_t)op2);
+        return true;
+    case TP_SYMBOL_MUL:
+        *value = (int32_t)((uint32_t)op1 * (uint32_t)op2);
+        return true;
+    case TP_SYMBOL_DIV:
+
+        if ((0 == op2) || ((INT32_MIN == op1) && (-1 == op2))){
+
+            return false;
+        }
+
+        *value = op1 / op2;
+        return true;
+    default:
+        break;
+    }
+
+    return false;
+}
+
+static bool replace_const_value(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE** parse_tree, int32_t value)
+{
+    // NOTE: The constant factor is made of one wasm opcode(i32.const).
+    if ((TP_PARSE_TREE_GRAMMER_FACTOR_2 == (*parse_tree)->member_grammer) ||
+        (TP_PARSE_TREE_GRAMMER_FACTOR_3 == (*parse_tree)->member_grammer)){
+
+        if (IS_TOKEN_CONST_VALUE((*parse_tree)->member_element[(*parse_tree)->member_element_num - 1].member_body.member_tp_token)){
+
+            return true;
+        }
+    }
+
+    // NOTE: The token of the replaced subtree is reused, because the tokens are not freed
+    // until the end of compile(see tp_free_parse_subtree). member_string is not changed,
+    // because the object hash refers it.
+    TP_TOKEN* token = get_first_token(*parse_tree);
+
+    if (NULL == token){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    TP_PARSE_TREE* const_value = (TP_PARSE_TREE*)TP_CALLOC(symbol_table, 1, sizeof(TP_PARSE_TREE));
+
+    if (NULL == const_value){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    // Grammer: Factor -> constant(same as make_parse_subtree function).
+    const_value->member_grammer = TP_PARSE_TREE_GRAMMER_FACTOR_3;
+    const_value->member_element_num = 1;
+    const_value->member_element = (TP_PARSE_TREE_ELEMENT*)TP_CALLOC(symbol_table, 1 + 1, sizeof(TP_PARSE_TREE));
+
+    if (NULL == const_value->member_element){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        TP_FREE(symbol_table, &const_value, sizeof(TP_PARSE_TREE));
+
+        return false;
+    }
+
+    const_value->member_element[0].member_type = TP_PARSE_TREE_TYPE_TOKEN;
+    const_value->member_element[0].member_body.member_tp_token = token;
+    const_value->member_element[1].member_type = TP_PARSE_TREE_TYPE_NULL;
+    const_value->member_element[1].member_body.member_tp_token = NULL;
+
+    token->member_symbol = TP_SYMBOL_CONST_VALUE;
+    token->member_symbol_type = TP_SYMBOL_CONST_VALUE_INT32;
+    token->member_i32_value = value;
+
+    tp_free_parse_subtree(symbol_table, parse_tree);
+
+    *parse_tree = const_value;
+
+    return true;
+}
+
+static TP_TOKEN* get_first_token(TP_PARSE_TREE* parse_tree)
+{
+    for (size_t i = 0; parse_tree->member_element_num > i; ++i){
+
+        switch (parse_tree->member_element[i].member_type){
+        case TP_PARSE_TREE_TYPE_TOKEN:
+            return parse_tree->member_element[i].member_body.member_tp_token;
+        case TP_PARSE_TREE_TYPE_NODE:{
+
+            TP_TOKEN* token = get_first_token(parse_tree->member_element[i].member_body.member_child);
+
+            if (token){
+
+                return token;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static bool eliminate_dead_statement(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE** parse_tree, bool* is_live)
+{
+    switch ((*parse_tree)->member_grammer){
+    // Grammer: Program -> Statement+
+    case TP_PARSE_TREE_GRAMMER_PROGRAM:{
+
+        size_t element_num = (*parse_tree)->member_element_num;
+
+        // NOTE: The statements are visited in reverse order of the source code.
+        for (size_t i = element_num; 0 < i; --i){
+
+            TP_PARSE_TREE_ELEMENT* element = &((*parse_tree)->member_element[i - 1]);
+
+            if ((TP_PARSE_TREE_TYPE_NODE != element->member_type) || (NULL == element->member_body.member_child)){
+
+                TP_PUT_LOG_MSG_ICE(symbol_table);
+
+                return false;
+            }
+
+            if ( ! eliminate_dead_statement(symbol_table, &(element->member_body.member_child), is_live)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                return false;
+            }
+        }
+
+        TP_PARSE_TREE* rest_statement = NULL;
+        size_t rest_statement_num = 0;
+
+        for (size_t i = 0; element_num > i; ++i){
+
+            if ((*parse_tree)->member_element[i].member_body.member_child){
+
+                rest_statement = (*parse_tree)->member_element[i].member_body.member_child;
+                ++rest_statement_num;
+            }
+        }
+
+        if (element_num == rest_statement_num){
+
+            return true;
+        }
+
+        // NOTE: The program of one statement is replaced by the statement.
+        if (1 == rest_statement_num){
+
+            for (size_t i = 0; element_num > i; ++i){
+
+                (*parse_tree)->member_element[i].member_body.member_child = NULL;
+            }
+        }
+
+        tp_free_parse_subtree(symbol_table, parse_tree);
+
+        *parse_tree = ((1 == rest_statement_num) ? rest_statement : NULL);
+
+        return true;
+    }
+    // Grammer: Statement -> variable '=' Expression ';'
+    case TP_PARSE_TREE_GRAMMER_STATEMENT_1:
+//      break;
+    // Grammer: Statement -> Type variable '=' Expression ';'
+    case TP_PARSE_TREE_GRAMMER_STATEMENT_2:
+        break;
+    default:
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    size_t element_num = (*parse_tree)->member_element_num;
+
+    if (((TP_PARSE_TREE_GRAMMER_STATEMENT_1 == (*parse_tree)->member_grammer) &&
+        (symbol_table->member_grammer_statement_1_num != element_num)) ||
+        ((TP_PARSE_TREE_GRAMMER_STATEMENT_2 == (*parse_tree)->member_grammer) &&
+        (symbol_table->member_grammer_statement_2_num != element_num))){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    TP_PARSE_TREE_ELEMENT* variable = &((*parse_tree)->member_element[element_num - 4]);
+    TP_PARSE_TREE_ELEMENT* expression = &((*parse_tree)->member_element[element_num - 2]);
+
+    if ((TP_PARSE_TREE_TYPE_TOKEN != variable->member_type) || (TP_PARSE_TREE_TYPE_NODE != expression->member_type)){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    uint32_t local_index = 0;
+
+    if ( ! tp_get_local_index(symbol_table, variable->member_body.member_tp_token, &local_index)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    // NOTE: The last statement is the returned value(see wasm_gen_statement_1_and_2 function of tp_make_wasm.c).
+    if ((symbol_table->member_last_statement != *parse_tree) &&
+        (false == is_live[local_index]) && (false == is_may_trap(symbol_table, expression->member_body.member_child))){
+
+        tp_free_parse_subtree(symbol_table, parse_tree);
+
+        ++(symbol_table->member_optimization_statistics.member_removed_dead_statement_num);
+
+        return true;
+    }
+
+    // NOTE: The value of the variable before this statement is dead except the uses of the expression.
+    is_live[local_index] = false;
+
+    if ( ! set_live_variable(symbol_table, expression->member_body.member_child, is_live)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool set_live_variable(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, bool* is_live)
+{
+    for (size_t i = 0; parse_tree->member_element_num > i; ++i){
+
+        TP_PARSE_TREE_ELEMENT* element = &(parse_tree->member_element[i]);
+
+        switch (element->member_type){
+        case TP_PARSE_TREE_TYPE_TOKEN:{
+
+            // NOTE: The identifier of the expression is the variable only.
+            if ( ! IS_TOKEN_ID(element->member_body.member_tp_token)){
+
+                break;
+            }
+
+            uint32_t local_index = 0;
+
+            if ( ! tp_get_local_index(symbol_table, element->member_body.member_tp_token, &local_index)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                return false;
+            }
+
+            is_live[local_index] = true;
+            break;
+        }
+        case TP_PARSE_TREE_TYPE_NODE:
+
+            if ( ! set_live_variable(symbol_table, element->member_body.member_child, is_live)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                return false;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    return true;
+}
+
+static bool is_may_trap(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree)
+{
+    // Grammer: Term -> Factor (('*' | '/') Factor)*
+    if (((TP_PARSE_TREE_GRAMMER_TERM_1 == parse_tree->member_grammer) ||
+        (TP_PARSE_TREE_GRAMMER_TERM_2 == parse_tree->member_grammer)) &&
+        (3 == parse_tree->member_element_num) &&
+        (TP_PARSE_TREE_TYPE_TOKEN == parse_tree->member_element[1].member_type) &&
+        IS_TOKEN_DIV(parse_tree->member_element[1].member_body.member_tp_token)){
+
+        int32_t value = 0;
+
+        if ((TP_PARSE_TREE_TYPE_NODE != parse_tree->member_element[2].member_type) ||
+            ( ! get_const_factor(symbol_table, parse_tree->member_element[2].member_body.member_child, &value)) ||
+            (0 == value) || (-1 == value)){
+
+            return true;
+        }
+    }
+
+    for (size_t i = 0; parse_tree->member_element_num > i; ++i){
+
+        if ((TP_PARSE_TREE_TYPE_NODE == parse_tree->member_element[i].member_type) &&
+            is_may_trap(symbol_table, parse_tree->member_element[i].member_body.member_child)){
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool get_const_factor(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, int32_t* value)
+{
+    switch (parse_tree->member_grammer){
+    // Grammer: Factor -> '(' Expression ')'
+    case TP_PARSE_TREE_GRAMMER_FACTOR_1:
+
+        if ((symbol_table->member_grammer_factor_1_num != parse_tree->member_element_num) ||
+            (TP_PARSE_TREE_TYPE_NODE != parse_tree->member_element[1].member_type)){
+
+            return false;
+        }
+
+        return get_const_factor(symbol_table, parse_tree->member_element[1].member_body.member_child, value);
+    // Grammer: Factor -> ('+' | '-') constant
+    case TP_PARSE_TREE_GRAMMER_FACTOR_2:
+
+        if ((symbol_table->member_grammer_factor_2_num != parse_tree->member_element_num) ||
+            (TP_PARSE_TREE_TYPE_TOKEN != parse_tree->member_element[0].member_type) ||
+            (TP_PARSE_TREE_TYPE_TOKEN != parse_tree->member_element[1].member_type) ||
+            ( ! IS_TOKEN_CONST_VALUE(parse_tree->member_element[1].member_body.member_tp_token))){
+
+            return false;
+        }
+
+        *value = parse_tree->member_element[1].member_body.member_tp_token->member_i32_value;
+
+        if (IS_TOKEN_MINUS(parse_tree->member_element[0].member_body.member_tp_token)){
+
+            *value = (int32_t)(0 - (uint32_t)(*value));
+        }
+        return true;
+    // Grammer: Factor -> constant
+    case TP_PARSE_TREE_GRAMMER_FACTOR_3:
+
+        if ((symbol_table->member_grammer_factor_3_num != parse_tree->member_element_num) ||
+            (TP_PARSE_TREE_TYPE_TOKEN != parse_tree->member_element[0].member_type) ||
+            ( ! IS_TOKEN_CONST_VALUE(parse_tree->member_element[0].member_body.member_tp_token))){
+
+            return false;
+        }
+
+        *value = parse_tree->member_element[0].member_body.member_tp_token->member_i32_value;
+        return true;
+    default:
+        break;
+    }
+
+    return false;
+}
+
+static bool eliminate_common_subexpression(TP_SYMBOL_TABLE* symbol_table)
+{
+    bool is_eliminate_success = false;
+
+    uint32_t local_num = symbol_table->member_param_count + symbol_table->member_var_count;
+
+    // NOTE: One value number is made by one node of the parse tree or one local variable at most.
+    uint32_t value_number_max = count_parse_tree(symbol_table->member_tp_parse_tree) + local_num;
+
+    uint32_t hash_table_size = 1;
+
+    while (hash_table_size < (value_number_max * 2)){
+
+        hash_table_size <<= 1;
+
+        if (0 == hash_table_size){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return false;
+        }
+    }
+
+    TP_VALUE_NUMBER_TABLE table = {
+        .member_hash_table = NULL,
+        .member_hash_table_size = hash_table_size,
+        .member_value_number_num = 0,
+        .member_local_value_number = NULL,
+        .member_first_computation = NULL
+    };
+
+    table.member_hash_table = (TP_VALUE_NUMBER*)TP_CALLOC(symbol_table, hash_table_size, sizeof(TP_VALUE_NUMBER));
+
+    if (NULL == table.member_hash_table){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        goto error_proc;
+    }
+
+    table.member_local_value_number = (uint32_t*)TP_CALLOC(symbol_table, local_num + 1, sizeof(uint32_t));
+
+    if (NULL == table.member_local_value_number){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        goto error_proc;
+    }
+
+    table.member_first_computation = (TP_PARSE_TREE**)TP_CALLOC(symbol_table, hash_table_size + 1, sizeof(TP_PARSE_TREE*));
+
+    if (NULL == table.member_first_computation){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        goto error_proc;
+    }
+
+    if ( ! calc_value_number_statement(symbol_table, symbol_table->member_tp_parse_tree, &table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    uint32_t var_count = symbol_table->member_var_count;
+
+    if ( ! replace_common_subexpression(symbol_table, symbol_table->member_tp_parse_tree, &table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    symbol_table->member_optimization_statistics.member_common_subexpression_variable_num +=
+        (symbol_table->member_var_count - var_count);
+
+    is_eliminate_success = true;
+
+error_proc:
+    if (table.member_hash_table){
+
+        TP_FREE(symbol_table, &(table.member_hash_table), hash_table_size * sizeof(TP_VALUE_NUMBER));
+    }
+
+    if (table.member_local_value_number){
+
+        TP_FREE(symbol_table, &(table.member_local_value_number), (local_num + 1) * sizeof(uint32_t));
+    }
+
+    if (table.member_first_computation){
+
+        TP_FREE(symbol_table, &(table.member_first_computation), (hash_table_size + 1) * sizeof(TP_PARSE_TREE*));
+    }
+
+    return is_eliminate_success;
+}
+
+static uint32_t count_parse_tree(TP_PARSE_TREE* parse_tree)
+{
+    uint32_t count = 1;
+
+    for (size_t i = 0; parse_tree->member_element_num > i; ++i){
+
+        if ((TP_PARSE_TREE_TYPE_NODE == parse_tree->member_element[i].member_type) &&
+            parse_tree->member_element[i].member_body.member_child){
+
+            count += count_parse_tree(parse_tree->member_element[i].member_body.member_child);
+        }
+    }
+
+    return count;
+}
+
+static bool calc_value_number_statement(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_VALUE_NUMBER_TABLE* table)
+{
+    switch (parse_tree->member_grammer){
+    // Grammer: Program -> Statement+
+    case TP_PARSE_TREE_GRAMMER_PROGRAM:
+
+        // NOTE: The statements are visited in order of the source code.
+        for (size_t i = 0; parse_tree->member_element_num > i; ++i){
+
+            if (TP_PARSE_TREE_TYPE_NODE != parse_tree->member_element[i].member_type){
+
+                TP_PUT_LOG_MSG_ICE(symbol_table);
+
+                return false;
+            }
+
+            if ( ! calc_value_number_statement(symbol_table, parse_tree->member_element[i].member_body.member_child, table)){
+
+                TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+                return false;
+            }
+        }
+        return true;
+    // Grammer: Statement -> variable '=' Expression ';'
+    case TP_PARSE_TREE_GRAMMER_STATEMENT_1:
+//      break;
+    // Grammer: Statement -> Type variable '=' Expression ';'
+    case TP_PARSE_TREE_GRAMMER_STATEMENT_2:
+        break;
+    default:
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    size_t element_num = parse_tree->member_element_num;
+
+    if (((TP_PARSE_TREE_GRAMMER_STATEMENT_1 == parse_tree->member_grammer) &&
+        (symbol_table->member_grammer_statement_1_num != element_num)) ||
+        ((TP_PARSE_TREE_GRAMMER_STATEMENT_2 == parse_tree->member_grammer) &&
+        (symbol_table->member_grammer_statement_2_num != element_num))){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    TP_PARSE_TREE_ELEMENT* variable = &(parse_tree->member_element[element_num - 4]);
+    TP_PARSE_TREE_ELEMENT* expression = &(parse_tree->member_element[element_num - 2]);
+
+    if ((TP_PARSE_TREE_TYPE_TOKEN != variable->member_type) || (TP_PARSE_TREE_TYPE_NODE != expression->member_type)){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    uint32_t local_index = 0;
+
+    if ( ! tp_get_local_index(symbol_table, variable->member_body.member_tp_token, &local_index)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! calc_value_number_expression(symbol_table, expression->member_body.member_child, table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    // NOTE: The variable has the value number of the expression after this statement.
+    table->member_local_value_number[local_index] = expression->member_body.member_child->member_value_number;
+
+    return true;
+}
+
+static bool calc_value_number_expression(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_VALUE_NUMBER_TABLE* table)
+{
+    switch (parse_tree->member_grammer){
+    // Grammer: Expression -> Term (('+' | '-') Term)*
+    case TP_PARSE_TREE_GRAMMER_EXPRESSION_1:
+//      break;
+    case TP_PARSE_TREE_GRAMMER_EXPRESSION_2:
+//      break;
+    // Grammer: Term -> Factor (('*' | '/') Factor)*
+    case TP_PARSE_TREE_GRAMMER_TERM_1:
+//      break;
+    case TP_PARSE_TREE_GRAMMER_TERM_2:
+        break;
+    // Grammer: Factor -> '(' Expression ')'
+    case TP_PARSE_TREE_GRAMMER_FACTOR_1:
+
+        if ((symbol_table->member_grammer_factor_1_num != parse_tree->member_element_num) ||
+            (TP_PARSE_TREE_TYPE_NODE != parse_tree->member_element[1].member_type)){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return false;
+        }
+
+        if ( ! calc_value_number_expression(symbol_table, parse_tree->member_element[1].member_body.member_child, table)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+
+        parse_tree->member_value_number = parse_tree->member_element[1].member_body.member_child->member_value_number;
+
+        return true;
+    // Grammer: Factor -> ('+' | '-')? (variable | constant)
+    case TP_PARSE_TREE_GRAMMER_FACTOR_2:
+//      break;
+    case TP_PARSE_TREE_GRAMMER_FACTOR_3:
+        return calc_value_number_factor(symbol_table, parse_tree, table);
+    default:
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    // Grammer: (Expression | Term) ('+' | '-' | '*' | '/') (Term | Factor)
+
+    if ((3 != parse_tree->member_element_num) ||
+        (TP_PARSE_TREE_TYPE_NODE != parse_tree->member_element[0].member_type) ||
+        (TP_PARSE_TREE_TYPE_TOKEN != parse_tree->member_element[1].member_type) ||
+        (TP_PARSE_TREE_TYPE_NODE != parse_tree->member_element[2].member_type)){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    TP_PARSE_TREE* op1_tree = parse_tree->member_element[0].member_body.member_child;
+    TP_PARSE_TREE* op2_tree = parse_tree->member_element[2].member_body.member_child;
+
+    if ( ! calc_value_number_expression(symbol_table, op1_tree, table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if ( ! calc_value_number_expression(symbol_table, op2_tree, table)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    uint32_t op1 = op1_tree->member_value_number;
+    uint32_t op2 = op2_tree->member_value_number;
+
+    TP_VALUE_NUMBER_KIND kind = TP_VALUE_NUMBER_KIND_NONE;
+
+    switch (parse_tree->member_element[1].member_body.member_tp_token->member_symbol){
+    case TP_SYMBOL_PLUS:
+        kind = TP_VALUE_NUMBER_KIND_ADD;
+        break;
+    case TP_SYMBOL_MINUS:
+        kind = TP_VALUE_NUMBER_KIND_SUB;
+        break;
+    case TP_SYMBOL_MUL:
+        kind = TP_VALUE_NUMBER_KIND_MUL;
+        break;
+    case TP_SYMBOL_DIV:
+        kind = TP_VALUE_NUMBER_KIND_DIV;
+        break;
+    default:
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    // NOTE: The operands of the commutative operators are sorted.
+    if (((TP_VALUE_NUMBER_KIND_ADD == kind) || (TP_VALUE_NUMBER_KIND_MUL == kind)) && (op1 > op2)){
+
+        uint32_t tmp_op = op1;
+        op1 = op2;
+        op2 = tmp_op;
+    }
+
+    if ( ! get_value_number(symbol_table, table, kind, op1, op2, &(parse_tree->member_value_number))){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool calc_value_number_factor(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_VALUE_NUMBER_TABLE* table)
+{
+    // Factor -> ('+' | '-')? (variable | constant)
+
+    bool is_minus = false;
+    TP_TOKEN* token = NULL;
+
+    if (TP_PARSE_TREE_GRAMMER_FACTOR_2 == parse_tree->member_grammer){
+
+        if ((symbol_table->member_grammer_factor_2_num != parse_tree->member_element_num) ||
+            (TP_PARSE_TREE_TYPE_TOKEN != parse_tree->member_element[0].member_type) ||
+            (TP_PARSE_TREE_TYPE_TOKEN != parse_tree->member_element[1].member_type)){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return false;
+        }
+
+        is_minus = IS_TOKEN_MINUS(parse_tree->member_element[0].member_body.member_tp_token);
+        token = parse_tree->member_element[1].member_body.member_tp_token;
+    }else{
+
+        if ((symbol_table->member_grammer_factor_3_num != parse_tree->member_element_num) ||
+            (TP_PARSE_TREE_TYPE_TOKEN != parse_tree->member_element[0].member_type)){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return false;
+        }
+
+        token = parse_tree->member_element[0].member_body.member_tp_token;
+    }
+
+    uint32_t value_number = 0;
+
+    if (IS_TOKEN_CONST_VALUE(token)){
+
+        int32_t value = (is_minus ? (int32_t)(0 - (uint32_t)(token->member_i32_value)) : token->member_i32_value);
+
+        return get_value_number(
+            symbol_table, table, TP_VALUE_NUMBER_KIND_CONST, (uint32_t)value, 0, &(parse_tree->member_value_number)
+        );
+    }
+
+    uint32_t local_index = 0;
+
+    if ( ! tp_get_local_index(symbol_table, token, &local_index)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    if (0 == table->member_local_value_number[local_index]){
+
+        if ( ! get_value_number(
+            symbol_table, table, TP_VALUE_NUMBER_KIND_LOCAL, local_index, 0,
+            &(table->member_local_value_number[local_index]))){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+    }
+
+    value_number = table->member_local_value_number[local_index];
+
+    if (is_minus){
+
+        return get_value_number(
+            symbol_table, table, TP_VALUE_NUMBER_KIND_NEG, value_number, 0, &(parse_tree->member_value_number)
+        );
+    }
+
+    parse_tree->member_value_number = value_number;
+
+    return true;
+}
+
+static bool get_value_number(
+    TP_SYMBOL_TABLE* symbol_table, TP_VALUE_NUMBER_TABLE* table,
+    TP_VALUE_NUMBER_KIND kind, uint32_t op1, uint32_t op2, uint32_t* value_number)
+{
+    uint32_t hash = (uint32_t)kind;
+    hash = (hash * 0x9e3779b1) ^ op1;
+    hash = (hash * 0x9e3779b1) ^ op2;
+    hash *= 0x9e3779b1;
+
+    uint32_t mask = table->member_hash_table_size - 1;
+
+    // NOTE: Open addressing with linear probing.
+    for (uint32_t i = 0; table->member_hash_table_size > i; ++i){
+
+        TP_VALUE_NUMBER* entry = &(table->member_hash_table[(hash + i) & mask]);
+
+        if (TP_VALUE_NUMBER_KIND_NONE == entry->member_kind){
+
+            entry->member_kind = kind;
+            entry->member_op1 = op1;
+            entry->member_op2 = op2;
+            entry->member_value_number = ++(table->member_value_number_num);
+
+            *value_number = entry->member_value_number;
+
+            return true;
+        }
+
+        if ((kind == entry->member_kind) && (op1 == entry->member_op1) && (op2 == entry->member_op2)){
+
+            *value_number = entry->member_value_number;
+
+            return true;
+        }
+    }
+
+    TP_PUT_LOG_MSG_ICE(symbol_table);
+
+    return false;
+}
+
+static bool replace_common_subexpression(
+    TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree, TP_VALUE_NUMBER_TABLE* table)
+{
+    // NOTE: The subtrees are visited in preorder: the first computation of a value is found
+    // before the later computations, and the subtrees of the replaced computation are not visited.
+    if (is_common_subexpression(parse_tree)){
+
+        uint32_t value_number = parse_tree->member_value_number;
+
+        if ((0 == value_number) || (table->member_hash_table_size < value_number)){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return false;
+        }
+
+        TP_PARSE_TREE* first_computation = table->member_first_computation[value_number];
+
+        if (NULL == first_computation){
+
+            table->member_first_computation[value_number] = parse_tree;
+        }else{
+
+            if (TP_PARSE_TREE_CSE_NONE == first_computation->member_cse_kind){
+
+                first_computation->member_cse_kind = TP_PARSE_TREE_CSE_TEE_LOCAL;
+                first_computation->member_cse_local_index =
+                    symbol_table->member_param_count + symbol_table->member_var_count;
+
+                ++(symbol_table->member_var_count);
+            }
+
+            parse_tree->member_cse_kind = TP_PARSE_TREE_CSE_GET_LOCAL;
+            parse_tree->member_cse_local_index = first_computation->member_cse_local_index;
+
+            ++(symbol_table->member_optimization_statistics.member_eliminated_common_subexpression_num);
+
+            return true;
+        }
+    }
+
+    for (size_t i = 0; parse_tree->member_element_num > i; ++i){
+
+        if (TP_PARSE_TREE_TYPE_NODE != parse_tree->member_element[i].member_type){
+
+            continue;
+        }
+
+        if ( ! replace_common_subexpression(symbol_table, parse_tree->member_element[i].member_body.member_child, table)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool is_common_subexpression(TP_PARSE_TREE* parse_tree)
+{
+    switch (parse_tree->member_grammer){
+    // Grammer: (Expression | Term) ('+' | '-' | '*' | '/') (Term | Factor)
+    case TP_PARSE_TREE_GRAMMER_EXPRESSION_1:
+//      break;
+    case TP_PARSE_TREE_GRAMMER_EXPRESSION_2:
+//      break;
+    case TP_PARSE_TREE_GRAMMER_TERM_1:
+//      break;
+    case TP_PARSE_TREE_GRAMMER_TERM_2:
+        return true;
+    // Grammer: Factor -> '-' variable(change of sign is made of 5 wasm opcodes).
+    case TP_PARSE_TREE_GRAMMER_FACTOR_2:
+        return (2 == parse_tree->member_element_num) &&
+            IS_TOKEN_MINUS(parse_tree->member_element[0].member_body.member_tp_token) &&
+            ( ! IS_TOKEN_CONST_VALUE(parse_tree->member_element[1].member_body.member_tp_token));
+    default:
+        break;
+    }
+
+    return false;
+}
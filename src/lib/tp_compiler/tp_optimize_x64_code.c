@@ -0,0 +1,868 @@
+// (C) Shin'ichi Ichikawa. Released under the MIT license.
+
+#include "tp_compiler.h"
+
+// Functions:
+//  (1) Store to load forwarding: the reload of the stored value is replaced by the move
+//      from the register(or removed).
+//  (2) Move folding: mov t, src followed by the use of t is folded into the use
+//      (mov dst, src, mov dst, imm, op dst, imm, imul dst, dst, imm or op dst, [memory])
+//      if t is dead after the use.
+//  (3) Self moves are removed.
+//  (4) The push/pop brackets of the scratch register are removed if the saved value is not needed,
+//      and the adjacent brackets are merged.
+//
+// Note:
+//  (1) The instructions from the first wasm opcode to END are recorded by the encoders of
+//      tp_make_x64_code_body.c. They have no jump targets and no fixups, so the function body
+//      is encoded again after the optimization.
+//  (2) The memory operands are the 32 bits slots of the stack frame([rbp+offset]).
+//  (3) The rewritten instruction is not longer than the removed instructions before it and itself.
+
+#define TP_X64_PEEPHOLE_WINDOW 8
+#define TP_X64_REGISTER_MASK(x64_register) (1U << (x64_register))
+
+typedef struct tp_x64_stored_value_{
+    bool member_is_stored;
+    int32_t member_offset;
+    TP_WASM_STACK_ELEMENT member_register; // Same value as [rbp+member_offset].
+}TP_X64_STORED_VALUE;
+
+static bool is_x64_register_operand(TP_WASM_STACK_ELEMENT* operand);
+static uint32_t get_x64_register_mask(TP_WASM_STACK_ELEMENT* operand);
+static void get_x64_register_use_def(TP_X64_INSTRUCTION* x64_instruction, uint32_t* use, uint32_t* def);
+static bool is_write_x64_memory(TP_X64_INSTRUCTION* x64_instruction, int32_t offset);
+static bool is_overlap_x64_memory(int32_t offset1, int32_t offset2);
+static uint32_t get_next_x64_instruction(TP_SYMBOL_TABLE* symbol_table, uint32_t index);
+static void remove_x64_instruction(TP_SYMBOL_TABLE* symbol_table, TP_X64_INSTRUCTION* x64_instruction);
+static void calc_x64_live_register(TP_SYMBOL_TABLE* symbol_table, uint32_t* live_out, uint32_t live_out_end);
+static bool forward_stored_value(TP_SYMBOL_TABLE* symbol_table);
+static bool fold_move(TP_SYMBOL_TABLE* symbol_table, uint32_t* live_out);
+static bool fold_move_into_use(TP_SYMBOL_TABLE* symbol_table, TP_X64_INSTRUCTION* move, TP_X64_INSTRUCTION* use);
+static bool remove_self_move(TP_SYMBOL_TABLE* symbol_table);
+static bool remove_push_pop(
+    TP_SYMBOL_TABLE* symbol_table, uint32_t* live_out, uint32_t* push_index, uint32_t* def_mask, bool* is_change
+);
+static bool merge_push_pop(TP_SYMBOL_TABLE* symbol_table, uint32_t* live_out);
+static bool encode_x64_code_again(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_begin, uint32_t* x64_code_size
+);
+
+bool tp_append_x64_instruction(TP_SYMBOL_TABLE* symbol_table, TP_X64_INSTRUCTION* x64_instruction)
+{
+    if (symbol_table->member_x64_instruction_num ==
+        (symbol_table->member_x64_instruction_size / sizeof(TP_X64_INSTRUCTION))){
+
+        uint64_t x64_instruction_size = (uint64_t)(symbol_table->member_x64_instruction_size) +
+            TP_X64_INSTRUCTION_SIZE_ALLOCATE_UNIT * sizeof(TP_X64_INSTRUCTION);
+
+        if (UINT32_MAX < x64_instruction_size){
+
+            TP_PUT_LOG_MSG(
+                symbol_table, TP_LOG_TYPE_DISP_FORCE,
+                TP_MSG_FMT("ERROR: UINT32_MAX < x64_instruction_size(%1)"),
+                TP_LOG_PARAM_UINT64_VALUE(x64_instruction_size)
+            );
+
+            return false;
+        }
+
+        TP_X64_INSTRUCTION* x64_instruction_buffer = (TP_X64_INSTRUCTION*)TP_REALLOC(symbol_table,
+            symbol_table->member_x64_instruction, (size_t)x64_instruction_size
+        );
+
+        if (NULL == x64_instruction_buffer){
+
+            TP_PRINT_CRT_ERROR(symbol_table);
+
+            return false;
+        }
+
+        symbol_table->member_x64_instruction = x64_instruction_buffer;
+        symbol_table->member_x64_instruction_size = (uint32_t)x64_instruction_size;
+    }
+
+    symbol_table->member_x64_instruction[symbol_table->member_x64_instruction_num] = *x64_instruction;
+
+    ++(symbol_table->member_x64_instruction_num);
+
+    return true;
+}
+
+bool tp_optimize_x64_code(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_begin, uint32_t* x64_code_size,
+    TP_WASM_STACK_ELEMENT* result)
+{
+    symbol_table->member_is_record_x64_instruction = false;
+
+    uint32_t x64_instruction_num = symbol_table->member_x64_instruction_num;
+
+    if (0 == x64_instruction_num){
+
+        return true;
+    }
+
+    // NOTE: The encoders record all of the instructions of the function body.
+    uint32_t x64_code_end = x64_code_begin;
+
+    for (uint32_t i = 0; x64_instruction_num > i; ++i){
+
+        if (x64_code_end != symbol_table->member_x64_instruction[i].member_offset){
+
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+
+            return false;
+        }
+
+        x64_code_end += symbol_table->member_x64_instruction[i].member_size;
+    }
+
+    if (x64_code_end != *x64_code_size){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    uint32_t* live_out = (uint32_t*)TP_CALLOC(symbol_table, x64_instruction_num, sizeof(uint32_t) * 3);
+
+    if (NULL == live_out){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    uint32_t* push_index = live_out + x64_instruction_num;
+    uint32_t* def_mask = push_index + x64_instruction_num;
+
+    // The result of the function body is read after END.
+    uint32_t live_out_end = get_x64_register_mask(result);
+
+    bool is_change = false;
+
+    do{
+        is_change = forward_stored_value(symbol_table);
+
+        calc_x64_live_register(symbol_table, live_out, live_out_end);
+
+        if (fold_move(symbol_table, live_out)){
+
+            is_change = true;
+        }
+
+        if (remove_self_move(symbol_table)){
+
+            is_change = true;
+        }
+
+        calc_x64_live_register(symbol_table, live_out, live_out_end);
+
+        if ( ! remove_push_pop(symbol_table, live_out, push_index, def_mask, &is_change)){
+
+            TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+            TP_FREE(symbol_table, &live_out, x64_instruction_num * sizeof(uint32_t) * 3);
+
+            return false;
+        }
+
+        calc_x64_live_register(symbol_table, live_out, live_out_end);
+
+        if (merge_push_pop(symbol_table, live_out)){
+
+            is_change = true;
+        }
+    }while (is_change);
+
+    TP_FREE(symbol_table, &live_out, x64_instruction_num * sizeof(uint32_t) * 3);
+
+    if ( ! encode_x64_code_again(symbol_table, x64_code_buffer, x64_code_begin, x64_code_size)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        return false;
+    }
+
+    TP_OPTIMIZATION_STATISTICS* statistics = &(symbol_table->member_optimization_statistics);
+
+    statistics->member_peephole_saved_x64_code_size += (x64_code_end - *x64_code_size);
+
+    TP_PUT_LOG_MSG(
+        symbol_table, TP_LOG_TYPE_HIDE,
+        TP_MSG_FMT(
+            "peephole optimization of x64 code\n"
+            "forwarded loads: %1\n"
+            "folded moves: %2\n"
+            "removed self moves: %3\n"
+            "removed push/pop: %4\n"
+            "removed instructions: %5\n"
+            "saved x64 code size: %6\n"
+            "strength reduced multiplications: %7\n"
+            "strength reduced divisions: %8\n"
+            "immediate operands: %9"
+        ),
+        TP_LOG_PARAM_UINT64_VALUE(statistics->member_peephole_forwarded_load_num),
+        TP_LOG_PARAM_UINT64_VALUE(statistics->member_peephole_folded_move_num),
+        TP_LOG_PARAM_UINT64_VALUE(statistics->member_peephole_removed_self_move_num),
+        TP_LOG_PARAM_UINT64_VALUE(statistics->member_peephole_removed_push_pop_num),
+        TP_LOG_PARAM_UINT64_VALUE(statistics->member_peephole_removed_instruction_num),
+        TP_LOG_PARAM_UINT64_VALUE(statistics->member_peephole_saved_x64_code_size),
+        TP_LOG_PARAM_UINT64_VALUE(statistics->member_strength_reduced_mul_num),
+        TP_LOG_PARAM_UINT64_VALUE(statistics->member_strength_reduced_div_num),
+        TP_LOG_PARAM_UINT64_VALUE(statistics->member_immediate_operand_num)
+    );
+
+    return true;
+}
+
+static bool is_x64_register_operand(TP_WASM_STACK_ELEMENT* operand)
+{
+    return ((TP_X64_ITEM_KIND_X86_32_REGISTER == operand->member_x64_item_kind) ||
+        (TP_X64_ITEM_KIND_X64_32_REGISTER == operand->member_x64_item_kind));
+}
+
+static uint32_t get_x64_register_mask(TP_WASM_STACK_ELEMENT* operand)
+{
+    TP_X64_64_REGISTER x64_register = tp_get_x64_64_register(operand);
+
+    return ((TP_X64_64_REGISTER_NULL == x64_register) ? 0 : TP_X64_REGISTER_MASK(x64_register));
+}
+
+static void get_x64_register_use_def(TP_X64_INSTRUCTION* x64_instruction, uint32_t* use, uint32_t* def)
+{
+    uint32_t dst = get_x64_register_mask(&(x64_instruction->member_dst));
+    uint32_t src = get_x64_register_mask(&(x64_instruction->member_src));
+
+    switch (x64_instruction->member_kind){
+    case TP_X64_INSTRUCTION_KIND_2_OPERAND:
+        switch (x64_instruction->member_x64_op){
+        case TP_X64_MOV:
+            *use = src;
+            *def = dst;
+            return;
+        case TP_X64_IDIV:
+            // NOTE: EDX:EAX is the dividend, and EAX(quotient) and EDX(remainder) are changed.
+            *use = (src | TP_X64_REGISTER_MASK(TP_X64_64_REGISTER_RAX) | TP_X64_REGISTER_MASK(TP_X64_64_REGISTER_RDX));
+            *def = (TP_X64_REGISTER_MASK(TP_X64_64_REGISTER_RAX) | TP_X64_REGISTER_MASK(TP_X64_64_REGISTER_RDX));
+            return;
+        default:
+            *use = (dst | src);
+            *def = dst;
+            return;
+        }
+    case TP_X64_INSTRUCTION_KIND_MOV_IMM:
+        *use = 0;
+        *def = dst;
+        return;
+    case TP_X64_INSTRUCTION_KIND_ALU_IMM:
+        *use = dst;
+        *def = dst;
+        return;
+    case TP_X64_INSTRUCTION_KIND_IMUL_IMM:
+        *use = src;
+        *def = dst;
+        return;
+    case TP_X64_INSTRUCTION_KIND_PUSH:
+        *use = TP_X64_REGISTER_MASK(x64_instruction->member_register);
+        *def = 0;
+        return;
+    case TP_X64_INSTRUCTION_KIND_POP:
+        *use = 0;
+        *def = TP_X64_REGISTER_MASK(x64_instruction->member_register);
+        return;
+    case TP_X64_INSTRUCTION_KIND_SHIFT_IMM:
+//      break;
+    case TP_X64_INSTRUCTION_KIND_NEG:
+        *use = dst;
+        *def = dst;
+        return;
+    case TP_X64_INSTRUCTION_KIND_LEA_SCALE:
+//      break;
+    case TP_X64_INSTRUCTION_KIND_MUL_HIGH:
+        *use = src;
+        *def = dst;
+        return;
+    case TP_X64_INSTRUCTION_KIND_CDQ:
+        *use = TP_X64_REGISTER_MASK(TP_X64_64_REGISTER_RAX);
+        *def = TP_X64_REGISTER_MASK(TP_X64_64_REGISTER_RDX);
+        return;
+    default:
+        break;
+    }
+
+    // NOTE: Unknown instructions use and change all registers.
+    *use = UINT32_MAX;
+    *def = UINT32_MAX;
+}
+
+static bool is_write_x64_memory(TP_X64_INSTRUCTION* x64_instruction, int32_t offset)
+{
+    switch (x64_instruction->member_kind){
+    case TP_X64_INSTRUCTION_KIND_2_OPERAND:
+//      break;
+    case TP_X64_INSTRUCTION_KIND_MOV_IMM:
+//      break;
+    case TP_X64_INSTRUCTION_KIND_ALU_IMM:
+//      break;
+    case TP_X64_INSTRUCTION_KIND_SHIFT_IMM:
+//      break;
+    case TP_X64_INSTRUCTION_KIND_NEG:
+        return ((TP_X64_ITEM_KIND_MEMORY == x64_instruction->member_dst.member_x64_item_kind) &&
+            is_overlap_x64_memory(x64_instruction->member_dst.member_offset, offset));
+    default:
+        break;
+    }
+
+    return false;
+}
+
+static bool is_overlap_x64_memory(int32_t offset1, int32_t offset2)
+{
+    return (((int64_t)offset1 < (int64_t)offset2 + (int64_t)sizeof(int32_t)) &&
+        ((int64_t)offset2 < (int64_t)offset1 + (int64_t)sizeof(int32_t)));
+}
+
+static uint32_t get_next_x64_instruction(TP_SYMBOL_TABLE* symbol_table, uint32_t index)
+{
+    uint32_t x64_instruction_num = symbol_table->member_x64_instruction_num;
+
+    for (uint32_t i = index + 1; x64_instruction_num > i; ++i){
+
+        if (false == symbol_table->member_x64_instruction[i].member_is_remove){
+
+            return i;
+        }
+    }
+
+    return x64_instruction_num;
+}
+
+static void remove_x64_instruction(TP_SYMBOL_TABLE* symbol_table, TP_X64_INSTRUCTION* x64_instruction)
+{
+    x64_instruction->member_is_remove = true;
+
+    ++(symbol_table->member_optimization_statistics.member_peephole_removed_instruction_num);
+}
+
+static void calc_x64_live_register(TP_SYMBOL_TABLE* symbol_table, uint32_t* live_out, uint32_t live_out_end)
+{
+    uint32_t live = live_out_end;
+
+    for (uint32_t i = symbol_table->member_x64_instruction_num; 0 < i; --i){
+
+        TP_X64_INSTRUCTION* x64_instruction = &(symbol_table->member_x64_instruction[i - 1]);
+
+        if (x64_instruction->member_is_remove){
+
+            continue;
+        }
+
+        live_out[i - 1] = live;
+
+        uint32_t use = 0;
+        uint32_t def = 0;
+
+        get_x64_register_use_def(x64_instruction, &use, &def);
+
+        live = (use | (live & ~def));
+    }
+}
+
+static bool forward_stored_value(TP_SYMBOL_TABLE* symbol_table)
+{
+    bool is_change = false;
+
+    TP_X64_STORED_VALUE stored_value[TP_X64_64_REGISTER_NULL] = { 0 };
+
+    uint32_t x64_instruction_num = symbol_table->member_x64_instruction_num;
+
+    for (uint32_t i = 0; x64_instruction_num > i; ++i){
+
+        TP_X64_INSTRUCTION* x64_instruction = &(symbol_table->member_x64_instruction[i]);
+
+        if (x64_instruction->member_is_remove){
+
+            continue;
+        }
+
+        TP_WASM_STACK_ELEMENT* dst = &(x64_instruction->member_dst);
+        TP_WASM_STACK_ELEMENT* src = &(x64_instruction->member_src);
+
+        bool is_mov = ((TP_X64_INSTRUCTION_KIND_2_OPERAND == x64_instruction->member_kind) &&
+            (TP_X64_MOV == x64_instruction->member_x64_op));
+
+        // mov reg, [rbp+offset]
+        if (is_mov && is_x64_register_operand(dst) && (TP_X64_ITEM_KIND_MEMORY == src->member_x64_item_kind)){
+
+            TP_X64_64_REGISTER dst_register = tp_get_x64_64_register(dst);
+            int32_t offset = src->member_offset;
+
+            if (stored_value[dst_register].member_is_stored && (offset == stored_value[dst_register].member_offset)){
+
+                remove_x64_instruction(symbol_table, x64_instruction);
+
+                ++(symbol_table->member_optimization_statistics.member_peephole_forwarded_load_num);
+
+                is_change = true;
+
+                continue;
+            }
+
+            for (uint32_t j = 0; TP_X64_64_REGISTER_NULL > j; ++j){
+
+                if (stored_value[j].member_is_stored && (offset == stored_value[j].member_offset)){
+
+                    // mov reg, stored_register
+                    *src = stored_value[j].member_register;
+
+                    x64_instruction->member_is_rewrite = true;
+
+                    ++(symbol_table->member_optimization_statistics.member_peephole_forwarded_load_num);
+
+                    is_change = true;
+
+                    break;
+                }
+            }
+
+            stored_value[dst_register].member_is_stored = true;
+            stored_value[dst_register].member_offset = offset;
+            stored_value[dst_register].member_register = *dst;
+
+            continue;
+        }
+
+        uint32_t use = 0;
+        uint32_t def = 0;
+
+        get_x64_register_use_def(x64_instruction, &use, &def);
+
+        for (uint32_t j = 0; TP_X64_64_REGISTER_NULL > j; ++j){
+
+            if (def & TP_X64_REGISTER_MASK(j)){
+
+                stored_value[j].member_is_stored = false;
+            }
+        }
+
+        if (TP_X64_ITEM_KIND_MEMORY == dst->member_x64_item_kind){
+
+            for (uint32_t j = 0; TP_X64_64_REGISTER_NULL > j; ++j){
+
+                if (stored_value[j].member_is_stored &&
+                    is_write_x64_memory(x64_instruction, stored_value[j].member_offset)){
+
+                    stored_value[j].member_is_stored = false;
+                }
+            }
+
+            // mov [rbp+offset], reg
+            if (is_mov && is_x64_register_operand(src)){
+
+                TP_X64_64_REGISTER src_register = tp_get_x64_64_register(src);
+
+                stored_value[src_register].member_is_stored = true;
+                stored_value[src_register].member_offset = dst->member_offset;
+                stored_value[src_register].member_register = *src;
+            }
+        }
+    }
+
+    return is_change;
+}
+
+static bool fold_move(TP_SYMBOL_TABLE* symbol_table, uint32_t* live_out)
+{
+    bool is_change = false;
+
+    uint32_t x64_instruction_num = symbol_table->member_x64_instruction_num;
+
+    for (uint32_t i = 0; x64_instruction_num > i; ++i){
+
+        TP_X64_INSTRUCTION* move = &(symbol_table->member_x64_instruction[i]);
+
+        if (move->member_is_remove || (TP_X64_MOV != move->member_x64_op) ||
+            ((TP_X64_INSTRUCTION_KIND_2_OPERAND != move->member_kind) &&
+            (TP_X64_INSTRUCTION_KIND_MOV_IMM != move->member_kind)) ||
+            (false == is_x64_register_operand(&(move->member_dst)))){
+
+            continue;
+        }
+
+        uint32_t temporary = get_x64_register_mask(&(move->member_dst));
+        uint32_t source = ((TP_X64_INSTRUCTION_KIND_2_OPERAND == move->member_kind) ?
+            get_x64_register_mask(&(move->member_src)) : 0
+        );
+        bool is_source_memory = ((TP_X64_INSTRUCTION_KIND_2_OPERAND == move->member_kind) &&
+            (TP_X64_ITEM_KIND_MEMORY == move->member_src.member_x64_item_kind)
+        );
+
+        // NOTE: The source must not be changed before the use of the temporary register.
+        uint32_t j = get_next_x64_instruction(symbol_table, i);
+
+        for (uint32_t k = 0; (TP_X64_PEEPHOLE_WINDOW > k) && (x64_instruction_num > j); ++k){
+
+            TP_X64_INSTRUCTION* use = &(symbol_table->member_x64_instruction[j]);
+
+            uint32_t use_mask = 0;
+            uint32_t def_mask = 0;
+
+            get_x64_register_use_def(use, &use_mask, &def_mask);
+
+            if ((use_mask | def_mask) & temporary){
+
+                if ((0 == (def_mask & temporary)) && (0 == (live_out[j] & temporary)) &&
+                    fold_move_into_use(symbol_table, move, use)){
+
+                    remove_x64_instruction(symbol_table, move);
+
+                    ++(symbol_table->member_optimization_statistics.member_peephole_folded_move_num);
+
+                    is_change = true;
+                }
+
+                break;
+            }
+
+            if ((def_mask & source) ||
+                (is_source_memory && is_write_x64_memory(use, move->member_src.member_offset))){
+
+                break;
+            }
+
+            j = get_next_x64_instruction(symbol_table, j);
+        }
+    }
+
+    return is_change;
+}
+
+static bool fold_move_into_use(TP_SYMBOL_TABLE* symbol_table, TP_X64_INSTRUCTION* move, TP_X64_INSTRUCTION* use)
+{
+    if (TP_X64_INSTRUCTION_KIND_2_OPERAND != use->member_kind){
+
+        return false;
+    }
+
+    TP_X64_64_REGISTER temporary = tp_get_x64_64_register(&(move->member_dst));
+
+    // NOTE: The temporary register is the source operand only.
+    if ((temporary != tp_get_x64_64_register(&(use->member_src))) ||
+        (temporary == tp_get_x64_64_register(&(use->member_dst)))){
+
+        return false;
+    }
+
+    if ((TP_X64_IDIV == use->member_x64_op) &&
+        ((TP_X64_64_REGISTER_RAX == temporary) || (TP_X64_64_REGISTER_RDX == temporary))){
+
+        return false;
+    }
+
+    TP_X64_INSTRUCTION folded = *use;
+
+    switch (move->member_kind){
+    case TP_X64_INSTRUCTION_KIND_2_OPERAND:
+
+        // NOTE: The memory to memory operation is not an instruction.
+        if ((TP_X64_ITEM_KIND_MEMORY == move->member_src.member_x64_item_kind) &&
+            (TP_X64_ITEM_KIND_MEMORY == use->member_dst.member_x64_item_kind)){
+
+            return false;
+        }
+
+        // op dst, src
+        folded.member_src = move->member_src;
+        break;
+    case TP_X64_INSTRUCTION_KIND_MOV_IMM:
+
+        switch (use->member_x64_op){
+        case TP_X64_MOV:
+            // mov dst, imm
+            folded.member_kind = TP_X64_INSTRUCTION_KIND_MOV_IMM;
+            folded.member_x64_mov_imm_mode = move->member_x64_mov_imm_mode;
+            memset(&(folded.member_src), 0, sizeof(folded.member_src));
+            break;
+        case TP_X64_ADD:
+//          break;
+        case TP_X64_SUB:
+//          break;
+        case TP_X64_XOR:
+            // op dst, imm
+            folded.member_kind = TP_X64_INSTRUCTION_KIND_ALU_IMM;
+            memset(&(folded.member_src), 0, sizeof(folded.member_src));
+            break;
+        case TP_X64_IMUL:
+
+            if (false == is_x64_register_operand(&(use->member_dst))){
+
+                return false;
+            }
+
+            // imul dst, dst, imm
+            folded.member_kind = TP_X64_INSTRUCTION_KIND_IMUL_IMM;
+            folded.member_src = use->member_dst;
+            break;
+        default:
+            return false;
+        }
+
+        folded.member_imm = move->member_imm;
+        break;
+    default:
+        return false;
+    }
+
+    // NOTE: The folded instruction is not longer than the move and the use
+    // (mov dst, imm32 is longer than xor t, t and mov dst, t).
+    uint32_t x64_instruction_size = tp_encode_x64_instruction(symbol_table, NULL, 0, &folded);
+
+    if ((0 == x64_instruction_size) ||
+        ((uint64_t)(move->member_size) + use->member_size < x64_instruction_size)){
+
+        return false;
+    }
+
+    *use = folded;
+
+    use->member_is_rewrite = true;
+
+    return true;
+}
+
+static bool remove_self_move(TP_SYMBOL_TABLE* symbol_table)
+{
+    bool is_change = false;
+
+    uint32_t x64_instruction_num = symbol_table->member_x64_instruction_num;
+
+    for (uint32_t i = 0; x64_instruction_num > i; ++i){
+
+        TP_X64_INSTRUCTION* x64_instruction = &(symbol_table->member_x64_instruction[i]);
+
+        if (x64_instruction->member_is_remove ||
+            (TP_X64_INSTRUCTION_KIND_2_OPERAND != x64_instruction->member_kind) ||
+            (TP_X64_MOV != x64_instruction->member_x64_op)){
+
+            continue;
+        }
+
+        TP_X64_64_REGISTER dst_register = tp_get_x64_64_register(&(x64_instruction->member_dst));
+
+        // mov reg, reg
+        if ((TP_X64_64_REGISTER_NULL != dst_register) &&
+            (dst_register == tp_get_x64_64_register(&(x64_instruction->member_src)))){
+
+            remove_x64_instruction(symbol_table, x64_instruction);
+
+            ++(symbol_table->member_optimization_statistics.member_peephole_removed_self_move_num);
+
+            is_change = true;
+        }
+    }
+
+    return is_change;
+}
+
+static bool remove_push_pop(
+    TP_SYMBOL_TABLE* symbol_table, uint32_t* live_out, uint32_t* push_index, uint32_t* def_mask, bool* is_change)
+{
+    uint32_t push_num = 0;
+
+    uint32_t x64_instruction_num = symbol_table->member_x64_instruction_num;
+
+    for (uint32_t i = 0; x64_instruction_num > i; ++i){
+
+        TP_X64_INSTRUCTION* x64_instruction = &(symbol_table->member_x64_instruction[i]);
+
+        if (x64_instruction->member_is_remove){
+
+            continue;
+        }
+
+        uint32_t use = 0;
+        uint32_t def = 0;
+
+        get_x64_register_use_def(x64_instruction, &use, &def);
+
+        switch (x64_instruction->member_kind){
+        case TP_X64_INSTRUCTION_KIND_PUSH:
+            push_index[push_num] = i;
+            def_mask[push_num] = 0;
+            ++push_num;
+            continue;
+        case TP_X64_INSTRUCTION_KIND_POP:{
+
+            if (0 == push_num){
+
+                TP_PUT_LOG_MSG_ICE(symbol_table);
+
+                return false;
+            }
+
+            --push_num;
+
+            TP_X64_INSTRUCTION* push = &(symbol_table->member_x64_instruction[push_index[push_num]]);
+
+            if (push->member_register != x64_instruction->member_register){
+
+                TP_PUT_LOG_MSG_ICE(symbol_table);
+
+                return false;
+            }
+
+            uint32_t saved_register = TP_X64_REGISTER_MASK(x64_instruction->member_register);
+
+            // NOTE: The saved value is not changed or not used after pop.
+            if ((0 == (def_mask[push_num] & saved_register)) || (0 == (live_out[i] & saved_register))){
+
+                remove_x64_instruction(symbol_table, push);
+                remove_x64_instruction(symbol_table, x64_instruction);
+
+                symbol_table->member_optimization_statistics.member_peephole_removed_push_pop_num += 2;
+
+                *is_change = true;
+            }
+
+            break;
+        }
+        default:
+            break;
+        }
+
+        for (uint32_t j = 0; push_num > j; ++j){
+
+            def_mask[j] |= def;
+        }
+    }
+
+    if (push_num){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool merge_push_pop(TP_SYMBOL_TABLE* symbol_table, uint32_t* live_out)
+{
+    bool is_change = false;
+
+    uint32_t x64_instruction_num = symbol_table->member_x64_instruction_num;
+
+    for (uint32_t i = 0; x64_instruction_num > i; ++i){
+
+        TP_X64_INSTRUCTION* pop = &(symbol_table->member_x64_instruction[i]);
+
+        if (pop->member_is_remove || (TP_X64_INSTRUCTION_KIND_POP != pop->member_kind)){
+
+            continue;
+        }
+
+        uint32_t saved_register = TP_X64_REGISTER_MASK(pop->member_register);
+
+        // pop reg ... push reg: the register keeps the saved value on the stack until the next pop.
+        uint32_t j = get_next_x64_instruction(symbol_table, i);
+
+        for (uint32_t k = 0; (TP_X64_PEEPHOLE_WINDOW > k) && (x64_instruction_num > j); ++k){
+
+            TP_X64_INSTRUCTION* push = &(symbol_table->member_x64_instruction[j]);
+
+            if (TP_X64_INSTRUCTION_KIND_PUSH == push->member_kind){
+
+                // NOTE: The register has the value of the previous bracket instead of the saved value
+                // after the merge, so the register must not be read before written in the next bracket.
+                if ((push->member_register == pop->member_register) && (0 == (live_out[j] & saved_register))){
+
+                    remove_x64_instruction(symbol_table, pop);
+                    remove_x64_instruction(symbol_table, push);
+
+                    symbol_table->member_optimization_statistics.member_peephole_removed_push_pop_num += 2;
+
+                    is_change = true;
+                }
+
+                break;
+            }
+
+            if (TP_X64_INSTRUCTION_KIND_POP == push->member_kind){
+
+                break;
+            }
+
+            uint32_t use = 0;
+            uint32_t def = 0;
+
+            get_x64_register_use_def(push, &use, &def);
+
+            if ((use | def) & saved_register){
+
+                break;
+            }
+
+            j = get_next_x64_instruction(symbol_table, j);
+        }
+    }
+
+    return is_change;
+}
+
+static bool encode_x64_code_again(
+    TP_SYMBOL_TABLE* symbol_table, uint8_t* x64_code_buffer, uint32_t x64_code_begin, uint32_t* x64_code_size)
+{
+    uint32_t x64_code_offset = x64_code_begin;
+
+    uint32_t x64_instruction_num = symbol_table->member_x64_instruction_num;
+
+    for (uint32_t i = 0; x64_instruction_num > i; ++i){
+
+        TP_X64_INSTRUCTION* x64_instruction = &(symbol_table->member_x64_instruction[i]);
+
+        if (x64_instruction->member_is_remove){
+
+            continue;
+        }
+
+        if (x64_instruction->member_is_rewrite){
+
+            uint32_t x64_instruction_size = tp_encode_x64_instruction(symbol_table, NULL, 0, x64_instruction);
+
+            // NOTE: The bytes of the next instructions are not overwritten.
+            if ((0 == x64_instruction_size) ||
+                ((uint64_t)x64_code_offset + x64_instruction_size >
+                (uint64_t)(x64_instruction->member_offset) + x64_instruction->member_size)){
+
+                TP_PUT_LOG_MSG_ICE(symbol_table);
+
+                return false;
+            }
+
+            if (x64_instruction_size != tp_encode_x64_instruction(
+                symbol_table, x64_code_buffer, x64_code_offset, x64_instruction)){
+
+                TP_PUT_LOG_MSG_ICE(symbol_table);
+
+                return false;
+            }
+
+            x64_instruction->member_size = x64_instruction_size;
+        }else if (x64_code_offset != x64_instruction->member_offset){
+
+            memmove(
+                x64_code_buffer + x64_code_offset,
+                x64_code_buffer + x64_instruction->member_offset, x64_instruction->member_size
+            );
+        }
+
+        x64_instruction->member_offset = x64_code_offset;
+
+        x64_code_offset += x64_instruction->member_size;
+    }
+
+    *x64_code_size = x64_code_offset;
+
+    return true;
+}
@@ -69,6 +69,40 @@ bool tp_search_object(TP_SYMBOL_TABLE* symbol_table, TP_TOKEN* token, REGISTER_O
     );
 }
 
+bool tp_get_local_index(TP_SYMBOL_TABLE* symbol_table, TP_TOKEN* token, uint32_t* local_index)
+{
+    REGISTER_OBJECT register_object = { 0 };
+
+    if ( ! (IS_TOKEN_ID(token) && tp_search_object(symbol_table, token, &register_object))){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    // NOTE: Same as the local index of wasm(see get_var_value function of tp_make_wasm.c).
+    switch (register_object.member_register_object_type){
+    case DEFINED_REGISTER_OBJECT:
+        *local_index = symbol_table->member_param_count + register_object.member_var_index;
+        break;
+    case UNDEFINED_REGISTER_OBJECT:
+        *local_index = register_object.member_var_index;
+        break;
+    default:
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+        return false;
+    }
+
+    if ((symbol_table->member_param_count + symbol_table->member_var_count) <= *local_index){
+
+        TP_PUT_LOG_MSG_ICE(symbol_table);
+
+        return false;
+    }
+
+    return true;
+}
+
 static bool search_parse_tree(TP_SYMBOL_TABLE* symbol_table, TP_PARSE_TREE* parse_tree)
 {
     bool is_semantic_analysis_success = true;
@@ -291,6 +325,7 @@ static bool register_defined_variable(TP_SYMBOL_TABLE* symbol_table, TP_TOKEN* t
     }else{
 
         object.member_register_object_type = DEFINED_REGISTER_OBJECT;
+        object.member_var_index = symbol_table->member_var_count;
 
         if ( ! register_object(symbol_table, token, &object)){
 
@@ -315,7 +350,9 @@ static bool register_undefined_variable(TP_SYMBOL_TABLE* symbol_table, TP_TOKEN*
         }
     }else{
 
+        // Undefined variables are input parameters in order of first use.
         object.member_register_object_type = UNDEFINED_REGISTER_OBJECT;
+        object.member_var_index = symbol_table->member_param_count;
 
         if ( ! register_object(symbol_table, token, &object)){
 
@@ -323,6 +360,8 @@ static bool register_undefined_variable(TP_SYMBOL_TABLE* symbol_table, TP_TOKEN*
 
             return false;
         }
+
+        ++(symbol_table->member_param_count);
     }
 
     return true;
@@ -394,7 +433,6 @@ static bool register_object_hash_element(
             hash_element->member_sama_hash_data[i].member_register_object.member_register_object_type){
 
             hash_element->member_sama_hash_data[i] = *hash_data;
-            hash_element->member_sama_hash_data[i].member_register_object.member_var_index = symbol_table->member_var_count;
 
             return true;
         }else if (0 == strcmp(hash_element->member_sama_hash_data[i].member_string, hash_data->member_string)){
@@ -407,7 +445,7 @@ static bool register_object_hash_element(
 
     if (NULL == next){
 
-        next = (REGISTER_OBJECT_HASH_ELEMENT*)calloc(sizeof(REGISTER_OBJECT_HASH_ELEMENT), 1);
+        next = (REGISTER_OBJECT_HASH_ELEMENT*)TP_CALLOC(symbol_table, sizeof(REGISTER_OBJECT_HASH_ELEMENT), 1);
 
         if (NULL == next){
 
@@ -417,7 +455,6 @@ static bool register_object_hash_element(
         }
 
         next->member_sama_hash_data[0] = *hash_data;
-        next->member_sama_hash_data[0].member_register_object.member_var_index = symbol_table->member_var_count;
 
         hash_element->member_next = (struct register_object_hash_element_*)next;
 
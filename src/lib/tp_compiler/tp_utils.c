@@ -1,6 +1,9 @@
 
 // (C) Shin'ichi Ichikawa. Released under the MIT license.
 
+#if ! defined(_WIN32)
+#include <malloc.h>
+#endif
 #include "tp_compiler.h"
 
 typedef enum TP_LOG_FORMAT_STATUS_{
@@ -29,12 +32,136 @@ static bool write_param_log_msg(
     TP_SYMBOL_TABLE* symbol_table, bool is_write_file, bool is_disp, size_t param_index,
     TP_LOG_PARAM_ELEMENT* log_param_element, size_t log_param_element_num
 );
+static FILE* get_disp_log_file(TP_SYMBOL_TABLE* symbol_table);
+static size_t get_allocation_size(void* ptr);
+static void count_allocation(TP_SYMBOL_TABLE* symbol_table, void* ptr, size_t prev_size);
+
+uint64_t tp_get_wall_time(void)
+{
+    // Nanoseconds of the monotonic clock.
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency = { 0 };
+
+    if (0 == frequency.QuadPart){
+
+        (void)QueryPerformanceFrequency(&frequency);
+    }
+
+    LARGE_INTEGER counter = { 0 };
+
+    (void)QueryPerformanceCounter(&counter);
+
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000 +
+        (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000 / frequency.QuadPart;
+#else
+    struct timespec now = { 0 };
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+#endif
+}
+
+uint64_t tp_get_cpu_time(void)
+{
+    // Nanoseconds of the user and kernel time of the current thread.
+#if defined(_WIN32)
+    FILETIME creation_time = { 0 };
+    FILETIME exit_time = { 0 };
+    FILETIME kernel_time = { 0 };
+    FILETIME user_time = { 0 };
+
+    if ( ! GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time)){
+
+        return 0;
+    }
+
+    uint64_t kernel = ((uint64_t)(kernel_time.dwHighDateTime) << 32) | kernel_time.dwLowDateTime;
+    uint64_t user = ((uint64_t)(user_time.dwHighDateTime) << 32) | user_time.dwLowDateTime;
+
+    // FILETIME is in 100 nanoseconds.
+    return (kernel + user) * 100;
+#else
+    struct timespec now = { 0 };
+
+    (void)clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+#endif
+}
+
+void* tp_calloc(TP_SYMBOL_TABLE* symbol_table, size_t num, size_t size, uint8_t* file, size_t line_num)
+{
+    // NOTE: The debug CRT reports the memory leak at the caller of TP_CALLOC(see _CRTDBG_MAP_ALLOC).
+#if defined(_DEBUG)
+    void* ptr = _calloc_dbg(num, size, _NORMAL_BLOCK, file, (int)line_num);
+#else
+    void* ptr = calloc(num, size);
+#endif
+
+    if (ptr && symbol_table && symbol_table->member_is_record_compile_phase){
+
+        count_allocation(symbol_table, ptr, 0);
+    }
+
+    return ptr;
+}
+
+void* tp_realloc(TP_SYMBOL_TABLE* symbol_table, void* ptr, size_t size, uint8_t* file, size_t line_num)
+{
+    bool is_record = (symbol_table && symbol_table->member_is_record_compile_phase);
+
+    size_t prev_size = ((is_record && ptr) ? get_allocation_size(ptr) : 0);
+
+#if defined(_DEBUG)
+    void* new_ptr = _realloc_dbg(ptr, size, _NORMAL_BLOCK, file, (int)line_num);
+#else
+    void* new_ptr = realloc(ptr, size);
+#endif
+
+    if (new_ptr && is_record){
+
+        count_allocation(symbol_table, new_ptr, prev_size);
+    }
+
+    return new_ptr;
+}
+
+static size_t get_allocation_size(void* ptr)
+{
+#if defined(_WIN32)
+    return _msize(ptr);
+#else
+    return malloc_usable_size(ptr);
+#endif
+}
+
+static void count_allocation(TP_SYMBOL_TABLE* symbol_table, void* ptr, size_t prev_size)
+{
+    TP_MEMORY_STATISTICS* memory_statistics = &(symbol_table->member_memory_statistics);
+
+    size_t size = get_allocation_size(ptr);
+
+    ++(memory_statistics->member_allocation_num);
+    memory_statistics->member_allocation_bytes += size;
+    memory_statistics->member_live_bytes += ((int64_t)size - (int64_t)prev_size);
+
+    if (memory_statistics->member_peak_bytes < memory_statistics->member_live_bytes){
+
+        memory_statistics->member_peak_bytes = memory_statistics->member_live_bytes;
+    }
+}
 
 #pragma optimize("", off)
 void tp_free(TP_SYMBOL_TABLE* symbol_table, void** ptr, size_t size, uint8_t* file, uint8_t* func, size_t line_num)
 {
     if (ptr && (*ptr)){
 
+        if (symbol_table && symbol_table->member_is_record_compile_phase){
+
+            symbol_table->member_memory_statistics.member_live_bytes -= (int64_t)get_allocation_size(*ptr);
+        }
+
         if (size){
 
             memset(*ptr, 0, size);
@@ -51,6 +178,11 @@ void tp_free2(TP_SYMBOL_TABLE* symbol_table, void*** ptr, size_t size, uint8_t*
 {
     if (ptr && (*ptr)){
 
+        if (symbol_table && symbol_table->member_is_record_compile_phase){
+
+            symbol_table->member_memory_statistics.member_live_bytes -= (int64_t)get_allocation_size(*ptr);
+        }
+
         if (size){
 
             memset(*ptr, 0, size);
@@ -66,6 +198,10 @@ void tp_free2(TP_SYMBOL_TABLE* symbol_table, void*** ptr, size_t size, uint8_t*
 
 void tp_get_last_error(TP_SYMBOL_TABLE* symbol_table, uint8_t* file, uint8_t* func, size_t line_num)
 {
+#if ! defined(_WIN32)
+    // NOTE: The POSIX functions set errno.
+    tp_print_crt_error(symbol_table, file, func, line_num);
+#else
     LPVOID msg_buffer = NULL;
 
     FormatMessageA(
@@ -97,6 +233,7 @@ void tp_get_last_error(TP_SYMBOL_TABLE* symbol_table, uint8_t* file, uint8_t* fu
     SetLastError(NO_ERROR);
 
     errno_t err = _set_errno(0);
+#endif
 }
 
 void tp_print_crt_error(TP_SYMBOL_TABLE* symbol_table, uint8_t* file, uint8_t* func, size_t line_num)
@@ -127,18 +264,31 @@ bool tp_put_log_msg(
     uint8_t* format_string, uint8_t* file, uint8_t* func, size_t line_num,
     TP_LOG_PARAM_ELEMENT* log_param_element, size_t log_param_element_num)
 {
-    bool is_write_file = symbol_table->member_is_output_log_file;
+    FILE* disp_log_file = get_disp_log_file(symbol_table);
 
-    bool is_disp = (
-        (TP_LOG_TYPE_DISP_FORCE == log_type) ||
-        ((false == symbol_table->member_log_hide_after_disp) &&
-        ((TP_LOG_TYPE_DEFAULT == log_type) ||
-        (TP_LOG_TYPE_HIDE_AFTER_DISP == log_type)))
-    );
+    bool is_write_file = false;
+    bool is_disp = false;
 
-    if (symbol_table->member_is_no_output_messages){
+    if (NULL == symbol_table){
 
-        is_disp = false;
+        // Called from outside of compile. e.g. tp_release_compiled_function()
+        // NOTE: TP_LOG_TYPE_HIDE(e.g. TRACE) is written to the log file of a compile only.
+        is_disp = (TP_LOG_TYPE_HIDE != log_type);
+    }else{
+
+        is_write_file = symbol_table->member_is_output_log_file;
+
+        is_disp = (
+            (TP_LOG_TYPE_DISP_FORCE == log_type) ||
+            ((false == symbol_table->member_log_hide_after_disp) &&
+            ((TP_LOG_TYPE_DEFAULT == log_type) ||
+            (TP_LOG_TYPE_HIDE_AFTER_DISP == log_type)))
+        );
+
+        if (symbol_table->member_is_no_output_messages){
+
+            is_disp = false;
+        }
     }
 
     uint8_t file_name[_MAX_PATH] = { 0 };
@@ -164,12 +314,12 @@ bool tp_put_log_msg(
 
     if (is_disp){
 
-        fprintf(symbol_table->member_disp_log_file, "%s(%zd): ", file_name, line_num);
+        fprintf_s(disp_log_file, "%s(%zu): ", file_name, line_num);
     }
 
     if (is_write_file){
 
-        fprintf(symbol_table->member_write_log_file, "%s(%zd): ", file_name, line_num);
+        fprintf_s(symbol_table->member_write_log_file, "%s(%zu): ", file_name, line_num);
     }
 
     if ( ! put_log_msg_main(
@@ -181,7 +331,7 @@ bool tp_put_log_msg(
 
     if (is_disp){
 
-        fprintf(symbol_table->member_disp_log_file, "\n");
+        fprintf(disp_log_file, "\n");
     }
 
     if (is_write_file){
@@ -189,7 +339,7 @@ bool tp_put_log_msg(
         fprintf(symbol_table->member_write_log_file, "\n");
     }
 
-    if (TP_LOG_TYPE_HIDE_AFTER_DISP == log_type){
+    if (symbol_table && (TP_LOG_TYPE_HIDE_AFTER_DISP == log_type)){
 
         symbol_table->member_log_hide_after_disp = true;
     }
@@ -203,6 +353,8 @@ static bool put_log_msg_main(
     TP_SYMBOL_TABLE* symbol_table, TP_LOG_TYPE log_type, bool is_write_file, bool is_disp, uint8_t* format_string,
     TP_LOG_PARAM_ELEMENT* log_param_element, size_t log_param_element_num)
 {
+    FILE* disp_log_file = get_disp_log_file(symbol_table);
+
     TP_LOG_FORMAT_STATUS status = TP_LOG_FORMAT_STATUS_TEXT_START;
     size_t param_index = 0;
     size_t text_start_pos = 0;
@@ -255,7 +407,7 @@ static bool put_log_msg_main(
                 if (is_disp){
 
                     fprintf(
-                        symbol_table->member_disp_log_file,
+                        disp_log_file,
                         "\nERROR: \\0 after TP_LOG_FORMAT_STATUS_PERCENT at %s(%d).\n",
                         __func__, __LINE__
                     );
@@ -313,7 +465,7 @@ static bool put_log_msg_main(
 
             if (is_disp){
 
-                fprintf(symbol_table->member_disp_log_file, "Bad TP_LOG_FORMAT_STATUS(%d).\n", status);
+                fprintf(disp_log_file, "Bad TP_LOG_FORMAT_STATUS(%d).\n", status);
             }
 
             if (is_write_file){
@@ -345,14 +497,18 @@ static bool convert_string_to_value(
     TP_SYMBOL_TABLE* symbol_table, bool is_write_file, bool is_disp,
     uint8_t* text, size_t text_start_pos, size_t text_size, size_t* param_index)
 {
-    if (text_size >= sizeof(symbol_table->member_temp_buffer)){
+    FILE* disp_log_file = get_disp_log_file(symbol_table);
+
+    uint8_t temp_buffer[TP_MESSAGE_BUFFER_SIZE] = { 0 };
+
+    if (text_size >= sizeof(temp_buffer)){
 
         if (is_disp){
 
             fprintf(
-                symbol_table->member_disp_log_file,
-                "\nERROR: text_size(%zd) >= sizeof(%zd: symbol_table->member_temp_buffer) at %s(%d).\n",
-                text_size, sizeof(symbol_table->member_temp_buffer),
+                disp_log_file,
+                "\nERROR: text_size(%zd) >= sizeof(%zd: temp_buffer) at %s(%d).\n",
+                text_size, sizeof(temp_buffer),
                 __func__, __LINE__
             );
         }
@@ -361,8 +517,8 @@ static bool convert_string_to_value(
 
             fprintf(
                 symbol_table->member_write_log_file,
-                "\nERROR: text_size(%zd) >= sizeof(%zd: symbol_table->member_temp_buffer) at %s(%d).\n",
-                text_size, sizeof(symbol_table->member_temp_buffer),
+                "\nERROR: text_size(%zd) >= sizeof(%zd: temp_buffer) at %s(%d).\n",
+                text_size, sizeof(temp_buffer),
                 __func__, __LINE__
             );
         }
@@ -370,20 +526,19 @@ static bool convert_string_to_value(
         return false;
     }
 
-    memset(symbol_table->member_temp_buffer, 0, sizeof(symbol_table->member_temp_buffer));
-    memcpy(symbol_table->member_temp_buffer, text + text_start_pos, text_size);
+    memcpy(temp_buffer, text + text_start_pos, text_size);
 
     char* error_first_char = NULL;
 
-    size_t value = (size_t)strtoull(symbol_table->member_temp_buffer, &error_first_char, 0);
+    size_t value = (size_t)strtoull(temp_buffer, &error_first_char, 0);
 
-    if (symbol_table->member_temp_buffer == error_first_char){
+    if (temp_buffer == error_first_char){
 
         if (is_disp){
 
             fprintf(
-                symbol_table->member_disp_log_file,
-                "\nERROR: strtoull(\"%s\") convert failed at %s(%d).\n", symbol_table->member_temp_buffer,
+                disp_log_file,
+                "\nERROR: strtoull(\"%s\") convert failed at %s(%d).\n", temp_buffer,
                 __func__, __LINE__
             );
         }
@@ -392,7 +547,7 @@ static bool convert_string_to_value(
 
             fprintf(
                 symbol_table->member_write_log_file,
-                "\nERROR: strtoull(\"%s\") convert failed at %s(%d).\n", symbol_table->member_temp_buffer,
+                "\nERROR: strtoull(\"%s\") convert failed at %s(%d).\n", temp_buffer,
                 __func__, __LINE__
             );
         }
@@ -415,11 +570,13 @@ static bool convert_string_to_value(
 static bool write_text_log_msg(
     TP_SYMBOL_TABLE* symbol_table, bool is_write_file, bool is_disp, uint8_t* text, size_t text_start_pos, size_t text_size)
 {
+    FILE* disp_log_file = get_disp_log_file(symbol_table);
+
     size_t fwrite_bytes = 0;
 
     if (is_disp){
 
-        fwrite_bytes = fwrite(text + text_start_pos, sizeof(uint8_t), text_size, symbol_table->member_disp_log_file);
+        fwrite_bytes = fwrite(text + text_start_pos, sizeof(uint8_t), text_size, disp_log_file);
     }
 
     if (is_write_file){
@@ -434,12 +591,14 @@ static bool write_param_log_msg(
     TP_SYMBOL_TABLE* symbol_table, bool is_write_file, bool is_disp, size_t param_index,
     TP_LOG_PARAM_ELEMENT* log_param_element, size_t log_param_element_num)
 {
+    FILE* disp_log_file = get_disp_log_file(symbol_table);
+
     if (log_param_element_num <= param_index){
 
         if (is_disp){
 
             fprintf(
-                symbol_table->member_disp_log_file, "\nERROR: log_param_element_num(%zd) <= param_index(%zd) at %s(%d).\n",
+                disp_log_file, "\nERROR: log_param_element_num(%zd) <= param_index(%zd) at %s(%d).\n",
                 log_param_element_num, param_index, __func__, __LINE__
             );
         }
@@ -467,7 +626,7 @@ static bool write_param_log_msg(
 
         if (is_disp){
 
-            fprintf(symbol_table->member_disp_log_file, "%s", string);
+            fprintf(disp_log_file, "%s", string);
         }
 
         if (is_write_file){
@@ -481,7 +640,7 @@ static bool write_param_log_msg(
 
         if (is_disp){
 
-            fprintf(symbol_table->member_disp_log_file, "%d", log_param_element[param_index].member_body.member_int32_value);
+            fprintf(disp_log_file, "%d", log_param_element[param_index].member_body.member_int32_value);
         }
 
         if (is_write_file){
@@ -494,7 +653,7 @@ static bool write_param_log_msg(
 
         if (is_disp){
 
-            fprintf(symbol_table->member_disp_log_file, "%zd", log_param_element[param_index].member_body.member_uint64_value);
+            fprintf(disp_log_file, "%zd", log_param_element[param_index].member_body.member_uint64_value);
         }
 
         if (is_write_file){
@@ -507,7 +666,7 @@ static bool write_param_log_msg(
 
         if (is_disp){
 
-            fprintf(symbol_table->member_disp_log_file, "Bad TP_LOG_PARAM_TYPE(%d).\n", log_param_element[param_index].member_type);
+            fprintf(disp_log_file, "Bad TP_LOG_PARAM_TYPE(%d).\n", log_param_element[param_index].member_type);
         }
 
         if (is_write_file){
@@ -521,3 +680,158 @@ static bool write_param_log_msg(
     return true;
 }
 
+static FILE* get_disp_log_file(TP_SYMBOL_TABLE* symbol_table)
+{
+    return symbol_table ? symbol_table->member_disp_log_file : stderr;
+}
+
+#if ! defined(_WIN32)
+errno_t fopen_s(FILE** file_stream, const char* path, const char* mode)
+{
+    if ((NULL == file_stream) || (NULL == path) || (NULL == mode)){
+
+        return EINVAL;
+    }
+
+    *file_stream = fopen(path, mode);
+
+    return (*file_stream) ? 0 : errno;
+}
+
+errno_t localtime_s(struct tm* local_time, const time_t* now)
+{
+    if ((NULL == local_time) || (NULL == now)){
+
+        return EINVAL;
+    }
+
+    return localtime_r(now, local_time) ? 0 : errno;
+}
+
+errno_t strerror_s(char* buffer, size_t buffer_size, int error_number)
+{
+    if ((NULL == buffer) || (0 == buffer_size)){
+
+        return EINVAL;
+    }
+
+    int length = snprintf(buffer, buffer_size, "%s", strerror(error_number));
+
+    return ((0 <= length) && ((size_t)length < buffer_size)) ? 0 : ERANGE;
+}
+
+errno_t strncpy_s(char* dest, size_t dest_size, const char* src, size_t count)
+{
+    if ((NULL == dest) || (0 == dest_size) || (NULL == src)){
+
+        return EINVAL;
+    }
+
+    size_t length = strnlen(src, count);
+
+    if (dest_size <= length){
+
+        dest[0] = '\0';
+
+        return ERANGE;
+    }
+
+    memcpy(dest, src, length);
+    dest[length] = '\0';
+
+    return 0;
+}
+
+errno_t _splitpath_s(
+    const char* path, char* drive, size_t drive_size, char* dir, size_t dir_size,
+    char* fname, size_t fname_size, char* ext, size_t ext_size)
+{
+    // NOTE: There is no drive letter; dir keeps the last separator like Windows.
+    if (NULL == path){
+
+        return EINVAL;
+    }
+
+    const char* separator = strrchr(path, '/');
+    const char* base = (separator ? (separator + 1) : path);
+    const char* dot = strrchr(base, '.');
+
+    if (NULL == dot){
+
+        dot = base + strlen(base);
+    }
+
+    size_t dir_length = (size_t)(base - path);
+    size_t fname_length = (size_t)(dot - base);
+    size_t ext_length = strlen(dot);
+
+    if ((drive && (0 == drive_size)) || (dir && (dir_size <= dir_length)) ||
+        (fname && (fname_size <= fname_length)) || (ext && (ext_size <= ext_length))){
+
+        return ERANGE;
+    }
+
+    if (drive){
+
+        drive[0] = '\0';
+    }
+
+    if (dir){
+
+        memcpy(dir, path, dir_length);
+        dir[dir_length] = '\0';
+    }
+
+    if (fname){
+
+        memcpy(fname, base, fname_length);
+        fname[fname_length] = '\0';
+    }
+
+    if (ext){
+
+        memcpy(ext, dot, ext_length);
+        ext[ext_length] = '\0';
+    }
+
+    return 0;
+}
+
+errno_t _makepath_s(
+    char* path, size_t path_size, const char* drive, const char* dir, const char* fname, const char* ext)
+{
+    if ((NULL == path) || (0 == path_size)){
+
+        return EINVAL;
+    }
+
+    const char* dir_separator = "";
+
+    if (dir && dir[0] && ('/' != dir[strlen(dir) - 1])){
+
+        dir_separator = "/";
+    }
+
+    const char* ext_separator = "";
+
+    if (ext && ext[0] && ('.' != ext[0])){
+
+        ext_separator = ".";
+    }
+
+    int length = snprintf(
+        path, path_size, "%s%s%s%s%s%s",
+        (drive ? drive : ""), (dir ? dir : ""), dir_separator,
+        (fname ? fname : ""), ext_separator, (ext ? ext : "")
+    );
+
+    if ((length < 0) || (path_size <= (size_t)length)){
+
+        path[0] = '\0';
+
+        return ERANGE;
+    }
+
+    return 0;
+}
+#endif
@@ -0,0 +1,508 @@
+// (C) Shin'ichi Ichikawa. Released under the MIT license.
+
+#include "tp_compiler.h"
+
+// wasm interpreter:
+// The validated wasm instructions(see tp_get_wasm_instruction) are translated once into
+// an interpreter instruction array(get_local/i32.const followed by a binary operator are
+// fused into one instruction). The wasm stack depth and local indexes are checked by
+// tp_validate_wasm_instruction, so the interpreter loop does not check them. GCC and Clang
+// dispatch by labels as values(each instruction jumps to the next one), other compilers by
+// the switch statement.
+
+#if defined(__GNUC__)
+#define TP_WASM_INTERPRETER_THREADED_DISPATCH
+#endif
+
+static void free_interpreter_code(TP_WASM_INTERPRETER_CODE** interpreter_code);
+static int64_t atomic_increment(volatile int64_t* value);
+static int64_t atomic_decrement(volatile int64_t* value);
+static bool translate_wasm_instruction(
+    TP_SYMBOL_TABLE* symbol_table, TP_WASM_INTERPRETER_CODE* interpreter_code
+);
+static void append_instruction(
+    TP_WASM_INTERPRETER_CODE* interpreter_code, TP_WASM_INTERPRETER_OPCODE opcode, int32_t operand
+);
+static TP_WASM_INTERPRETER_OPCODE get_binary_opcode(uint32_t wasm_opcode);
+static int32_t* allocate_frame(TP_WASM_INTERPRETER_CODE* interpreter_code, int32_t* frame_buffer);
+static void free_frame(TP_WASM_INTERPRETER_CODE* interpreter_code, int32_t* frame_buffer, int32_t** frame);
+static bool run_wasm_interpreter(TP_WASM_INTERPRETER_CODE* interpreter_code, int32_t* frame, int32_t* return_value);
+
+TP_WASM_INTERPRETER_CODE* tp_make_wasm_interpreter_code(TP_SYMBOL_TABLE* symbol_table)
+{
+    TP_WASM_INTERPRETER_CODE* interpreter_code =
+        (TP_WASM_INTERPRETER_CODE*)TP_CALLOC(symbol_table, 1, sizeof(TP_WASM_INTERPRETER_CODE));
+
+    if (NULL == interpreter_code){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return NULL;
+    }
+
+    interpreter_code->member_ref_count = 1;
+
+    // NOTE: The number of locals is checked by tp_validate_wasm_instruction.
+    interpreter_code->member_param_count = symbol_table->member_wasm_instruction_param_count;
+    interpreter_code->member_local_num =
+        symbol_table->member_wasm_instruction_param_count + symbol_table->member_wasm_instruction_var_count;
+    interpreter_code->member_stack_depth_max = symbol_table->member_wasm_instruction_stack_depth_max;
+
+    if ( ! translate_wasm_instruction(symbol_table, interpreter_code)){
+
+        TP_PUT_LOG_MSG_TRACE(symbol_table);
+
+        goto error_proc;
+    }
+
+    // x64 code of tier up.
+    uint32_t wasm_instruction_num = symbol_table->member_wasm_instruction_num;
+
+    interpreter_code->member_wasm_instruction =
+        (TP_WASM_INSTRUCTION*)TP_CALLOC(symbol_table, wasm_instruction_num, sizeof(TP_WASM_INSTRUCTION));
+
+    if (NULL == interpreter_code->member_wasm_instruction){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        goto error_proc;
+    }
+
+    memcpy(
+        interpreter_code->member_wasm_instruction, symbol_table->member_wasm_instruction,
+        wasm_instruction_num * sizeof(TP_WASM_INSTRUCTION)
+    );
+
+    interpreter_code->member_wasm_instruction_num = wasm_instruction_num;
+
+    return interpreter_code;
+
+error_proc:
+
+    free_interpreter_code(&interpreter_code);
+
+    return NULL;
+}
+
+void tp_add_ref_wasm_interpreter_code(TP_WASM_INTERPRETER_CODE* interpreter_code)
+{
+    (void)atomic_increment(&(interpreter_code->member_ref_count));
+}
+
+void tp_release_wasm_interpreter_code(TP_WASM_INTERPRETER_CODE** interpreter_code)
+{
+    if ((NULL == interpreter_code) || (NULL == *interpreter_code)){
+
+        return;
+    }
+
+    if (atomic_decrement(&((*interpreter_code)->member_ref_count))){
+
+        *interpreter_code = NULL;
+
+        return;
+    }
+
+    free_interpreter_code(interpreter_code);
+}
+
+static void free_interpreter_code(TP_WASM_INTERPRETER_CODE** interpreter_code)
+{
+    if ((NULL == interpreter_code) || (NULL == *interpreter_code)){
+
+        return;
+    }
+
+    TP_WASM_INTERPRETER_CODE* code = *interpreter_code;
+
+    TP_FREE(NULL, &(code->member_instruction), code->member_instruction_num * sizeof(TP_WASM_INTERPRETER_INSTRUCTION));
+
+    TP_FREE(
+        NULL, &(code->member_wasm_instruction),
+        code->member_wasm_instruction_num * sizeof(TP_WASM_INSTRUCTION)
+    );
+
+    TP_FREE(NULL, interpreter_code, sizeof(TP_WASM_INTERPRETER_CODE));
+}
+
+static int64_t atomic_increment(volatile int64_t* value)
+{
+#if defined(_WIN32)
+    return InterlockedIncrement64((volatile LONG64*)value);
+#else
+    return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static int64_t atomic_decrement(volatile int64_t* value)
+{
+#if defined(_WIN32)
+    return InterlockedDecrement64((volatile LONG64*)value);
+#else
+    return __atomic_sub_fetch(value, 1, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static bool translate_wasm_instruction(
+    TP_SYMBOL_TABLE* symbol_table, TP_WASM_INTERPRETER_CODE* interpreter_code)
+{
+    uint32_t wasm_instruction_num = symbol_table->member_wasm_instruction_num;
+    TP_WASM_INSTRUCTION* wasm_instruction = symbol_table->member_wasm_instruction;
+
+    // NOTE: The number of instructions is not more than the number of wasm instructions.
+    interpreter_code->member_instruction = (TP_WASM_INTERPRETER_INSTRUCTION*)TP_CALLOC(symbol_table,
+        wasm_instruction_num, sizeof(TP_WASM_INTERPRETER_INSTRUCTION)
+    );
+
+    if (NULL == interpreter_code->member_instruction){
+
+        TP_PRINT_CRT_ERROR(symbol_table);
+
+        return false;
+    }
+
+    for (uint32_t i = 0; wasm_instruction_num > i; ++i){
+
+        uint32_t wasm_opcode = wasm_instruction[i].member_wasm_opcode;
+
+        // NOTE: END is the last wasm instruction.
+        TP_WASM_INTERPRETER_OPCODE binary_opcode = ((wasm_instruction_num > (i + 1)) ?
+            get_binary_opcode(wasm_instruction[i + 1].member_wasm_opcode) : TP_WASM_INTERPRETER_OPCODE_NUM);
+
+        switch (wasm_opcode){
+        case TP_WASM_OPCODE_GET_LOCAL:{
+
+            int32_t local_index = (int32_t)(wasm_instruction[i].member_immediate.member_local_index);
+
+            if (TP_WASM_INTERPRETER_OPCODE_NUM != binary_opcode){
+
+                ++i;
+
+                append_instruction(
+                    interpreter_code,
+                    (TP_WASM_INTERPRETER_OPCODE)(binary_opcode +
+                        (TP_WASM_INTERPRETER_OPCODE_I32_ADD_LOCAL - TP_WASM_INTERPRETER_OPCODE_I32_ADD)),
+                    local_index
+                );
+            }else{
+
+                append_instruction(interpreter_code, TP_WASM_INTERPRETER_OPCODE_GET_LOCAL, local_index);
+            }
+            break;
+        }
+        case TP_WASM_OPCODE_SET_LOCAL:
+            append_instruction(
+                interpreter_code, TP_WASM_INTERPRETER_OPCODE_SET_LOCAL,
+                (int32_t)(wasm_instruction[i].member_immediate.member_local_index)
+            );
+            break;
+        case TP_WASM_OPCODE_TEE_LOCAL:
+            append_instruction(
+                interpreter_code, TP_WASM_INTERPRETER_OPCODE_TEE_LOCAL,
+                (int32_t)(wasm_instruction[i].member_immediate.member_local_index)
+            );
+            break;
+        case TP_WASM_OPCODE_I32_CONST:{
+
+            int32_t value = wasm_instruction[i].member_immediate.member_i32;
+
+            if (TP_WASM_INTERPRETER_OPCODE_NUM != binary_opcode){
+
+                ++i;
+
+                append_instruction(
+                    interpreter_code,
+                    (TP_WASM_INTERPRETER_OPCODE)(binary_opcode +
+                        (TP_WASM_INTERPRETER_OPCODE_I32_ADD_CONST - TP_WASM_INTERPRETER_OPCODE_I32_ADD)),
+                    value
+                );
+            }else{
+
+                append_instruction(interpreter_code, TP_WASM_INTERPRETER_OPCODE_I32_CONST, value);
+            }
+            break;
+        }
+        case TP_WASM_OPCODE_I32_ADD:
+//          break;
+        case TP_WASM_OPCODE_I32_SUB:
+//          break;
+        case TP_WASM_OPCODE_I32_MUL:
+//          break;
+        case TP_WASM_OPCODE_I32_DIV:
+//          break;
+        case TP_WASM_OPCODE_I32_XOR:
+            append_instruction(interpreter_code, get_binary_opcode(wasm_opcode), 0);
+            break;
+        case TP_WASM_OPCODE_END:
+            append_instruction(interpreter_code, TP_WASM_INTERPRETER_OPCODE_END, 0);
+            return true;
+        default:
+            TP_PUT_LOG_MSG_ICE(symbol_table);
+            return false;
+        }
+    }
+
+    TP_PUT_LOG_MSG_ICE(symbol_table);
+
+    return false;
+}
+
+static void append_instruction(
+    TP_WASM_INTERPRETER_CODE* interpreter_code, TP_WASM_INTERPRETER_OPCODE opcode, int32_t operand)
+{
+    interpreter_code->member_instruction[interpreter_code->member_instruction_num].member_opcode = opcode;
+    interpreter_code->member_instruction[interpreter_code->member_instruction_num].member_operand = operand;
+
+    ++(interpreter_code->member_instruction_num);
+}
+
+static TP_WASM_INTERPRETER_OPCODE get_binary_opcode(uint32_t wasm_opcode)
+{
+    switch (wasm_opcode){
+    case TP_WASM_OPCODE_I32_ADD: return TP_WASM_INTERPRETER_OPCODE_I32_ADD;
+    case TP_WASM_OPCODE_I32_SUB: return TP_WASM_INTERPRETER_OPCODE_I32_SUB;
+    case TP_WASM_OPCODE_I32_MUL: return TP_WASM_INTERPRETER_OPCODE_I32_MUL;
+    case TP_WASM_OPCODE_I32_DIV: return TP_WASM_INTERPRETER_OPCODE_I32_DIV;
+    case TP_WASM_OPCODE_I32_XOR: return TP_WASM_INTERPRETER_OPCODE_I32_XOR;
+    default:
+        break;
+    }
+
+    return TP_WASM_INTERPRETER_OPCODE_NUM;
+}
+
+bool tp_run_wasm_interpreter(
+    TP_WASM_INTERPRETER_CODE* interpreter_code, const int32_t* inputs, int32_t* return_value)
+{
+    int32_t frame_buffer[TP_WASM_INTERPRETER_FRAME_SIZE];
+
+    int32_t* frame = allocate_frame(interpreter_code, frame_buffer);
+
+    if (NULL == frame){
+
+        return false;
+    }
+
+    // NOTE: NULL == inputs: all parameters are 0(locals of the frame are zero cleared).
+    for (uint32_t i = 0; inputs && (interpreter_code->member_param_count > i); ++i){
+
+        frame[i] = inputs[i];
+    }
+
+    bool status = run_wasm_interpreter(interpreter_code, frame, return_value);
+
+    free_frame(interpreter_code, frame_buffer, &frame);
+
+    return status;
+}
+
+bool tp_run_wasm_interpreter_batch(
+    TP_WASM_INTERPRETER_CODE* interpreter_code,
+    const int32_t* const* columns, int32_t* outputs, uint64_t row_count)
+{
+    int32_t frame_buffer[TP_WASM_INTERPRETER_FRAME_SIZE];
+
+    int32_t* frame = allocate_frame(interpreter_code, frame_buffer);
+
+    if (NULL == frame){
+
+        return false;
+    }
+
+    bool status = true;
+
+    for (uint64_t row = 0; row_count > row; ++row){
+
+        for (uint32_t i = 0; interpreter_code->member_param_count > i; ++i){
+
+            frame[i] = columns[i][row];
+        }
+
+        if ( ! run_wasm_interpreter(interpreter_code, frame, &(outputs[row]))){
+
+            status = false;
+
+            break;
+        }
+    }
+
+    free_frame(interpreter_code, frame_buffer, &frame);
+
+    return status;
+}
+
+static int32_t* allocate_frame(TP_WASM_INTERPRETER_CODE* interpreter_code, int32_t* frame_buffer)
+{
+    // Local variables, and the wasm stack after them.
+    uint64_t frame_size = (uint64_t)(interpreter_code->member_local_num) + interpreter_code->member_stack_depth_max;
+
+    if (TP_WASM_INTERPRETER_FRAME_SIZE >= frame_size){
+
+        memset(frame_buffer, 0, interpreter_code->member_local_num * sizeof(int32_t));
+
+        return frame_buffer;
+    }
+
+    int32_t* frame = (int32_t*)TP_CALLOC(NULL, (size_t)frame_size, sizeof(int32_t));
+
+    if (NULL == frame){
+
+        TP_PRINT_CRT_ERROR(NULL);
+
+        return NULL;
+    }
+
+    return frame;
+}
+
+static void free_frame(TP_WASM_INTERPRETER_CODE* interpreter_code, int32_t* frame_buffer, int32_t** frame)
+{
+    if (frame_buffer == *frame){
+
+        *frame = NULL;
+
+        return;
+    }
+
+    TP_FREE(
+        NULL, frame,
+        ((size_t)(interpreter_code->member_local_num) + interpreter_code->member_stack_depth_max) * sizeof(int32_t)
+    );
+}
+
+static bool run_wasm_interpreter(TP_WASM_INTERPRETER_CODE* interpreter_code, int32_t* frame, int32_t* return_value)
+{
+    TP_WASM_INTERPRETER_INSTRUCTION* ip = interpreter_code->member_instruction;
+
+    int32_t* local = frame;
+    int32_t* sp = frame + interpreter_code->member_local_num; // sp[-1] is the top of the wasm stack.
+
+    int32_t value = 0;
+
+    // NOTE: Wrap around arithmetic of wasm, without undefined behavior of signed overflow.
+#define TP_I32_ADD(a, b) ((int32_t)((uint32_t)(a) + (uint32_t)(b)))
+#define TP_I32_SUB(a, b) ((int32_t)((uint32_t)(a) - (uint32_t)(b)))
+#define TP_I32_MUL(a, b) ((int32_t)((uint32_t)(a) * (uint32_t)(b)))
+#define TP_I32_XOR(a, b) ((a) ^ (b))
+    // NOTE: Integer divide error of wasm(trap).
+#define TP_I32_DIV_CHECK(a, b) \
+    if ((0 == (b)) || ((INT32_MIN == (a)) && (-1 == (b)))){ goto divide_error; }
+
+#if defined(TP_WASM_INTERPRETER_THREADED_DISPATCH)
+    static void* const dispatch_table[TP_WASM_INTERPRETER_OPCODE_NUM] = {
+        [TP_WASM_INTERPRETER_OPCODE_GET_LOCAL] = &&op_get_local,
+        [TP_WASM_INTERPRETER_OPCODE_SET_LOCAL] = &&op_set_local,
+        [TP_WASM_INTERPRETER_OPCODE_TEE_LOCAL] = &&op_tee_local,
+        [TP_WASM_INTERPRETER_OPCODE_I32_CONST] = &&op_i32_const,
+        [TP_WASM_INTERPRETER_OPCODE_I32_ADD] = &&op_i32_add,
+        [TP_WASM_INTERPRETER_OPCODE_I32_SUB] = &&op_i32_sub,
+        [TP_WASM_INTERPRETER_OPCODE_I32_MUL] = &&op_i32_mul,
+        [TP_WASM_INTERPRETER_OPCODE_I32_DIV] = &&op_i32_div,
+        [TP_WASM_INTERPRETER_OPCODE_I32_XOR] = &&op_i32_xor,
+        [TP_WASM_INTERPRETER_OPCODE_I32_ADD_LOCAL] = &&op_i32_add_local,
+        [TP_WASM_INTERPRETER_OPCODE_I32_SUB_LOCAL] = &&op_i32_sub_local,
+        [TP_WASM_INTERPRETER_OPCODE_I32_MUL_LOCAL] = &&op_i32_mul_local,
+        [TP_WASM_INTERPRETER_OPCODE_I32_DIV_LOCAL] = &&op_i32_div_local,
+        [TP_WASM_INTERPRETER_OPCODE_I32_XOR_LOCAL] = &&op_i32_xor_local,
+        [TP_WASM_INTERPRETER_OPCODE_I32_ADD_CONST] = &&op_i32_add_const,
+        [TP_WASM_INTERPRETER_OPCODE_I32_SUB_CONST] = &&op_i32_sub_const,
+        [TP_WASM_INTERPRETER_OPCODE_I32_MUL_CONST] = &&op_i32_mul_const,
+        [TP_WASM_INTERPRETER_OPCODE_I32_DIV_CONST] = &&op_i32_div_const,
+        [TP_WASM_INTERPRETER_OPCODE_I32_XOR_CONST] = &&op_i32_xor_const,
+        [TP_WASM_INTERPRETER_OPCODE_END] = &&op_end
+    };
+#define TP_INTERPRETER_OP(opcode, label) label
+#define TP_INTERPRETER_NEXT() goto *dispatch_table[(++ip)->member_opcode]
+
+    goto *dispatch_table[ip->member_opcode];
+#else
+#define TP_INTERPRETER_OP(opcode, label) case (opcode)
+#define TP_INTERPRETER_NEXT() ++ip; goto dispatch
+
+dispatch:
+    switch (ip->member_opcode){
+#endif
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_GET_LOCAL, op_get_local):
+        *sp++ = local[ip->member_operand];
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_SET_LOCAL, op_set_local):
+        local[ip->member_operand] = *--sp;
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_TEE_LOCAL, op_tee_local):
+        local[ip->member_operand] = sp[-1];
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_CONST, op_i32_const):
+        *sp++ = ip->member_operand;
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_ADD, op_i32_add):
+        --sp; sp[-1] = TP_I32_ADD(sp[-1], sp[0]);
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_SUB, op_i32_sub):
+        --sp; sp[-1] = TP_I32_SUB(sp[-1], sp[0]);
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_MUL, op_i32_mul):
+        --sp; sp[-1] = TP_I32_MUL(sp[-1], sp[0]);
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_DIV, op_i32_div):
+        --sp; TP_I32_DIV_CHECK(sp[-1], sp[0]); sp[-1] /= sp[0];
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_XOR, op_i32_xor):
+        --sp; sp[-1] = TP_I32_XOR(sp[-1], sp[0]);
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_ADD_LOCAL, op_i32_add_local):
+        sp[-1] = TP_I32_ADD(sp[-1], local[ip->member_operand]);
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_SUB_LOCAL, op_i32_sub_local):
+        sp[-1] = TP_I32_SUB(sp[-1], local[ip->member_operand]);
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_MUL_LOCAL, op_i32_mul_local):
+        sp[-1] = TP_I32_MUL(sp[-1], local[ip->member_operand]);
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_DIV_LOCAL, op_i32_div_local):
+        value = local[ip->member_operand]; TP_I32_DIV_CHECK(sp[-1], value); sp[-1] /= value;
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_XOR_LOCAL, op_i32_xor_local):
+        sp[-1] = TP_I32_XOR(sp[-1], local[ip->member_operand]);
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_ADD_CONST, op_i32_add_const):
+        sp[-1] = TP_I32_ADD(sp[-1], ip->member_operand);
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_SUB_CONST, op_i32_sub_const):
+        sp[-1] = TP_I32_SUB(sp[-1], ip->member_operand);
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_MUL_CONST, op_i32_mul_const):
+        sp[-1] = TP_I32_MUL(sp[-1], ip->member_operand);
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_DIV_CONST, op_i32_div_const):
+        value = ip->member_operand; TP_I32_DIV_CHECK(sp[-1], value); sp[-1] /= value;
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_I32_XOR_CONST, op_i32_xor_const):
+        sp[-1] = TP_I32_XOR(sp[-1], ip->member_operand);
+        TP_INTERPRETER_NEXT();
+    TP_INTERPRETER_OP(TP_WASM_INTERPRETER_OPCODE_END, op_end):
+        *return_value = sp[-1];
+        return true;
+#if ! defined(TP_WASM_INTERPRETER_THREADED_DISPATCH)
+    default:
+        break;
+    }
+
+    fprintf_s(stderr, "ERROR: Bad interpreter opcode(%d) at %s function.\n", ip->member_opcode, __func__);
+
+    return false;
+#endif
+
+#undef TP_INTERPRETER_NEXT
+#undef TP_INTERPRETER_OP
+#undef TP_I32_DIV_CHECK
+#undef TP_I32_XOR
+#undef TP_I32_MUL
+#undef TP_I32_SUB
+#undef TP_I32_ADD
+
+divide_error:
+
+    fprintf_s(stderr, "ERROR: Integer divide error at %s function.\n", __func__);
+
+    return false;
+}